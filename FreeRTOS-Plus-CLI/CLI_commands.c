@@ -10,6 +10,15 @@
 #include "HL_emac.h"
 #include "HL_mdio.h"
 #include "HL_phy_dp83640.h"
+#include "ptp_clock.h"
+#include "pps_discipline.h"
+#include "clock_output.h"
+#include "ptp_crosstimestamp.h"
+#include "rti_runtimestats.h"
+#include "FreeRTOS_IP_Private.h"
+#include "pcap_capture.h"
+#include "iperf.h"
+#include "emac_stats.h"
 extern hdkif_t hdkif_data[MAX_EMAC_INSTANCE];
 
 
@@ -168,48 +177,151 @@ portBASE_TYPE xMemTestCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, co
 
 /*-----------------------------------------------------------*/
 BaseType_t xEMACRxEventSemaphoreFulls = 0;
+
+/* Az sszestsekben szerepl EMAC statisztika szmllk */
+static const uint8_t ucEmacStatRxErrors[] = { emacstatsRXCRCERRORS, emacstatsRXALIGNCODEERRORS, emacstatsRXOVERSIZED, emacstatsRXJABBER, emacstatsRXUNDERSIZED, emacstatsRXFRAGMENTS };
+static const uint8_t ucEmacStatTxErrors[] = { emacstatsTXEXCESSIVECOLL, emacstatsTXLATECOLL, emacstatsTXUNDERRUN, emacstatsTXCARRIERSENSE };
+static const uint8_t ucEmacStatDrops[] = { emacstatsRXSOFOVERRUNS, emacstatsRXMOFOVERRUNS, emacstatsRXDMAOVERRUNS, emacstatsRXEVENTLOST };
+#define emacstatCOUNT(x)			( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+#define emacstatCOUNTERS_PER_CALL	( 6U )
+
+static uint64_t prvEmacStatTotal( const uint8_t *pucCounters, size_t uxCount )
+{
+	uint64_t ullTotal = 0U;
+
+	while( uxCount-- > 0U )
+	{
+		ullTotal += ullEMACStatsGetTotal( pucCounters[ uxCount ] );
+	}
+	return ullTotal;
+}
+
+static uint32_t prvEmacStatRate( const uint8_t *pucCounters, size_t uxCount )
+{
+	uint32_t ulRate = 0U;
+
+	while( uxCount-- > 0U )
+	{
+		ulRate += ulEMACStatsGetRate( pucCounters[ uxCount ] );
+	}
+	return ulRate;
+}
+
 portBASE_TYPE xEmacStatCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString )
 {
+	static BaseType_t xIndex = 0;
 	BaseType_t xReturnValue = pdFALSE;
-	uint32_t xRxGoodFrames, xRxCrcErrors, xRxAlignCodeErrors, xRxOverSizedFrames, xRxJabberFrames, xRxUnderSizedFrames, xRxFrameFragments, xRxFilteredFrames, xRxOctetFrames, xRxSumErrors, xRxDmaOverruns;
-	uint32_t xTxGoodFrames, xTxCollisionFrames, xTxExcessiveCollision, xTxLateCollision, xTxUnderrunError, xTxCarrierSenseError, xTxOctetFrames, xTxSumErrors;
+	const char *pcParameter;
+	BaseType_t xParameterLength;
+	char *pcBuffer = ( char * ) pcWriteBuffer;
 	uint8_t xMacAddr[6] ={0x00,0x00,0x00,0x00,0x00,0x00};
 	uint32_t xIpAddr, xNetMask, xGatewayAddr, xDNSAddr;
 	uint32_t xRxHeadPointer, xTxHeadPointer;
 	char cIpBuffer[17], cNetMaskBuffer[17], cGWBuffer[17], cDNSBuffer[17];
 	hdkif_t *hdkif = &hdkif_data[0U];
+	EMACLatency_t xLatency;
+	uint32_t ulCounter, ulBucket;
+	size_t uxLength;
+
+	pcParameter = FreeRTOS_CLIGetParameter( ( const char * ) pcCommandString, 1, &xParameterLength );
 
-	// RX Statistics
-	xRxGoodFrames =  EMACReadNetStatRegisters(EMAC_BASE, 0);		// Good Receive Frames Register (RXGOODFRAMES) (offset = 200h)
-	xRxCrcErrors =  EMACReadNetStatRegisters(EMAC_BASE, 4);			// Receive CRC Errors Register (RXCRCERRORS) (offset = 210h)
-	xRxAlignCodeErrors = EMACReadNetStatRegisters(EMAC_BASE, 5);	// Receive Alignment/Code Errors Register (RXALIGNCODEERRORS) (offset = 214h)
-	xRxOverSizedFrames = EMACReadNetStatRegisters(EMAC_BASE, 6);	// Receive Oversized Frames Register (RXOVERSIZED) (offset = 218h)
-	xRxJabberFrames = EMACReadNetStatRegisters(EMAC_BASE, 7);		// Receive Jabber Frames Register (RXJABBER) (offset = 21Ch)
-	xRxUnderSizedFrames = EMACReadNetStatRegisters(EMAC_BASE, 8);	// Receive Undersized Frames Register (RXUNDERSIZED) (offset = 220h)
-	xRxFrameFragments = EMACReadNetStatRegisters(EMAC_BASE, 9);		// Receive Frame Fragments Register (RXFRAGMENTS) (offset = 224h)
-	xRxFilteredFrames = EMACReadNetStatRegisters(EMAC_BASE, 10);	// Filtered Receive Frames Register (RXFILTERED) (offset = 228h)
-	xRxOctetFrames = EMACReadNetStatRegisters(EMAC_BASE, 12);		// Receive Octet Frames Register (RXOCTETS) (offset = 230h)
-	xRxSumErrors = xRxCrcErrors + xRxAlignCodeErrors + xRxOverSizedFrames + xRxJabberFrames + xRxUnderSizedFrames + xRxFrameFragments;
-	xRxDmaOverruns = EMACReadNetStatRegisters(EMAC_BASE, 35);		// Receive DMA Overruns Register (RXDMAOVERRUNS) (offset = 28Ch)
-	// TX Statistics
-	xTxGoodFrames =  EMACReadNetStatRegisters(EMAC_BASE, 13);		// Good Transmit Frames Register (TXGOODFRAMES) (offset = 234h)
-	xTxCollisionFrames = EMACReadNetStatRegisters(EMAC_BASE, 18);	// Transmit Collision Frames Register (TXCOLLISION) (offset = 248h)
-	xTxExcessiveCollision = EMACReadNetStatRegisters(EMAC_BASE, 21);// Transmit Excessive Collision Frames Register (TXEXCESSIVECOLL) (offset = 254h)
-	xTxLateCollision = EMACReadNetStatRegisters(EMAC_BASE, 22);		// Transmit Late Collision Frames Register (TXLATECOLL) (offset = 258h)
-	xTxUnderrunError = EMACReadNetStatRegisters(EMAC_BASE, 23);		// Transmit Underrun Error Register (TXUNDERRUN) (offset = 25Ch)
-	xTxCarrierSenseError = EMACReadNetStatRegisters(EMAC_BASE, 24);	// Transmit Carrier Sense Errors Register (TXCARRIERSENSE) (offset = 260h)
-	xTxOctetFrames = EMACReadNetStatRegisters(EMAC_BASE, 25);		// Transmit Octet Frames Register (TXOCTETS) (offset = 264h)
-	xTxSumErrors = xTxExcessiveCollision + xTxLateCollision + xTxUnderrunError + xTxCarrierSenseError;
-
-	EMACMACSrcAddrGet(EMAC_BASE, xMacAddr);
-	FreeRTOS_GetAddressConfiguration(&xIpAddr, &xNetMask, &xGatewayAddr, &xDNSAddr);
-
-	vAddrToString(cIpBuffer,xIpAddr); vAddrToString(cNetMaskBuffer,xNetMask); vAddrToString(cGWBuffer,xGatewayAddr); vAddrToString(cDNSBuffer,xDNSAddr);
-
-	xRxHeadPointer = HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER));
-	xTxHeadPointer = HWREG(hdkif->emac_base + EMAC_TXHDP(EMAC_CHANNELNUMBER));
-	sprintf((char *)pcWriteBuffer,"EMAC\tHW addr: %02X:%02X:%02X:%02X:%02X:%02X\r\n\tInet:%s Mask:%s\r\n\tGW:%s DNS:%s\r\n\tRX packets:%u errors:%u overruns:%u filtered:%u\r\n\tTX packets:%u errors:%u collisions:%u carrier:%u\r\n\tRX bytes:%u TX bytes:%u\r\n\tRXHP:%p TXHP:%p\n\r",\
-			xMacAddr[5],xMacAddr[4],xMacAddr[3],xMacAddr[2],xMacAddr[1],xMacAddr[0],cIpBuffer,cNetMaskBuffer,cGWBuffer,cDNSBuffer,xRxGoodFrames,xRxSumErrors,xRxDmaOverruns,xRxFilteredFrames,xTxGoodFrames,xTxSumErrors,xTxCollisionFrames,xTxCarrierSenseError,xRxOctetFrames,xTxOctetFrames,xRxHeadPointer,xTxHeadPointer);
+	if( pcParameter == NULL )
+	{
+		if( xIndex == 0 )
+		{
+			EMACMACSrcAddrGet(EMAC_BASE, xMacAddr);
+			FreeRTOS_GetAddressConfiguration(&xIpAddr, &xNetMask, &xGatewayAddr, &xDNSAddr);
+
+			vAddrToString(cIpBuffer,xIpAddr); vAddrToString(cNetMaskBuffer,xNetMask); vAddrToString(cGWBuffer,xGatewayAddr); vAddrToString(cDNSBuffer,xDNSAddr);
+
+			xRxHeadPointer = HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER));
+			xTxHeadPointer = HWREG(hdkif->emac_base + EMAC_TXHDP(EMAC_CHANNELNUMBER));
+			snprintf( pcBuffer, xWriteBufferLen, "EMAC\tHW addr: %02X:%02X:%02X:%02X:%02X:%02X\r\n\tInet:%s Mask:%s\r\n\tGW:%s DNS:%s\r\n\tRXHP:%p TXHP:%p\r\n",
+					xMacAddr[5],xMacAddr[4],xMacAddr[3],xMacAddr[2],xMacAddr[1],xMacAddr[0],cIpBuffer,cNetMaskBuffer,cGWBuffer,cDNSBuffer,xRxHeadPointer,xTxHeadPointer );
+			xIndex = 1;
+			xReturnValue = pdTRUE;
+		}
+		else
+		{
+			/* Az EMAC szmllk sszegei a trls ta, s a sebessgek az utols peridusban */
+			snprintf( pcBuffer, xWriteBufferLen, "\tRX packets:%llu errors:%llu drops:%llu filtered:%llu\r\n\tTX packets:%llu errors:%llu collisions:%llu carrier:%llu\r\n\tRX bytes:%llu TX bytes:%llu\r\n"
+					"\tRX %u pkt/s %u kbit/s TX %u pkt/s %u kbit/s\r\n\terrors:%u/s drops:%u/s\r\n",
+					ullEMACStatsGetTotal( emacstatsRXGOODFRAMES ), prvEmacStatTotal( ucEmacStatRxErrors, emacstatCOUNT( ucEmacStatRxErrors ) ),
+					prvEmacStatTotal( ucEmacStatDrops, emacstatCOUNT( ucEmacStatDrops ) ), ullEMACStatsGetTotal( emacstatsRXFILTERED ),
+					ullEMACStatsGetTotal( emacstatsTXGOODFRAMES ), prvEmacStatTotal( ucEmacStatTxErrors, emacstatCOUNT( ucEmacStatTxErrors ) ),
+					ullEMACStatsGetTotal( emacstatsTXCOLLISION ), ullEMACStatsGetTotal( emacstatsTXCARRIERSENSE ),
+					ullEMACStatsGetTotal( emacstatsRXOCTETS ), ullEMACStatsGetTotal( emacstatsTXOCTETS ),
+					ulEMACStatsGetRate( emacstatsRXGOODFRAMES ), ulEMACStatsGetRate( emacstatsRXOCTETS ) / 125U,
+					ulEMACStatsGetRate( emacstatsTXGOODFRAMES ), ulEMACStatsGetRate( emacstatsTXOCTETS ) / 125U,
+					prvEmacStatRate( ucEmacStatRxErrors, emacstatCOUNT( ucEmacStatRxErrors ) ) + prvEmacStatRate( ucEmacStatTxErrors, emacstatCOUNT( ucEmacStatTxErrors ) ),
+					prvEmacStatRate( ucEmacStatDrops, emacstatCOUNT( ucEmacStatDrops ) ) );
+			xIndex = 0;
+		}
+	}
+	else if( ( xParameterLength == 3 ) && ( strncmp( pcParameter, "all", 3 ) == 0 ) )
+	{
+		/* Hvsonknt emacstatCOUNTERS_PER_CALL szmll */
+		pcBuffer[ 0 ] = '\0';
+		for( ulCounter = ( uint32_t ) xIndex; ( ulCounter < emacstatsCOUNTERS ) && ( ulCounter < ( uint32_t ) xIndex + emacstatCOUNTERS_PER_CALL ); ulCounter++ )
+		{
+			uxLength = strlen( pcBuffer );
+			snprintf( pcBuffer + uxLength, xWriteBufferLen - uxLength, "%-18s %14llu %10u/s\r\n",
+					pcEMACStatsGetName( ulCounter ), ullEMACStatsGetTotal( ulCounter ), ulEMACStatsGetRate( ulCounter ) );
+		}
+		if( ulCounter < emacstatsCOUNTERS )
+		{
+			xIndex = ( BaseType_t ) ulCounter;
+			xReturnValue = pdTRUE;
+		}
+		else
+		{
+			xIndex = 0;
+		}
+	}
+	else if( ( xParameterLength == 3 ) && ( strncmp( pcParameter, "lat", 3 ) == 0 ) )
+	{
+		/* Hisztogramonknt kt hvs: sszegzs, majd a nem res vdrk */
+		vEMACStatsGetLatency( xIndex / 2, &xLatency );
+		if( ( xIndex & 1 ) == 0 )
+		{
+			snprintf( pcBuffer, xWriteBufferLen, "%s\tsamples:%u avg:%u us max:%u us last period max:%u us\r\n",
+					( xIndex == 0 ) ? "ISR -> IP task" : "IP task -> socket", xLatency.ulCount,
+					( xLatency.ulCount != 0U ) ? ( uint32_t ) ( xLatency.ullSumUs / xLatency.ulCount ) : 0U, xLatency.ulMaxUs, xLatency.ulPeriodMaxUs );
+		}
+		else
+		{
+			pcBuffer[ 0 ] = '\0';
+			for( ulBucket = 0U; ulBucket < emacstatsHISTOGRAM_BUCKETS; ulBucket++ )
+			{
+				if( xLatency.ulBuckets[ ulBucket ] != 0U )
+				{
+					uxLength = strlen( pcBuffer );
+					snprintf( pcBuffer + uxLength, xWriteBufferLen - uxLength, "\t%s%5u us: %u\r\n",
+							( ulBucket < ( emacstatsHISTOGRAM_BUCKETS - 1U ) ) ? " <" : ">=",
+							( ulBucket < ( emacstatsHISTOGRAM_BUCKETS - 1U ) ) ? ( 1U << ulBucket ) : ( 1U << ( ulBucket - 1U ) ),
+							xLatency.ulBuckets[ ulBucket ] );
+				}
+			}
+		}
+		xIndex++;
+		if( xIndex < ( 2 * emacstatsLATENCIES ) )
+		{
+			xReturnValue = pdTRUE;
+		}
+		else
+		{
+			xIndex = 0;
+		}
+	}
+	else if( ( xParameterLength == 5 ) && ( strncmp( pcParameter, "reset", 5 ) == 0 ) )
+	{
+		vEMACStatsReset();
+		snprintf( pcBuffer, xWriteBufferLen, "emacstat: counters and histograms cleared\r\n" );
+	}
+	else
+	{
+		snprintf( pcBuffer, xWriteBufferLen, "emacstat: invalid parameter, see \"help\"\r\n" );
+	}
 
 	return xReturnValue;
 }
@@ -324,3 +436,420 @@ BaseType_t xNetStatCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const c
 	snprintf( pcWriteBuffer, xWriteBufferLen, "FreeRTOS_netstat() called - output uses FreeRTOS_printf\r\n" );
 	return pdFALSE;
 	}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPPSCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	{
+	PPSStatus_t xStatus;
+	uint64_t uxPhyTime = 0ULL;
+
+	( void ) pcCommandString;
+
+	vPPSGetStatus( &xStatus );
+	if( xPTPClockIsEnabled() != pdFALSE )
+	{
+		uxPhyTime = xPTPClockGetTime();
+	}
+
+	snprintf( pcWriteBuffer, xWriteBufferLen, "PPS\t%s pulses:%u missed:%u steps:%u\r\n\toffset:%lld ns freq:%d ppb pair window:%u ns\r\n\tPHY time:%llu.%09llu\r\n",
+			( xStatus.xLocked != pdFALSE ) ? "locked" : "unlocked",
+			xStatus.ulPulseCount, xStatus.ulMissedPulses, xStatus.ulSteps,
+			xStatus.xLastOffsetNs, xStatus.lFrequencyPpb, xStatus.ulPairWindowNs,
+			uxPhyTime / 1000000000ULL, uxPhyTime % 1000000000ULL );
+	return pdFALSE;
+	}
+
+BaseType_t xClkOutCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	{
+	static BaseType_t xIndex = 0;
+	ClockOutputStatus_t xStatus;
+
+	( void ) pcCommandString;
+
+	if( xClockOutputGetStatus( xIndex, &xStatus ) == pdFAIL )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, ( xIndex == 0 ) ? "No clock outputs\r\n" : "" );
+		xIndex = 0;
+		return pdFALSE;
+	}
+
+	snprintf( pcWriteBuffer, xWriteBufferLen, "%d\t%s period:%u ns tick:%u ps\r\n\tphase error:%d ns alignments:%u pulses:%u\r\n",
+			( int ) xIndex, ( xStatus.xIsPPS != pdFALSE ) ? "PPS" : "FREQ",
+			xStatus.ulPeriodNs, xStatus.ulTickPs,
+			xStatus.lLastPhaseErrorNs, xStatus.ulAlignments, xStatus.ulPulses );
+	xIndex++;
+	return pdTRUE;
+	}
+
+BaseType_t xXTSCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	{
+	PTPCrossTimestampStatus_t xStatus;
+	uint64_t uxPtpTime;
+
+	( void ) pcCommandString;
+
+	vPTPCrossTimestampGetStatus( &xStatus );
+	uxPtpTime = xPTPCrossTimestampNow();
+
+	snprintf( pcWriteBuffer, xWriteBufferLen, "XTS\t%s samples:%u rejected:%u rebases:%u\r\n\twindow:%u ns rate:%d ppb last error:%d ns\r\n\tPTP time:%llu.%09llu\r\n",
+			( xStatus.xValid != pdFALSE ) ? "valid" : "invalid",
+			xStatus.ulSamples, xStatus.ulRejected, xStatus.ulRebases,
+			xStatus.ulWindowNs, xStatus.lRatePpb, xStatus.lLastErrorNs,
+			uxPtpTime / 1000000000ULL, uxPtpTime % 1000000000ULL );
+	return pdFALSE;
+	}
+
+/*-----------------------------------------------------------*/
+/* The checksum of the stack before the 64-bit accumulating version, kept as the reference of the "cksum" benchmark. */
+typedef union
+{
+	uint32_t u32;
+	uint16_t u16[ 2 ];
+	uint8_t u8[ 4 ];
+} xCksumUnion32;
+
+typedef union
+{
+	uint32_t *u32ptr;
+	uint16_t *u16ptr;
+	uint8_t *u8ptr;
+} xCksumUnionPtr;
+
+static uint16_t prvChecksumReference( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+{
+	xCksumUnion32 xSum2, xSum, xTerm;
+	xCksumUnionPtr xSource, xLastSource;
+	uint32_t ulAlignBits, ulCarry = 0ul;
+
+	xSum.u32 = FreeRTOS_ntohs( ulSum );
+	xTerm.u32 = 0ul;
+
+	xSource.u8ptr = ( uint8_t * ) pucNextData;
+	ulAlignBits = ( ( ( uint32_t ) pucNextData ) & 0x03u );
+
+	if( ( ( ulAlignBits & 1ul ) != 0ul ) && ( uxDataLengthBytes >= ( size_t ) 1 ) )
+	{
+		xTerm.u8[ 1 ] = *( xSource.u8ptr );
+		( xSource.u8ptr )++;
+		uxDataLengthBytes--;
+	}
+
+	if( ( ( ulAlignBits == 1u ) || ( ulAlignBits == 2u ) ) && ( uxDataLengthBytes >= 2u ) )
+	{
+		xSum.u32 += *(xSource.u16ptr);
+		( xSource.u16ptr )++;
+		uxDataLengthBytes -= 2u;
+	}
+
+	xLastSource.u32ptr = ( xSource.u32ptr + ( uxDataLengthBytes / 4u ) ) - 3u;
+
+	while( xSource.u32ptr < xLastSource.u32ptr )
+	{
+		xSum2.u32 = xSum.u32 + xSource.u32ptr[ 0 ];
+		if( xSum2.u32 < xSum.u32 )
+		{
+			ulCarry++;
+		}
+		xSum.u32 = xSum2.u32 + xSource.u32ptr[ 1 ];
+		if( xSum2.u32 > xSum.u32 )
+		{
+			ulCarry++;
+		}
+		xSum2.u32 = xSum.u32 + xSource.u32ptr[ 2 ];
+		if( xSum2.u32 < xSum.u32 )
+		{
+			ulCarry++;
+		}
+		xSum.u32 = xSum2.u32 + xSource.u32ptr[ 3 ];
+		if( xSum2.u32 > xSum.u32 )
+		{
+			ulCarry++;
+		}
+		xSource.u32ptr += 4;
+	}
+
+	xSum.u32 = ( uint32_t )xSum.u16[ 0 ] + xSum.u16[ 1 ] + ulCarry;
+
+	uxDataLengthBytes %= 16u;
+	xLastSource.u8ptr = ( uint8_t * ) ( xSource.u8ptr + ( uxDataLengthBytes & ~( ( size_t ) 1 ) ) );
+
+	while( xSource.u16ptr < xLastSource.u16ptr )
+	{
+		xSum.u32 += xSource.u16ptr[ 0 ];
+		xSource.u16ptr++;
+	}
+
+	if( ( uxDataLengthBytes & ( size_t ) 1 ) != 0u )
+	{
+		xTerm.u8[ 0 ] = xSource.u8ptr[ 0 ];
+	}
+	xSum.u32 += xTerm.u32;
+
+	xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
+	xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
+
+	if( ( ulAlignBits & 1u ) != 0u )
+	{
+		xSum.u32 = ( ( xSum.u32 & 0xffu ) << 8 ) | ( ( xSum.u32 & 0xff00u ) >> 8 );
+	}
+
+	return FreeRTOS_htons( ( (uint16_t) xSum.u32 ) );
+}
+
+#define cksumITERATIONS		200U
+static const uint16_t usCksumSizes[] = { 20U, 60U, 128U, 256U, 576U, 1024U, 1460U, 1514U };
+static uint8_t ucCksumSource[ 1520U ] __attribute__((aligned(32)));
+static uint8_t ucCksumDestination[ 1520U ] __attribute__((aligned(32)));
+
+/* tlagos futsi id ns-ban, RTIFRC0 alapjn (az temez felfggesztve, a megszaktsok futnak) */
+static uint32_t prvCksumMeasure( BaseType_t xVariant, uint32_t ulOffset, size_t uxLength, uint16_t *pusResult )
+{
+	uint32_t ulStart, ulTicks, i;
+	uint16_t usResult = 0U;
+
+	vTaskSuspendAll();
+	ulStart = RTI_FRC0_REG;
+	for( i = 0U; i < cksumITERATIONS; i++ )
+	{
+		switch( xVariant )
+		{
+			case 0:
+				usResult = prvChecksumReference( 0UL, &ucCksumSource[ ulOffset ], uxLength );
+				break;
+			case 1:
+				usResult = usGenerateChecksum( 0UL, &ucCksumSource[ ulOffset ], uxLength );
+				break;
+			default:
+				usResult = usGenerateChecksumCopy( 0UL, &ucCksumDestination[ ulOffset ], &ucCksumSource[ ulOffset ], uxLength );
+				break;
+		}
+	}
+	ulTicks = RTI_FRC0_REG - ulStart;
+	xTaskResumeAll();
+
+	*pusResult = usResult;
+	return ( uint32_t ) ( RTI_FRC0_TICKS_TO_NS( ulTicks ) / cksumITERATIONS );
+}
+
+BaseType_t xCksumCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	{
+	static BaseType_t xIndex = 0;
+	uint32_t ulOffset, ulReferenceNs, ulNs, ulCopyNs, i;
+	uint16_t usReference, usResult, usCopyResult;
+	size_t uxLength;
+
+	( void ) pcCommandString;
+
+	if( xIndex == 0 )
+	{
+		/* Pszeudo-vletlen adat, a futtatsok sszehasonlthatk */
+		for( i = 0U; i < sizeof( ucCksumSource ); i++ )
+		{
+			ucCksumSource[ i ] = ( uint8_t ) ( ( i * 1103515245UL + 12345UL ) >> 16 );
+		}
+	}
+
+	/* Minden mret pros (IP/TCP fejlc) s pratlan kezdcmmel is */
+	uxLength = usCksumSizes[ xIndex / 2 ];
+	ulOffset = ( uint32_t ) ( xIndex & 1 );
+
+	ulReferenceNs = prvCksumMeasure( 0, ulOffset, uxLength, &usReference );
+	ulNs = prvCksumMeasure( 1, ulOffset, uxLength, &usResult );
+	ulCopyNs = prvCksumMeasure( 2, ulOffset, uxLength, &usCopyResult );
+
+	if( xIndex == 0 )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Checksum, average of %u runs\r\n", cksumITERATIONS );
+		xWriteBufferLen -= strlen( pcWriteBuffer );
+		pcWriteBuffer += strlen( pcWriteBuffer );
+	}
+
+	snprintf( pcWriteBuffer, xWriteBufferLen, "%4u bytes +%u\told:%5u ns new:%5u ns (%3u%%) copy+sum:%5u ns %s\r\n",
+			( unsigned ) uxLength, ( unsigned ) ulOffset,
+			ulReferenceNs, ulNs, ( ulReferenceNs != 0U ) ? ( ulNs * 100U ) / ulReferenceNs : 0U, ulCopyNs,
+			( usResult == usReference && usCopyResult == usReference && memcmp( &ucCksumDestination[ ulOffset ], &ucCksumSource[ ulOffset ], uxLength ) == 0 ) ? "ok" : "MISMATCH" );
+
+	xIndex++;
+	if( xIndex >= ( BaseType_t ) ( 2U * ( sizeof( usCksumSizes ) / sizeof( usCksumSizes[ 0 ] ) ) ) )
+	{
+		xIndex = 0;
+		return pdFALSE;
+	}
+	return pdTRUE;
+	}
+
+/*-----------------------------------------------------------*/
+BaseType_t xPCAPCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	{
+	const char *pcParameter;
+	BaseType_t xParameterLength, xResult = pdPASS;
+	PCAPStatus_t xStatus;
+	char cFilter[ 64 ];
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterLength );
+
+	if( pcParameter == NULL )
+	{
+		/* Paramter nlkl az llapotot rjuk ki */
+	}
+	else if( ( xParameterLength == 5 ) && ( strncmp( pcParameter, "start", 5 ) == 0 ) )
+	{
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterLength );
+		xResult = xPCAPStart( ( pcParameter != NULL ) ? ( uint32_t ) atol( pcParameter ) : 0U );
+	}
+	else if( ( xParameterLength == 4 ) && ( strncmp( pcParameter, "stop", 4 ) == 0 ) )
+	{
+		vPCAPStop();
+	}
+	else if( ( xParameterLength == 6 ) && ( strncmp( pcParameter, "filter", 6 ) == 0 ) )
+	{
+		/* A kifejezs a parancssor vgig tart */
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterLength );
+		xResult = xPCAPSetFilter( ( pcParameter != NULL ) ? pcParameter : "" );
+	}
+	else
+	{
+		xResult = pdFAIL;
+	}
+
+	if( xResult == pdFAIL )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "pcap: invalid parameter, see \"help\"\r\n" );
+		return pdFALSE;
+	}
+
+	vPCAPGetStatus( &xStatus );
+	vPCAPGetFilter( cFilter, sizeof( cFilter ) );
+	snprintf( pcWriteBuffer, xWriteBufferLen, "PCAP\t%s snaplen:%u filter:%s\r\n\tcaptured:%u filtered:%u dropped:%u written:%u errors:%u\r\n\tfile:/ram/cap%u.pcapng %u bytes\r\n",
+			( xStatus.xActive != pdFALSE ) ? "running" : "stopped", xStatus.ulSnapLength, cFilter,
+			xStatus.ulCaptured, xStatus.ulFiltered, xStatus.ulDropped, xStatus.ulWritten, xStatus.ulWriteErrors,
+			xStatus.ulFileIndex, xStatus.ulFileSize );
+	return pdFALSE;
+	}
+
+/*-----------------------------------------------------------*/
+BaseType_t xIperfCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+	{
+	const char *pcParameter;
+	BaseType_t xParameterLength, xIndex, xResult = pdPASS;
+	BaseType_t xServer = pdFALSE, xClient = pdFALSE, xUDP = pdFALSE;
+	uint32_t ulIPAddress = 0U, ulSeconds = 0U, ulBandwidth = 0U, ulLength = 0U;
+	char *pcEnd;
+	char cIP[ 16 ];
+	IperfReport_t xReport;
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterLength );
+
+	if( pcParameter == NULL )
+	{
+		/* Paramter nlkl a mrs llst rjuk ki */
+	}
+	else if( ( xParameterLength == 4 ) && ( strncmp( pcParameter, "stop", 4 ) == 0 ) )
+	{
+		vIperfStop();
+	}
+	else
+	{
+		/* Az iperf2 kapcsoli: -s, -c <ip>, -u, -t <sec>, -b <bit/s>[k|m], -l <byte> */
+		for( xIndex = 1; ( pcParameter != NULL ) && ( xResult == pdPASS ); xIndex++ )
+		{
+			if( ( xParameterLength != 2 ) || ( pcParameter[ 0 ] != '-' ) )
+			{
+				xResult = pdFAIL;
+			}
+			else if( pcParameter[ 1 ] == 's' )
+			{
+				xServer = pdTRUE;
+			}
+			else if( pcParameter[ 1 ] == 'u' )
+			{
+				xUDP = pdTRUE;
+			}
+			else if( ( pcParameter[ 1 ] == 'c' ) || ( pcParameter[ 1 ] == 't' ) || ( pcParameter[ 1 ] == 'b' ) || ( pcParameter[ 1 ] == 'l' ) )
+			{
+				char cOption = pcParameter[ 1 ];
+
+				xIndex++;
+				pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, xIndex, &xParameterLength );
+				if( pcParameter == NULL )
+				{
+					xResult = pdFAIL;
+				}
+				else if( cOption == 'c' )
+				{
+					xClient = pdTRUE;
+					snprintf( cIP, sizeof( cIP ), "%.*s", ( int ) xParameterLength, pcParameter );
+					ulIPAddress = FreeRTOS_inet_addr( cIP );
+				}
+				else if( cOption == 'b' )
+				{
+					ulBandwidth = ( uint32_t ) strtoul( pcParameter, &pcEnd, 10 );
+					if( ( *pcEnd == 'k' ) || ( *pcEnd == 'K' ) )
+					{
+						ulBandwidth *= 1000U;
+					}
+					else if( ( *pcEnd == 'm' ) || ( *pcEnd == 'M' ) )
+					{
+						ulBandwidth *= 1000000U;
+					}
+				}
+				else if( cOption == 't' )
+				{
+					ulSeconds = ( uint32_t ) atol( pcParameter );
+				}
+				else
+				{
+					ulLength = ( uint32_t ) atol( pcParameter );
+				}
+			}
+			else
+			{
+				xResult = pdFAIL;
+			}
+
+			if( pcParameter != NULL )
+			{
+				pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, xIndex + 1, &xParameterLength );
+			}
+		}
+
+		if( xResult == pdFAIL )
+		{
+			/* Hibs kapcsol */
+		}
+		else if( ( xServer != pdFALSE ) && ( xClient == pdFALSE ) )
+		{
+			xResult = xIperfStartServer( xUDP );
+		}
+		else if( ( xClient != pdFALSE ) && ( xServer == pdFALSE ) )
+		{
+			xResult = xIperfStartClient( ulIPAddress, xUDP, ulSeconds, ulBandwidth, ulLength );
+		}
+		else
+		{
+			xResult = pdFAIL;
+		}
+	}
+
+	if( xResult == pdFAIL )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "iperf: invalid parameter or already running, see \"help\"\r\n" );
+		return pdFALSE;
+	}
+
+	vIperfGetReport( &xReport );
+	FreeRTOS_inet_ntoa( xReport.ulRemoteIP, cIP );
+	snprintf( pcWriteBuffer, xWriteBufferLen, "IPERF\t%s %s %s %s%s\r\n\t%u kB in %u ms, %u kbit/s, retransmits:%u\r\n\tdatagrams:%u lost:%u out-of-order:%u jitter:%u us\r\n\tCPU:%u.%u%% IP-task:%u.%u%%\r\n",
+			( xReport.xActive != pdFALSE ) ? "running" : "stopped",
+			( xReport.xUDP != pdFALSE ) ? "UDP" : "TCP",
+			( xReport.xServer != pdFALSE ) ? "server" : "client",
+			( xReport.ulRemoteIP != 0U ) ? cIP : "-",
+			( xReport.xRunning != pdFALSE ) ? " (measuring)" : "",
+			( unsigned ) ( xReport.ullBytes / 1024U ), ( unsigned ) xReport.ulDurationMs,
+			( xReport.ulDurationMs != 0U ) ? ( unsigned ) ( ( xReport.ullBytes * 8U ) / xReport.ulDurationMs ) : 0U,
+			( unsigned ) xReport.ulRetransmits,
+			( unsigned ) xReport.ulDatagrams, ( unsigned ) xReport.ulLost, ( unsigned ) xReport.ulOutOfOrder, ( unsigned ) xReport.ulJitterUs,
+			( unsigned ) ( xReport.ulCPULoad / 10U ), ( unsigned ) ( xReport.ulCPULoad % 10U ),
+			( unsigned ) ( xReport.ulIPTaskLoad / 10U ), ( unsigned ) ( xReport.ulIPTaskLoad % 10U ) );
+	return pdFALSE;
+	}
@@ -83,6 +83,9 @@
 #include "ff_headers.h"
 #include "ff_stdio.h"
 
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_gzip.h"
+
 #ifdef _WINDOWS_
 	#define snprintf _snprintf
 #endif
@@ -143,6 +146,11 @@ static BaseType_t prvCOPYCommand( char *pcWriteBuffer, size_t xWriteBufferLen, c
  */
 static BaseType_t prvPWDCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
+/*
+ * Implements the GZIP command.
+ */
+static BaseType_t prvGZIPCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
 /* Structure that defines the DIR command line command, which lists all the
 files in the current directory. */
 static const CLI_Command_Definition_t xDIR =
@@ -209,6 +217,16 @@ static const CLI_Command_Definition_t xPWD =
 	0 /* No parameters are expected. */
 };
 
+/* Structure that defines the GZIP command line command, which creates the
+compressed sibling of a file for the HTTP server. */
+static const CLI_Command_Definition_t xGZIP =
+{
+	"gzip", /* The command string to type. */
+	"\r\ngzip <filename>:\r\n Creates <filename>.gz, which the HTTP server sends to browsers accepting gzip\r\n",
+	prvGZIPCommand, /* The function to run. */
+	1 /* One parameter is expected. */
+};
+
 /*-----------------------------------------------------------*/
 
 void vRegisterFileSystemCLICommands( void )
@@ -221,6 +239,7 @@ void vRegisterFileSystemCLICommands( void )
 	FreeRTOS_CLIRegisterCommand( &xRMDIR );
 	FreeRTOS_CLIRegisterCommand( &xCOPY );
 	FreeRTOS_CLIRegisterCommand( &xPWD );
+	FreeRTOS_CLIRegisterCommand( &xGZIP );
 }
 /*-----------------------------------------------------------*/
 
@@ -582,6 +601,56 @@ static BaseType_t prvPWDCommand( char *pcWriteBuffer, size_t xWriteBufferLen, co
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvGZIPCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+const char *pcParameter;
+BaseType_t xParameterStringLength;
+FF_Stat_t xStat;
+int32_t lReturned;
+
+	/* This function assumes xWriteBufferLen is large enough! */
+	( void ) xWriteBufferLen;
+
+	/* Obtain the parameter string. */
+	pcParameter = FreeRTOS_CLIGetParameter
+					(
+						pcCommandString,		/* The command string itself. */
+						1,						/* Return the first parameter. */
+						&xParameterStringLength	/* Store the parameter string length. */
+					);
+
+	/* Sanity check something was returned. */
+	configASSERT( pcParameter );
+
+	if( ( ff_stat( pcParameter, &xStat ) != FF_ERR_NONE ) || ( xStat.st_mode == FF_IFDIR ) )
+	{
+		sprintf( pcWriteBuffer, "Error.  %s is not a file", pcParameter );
+	}
+	else
+	{
+		/* Compressing takes a while for large files. */
+		lReturned = FreeRTOS_gzip_sibling( pcParameter );
+
+		if( lReturned > 0 )
+		{
+			sprintf( pcWriteBuffer, "%s%s: %ld -> %ld bytes", pcParameter, gzipSUFFIX, ( long ) xStat.st_size, ( long ) lReturned );
+		}
+		else if( lReturned == 0 )
+		{
+			sprintf( pcWriteBuffer, "%s does not compress, no %s made", pcParameter, gzipSUFFIX );
+		}
+		else
+		{
+			sprintf( pcWriteBuffer, "Error.  %s%s was not made (errno %ld)", pcParameter, gzipSUFFIX, ( long ) -lReturned );
+		}
+	}
+
+	strcat( pcWriteBuffer, cliNEW_LINE );
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvPerformCopy( const char *pcSourceFile,
 									int32_t lSourceFileLength,
 									const char *pcDestinationFile,
@@ -63,9 +63,10 @@ portBASE_TYPE xEmacStatCommand( int8_t *pcWriteBuffer, size_t xWriteBufferLen, c
 static const CLI_Command_Definition_t xEmacStat =
 {
 	( const char *) "emacstat",
-	( const char *) "\r\nemacstat:\r\n Display network interface related statistics.\r\n",
+	( const char *) "\r\nemacstat <optional:all | lat | reset>:\r\n Display network interface related statistics (totals and per second rates),\r\n"
+	" all EMAC counters, the receive latency histograms, or clear them.\r\n",
 	( pdCOMMAND_LINE_CALLBACK ) xEmacStatCommand,
-	0
+	-1
 };
 
 BaseType_t xPingCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
@@ -87,4 +88,59 @@ static const CLI_Command_Definition_t xNetStat =
 	( pdCOMMAND_LINE_CALLBACK ) xNetStatCommand,
 	0 /* No parameters are expected. */
 };
+BaseType_t xPPSCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+/* Structure that defines the "pps" command line command. */
+static const CLI_Command_Definition_t xPPS =
+{
+	"pps",
+	"\r\npps:\r\n Displays the state of the 1PPS discipline of the PHY clock.\r\n",
+	( pdCOMMAND_LINE_CALLBACK ) xPPSCommand,
+	0 /* No parameters are expected. */
+};
+BaseType_t xClkOutCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+/* Structure that defines the "clkout" command line command. */
+static const CLI_Command_Definition_t xClkOut =
+{
+	"clkout",
+	"\r\nclkout:\r\n Displays the PTP locked ETPWM clock outputs.\r\n",
+	( pdCOMMAND_LINE_CALLBACK ) xClkOutCommand,
+	0 /* No parameters are expected. */
+};
+BaseType_t xXTSCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+/* Structure that defines the "xts" command line command. */
+static const CLI_Command_Definition_t xXTS =
+{
+	"xts",
+	"\r\nxts:\r\n Displays the PHY clock to RTIFRC0 cross-timestamp mapping.\r\n",
+	( pdCOMMAND_LINE_CALLBACK ) xXTSCommand,
+	0 /* No parameters are expected. */
+};
+BaseType_t xCksumCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+/* Structure that defines the "cksum" command line command. */
+static const CLI_Command_Definition_t xCksum =
+{
+	"cksum",
+	"\r\ncksum:\r\n Benchmarks the internet checksum of the IP stack against the previous implementation.\r\n",
+	( pdCOMMAND_LINE_CALLBACK ) xCksumCommand,
+	0 /* No parameters are expected. */
+};
+BaseType_t xPCAPCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+/* Structure that defines the "pcap" command line command. */
+static const CLI_Command_Definition_t xPCAP =
+{
+	"pcap",
+	"\r\npcap <optional:start [snaplen] | stop | filter [expression]>:\r\n Controls the packet capture to /ram/capN.pcapng, without parameters displays its state.\r\n"
+	" Filter: rx tx arp ip icmp tcp udp ptp, ether <type>, host <ip>, port <n>, all must match, a leading not inverts.\r\n",
+	( pdCOMMAND_LINE_CALLBACK ) xPCAPCommand,
+	-1
+};
+BaseType_t xIperfCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString);
+/* Structure that defines the "iperf" command line command. */
+static const CLI_Command_Definition_t xIperf =
+{
+	"iperf",
+	"\r\niperf <optional:-s [-u] | -c <ip> [-u] [-t sec] [-b bit/s[k|m]] [-l length] | stop>:\r\n Runs an iperf2 compatible throughput test on port 5001, without parameters displays its result.\r\n",
+	( pdCOMMAND_LINE_CALLBACK ) xIperfCommand,
+	-1
+};
 #endif /* CLI_COMMANDS_H_ */
@@ -84,6 +84,10 @@ to zero, so this is an old entry) an ARP request will be sent to see if the
 entry is still valid and can therefore be refreshed. */
 #define arpMAX_ARP_AGE_BEFORE_NEW_ARP_REQUEST		( 3 )
 
+/* The bucket of an IP address (in network byte order) in the ARP hash table. */
+#define arpHASH( ulIPAddress ) \
+	( ( ( ulIPAddress ) ^ ( ( ulIPAddress ) >> 8 ) ^ ( ( ulIPAddress ) >> 16 ) ^ ( ( ulIPAddress ) >> 24 ) ) & ( uint32_t ) ( ipconfigARP_HASH_BUCKETS - 1 ) )
+
 /* The time between gratuitous ARPs. */
 #ifndef arpGRATUITOUS_ARP_PERIOD
 	#define arpGRATUITOUS_ARP_PERIOD					( pdMS_TO_TICKS( 20000 ) )
@@ -96,11 +100,37 @@ entry is still valid and can therefore be refreshed. */
  */
 static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup, MACAddress_t * const pxMACAddress );
 
+/*
+ * Return the row of the ARP cache that holds ulIPAddress, or -1.
+ */
+static BaseType_t prvCacheFind( uint32_t ulIPAddress );
+
+/*
+ * Change the IP address of a row and move the row to the matching hash bucket.
+ */
+static void prvCacheSetAddress( BaseType_t xEntry, uint32_t ulIPAddress );
+
+/*
+ * Remove a row from the hash table and clear it.
+ */
+static void prvCacheClearEntry( BaseType_t xEntry );
+
+/*
+ * Send an ARP request for ulIPAddress, either broadcast (pxDestination is NULL)
+ * or directly to the MAC address that is known already.
+ */
+static void prvOutputARPRequest( uint32_t ulIPAddress, const MACAddress_t *pxDestination );
+
 /*-----------------------------------------------------------*/
 
 /* The ARP cache. */
 static ARPCacheRow_t xARPCache[ ipconfigARP_CACHE_ENTRIES ];
 
+/* The heads (row index + 1, 0 for an empty bucket) of the hash chains that
+index xARPCache[] by IP address.  Every row with a non-zero IP address is linked
+into the chain of its bucket. */
+static uint16_t usARPHashHead[ ipconfigARP_HASH_BUCKETS ];
+
 /* The time at which the last gratuitous ARP was sent.  Gratuitous ARPs are used
 to ensure ARP tables are up to date and to detect IP address conflicts. */
 static TickType_t xLastGratuitousARPTime = ( TickType_t ) 0;
@@ -224,7 +254,7 @@ ARPHeader_t *pxARPHeader;
 			if( ( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
 			{
 				lResult = xARPCache[ x ].ulIPAddress;
-				memset( &xARPCache[ x ], '\0', sizeof( xARPCache[ x ] ) );
+				prvCacheClearEntry( x );
 				break;
 			}
 		}
@@ -256,43 +286,49 @@ uint8_t ucMinAgeFound = 0U;
 		if( pdTRUE )
 	#endif
 	{
+		/* Does a row in the cache table hold an entry for the IP address being
+		queried? */
+		xIpEntry = prvCacheFind( ulIPAddress );
+
+		if( xIpEntry >= 0 )
+		{
+			if( pxMACAddress == NULL )
+			{
+				/* In case the parameter pxMACAddress is NULL, an entry will be reserved to
+				indicate that there is an outstanding ARP request, This entry will have
+				"ucValid == pdFALSE".  There is one already. */
+				return;
+			}
+
+			/* See if the MAC-address also matches. */
+			if( memcmp( xARPCache[ xIpEntry ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 )
+			{
+				/* This function will be called for each received packet
+				As this is by far the most common path the coding standard
+				is relaxed in this case and a return is permitted as an
+				optimisation. */
+				xARPCache[ xIpEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
+				xARPCache[ xIpEntry ].ucValid = ( uint8_t ) pdTRUE;
+				return;
+			}
+
+			/* Found an entry containing ulIPAddress, but the MAC address
+			doesn't match.  Might be an entry with ucValid=pdFALSE, waiting
+			for an ARP reply.  Still want to see if there is match with the
+			given MAC address.ucBytes.  If found, either of the two entries
+			must be cleared. */
+		}
+
 		/* Start with the maximum possible number. */
 		ucMinAgeFound--;
 
-		/* For each entry in the ARP cache table. */
+		/* The address is new or its MAC address has changed: only now is the
+		table traversed, to find the MAC address or the row to re-use. */
 		for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
 		{
-			/* Does this line in the cache table hold an entry for the IP
-			address	being queried? */
-			if( xARPCache[ x ].ulIPAddress == ulIPAddress )
+			if( x == xIpEntry )
 			{
-				if( pxMACAddress == NULL )
-				{
-					/* In case the parameter pxMACAddress is NULL, an entry will be reserved to
-					indicate that there is an outstanding ARP request, This entry will have
-					"ucValid == pdFALSE". */
-					xIpEntry = x;
-					break;
-				}
-
-				/* See if the MAC-address also matches. */
-				if( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 )
-				{
-					/* This function will be called for each received packet
-					As this is by far the most common path the coding standard
-					is relaxed in this case and a return is permitted as an
-					optimisation. */
-					xARPCache[ x ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
-					xARPCache[ x ].ucValid = ( uint8_t ) pdTRUE;
-					return;
-				}
-
-				/* Found an entry containing ulIPAddress, but the MAC address
-				doesn't match.  Might be an entry with ucValid=pdFALSE, waiting
-				for an ARP reply.  Still want to see if there is match with the
-				given MAC address.ucBytes.  If found, either of the two entries
-				must be cleared. */
-				xIpEntry = x;
+				/* Already handled above. */
 			}
 			else if( ( pxMACAddress != NULL ) && ( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
 			{
@@ -336,7 +372,7 @@ uint8_t ucMinAgeFound = 0U;
 				/* Both the MAC address as well as the IP address were found in
 				different locations: clear the entry which matches the
 				IP-address */
-				memset( &xARPCache[ xIpEntry ], '\0', sizeof( xARPCache[ xIpEntry ] ) );
+				prvCacheClearEntry( xIpEntry );
 			}
 		}
 		else if( xIpEntry >= 0 )
@@ -346,7 +382,7 @@ uint8_t ucMinAgeFound = 0U;
 		}
 
 		/* If the entry was not found, we use the oldest entry and set the IPaddress */
-		xARPCache[ xUseEntry ].ulIPAddress = ulIPAddress;
+		prvCacheSetAddress( xUseEntry, ulIPAddress );
 
 		if( pxMACAddress != NULL )
 		{
@@ -479,36 +515,100 @@ static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup, MACAddress
 BaseType_t x;
 eARPLookupResult_t eReturn = eARPCacheMiss;
 
-	/* Loop through each entry in the ARP cache. */
-	for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+	/* Does a row in the ARP cache table hold an entry for the IP address
+	being queried? */
+	x = prvCacheFind( ulAddressToLookup );
+
+	if( x >= 0 )
 	{
-		/* Does this row in the ARP cache table hold an entry for the IP address
-		being queried? */
-		if( xARPCache[ x ].ulIPAddress == ulAddressToLookup )
+		/* A matching valid entry was found. */
+		if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
 		{
-			/* A matching valid entry was found. */
-			if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+			/* This entry is waiting an ARP reply, so is not valid. */
+			eReturn = eCantSendPacket;
+		}
+		else
+		{
+			/* A valid entry was found.  Mark it as used, so vARPAgeCache()
+			will refresh it before it expires. */
+			memcpy( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) );
+			xARPCache[ x ].ucUsed = ( uint8_t ) pdTRUE;
+			eReturn = eARPCacheHit;
+		}
+	}
+
+	return eReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCacheFind( uint32_t ulIPAddress )
+{
+BaseType_t xReturn = -1;
+uint16_t usIndex;
+
+	/* Empty rows have IP address 0 and are not linked into the hash table. */
+	if( ulIPAddress != 0UL )
+	{
+		for( usIndex = usARPHashHead[ arpHASH( ulIPAddress ) ]; usIndex != 0U; usIndex = xARPCache[ usIndex - 1U ].usHashNext )
+		{
+			if( xARPCache[ usIndex - 1U ].ulIPAddress == ulIPAddress )
 			{
-				/* This entry is waiting an ARP reply, so is not valid. */
-				eReturn = eCantSendPacket;
+				xReturn = ( BaseType_t ) usIndex - 1;
+				break;
 			}
-			else
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCacheSetAddress( BaseType_t xEntry, uint32_t ulIPAddress )
+{
+uint16_t *pusLink;
+ARPCacheRow_t *pxRow = &( xARPCache[ xEntry ] );
+
+	if( pxRow->ulIPAddress != ulIPAddress )
+	{
+		if( pxRow->ulIPAddress != 0UL )
+		{
+			/* Unlink the row from the chain of its old address. */
+			for( pusLink = &( usARPHashHead[ arpHASH( pxRow->ulIPAddress ) ] ); *pusLink != 0U; pusLink = &( xARPCache[ *pusLink - 1U ].usHashNext ) )
 			{
-				/* A valid entry was found. */
-				memcpy( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) );
-				eReturn = eARPCacheHit;
+				if( *pusLink == ( uint16_t ) ( xEntry + 1 ) )
+				{
+					*pusLink = pxRow->usHashNext;
+					break;
+				}
 			}
-			break;
+		}
+
+		pxRow->ulIPAddress = ulIPAddress;
+		pxRow->usHashNext = 0U;
+		/* The row belongs to another peer now, which has not been used yet. */
+		pxRow->ucUsed = ( uint8_t ) pdFALSE;
+
+		if( ulIPAddress != 0UL )
+		{
+			pusLink = &( usARPHashHead[ arpHASH( ulIPAddress ) ] );
+			pxRow->usHashNext = *pusLink;
+			*pusLink = ( uint16_t ) ( xEntry + 1 );
 		}
 	}
+}
+/*-----------------------------------------------------------*/
 
-	return eReturn;
+static void prvCacheClearEntry( BaseType_t xEntry )
+{
+	prvCacheSetAddress( xEntry, 0UL );
+	memset( &xARPCache[ xEntry ], '\0', sizeof( xARPCache[ xEntry ] ) );
 }
 /*-----------------------------------------------------------*/
 
 void vARPAgeCache( void )
 {
 BaseType_t x;
+BaseType_t xRefreshCount = 0;
 TickType_t xTimeNow;
 
 	/* Loop through each entry in the ARP cache. */
@@ -534,6 +634,20 @@ TickType_t xTimeNow;
 				iptraceARP_TABLE_ENTRY_WILL_EXPIRE( xARPCache[ x ].ulIPAddress );
 				FreeRTOS_OutputARPRequest( xARPCache[ x ].ulIPAddress );
 			}
+			else if( ( xARPCache[ x ].ucUsed != ( uint8_t ) pdFALSE ) && ( xARPCache[ x ].ucAge <= ( uint8_t ) ipconfigARP_REFRESH_AGE ) )
+			{
+				/* Entries that packets are sent to are refreshed earlier, so
+				that an active flow never has to wait for an ARP reply.  Ask the
+				known host directly, the other hosts need not see this request.
+				The number of these early requests per period is limited, the
+				remaining entries are served in the next one. */
+				if( xRefreshCount < ( BaseType_t ) ipconfigARP_MAX_REFRESH_PER_PERIOD )
+				{
+					xRefreshCount++;
+					xARPCache[ x ].ucUsed = ( uint8_t ) pdFALSE;
+					prvOutputARPRequest( xARPCache[ x ].ulIPAddress, &( xARPCache[ x ].xMACAddress ) );
+				}
+			}
 			else
 			{
 				/* The age has just ticked down, with nothing to do. */
@@ -543,7 +657,7 @@ TickType_t xTimeNow;
 			{
 				/* The entry is no longer valid.  Wipe it out. */
 				iptraceARP_TABLE_ENTRY_EXPIRED( xARPCache[ x ].ulIPAddress );
-				xARPCache[ x ].ulIPAddress = 0UL;
+				prvCacheSetAddress( x, 0UL );
 			}
 		}
 	}
@@ -570,6 +684,12 @@ void vARPSendGratuitous( void )
 
 /*-----------------------------------------------------------*/
 void FreeRTOS_OutputARPRequest( uint32_t ulIPAddress )
+{
+	prvOutputARPRequest( ulIPAddress, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvOutputARPRequest( uint32_t ulIPAddress, const MACAddress_t *pxDestination )
 {
 NetworkBufferDescriptor_t *pxNetworkBuffer;
 
@@ -582,6 +702,11 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 		pxNetworkBuffer->ulIPAddress = ulIPAddress;
 		vARPGenerateRequestPacket( pxNetworkBuffer );
 
+		if( pxDestination != NULL )
+		{
+			memcpy( ( ( ARPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer )->xEthernetHeader.xDestinationAddress.ucBytes, pxDestination->ucBytes, sizeof( MACAddress_t ) );
+		}
+
 		#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
 		{
 			if( pxNetworkBuffer->xDataLength < ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES )
@@ -635,6 +760,7 @@ ARPPacket_t *pxARPPacket;
 void FreeRTOS_ClearARP( void )
 {
 	memset( xARPCache, '\0', sizeof( xARPCache ) );
+	memset( usARPHashHead, '\0', sizeof( usARPHashHead ) );
 }
 /*-----------------------------------------------------------*/
 
@@ -881,6 +881,11 @@ NetworkBufferDescriptor_t * pxNewBuffer;
 		pxNewBuffer->ulIPAddress = pxNetworkBuffer->ulIPAddress;
 		pxNewBuffer->usPort = pxNetworkBuffer->usPort;
 		pxNewBuffer->usBoundPort = pxNetworkBuffer->usBoundPort;
+		#if( ipconfigUSE_TX_PRIORITY != 0 )
+		{
+			pxNewBuffer->ucTxPriority = pxNetworkBuffer->ucTxPriority;
+		}
+		#endif
 		memcpy( pxNewBuffer->pucEthernetBuffer, pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength );
 	}
 
@@ -1388,6 +1393,8 @@ volatile eFrameProcessingResult_t eReturned; /* Volatile to prevent complier war
 
 	configASSERT( pxNetworkBuffer );
 
+	iptracePROCESSING_RECEIVED_PACKET( pxNetworkBuffer );
+
 	/* Interpret the Ethernet frame. */
 	eReturned = ipCONSIDER_FRAME_FOR_PROCESSING( pxNetworkBuffer->pucEthernetBuffer );
 	pxEthernetHeader = ( EthernetHeader_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
@@ -1915,21 +1922,70 @@ uint8_t ucProtocol;
 }
 /*-----------------------------------------------------------*/
 
-uint16_t usGenerateChecksum( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+/* Sums the 32-bit words of a 4-byte aligned block. A 64-bit accumulator absorbs
+the carries, so the inner loop has no carry test, and 8 words (32 bytes) are
+added per iteration. */
+#define ipCHECKSUM_ADD_WORDS( ullSum, pulSource, uxWords )					\
+{																			\
+	const uint32_t *pulLast = ( pulSource ) + ( ( uxWords ) & ~( ( size_t ) 7u ) );	\
+	while( ( pulSource ) < pulLast )										\
+	{																		\
+		( ullSum ) += ( uint64_t ) ( pulSource )[ 0 ] + ( pulSource )[ 1 ];	\
+		( ullSum ) += ( uint64_t ) ( pulSource )[ 2 ] + ( pulSource )[ 3 ];	\
+		( ullSum ) += ( uint64_t ) ( pulSource )[ 4 ] + ( pulSource )[ 5 ];	\
+		( ullSum ) += ( uint64_t ) ( pulSource )[ 6 ] + ( pulSource )[ 7 ];	\
+		( pulSource ) += 8;													\
+	}																		\
+	pulLast = ( pulSource ) + ( ( uxWords ) & ( size_t ) 7u );				\
+	while( ( pulSource ) < pulLast )										\
+	{																		\
+		( ullSum ) += *( pulSource );										\
+		( pulSource )++;													\
+	}																		\
+}
+
+/* Folds the 64-bit accumulator of the data into a 16-bit sum, takes care of
+an odd start address and adds the running sum of the caller. */
+static uint16_t prvChecksumFold( uint64_t ullSum, uint32_t ulSum, uint32_t ulAlignBits )
 {
-xUnion32 xSum2, xSum, xTerm;
-xUnionPtr xSource;		/* Points to first byte */
-xUnionPtr xLastSource;	/* Points to last byte plus one */
-uint32_t ulAlignBits, ulCarry = 0ul;
+xUnion32 xSum;
 
-	/* Small MCUs often spend up to 30% of the time doing checksum calculations
-	This function is optimised for 32-bit CPUs; Each time it will try to fetch
-	32-bits, sums it with an accumulator and counts the number of carries. */
+	ullSum = ( ullSum & 0xffffffffull ) + ( ullSum >> 32 );
+	ullSum = ( ullSum & 0xffffffffull ) + ( ullSum >> 32 );
+	xSum.u32 = ( uint32_t ) ullSum;
+	xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
+	xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
 
-	/* Swap the input (little endian platform only). */
-	xSum.u32 = FreeRTOS_ntohs( ulSum );
-	xTerm.u32 = 0ul;
+	if( ( ulAlignBits & 1u ) != 0u )
+	{
+		/* pucNextData started at an odd position, so every 16-bit term was
+		summed with its bytes swapped. */
+		xSum.u32 = ( ( xSum.u32 & 0xffu ) << 8 ) | ( ( xSum.u32 & 0xff00u ) >> 8 );
+	}
+
+	/* The running sum of the caller is in network order (swap it on little
+	endian platforms only). */
+	xSum.u32 += FreeRTOS_ntohs( ulSum );
+	xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
+	xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
 
+	/* swap the output (little endian platform only). */
+	return FreeRTOS_htons( ( (uint16_t) xSum.u32 ) );
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usGenerateChecksum( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+{
+uint64_t ullSum = 0ull;
+xUnion32 xTerm;
+xUnionPtr xSource;
+uint32_t ulAlignBits;
+
+	/* The EMAC has no checksum offload, so every byte sent or received over
+	TCP and UDP passes through here. The bulk is summed a word at a time; the
+	bytes before the first word boundary and after the last one are collected
+	in xTerm at their position within a 16-bit term. */
+	xTerm.u32 = 0ul;
 	xSource.u8ptr = ( uint8_t * ) pucNextData;
 	ulAlignBits = ( ( ( uint32_t ) pucNextData ) & 0x03u ); /* gives 0, 1, 2, or 3 */
 
@@ -1939,95 +1995,116 @@ uint32_t ulAlignBits, ulCarry = 0ul;
 		xTerm.u8[ 1 ] = *( xSource.u8ptr );
 		( xSource.u8ptr )++;
 		uxDataLengthBytes--;
-		/* Now xSource is word (16-bit) aligned. */
 	}
 
 	/* If half-word (16-bit) aligned... */
 	if( ( ( ulAlignBits == 1u ) || ( ulAlignBits == 2u ) ) && ( uxDataLengthBytes >= 2u ) )
 	{
-		xSum.u32 += *(xSource.u16ptr);
+		ullSum += *( xSource.u16ptr );
 		( xSource.u16ptr )++;
 		uxDataLengthBytes -= 2u;
-		/* Now xSource is word (32-bit) aligned. */
 	}
 
 	/* Word (32-bit) aligned, do the most part. */
-	xLastSource.u32ptr = ( xSource.u32ptr + ( uxDataLengthBytes / 4u ) ) - 3u;
+	ipCHECKSUM_ADD_WORDS( ullSum, xSource.u32ptr, uxDataLengthBytes / 4u );
 
-	/* In this loop, four 32-bit additions will be done, in total 16 bytes.
-	Indexing with constants (0,1,2,3) gives faster code than using
-	post-increments. */
-	while( xSource.u32ptr < xLastSource.u32ptr )
+	if( ( uxDataLengthBytes & 2u ) != 0u )
 	{
-		/* Use a secondary Sum2, just to see if the addition produced an
-		overflow. */
-		xSum2.u32 = xSum.u32 + xSource.u32ptr[ 0 ];
-		if( xSum2.u32 < xSum.u32 )
-		{
-			ulCarry++;
-		}
+		ullSum += *( xSource.u16ptr );
+		( xSource.u16ptr )++;
+	}
 
-		/* Now add the secondary sum to the major sum, and remember if there was
-		a carry. */
-		xSum.u32 = xSum2.u32 + xSource.u32ptr[ 1 ];
-		if( xSum2.u32 > xSum.u32 )
-		{
-			ulCarry++;
-		}
+	if( ( uxDataLengthBytes & 1u ) != 0u )	/* Maybe one more ? */
+	{
+		xTerm.u8[ 0 ] = xSource.u8ptr[ 0 ];
+	}
+	ullSum += xTerm.u32;
 
-		/* And do the same trick once again for indexes 2 and 3 */
-		xSum2.u32 = xSum.u32 + xSource.u32ptr[ 2 ];
-		if( xSum2.u32 < xSum.u32 )
-		{
-			ulCarry++;
-		}
+	return prvChecksumFold( ullSum, ulSum, ulAlignBits );
+}
+/*-----------------------------------------------------------*/
 
-		xSum.u32 = xSum2.u32 + xSource.u32ptr[ 3 ];
+uint16_t usGenerateChecksumCopy( uint32_t ulSum, uint8_t * pucDestination, const uint8_t * pucSource, size_t uxDataLengthBytes )
+{
+uint64_t ullSum = 0ull;
+xUnion32 xTerm;
+xUnionPtr xSource, xDestination;
+uint32_t ulAlignBits;
+const uint32_t *pulLast;
 
-		if( xSum2.u32 > xSum.u32 )
-		{
-			ulCarry++;
-		}
+	ulAlignBits = ( ( ( uint32_t ) pucSource ) & 0x03u );
 
-		/* And finally advance the pointer 4 * 4 = 16 bytes. */
-		xSource.u32ptr += 4;
+	if( ( ( ( uint32_t ) pucDestination ) & 0x03u ) != ulAlignBits )
+	{
+		/* The word loads and stores cannot both be aligned. */
+		memcpy( pucDestination, pucSource, uxDataLengthBytes );
+		return usGenerateChecksum( ulSum, pucSource, uxDataLengthBytes );
 	}
 
-	/* Now add all carries. */
-	xSum.u32 = ( uint32_t )xSum.u16[ 0 ] + xSum.u16[ 1 ] + ulCarry;
+	xTerm.u32 = 0ul;
+	xSource.u8ptr = ( uint8_t * ) pucSource;
+	xDestination.u8ptr = pucDestination;
 
-	uxDataLengthBytes %= 16u;
-	xLastSource.u8ptr = ( uint8_t * ) ( xSource.u8ptr + ( uxDataLengthBytes & ~( ( size_t ) 1 ) ) );
+	if( ( ( ulAlignBits & 1ul ) != 0ul ) && ( uxDataLengthBytes >= ( size_t ) 1 ) )
+	{
+		xTerm.u8[ 1 ] = *( xSource.u8ptr );
+		*( xDestination.u8ptr ) = xTerm.u8[ 1 ];
+		( xSource.u8ptr )++;
+		( xDestination.u8ptr )++;
+		uxDataLengthBytes--;
+	}
 
-	/* Half-word aligned. */
-	while( xSource.u16ptr < xLastSource.u16ptr )
+	if( ( ( ulAlignBits == 1u ) || ( ulAlignBits == 2u ) ) && ( uxDataLengthBytes >= 2u ) )
 	{
-		/* At least one more short. */
-		xSum.u32 += xSource.u16ptr[ 0 ];
-		xSource.u16ptr++;
+		*( xDestination.u16ptr ) = *( xSource.u16ptr );
+		ullSum += *( xDestination.u16ptr );
+		( xSource.u16ptr )++;
+		( xDestination.u16ptr )++;
+		uxDataLengthBytes -= 2u;
 	}
 
-	if( ( uxDataLengthBytes & ( size_t ) 1 ) != 0u )	/* Maybe one more ? */
+	/* Every word is loaded once, stored and added while it is in a register. */
+	pulLast = xSource.u32ptr + ( ( uxDataLengthBytes / 4u ) & ~( ( size_t ) 3u ) );
+	while( xSource.u32ptr < pulLast )
 	{
-		xTerm.u8[ 0 ] = xSource.u8ptr[ 0 ];
+	uint32_t ulWord0 = xSource.u32ptr[ 0 ], ulWord1 = xSource.u32ptr[ 1 ];
+	uint32_t ulWord2 = xSource.u32ptr[ 2 ], ulWord3 = xSource.u32ptr[ 3 ];
+
+		xDestination.u32ptr[ 0 ] = ulWord0;
+		xDestination.u32ptr[ 1 ] = ulWord1;
+		xDestination.u32ptr[ 2 ] = ulWord2;
+		xDestination.u32ptr[ 3 ] = ulWord3;
+		ullSum += ( uint64_t ) ulWord0 + ulWord1;
+		ullSum += ( uint64_t ) ulWord2 + ulWord3;
+		xSource.u32ptr += 4;
+		xDestination.u32ptr += 4;
 	}
-	xSum.u32 += xTerm.u32;
 
-	/* Now add all carries again. */
-	xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
+	pulLast = xSource.u32ptr + ( ( uxDataLengthBytes / 4u ) & ( size_t ) 3u );
+	while( xSource.u32ptr < pulLast )
+	{
+		*( xDestination.u32ptr ) = *( xSource.u32ptr );
+		ullSum += *( xDestination.u32ptr );
+		( xSource.u32ptr )++;
+		( xDestination.u32ptr )++;
+	}
 
-	/* The previous summation might have given a 16-bit carry. */
-	xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
+	if( ( uxDataLengthBytes & 2u ) != 0u )
+	{
+		*( xDestination.u16ptr ) = *( xSource.u16ptr );
+		ullSum += *( xDestination.u16ptr );
+		( xSource.u16ptr )++;
+		( xDestination.u16ptr )++;
+	}
 
-	if( ( ulAlignBits & 1u ) != 0u )
+	if( ( uxDataLengthBytes & 1u ) != 0u )
 	{
-		/* Quite unlikely, but pucNextData might be non-aligned, which would
-		 mean that a checksum is calculated starting at an odd position. */
-		xSum.u32 = ( ( xSum.u32 & 0xffu ) << 8 ) | ( ( xSum.u32 & 0xff00u ) >> 8 );
+		xTerm.u8[ 0 ] = xSource.u8ptr[ 0 ];
+		xDestination.u8ptr[ 0 ] = xTerm.u8[ 0 ];
 	}
+	ullSum += xTerm.u32;
 
-	/* swap the output (little endian platform only). */
-	return FreeRTOS_htons( ( (uint16_t) xSum.u32 ) );
+	return prvChecksumFold( ullSum, ulSum, ulAlignBits );
 }
 /*-----------------------------------------------------------*/
 
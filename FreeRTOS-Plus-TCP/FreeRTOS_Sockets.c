@@ -82,6 +82,9 @@ port number. */
 xBoundUDPSocketsList or xBoundTCPSocketsList */
 #define socketSOCKET_IS_BOUND( pxSocket )      ( listLIST_ITEM_CONTAINER( & ( pxSocket )->xBoundSocketListItem ) != NULL )
 
+/* The bucket of a port number (in either byte order) in a port hash table. */
+#define socketPORT_HASH( usPort )	( ( UBaseType_t ) ( ( ( usPort ) ^ ( ( usPort ) >> 8 ) ) & ( ipconfigSOCKET_HASH_BUCKETS - 1u ) ) )
+
 /* If FreeRTOS_sendto() is called on a socket that is not bound to a port
 number then, depending on the FreeRTOSIPConfig.h settings, it might be that a
 port number is automatically generated for the socket.  Automatically generated
@@ -139,12 +142,43 @@ static uint16_t prvGetPrivatePortNumber( BaseType_t xProtocol );
  */
 static const ListItem_t * pxListFindListItemWithValue( const List_t *pxList, TickType_t xWantedItemValue );
 
+/*
+ * Return pdTRUE if a socket of the given protocol is bound to usPort (network
+ * byte order).
+ */
+static BaseType_t prvPortIsInUse( BaseType_t xProtocol, uint16_t usPort );
+
+/*
+ * Add a bound socket to / remove it from a port hash table.
+ */
+static void prvPortHashInsert( FreeRTOS_Socket_t **ppxTable, FreeRTOS_Socket_t *pxSocket, uint16_t usPort );
+static void prvPortHashRemove( FreeRTOS_Socket_t **ppxTable, FreeRTOS_Socket_t *pxSocket, uint16_t usPort );
+
+#if( ipconfigUSE_TCP == 1 )
+	/*
+	 * The bucket of a connection in pxTCPTupleHash[].
+	 */
+	static UBaseType_t prvTCPTupleHash( UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort );
+
+	/*
+	 * Remove a TCP socket from pxTCPTupleHash[], if it is there.
+	 */
+	static void prvTCPTupleHashRemove( FreeRTOS_Socket_t *pxSocket );
+#endif /* ipconfigUSE_TCP */
+
 /*
  * Return pdTRUE only if pxSocket is valid and bound, as far as can be
  * determined.
  */
 static BaseType_t prvValidSocket( FreeRTOS_Socket_t *pxSocket, BaseType_t xProtocol, BaseType_t xIsBound );
 
+/*
+ * Called from FreeRTOS_recvfrom() and FreeRTOS_recvmulti(): wait until the UDP
+ * socket has received at least one packet, or until its receive time-out has
+ * passed.  Returns the number of waiting packets.
+ */
+static BaseType_t prvUDPWaitForPackets( FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags, EventBits_t *pxEventBits );
+
 /*
  * Before creating a socket, check the validity of the parameters used
  * and find the size of the socket space, which is different for UDP and TCP
@@ -197,6 +231,23 @@ List_t xBoundUDPSocketsList;
 	List_t xBoundTCPSocketsList;
 #endif /* ipconfigUSE_TCP == 1 */
 
+/* The bound sockets are also hashed, so finding the socket of a received packet
+does not walk the lists above.  The lists are kept for iterating all sockets.
+The sockets in a bucket are chained through pxPortHashNext, and only the IP-task
+modifies the tables. */
+static FreeRTOS_Socket_t *pxUDPPortHash[ ipconfigSOCKET_HASH_BUCKETS ];
+
+#if ipconfigUSE_TCP == 1
+	/* TCP sockets bound by the user, i.e. all but the child sockets of a
+	listening socket.  Their local ports are unique, a listening socket is
+	found here. */
+	static FreeRTOS_Socket_t *pxTCPPortHash[ ipconfigSOCKET_HASH_BUCKETS ];
+
+	/* All bound TCP sockets, hashed on the local port, the remote IP address
+	and the remote port (chained through u.xTCP.pxTupleHashNext). */
+	static FreeRTOS_Socket_t *pxTCPTupleHash[ ipconfigSOCKET_HASH_BUCKETS ];
+#endif /* ipconfigUSE_TCP == 1 */
+
 /* Holds the next private port number to use when binding a client socket for
 UDP, and if ipconfigUSE_TCP is set to 1, also TCP.  UDP uses index
 socketNEXT_UDP_PORT_NUMBER_INDEX and TCP uses index
@@ -237,6 +288,7 @@ const uint32_t ulAutoPortRange = socketAUTO_PORT_ALLOCATION_MAX_NUMBER - socketA
 uint32_t ulRandomPort;
 
 	vListInitialise( &xBoundUDPSocketsList );
+	memset( pxUDPPortHash, '\0', sizeof( pxUDPPortHash ) );
 
 	/* Determine the first anonymous UDP port number to get assigned.  Give it
 	a random value in order to avoid confusion about port numbers being used
@@ -258,6 +310,8 @@ uint32_t ulRandomPort;
 		usNextPortToUse[ socketNEXT_TCP_PORT_NUMBER_INDEX ] = ( uint16_t ) ulRandomPort;
 
 		vListInitialise( &xBoundTCPSocketsList );
+		memset( pxTCPPortHash, '\0', sizeof( pxTCPPortHash ) );
+		memset( pxTCPTupleHash, '\0', sizeof( pxTCPTupleHash ) );
 	}
 	#endif  /* ipconfigUSE_TCP == 1 */
 }
@@ -642,33 +696,16 @@ Socket_t xReturn;
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
 /*-----------------------------------------------------------*/
 
-/*
- * FreeRTOS_recvfrom: receive data from a bound socket
- * In this library, the function can only be used with connectionsless sockets
- * (UDP)
- */
-int32_t FreeRTOS_recvfrom( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags, struct freertos_sockaddr *pxSourceAddress, socklen_t *pxSourceAddressLength )
+static BaseType_t prvUDPWaitForPackets( FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags, EventBits_t *pxEventBits )
 {
-BaseType_t lPacketCount = 0;
-NetworkBufferDescriptor_t *pxNetworkBuffer;
-FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+BaseType_t lPacketCount;
 TickType_t xRemainingTime = ( TickType_t ) 0; /* Obsolete assignment, but some compilers output a warning if its not done. */
 BaseType_t xTimed = pdFALSE;
 TimeOut_t xTimeOut;
-int32_t lReturn;
 EventBits_t xEventBits = ( EventBits_t ) 0;
 
-	if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdTRUE ) == pdFALSE )
-	{
-		return -pdFREERTOS_ERRNO_EINVAL;
-	}
-
 	lPacketCount = ( BaseType_t ) listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) );
 
-	/* The function prototype is designed to maintain the expected Berkeley
-	sockets standard, but this implementation does not use all the parameters. */
-	( void ) pxSourceAddressLength;
-
 	while( lPacketCount == 0 )
 	{
 		if( xTimed == pdFALSE )
@@ -739,6 +776,36 @@ EventBits_t xEventBits = ( EventBits_t ) 0;
 		}
 	} /* while( lPacketCount == 0 ) */
 
+	*pxEventBits = xEventBits;
+
+	return lPacketCount;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * FreeRTOS_recvfrom: receive data from a bound socket
+ * In this library, the function can only be used with connectionsless sockets
+ * (UDP)
+ */
+int32_t FreeRTOS_recvfrom( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags, struct freertos_sockaddr *pxSourceAddress, socklen_t *pxSourceAddressLength )
+{
+BaseType_t lPacketCount = 0;
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+int32_t lReturn;
+EventBits_t xEventBits = ( EventBits_t ) 0;
+
+	if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdTRUE ) == pdFALSE )
+	{
+		return -pdFREERTOS_ERRNO_EINVAL;
+	}
+
+	/* The function prototype is designed to maintain the expected Berkeley
+	sockets standard, but this implementation does not use all the parameters. */
+	( void ) pxSourceAddressLength;
+
+	lPacketCount = prvUDPWaitForPackets( pxSocket, xFlags, &xEventBits );
+
 	if( lPacketCount != 0 )
 	{
 		taskENTER_CRITICAL();
@@ -751,6 +818,7 @@ EventBits_t xEventBits = ( EventBits_t ) 0;
 				/* Remove the network buffer from the list of buffers waiting to
 				be processed by the socket. */
 				uxListRemove( &( pxNetworkBuffer->xBufferListItem ) );
+				iptraceRECVFROM_PACKET( pxNetworkBuffer );
 			}
 		}
 		taskEXIT_CRITICAL();
@@ -895,6 +963,12 @@ FreeRTOS_Socket_t *pxSocket;
 				space that will eventually get used by the Ethernet header. */
 				pxNetworkBuffer->pucEthernetBuffer[ ipSOCKET_OPTIONS_OFFSET ] = pxSocket->ucSocketOptions;
 
+				#if( ipconfigUSE_TX_PRIORITY != 0 )
+				{
+					pxNetworkBuffer->ucTxPriority = pxSocket->ucTxPriority;
+				}
+				#endif /* ipconfigUSE_TX_PRIORITY */
+
 				/* Tell the networking task that the packet needs sending. */
 				xStackTxEvent.pvData = pxNetworkBuffer;
 
@@ -947,6 +1021,182 @@ FreeRTOS_Socket_t *pxSocket;
 } /* Tested */
 /*-----------------------------------------------------------*/
 
+int32_t FreeRTOS_recvmulti( Socket_t xSocket, struct freertos_mmsg *pxMessages, size_t uxCount, BaseType_t xFlags )
+{
+BaseType_t lPacketCount;
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+EventBits_t xEventBits = ( EventBits_t ) 0;
+size_t x;
+int32_t lReturn;
+
+	if( ( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdTRUE ) == pdFALSE ) ||
+		( uxCount == 0u ) || ( ( xFlags & FREERTOS_MSG_PEEK ) != 0 ) )
+	{
+		return -pdFREERTOS_ERRNO_EINVAL;
+	}
+
+	/* Only wait for the first packet, like FreeRTOS_recvfrom() does. */
+	lPacketCount = prvUDPWaitForPackets( pxSocket, xFlags, &xEventBits );
+
+	if( lPacketCount != 0 )
+	{
+		/* Take all packets in a single critical section.  The descriptors
+		are stored temporarily, the messages are filled in afterwards. */
+		taskENTER_CRITICAL();
+		{
+			/* Another task reading the same socket may have taken packets
+			since lPacketCount was obtained, count them again here. */
+			if( uxCount > ( size_t ) listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) ) )
+			{
+				uxCount = ( size_t ) listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) );
+			}
+
+			for( x = 0u; x < uxCount; x++ )
+			{
+				pxNetworkBuffer = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxSocket->u.xUDP.xWaitingPacketsList ) );
+				uxListRemove( &( pxNetworkBuffer->xBufferListItem ) );
+				iptraceRECVFROM_PACKET( pxNetworkBuffer );
+				pxMessages[ x ].pvPayload = ( void * ) pxNetworkBuffer;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		for( x = 0u; x < uxCount; x++ )
+		{
+			pxNetworkBuffer = ( NetworkBufferDescriptor_t * ) pxMessages[ x ].pvPayload;
+
+			pxMessages[ x ].pvPayload = ( void * ) ( &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ) );
+			pxMessages[ x ].xLength = pxNetworkBuffer->xDataLength;
+			pxMessages[ x ].xAddress.sin_port = pxNetworkBuffer->usPort;
+			pxMessages[ x ].xAddress.sin_addr = pxNetworkBuffer->ulIPAddress;
+		}
+
+		if( uxCount != 0u )
+		{
+			lReturn = ( int32_t ) uxCount;
+		}
+		else
+		{
+			/* The other reader took them all. */
+			lReturn = -pdFREERTOS_ERRNO_EWOULDBLOCK;
+		}
+	}
+#if( ipconfigSUPPORT_SIGNALS != 0 )
+	else if( ( xEventBits & eSOCKET_INTR ) != 0 )
+	{
+		lReturn = -pdFREERTOS_ERRNO_EINTR;
+		iptraceRECVFROM_INTERRUPTED();
+	}
+#endif /* ipconfigSUPPORT_SIGNALS */
+	else
+	{
+		( void ) xEventBits;
+		lReturn = -pdFREERTOS_ERRNO_EWOULDBLOCK;
+		iptraceRECVFROM_TIMEOUT();
+	}
+
+	return lReturn;
+}
+/*-----------------------------------------------------------*/
+
+int32_t FreeRTOS_sendmulti( Socket_t xSocket, const struct freertos_mmsg *pxMessages, size_t uxCount, BaseType_t xFlags )
+{
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+IPStackEvent_t xStackTxEvent = { eStackTxEvent, NULL };
+TimeOut_t xTimeOut;
+TickType_t xTicksToWait;
+FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+size_t x = 0u;
+
+	if( ( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdFALSE ) == pdFALSE ) || ( pxMessages == NULL ) )
+	{
+		return -pdFREERTOS_ERRNO_EINVAL;
+	}
+
+	/* The checks that FreeRTOS_sendto() makes for every packet are made once
+	for the whole batch. */
+	if( ( socketSOCKET_IS_BOUND( pxSocket ) != pdFALSE ) ||
+		( FreeRTOS_bind( xSocket, NULL, 0u ) == 0 ) )
+	{
+		xTicksToWait = pxSocket->xSendBlockTime;
+
+		#if( ipconfigUSE_CALLBACKS != 0 )
+		{
+			if( xIsCallingFromIPTask() != pdFALSE )
+			{
+				/* No blocking within a call-back handler, see FreeRTOS_sendto(). */
+				xTicksToWait = ( TickType_t )0;
+			}
+		}
+		#endif /* ipconfigUSE_CALLBACKS */
+
+		if( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 )
+		{
+			xTicksToWait = ( TickType_t ) 0;
+		}
+
+		vTaskSetTimeOutState( &xTimeOut );
+
+		for( x = 0u; x < uxCount; x++ )
+		{
+			if( pxMessages[ x ].xLength > ( size_t ) ipMAX_UDP_PAYLOAD_LENGTH )
+			{
+				iptraceSENDTO_DATA_TOO_LONG();
+				break;
+			}
+
+			/* The payload was obtained with FreeRTOS_GetUDPPayloadBuffer(). */
+			pxNetworkBuffer = pxUDPPayloadBuffer_to_NetworkBuffer( pxMessages[ x ].pvPayload );
+			configASSERT( pxNetworkBuffer != NULL );
+
+			pxNetworkBuffer->xDataLength = pxMessages[ x ].xLength;
+			pxNetworkBuffer->usPort = pxMessages[ x ].xAddress.sin_port;
+			pxNetworkBuffer->usBoundPort = ( uint16_t ) socketGET_SOCKET_PORT( pxSocket );
+			pxNetworkBuffer->ulIPAddress = pxMessages[ x ].xAddress.sin_addr;
+			pxNetworkBuffer->pucEthernetBuffer[ ipSOCKET_OPTIONS_OFFSET ] = pxSocket->ucSocketOptions;
+
+			#if( ipconfigUSE_TX_PRIORITY != 0 )
+			{
+				pxNetworkBuffer->ucTxPriority = pxSocket->ucTxPriority;
+			}
+			#endif /* ipconfigUSE_TX_PRIORITY */
+
+			xStackTxEvent.pvData = pxNetworkBuffer;
+
+			if( xSendEventStructToIPTask( &xStackTxEvent, xTicksToWait ) != pdPASS )
+			{
+				/* This packet and the ones that follow still belong to the
+				caller. */
+				iptraceSTACK_TX_EVENT_LOST( ipSTACK_TX_EVENT );
+				break;
+			}
+
+			#if( ipconfigUSE_CALLBACKS == 1 )
+			{
+				if( ipconfigIS_VALID_PROG_ADDRESS( pxSocket->u.xUDP.pxHandleSent ) )
+				{
+					pxSocket->u.xUDP.pxHandleSent( (Socket_t *)pxSocket, pxMessages[ x ].xLength );
+				}
+			}
+			#endif /* ipconfigUSE_CALLBACKS */
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE )
+			{
+				/* The entire block time has been used up. */
+				xTicksToWait = ( TickType_t ) 0;
+			}
+		}
+	}
+	else
+	{
+		iptraceSENDTO_SOCKET_NOT_BOUND();
+	}
+
+	return ( int32_t ) x;
+}
+/*-----------------------------------------------------------*/
+
 /*
  * FreeRTOS_bind() : binds a sockt to a local port number.  If port 0 is
  * provided, a system provided port number will be assigned.  This function can
@@ -1079,7 +1329,7 @@ List_t *pxSocketList;
 		/* Check to ensure the port is not already in use.  If the bind is
 		called internally, a port MAY be used by more than one socket. */
 		if( ( ( xInternal == pdFALSE ) || ( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP ) ) &&
-			( pxListFindListItemWithValue( pxSocketList, ( TickType_t ) pxAddress->sin_port ) != NULL ) )
+			( prvPortIsInUse( ( BaseType_t ) pxSocket->ucProtocol, pxAddress->sin_port ) != pdFALSE ) )
 		{
 			FreeRTOS_debug_printf( ( "vSocketBind: %sP port %d in use\n",
 				pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP ? "TC" : "UD",
@@ -1110,6 +1360,22 @@ List_t *pxSocketList;
 				/* Add the socket to 'xBoundUDPSocketsList' or 'xBoundTCPSocketsList' */
 				vListInsertEnd( pxSocketList, &( pxSocket->xBoundSocketListItem ) );
 
+				/* And to the hash tables. */
+				#if( ipconfigUSE_TCP == 1 )
+				if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
+				{
+					if( xInternal == pdFALSE )
+					{
+						prvPortHashInsert( pxTCPPortHash, pxSocket, pxSocket->usLocalPort );
+					}
+					vSocketTCPRehash( pxSocket );
+				}
+				else
+				#endif /* ipconfigUSE_TCP == 1 */
+				{
+					prvPortHashInsert( pxUDPPortHash, pxSocket, pxAddress->sin_port );
+				}
+
 				#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 				{
 					xTaskResumeAll();
@@ -1243,6 +1509,19 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 
 		uxListRemove( &( pxSocket->xBoundSocketListItem ) );
 
+		#if( ipconfigUSE_TCP == 1 )
+		if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
+		{
+			/* A child socket is not in pxTCPPortHash[], the call does nothing. */
+			prvPortHashRemove( pxTCPPortHash, pxSocket, pxSocket->usLocalPort );
+			prvTCPTupleHashRemove( pxSocket );
+		}
+		else
+		#endif /* ipconfigUSE_TCP == 1 */
+		{
+			prvPortHashRemove( pxUDPPortHash, pxSocket, ( uint16_t ) socketGET_SOCKET_PORT( pxSocket ) );
+		}
+
 		#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 		{
 			xTaskResumeAll();
@@ -1383,6 +1662,21 @@ FreeRTOS_Socket_t *pxSocket;
 				break;
 		#endif /* ipconfigUDP_MAX_RX_PACKETS */
 
+		#if( ipconfigUSE_TX_PRIORITY != 0 )
+			case FREERTOS_SO_TX_PRIORITY:
+				/* Select the transmit priority class of this socket. */
+				if( *( ( BaseType_t * ) pvOptionValue ) != 0 )
+				{
+					pxSocket->ucTxPriority = ( uint8_t ) ipTX_PRIORITY_HIGH;
+				}
+				else
+				{
+					pxSocket->ucTxPriority = ( uint8_t ) ipTX_PRIORITY_NORMAL;
+				}
+				xReturn = 0;
+				break;
+		#endif /* ipconfigUSE_TX_PRIORITY */
+
 		case FREERTOS_SO_UDPCKSUM_OUT :
 			/* Turn calculating of the UDP checksum on/off for this socket. */
 			lOptionValue = ( BaseType_t ) pvOptionValue;
@@ -1655,19 +1949,16 @@ static uint16_t prvGetPrivatePortNumber( BaseType_t xProtocol )
 {
 uint16_t usResult;
 BaseType_t xIndex;
-const List_t *pxList;
 
 #if ipconfigUSE_TCP == 1
 	if( xProtocol == ( BaseType_t ) FREERTOS_IPPROTO_TCP )
 	{
 		xIndex = socketNEXT_TCP_PORT_NUMBER_INDEX;
-		pxList = &xBoundTCPSocketsList;
 	}
 	else
 #endif
 	{
 		xIndex = socketNEXT_UDP_PORT_NUMBER_INDEX;
-		pxList = &xBoundUDPSocketsList;
 	}
 
 	/* Avoid compiler warnings if ipconfigUSE_TCP is not defined. */
@@ -1691,7 +1982,7 @@ const List_t *pxList;
 
 		usResult = FreeRTOS_htons( usNextPortToUse[ xIndex ] );
 
-		if( pxListFindListItemWithValue( pxList, ( TickType_t ) usResult ) == NULL )
+		if( prvPortIsInUse( xProtocol, usResult ) == pdFALSE )
 		{
 			break;
 		}
@@ -1729,24 +2020,72 @@ const ListItem_t * pxResult = NULL;
 
 FreeRTOS_Socket_t *pxUDPSocketLookup( UBaseType_t uxLocalPort )
 {
-const ListItem_t *pxListItem;
-FreeRTOS_Socket_t *pxSocket = NULL;
+FreeRTOS_Socket_t *pxSocket;
+
+	/* Looking up a socket is quite simple, find a match with the local port
+	(network byte order) in its bucket of the port hash table. */
+	for( pxSocket = pxUDPPortHash[ socketPORT_HASH( uxLocalPort ) ];
+		 pxSocket != NULL;
+		 pxSocket = pxSocket->pxPortHashNext )
+	{
+		if( socketGET_SOCKET_PORT( pxSocket ) == ( TickType_t ) uxLocalPort )
+		{
+			break;
+		}
+	}
+	return pxSocket;
+}
 
-	/* Looking up a socket is quite simple, find a match with the local port.
+/*-----------------------------------------------------------*/
 
-	See if there is a list item associated with the port number on the
-	list of bound sockets. */
-	pxListItem = pxListFindListItemWithValue( &xBoundUDPSocketsList, ( TickType_t ) uxLocalPort );
+static BaseType_t prvPortIsInUse( BaseType_t xProtocol, uint16_t usPort )
+{
+BaseType_t xReturn;
 
-	if( pxListItem != NULL )
+	#if( ipconfigUSE_TCP == 1 )
+	if( xProtocol == ( BaseType_t ) FREERTOS_IPPROTO_TCP )
 	{
-		/* The owner of the list item is the socket itself. */
-		pxSocket = ( FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxListItem );
-		configASSERT( pxSocket != NULL );
+		/* The child sockets share the port of their listening socket and are
+		not in pxTCPPortHash[], but they keep the port in use as long as they
+		exist.  Binding is rare, the list is walked. */
+		xReturn = ( pxListFindListItemWithValue( &xBoundTCPSocketsList, ( TickType_t ) usPort ) != NULL ) ? pdTRUE : pdFALSE;
 	}
-	return pxSocket;
+	else
+	#endif /* ipconfigUSE_TCP == 1 */
+	{
+		xReturn = ( pxUDPSocketLookup( ( UBaseType_t ) usPort ) != NULL ) ? pdTRUE : pdFALSE;
+	}
+
+	/* Avoid compiler warnings if ipconfigUSE_TCP is not defined. */
+	( void ) xProtocol;
+
+	return xReturn;
 }
+/*-----------------------------------------------------------*/
+
+static void prvPortHashInsert( FreeRTOS_Socket_t **ppxTable, FreeRTOS_Socket_t *pxSocket, uint16_t usPort )
+{
+UBaseType_t uxBucket = socketPORT_HASH( usPort );
 
+	pxSocket->pxPortHashNext = ppxTable[ uxBucket ];
+	ppxTable[ uxBucket ] = pxSocket;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPortHashRemove( FreeRTOS_Socket_t **ppxTable, FreeRTOS_Socket_t *pxSocket, uint16_t usPort )
+{
+FreeRTOS_Socket_t **ppxLink;
+
+	for( ppxLink = &( ppxTable[ socketPORT_HASH( usPort ) ] ); *ppxLink != NULL; ppxLink = &( ( *ppxLink )->pxPortHashNext ) )
+	{
+		if( *ppxLink == pxSocket )
+		{
+			*ppxLink = pxSocket->pxPortHashNext;
+			pxSocket->pxPortHashNext = NULL;
+			break;
+		}
+	}
+}
 /*-----------------------------------------------------------*/
 
 #if ipconfigINCLUDE_FULL_INET_ADDR == 1
@@ -1908,7 +2247,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 		vTaskSuspendAll();
 		{
-			if( ( pxListFindListItemWithValue( &xBoundUDPSocketsList, ( TickType_t ) usPortNr ) != NULL ) )
+			if( pxUDPSocketLookup( ( UBaseType_t ) usPortNr ) != NULL )
 			{
 				xFound = pdTRUE;
 			}
@@ -2337,6 +2676,11 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 		#endif /* ipconfigSUPPORT_SIGNALS */
 			if( xByteCount > 0 )
 			{
+				if( ( xFlags & FREERTOS_MSG_PEEK ) == 0 )
+				{
+					iptraceRECV_DATA( pxSocket );
+				}
+
 				if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
 				{
 					xByteCount = ( BaseType_t ) uxStreamBufferGet( pxSocket->u.xTCP.rxStream, 0ul, ( uint8_t * ) pvBuffer, ( size_t ) xBufferLength, ( xFlags & FREERTOS_MSG_PEEK ) != 0 );
@@ -2423,22 +2767,40 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	'*pxLength' will contain the number of bytes that may be written. */
 	uint8_t *FreeRTOS_get_tx_head( Socket_t xSocket, BaseType_t *pxLength )
 	{
-	uint8_t *pucReturn;
+		return FreeRTOS_get_tx_head_offset( xSocket, 0u, pxLength );
+	}
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	/* Get a direct pointer to the circular transmit buffer, 'uxOffset' bytes
+	past its head.  '*pxLength' will contain the number of bytes that may be
+	written there before the buffer wraps.  The transmit stream is created if it
+	doesn't exist yet. */
+	uint8_t *FreeRTOS_get_tx_head_offset( Socket_t xSocket, size_t uxOffset, BaseType_t *pxLength )
+	{
+	uint8_t *pucReturn = NULL;
 	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
-	StreamBuffer_t *pxBuffer = pxSocket->u.xTCP.txStream;
+	StreamBuffer_t *pxBuffer = NULL;
 
-		if( pxBuffer != NULL )
+		*pxLength = 0;
+
+		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdTRUE ) != pdFALSE )
 		{
-		BaseType_t xSpace = ( BaseType_t ) uxStreamBufferGetSpace( pxBuffer );
-		BaseType_t xRemain = ( BaseType_t ) ( pxBuffer->LENGTH - pxBuffer->uxHead );
+			pxBuffer = pxSocket->u.xTCP.txStream;
 
-			*pxLength = FreeRTOS_min_BaseType( xSpace, xRemain );
-			pucReturn = pxBuffer->ucArray + pxBuffer->uxHead;
+			if( ( pxBuffer == NULL ) && ( pxSocket->u.xTCP.bits.bMallocError == pdFALSE_UNSIGNED ) &&
+				( pxSocket->u.xTCP.ucTCPState != eCLOSED ) )
+			{
+				/* Create the outgoing stream only when it is needed */
+				pxBuffer = prvTCPCreateStream( pxSocket, pdFALSE );
+			}
 		}
-		else
+
+		if( pxBuffer != NULL )
 		{
-			*pxLength = 0;
-			pucReturn = NULL;
+			*pxLength = ( BaseType_t ) uxStreamBufferGetHeadPtr( pxBuffer, uxOffset, &pucReturn );
 		}
 
 		return pucReturn;
@@ -2824,44 +3186,97 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	 */
 	FreeRTOS_Socket_t *pxTCPSocketLookup( uint32_t ulLocalIP, UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort )
 	{
-	ListItem_t *pxIterator;
-	FreeRTOS_Socket_t *pxResult = NULL, *pxListenSocket = NULL;
-	MiniListItem_t *pxEnd = ( MiniListItem_t* )listGET_END_MARKER( &xBoundTCPSocketsList );
+	FreeRTOS_Socket_t *pxSocket;
 
 		/* Parameter not yet supported. */
 		( void ) ulLocalIP;
 
-		for( pxIterator  = ( ListItem_t * ) listGET_NEXT( pxEnd );
-			 pxIterator != ( ListItem_t * ) pxEnd;
-			 pxIterator  = ( ListItem_t * ) listGET_NEXT( pxIterator ) )
+		/* For sockets not in listening mode, find a match with xLocalPort,
+		ulRemoteIP AND xRemotePort. */
+		for( pxSocket = pxTCPTupleHash[ prvTCPTupleHash( uxLocalPort, ulRemoteIP, uxRemotePort ) ];
+			 pxSocket != NULL;
+			 pxSocket = pxSocket->u.xTCP.pxTupleHashNext )
 		{
-			FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+			if( ( pxSocket->usLocalPort == ( uint16_t ) uxLocalPort ) &&
+				( pxSocket->u.xTCP.ucTCPState != eTCP_LISTEN ) &&
+				( pxSocket->u.xTCP.usRemotePort == ( uint16_t ) uxRemotePort ) &&
+				( pxSocket->u.xTCP.ulRemoteIP == ulRemoteIP ) )
+			{
+				break;
+			}
+		}
 
-			if( pxSocket->usLocalPort == ( uint16_t ) uxLocalPort )
+		if( pxSocket == NULL )
+		{
+			/* An exact match was not found, maybe a socket is listening to
+			uxLocalPort.  Only a socket bound by the user can listen, and its
+			port is unique among those. */
+			for( pxSocket = pxTCPPortHash[ socketPORT_HASH( uxLocalPort ) ];
+				 pxSocket != NULL;
+				 pxSocket = pxSocket->pxPortHashNext )
 			{
-				if( pxSocket->u.xTCP.ucTCPState == eTCP_LISTEN )
-				{
-					/* If this is a socket listening to uxLocalPort, remember it
-					in case there is no perfect match. */
-					pxListenSocket = pxSocket;
-				}
-				else if( ( pxSocket->u.xTCP.usRemotePort == ( uint16_t ) uxRemotePort ) && ( pxSocket->u.xTCP.ulRemoteIP == ulRemoteIP ) )
+				if( pxSocket->usLocalPort == ( uint16_t ) uxLocalPort )
 				{
-					/* For sockets not in listening mode, find a match with
-					xLocalPort, ulRemoteIP AND xRemotePort. */
-					pxResult = pxSocket;
+					if( pxSocket->u.xTCP.ucTCPState != eTCP_LISTEN )
+					{
+						pxSocket = NULL;
+					}
 					break;
 				}
 			}
 		}
-		if( pxResult == NULL )
+
+		return pxSocket;
+	}
+	/*-----------------------------------------------------------*/
+
+	static UBaseType_t prvTCPTupleHash( UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort )
+	{
+	uint32_t ulHash = ulRemoteIP ^ ( ( ( uint32_t ) uxLocalPort << 16 ) | ( ( uint32_t ) uxRemotePort & 0xffffu ) );
+
+		ulHash ^= ulHash >> 16;
+		ulHash ^= ulHash >> 8;
+
+		return ( UBaseType_t ) ( ulHash & ( ipconfigSOCKET_HASH_BUCKETS - 1u ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPTupleHashRemove( FreeRTOS_Socket_t *pxSocket )
+	{
+	FreeRTOS_Socket_t **ppxLink;
+
+		/* uxTupleBucket holds the bucket plus one, zero when not hashed. */
+		if( pxSocket->u.xTCP.uxTupleBucket != 0u )
 		{
-			/* An exact match was not found, maybe a listening socket was
-			found. */
-			pxResult = pxListenSocket;
+			for( ppxLink = &( pxTCPTupleHash[ pxSocket->u.xTCP.uxTupleBucket - 1u ] ); *ppxLink != NULL; ppxLink = &( ( *ppxLink )->u.xTCP.pxTupleHashNext ) )
+			{
+				if( *ppxLink == pxSocket )
+				{
+					*ppxLink = pxSocket->u.xTCP.pxTupleHashNext;
+					break;
+				}
+			}
+			pxSocket->u.xTCP.pxTupleHashNext = NULL;
+			pxSocket->u.xTCP.uxTupleBucket = 0u;
 		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * The remote address of a bound socket is set by FreeRTOS_connect() or when
+	 * a connection is accepted, the IP-task calls this function to move the
+	 * socket to the bucket of its new address.
+	 */
+	void vSocketTCPRehash( FreeRTOS_Socket_t *pxSocket )
+	{
+	UBaseType_t uxBucket;
 
-		return pxResult;
+		prvTCPTupleHashRemove( pxSocket );
+
+		uxBucket = prvTCPTupleHash( pxSocket->usLocalPort, pxSocket->u.xTCP.ulRemoteIP, pxSocket->u.xTCP.usRemotePort );
+		pxSocket->u.xTCP.pxTupleHashNext = pxTCPTupleHash[ uxBucket ];
+		pxTCPTupleHash[ uxBucket ] = pxSocket;
+		pxSocket->u.xTCP.uxTupleBucket = uxBucket + 1u;
 	}
 
 #endif /* ipconfigUSE_TCP */
@@ -3317,6 +3732,28 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP == 1 )
+
+	BaseType_t FreeRTOS_retransmits( Socket_t xSocket )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	BaseType_t xReturn;
+
+		if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+		{
+			xReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			xReturn = ( BaseType_t ) pxSocket->u.xTCP.xTCPWindow.ulRetransmitCount;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_TCP == 1 )
 
 	void FreeRTOS_netstat( void )
@@ -3341,6 +3778,8 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	/* Show a simple listing of all created sockets and their connections */
 	ListItem_t *pxIterator;
 	BaseType_t count = 0;
+	BaseType_t x;
+	NetworkBufferClassStats_t xClassStats;
 
 		if( listLIST_IS_INITIALISED( &xBoundTCPSocketsList ) == pdFALSE )
 		{
@@ -3403,6 +3842,20 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				uxGetMinimumFreeNetworkBuffers( ),
 				uxGetNumberOfFreeNetworkBuffers( ),
 				ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ) );
+
+			for( x = 0; x < ipNETWORK_BUFFER_CLASS_COUNT; x++ )
+			{
+				if( xGetNetworkBufferClassStats( x, &xClassStats ) == pdPASS )
+				{
+					FreeRTOS_printf( ( "FreeRTOS_netstat: %4u-byte buffers %lu < %lu < %lu free, %lu fallbacks %lu failures\n",
+						xClassStats.uxBufferSize,
+						xClassStats.uxMinimumFree,
+						xClassStats.uxFree,
+						xClassStats.uxCount,
+						xClassStats.ulFallbacks,
+						xClassStats.ulFailures ) );
+				}
+			}
 		}
 	}
 
@@ -738,6 +738,11 @@ NetworkBufferDescriptor_t xTempBuffer;
 			xTempBuffer.pxNextBuffer = NULL;
 		}
 		#endif
+		#if( ipconfigUSE_TX_PRIORITY != 0 )
+		{
+			xTempBuffer.ucTxPriority = ( uint8_t ) ipTX_PRIORITY_NORMAL;
+		}
+		#endif
 		xTempBuffer.pucEthernetBuffer = pxSocket->u.xTCP.xPacket.u.ucLastPacket;
 		xTempBuffer.xDataLength = sizeof( pxSocket->u.xTCP.xPacket.u.ucLastPacket );
 		xReleaseAfterSend = pdFALSE;
@@ -766,6 +771,12 @@ NetworkBufferDescriptor_t xTempBuffer;
 		/* Fill the packet, using hton translations. */
 		if( pxSocket != NULL )
 		{
+			#if( ipconfigUSE_TX_PRIORITY != 0 )
+			{
+				pxNetworkBuffer->ucTxPriority = pxSocket->ucTxPriority;
+			}
+			#endif /* ipconfigUSE_TX_PRIORITY */
+
 			/* Calculate the space in the RX buffer in order to advertise the
 			size of this socket's reception window. */
 			pxTCPWindow = &( pxSocket->u.xTCP.xTCPWindow );
@@ -1028,6 +1039,10 @@ BaseType_t xReturn = pdTRUE;
 	}
 	#endif /* ipconfigHAS_PRINTF != 0 */
 
+	/* FreeRTOS_connect() has set the remote address, the replies of the peer
+	must find this socket. */
+	vSocketTCPRehash( pxSocket );
+
 	ulRemoteIP = FreeRTOS_htonl( pxSocket->u.xTCP.ulRemoteIP );
 
 	/* Determine the ARP cache status for the requested IP address. */
@@ -2214,6 +2229,11 @@ BaseType_t xResult = 0;
 				prvTCPSendReset( pxNetworkBuffer );
 				xResult = -1;
 			}
+			else if( lOffset == 0 )
+			{
+				/* The data is available to the socket owner from now on. */
+				iptraceTCP_RX_DATA_STORED( pxSocket, pxNetworkBuffer );
+			}
 		}
 
 		/* After a missing packet has come in, higher packets may be passed to
@@ -3161,6 +3181,7 @@ FreeRTOS_Socket_t *pxReturn;
 	{
 		pxReturn->u.xTCP.usRemotePort = FreeRTOS_htons( pxTCPPacket->xTCPHeader.usSourcePort );
 		pxReturn->u.xTCP.ulRemoteIP = FreeRTOS_htonl( pxTCPPacket->xIPHeader.ulSourceIPAddress );
+		vSocketTCPRehash( pxReturn );
 		pxReturn->u.xTCP.xTCPWindow.ulOurSequenceNumber = ulNextInitialSequenceNumber;
 
 		/* Here is the SYN action. */
@@ -3192,6 +3213,11 @@ struct freertos_sockaddr xAddress;
 	pxNewSocket->xReceiveBlockTime = pxSocket->xReceiveBlockTime;
 	pxNewSocket->xSendBlockTime = pxSocket->xSendBlockTime;
 	pxNewSocket->ucSocketOptions = pxSocket->ucSocketOptions;
+	#if( ipconfigUSE_TX_PRIORITY != 0 )
+	{
+		pxNewSocket->ucTxPriority = pxSocket->ucTxPriority;
+	}
+	#endif /* ipconfigUSE_TX_PRIORITY */
 	pxNewSocket->u.xTCP.uxRxStreamSize = pxSocket->u.xTCP.uxRxStreamSize;
 	pxNewSocket->u.xTCP.uxTxStreamSize = pxSocket->u.xTCP.uxTxStreamSize;
 	pxNewSocket->u.xTCP.uxLittleSpace = pxSocket->u.xTCP.uxLittleSpace;
@@ -657,6 +657,7 @@ const int32_t l500ms = 500;
 
 	pxWindow->u.ulFlags = 0ul;
 	pxWindow->u.bits.bHasInit = pdTRUE_UNSIGNED;
+	pxWindow->ulRetransmitCount = 0ul;
 
 	if( ulMSS != 0ul )
 	{
@@ -1316,6 +1317,7 @@ const int32_t l500ms = 500;
 					head of the waiting queue. */
 					pxSegment = xTCPWindowGetHead( &( pxWindow->xWaitQueue ) );
 					pxSegment->u.bits.ucDupAckCount = pdFALSE_UNSIGNED;
+					pxWindow->ulRetransmitCount++;
 
 					/* Some detailed logging. */
 					if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != 0 ) )
@@ -1390,7 +1392,8 @@ const int32_t l500ms = 500;
 		else
 		{
 			/* There is a priority segment. It doesn't need any checking for
-			space or timeouts. */
+			space or timeouts.  Only fast retransmissions are put in this queue. */
+			pxWindow->ulRetransmitCount++;
 			if( xTCPWindowLoggingLevel != 0 )
 			{
 				FreeRTOS_debug_printf( ( "ulTCPWindowTxGet[%u,%u]: PrioQueue %ld bytes for sequence number %lu (ws %lu)\n",
@@ -1831,6 +1834,10 @@ const int32_t l500ms = 500;
 
 			if( ulLength != 0ul )
 			{
+				if( pxSegment->u.bits.bOutstanding != pdFALSE_UNSIGNED )
+				{
+					pxWindow->ulRetransmitCount++;
+				}
 				pxSegment->u.bits.bOutstanding = pdTRUE_UNSIGNED;
 				pxSegment->u.bits.ucTransmitCount++;
 				vTCPTimerSet (&pxSegment->xTransmitTimer);
@@ -343,6 +343,26 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigTCP_TIME_TO_LIVE		128
 #endif
 
+#ifndef ipconfigUSE_TX_PRIORITY
+	/* When non-zero, every network buffer carries a transmit priority class
+	 * (ipTX_PRIORITY_NORMAL or ipTX_PRIORITY_HIGH), which sockets can set with
+	 * FREERTOS_SO_TX_PRIORITY.  The network driver may use it to queue
+	 * time-critical frames ahead of bulk traffic.
+	 */
+	#define ipconfigUSE_TX_PRIORITY			0
+#endif
+
+#ifndef ipconfigUSE_RX_TIMESTAMPS
+	/* When non-zero, every network buffer carries ulRxTimestamp, set by the
+	 * network driver when the frame was received, and every TCP socket carries
+	 * the timestamp of the oldest data in its rxStream.  The stack only stores
+	 * them; the iptrace hooks (iptracePROCESSING_RECEIVED_PACKET,
+	 * iptraceRECVFROM_PACKET, iptraceTCP_RX_DATA_STORED and iptraceRECV_DATA)
+	 * can use them to measure the receive latencies.  Zero means no timestamp.
+	 */
+	#define ipconfigUSE_RX_TIMESTAMPS		0
+#endif
+
 #ifndef ipconfigUDP_MAX_RX_PACKETS
 	/* Make postive to define the maximum number of packets which will be buffered
 	 * for each UDP socket.
@@ -574,4 +594,55 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigPACKET_FILLER_SIZE 2
 #endif
 
+#ifndef ipconfigSOCKET_HASH_BUCKETS
+	/* Number of buckets of the hash tables used to find the socket of a
+	received packet.  Must be a power of 2. */
+	#define ipconfigSOCKET_HASH_BUCKETS 32
+#endif
+
+#if( ( ipconfigSOCKET_HASH_BUCKETS & ( ipconfigSOCKET_HASH_BUCKETS - 1 ) ) != 0 )
+	#error ipconfigSOCKET_HASH_BUCKETS must be a power of 2
+#endif
+
+#ifndef ipconfigARP_HASH_BUCKETS
+	/* Number of buckets of the hash table used to find an IP address in the
+	ARP cache.  Must be a power of 2. */
+	#define ipconfigARP_HASH_BUCKETS 16
+#endif
+
+#if( ( ipconfigARP_HASH_BUCKETS & ( ipconfigARP_HASH_BUCKETS - 1 ) ) != 0 )
+	#error ipconfigARP_HASH_BUCKETS must be a power of 2
+#endif
+
+#if( ipconfigARP_CACHE_ENTRIES > 0xFFFE )
+	#error ipconfigARP_CACHE_ENTRIES is too large
+#endif
+
+#ifndef ipconfigARP_REFRESH_AGE
+	/* Entries that are in use are refreshed with a unicast ARP request once
+	their age drops to this value (in ARP timer periods, normally 10 seconds),
+	so that they are renewed before they expire. */
+	#define ipconfigARP_REFRESH_AGE 6
+#endif
+
+#ifndef ipconfigARP_MAX_REFRESH_PER_PERIOD
+	/* Maximum number of early unicast refresh requests sent by one run of
+	vARPAgeCache(), so that a large cache does not drain the network buffers at
+	once.  The broadcast requests for entries about to expire are not limited. */
+	#define ipconfigARP_MAX_REFRESH_PER_PERIOD 8
+#endif
+
+#ifndef ipconfigNUM_SMALL_NETWORK_BUFFERS
+	/* Number of small network buffers, which are used for packets that fit in
+	ipconfigSMALL_NETWORK_BUFFER_SIZE bytes, like ARP packets and TCP ACK's.
+	They come on top of the ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS full-sized
+	buffers.  Only BufferAllocation_3.c supports them. */
+	#define ipconfigNUM_SMALL_NETWORK_BUFFERS 0
+#endif
+
+#ifndef ipconfigSMALL_NETWORK_BUFFER_SIZE
+	/* The size of a small network buffer, Ethernet header included. */
+	#define ipconfigSMALL_NETWORK_BUFFER_SIZE 128
+#endif
+
 #endif /* FREERTOS_DEFAULT_IP_CONFIG_H */
@@ -77,6 +77,8 @@ typedef struct xARP_CACHE_TABLE_ROW
 	MACAddress_t xMACAddress;  /* The MAC address of an ARP cache entry. */
 	uint8_t ucAge;				/* A value that is periodically decremented but can also be refreshed by active communication.  The ARP cache entry is removed if the value reaches zero. */
     uint8_t ucValid;			/* pdTRUE: xMACAddress is valid, pdFALSE: waiting for ARP reply */
+	uint16_t usHashNext;		/* Index + 1 of the next row in the same hash bucket, 0 ends the chain. */
+	uint8_t ucUsed;				/* pdTRUE when packets were sent to this address since the last refresh request. */
 } ARPCacheRow_t;
 
 typedef enum
@@ -115,6 +115,11 @@ buffer will have the following contents:
     #define ipBUFFER_PADDING    ( 8u + ipconfigPACKET_FILLER_SIZE )
 #endif
 
+/* Transmit priority classes of a network buffer, see ipconfigUSE_TX_PRIORITY
+and FREERTOS_SO_TX_PRIORITY. */
+#define ipTX_PRIORITY_NORMAL	( 0u )
+#define ipTX_PRIORITY_HIGH		( 1u )
+
 /* The structure used to store buffers and pass them around the network stack.
 Buffers can be in use by the stack, in use by the network interface hardware
 driver, or free (not in use). */
@@ -129,6 +134,12 @@ typedef struct xNETWORK_BUFFER
 	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
 		struct xNETWORK_BUFFER *pxNextBuffer; /* Possible optimisation for expert users - requires network driver support. */
 	#endif
+	#if( ipconfigUSE_TX_PRIORITY != 0 )
+		uint8_t ucTxPriority;		/* Transmit priority class, ipTX_PRIORITY_NORMAL or ipTX_PRIORITY_HIGH. */
+	#endif
+	#if( ipconfigUSE_RX_TIMESTAMPS != 0 )
+		uint32_t ulRxTimestamp;		/* Reception time set by the network driver, 0 when not stamped. */
+	#endif
 } NetworkBufferDescriptor_t;
 
 #include "pack_struct_start.h"
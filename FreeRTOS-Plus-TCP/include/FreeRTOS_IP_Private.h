@@ -467,6 +467,12 @@ eFrameProcessingResult_t eConsiderFrameForProcessing( const uint8_t * const pucE
  */
 uint16_t usGenerateChecksum( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes );
 
+/*
+ * Copy uxDataLengthBytes from pucSource to pucDestination and return the
+ * checksum of the data, in one pass over the memory.
+ */
+uint16_t usGenerateChecksumCopy( uint32_t ulSum, uint8_t * pucDestination, const uint8_t * pucSource, size_t uxDataLengthBytes );
+
 /* Socket related private functions. */
 BaseType_t xProcessReceivedUDPPacket( NetworkBufferDescriptor_t *pxNetworkBuffer, uint16_t usPort );
 void vNetworkSocketsInit( void );
@@ -562,6 +568,8 @@ BaseType_t xIPIsNetworkTaskReady( void );
 								 * TCP win segments */
 		uint8_t ucTCPState;		/* TCP state: see eTCP_STATE */
 		struct XSOCKET *pxPeerSocket;	/* for server socket: child, for child socket: parent */
+		struct XSOCKET *pxTupleHashNext;	/* Next socket in the same bucket of the local port / remote address hash table */
+		UBaseType_t uxTupleBucket;		/* The bucket in that table plus one, 0 when not hashed */
 		#if( ipconfigTCP_KEEP_ALIVE == 1 )
 			uint8_t ucKeepRepCount;
 			TickType_t xLastAliveTime;
@@ -597,6 +605,9 @@ BaseType_t xIPIsNetworkTaskReady( void );
 		uint32_t ulRxCurWinSize;	/* Constantly changing: this is the current size available for data reception */
 		size_t uxRxWinSize;	/* Fixed value: size of the TCP reception window */
 		size_t uxTxWinSize;	/* Fixed value: size of the TCP transmit window */
+		#if( ipconfigUSE_RX_TIMESTAMPS != 0 )
+			uint32_t ulRxTimestamp;	/* Timestamp of the oldest data in rxStream not read yet, 0 when none */
+		#endif /* ipconfigUSE_RX_TIMESTAMPS */
 
 		TCPWindow_t xTCPWindow;
 	} IPTCPSocket_t;
@@ -635,12 +646,16 @@ typedef struct XSOCKET
 	EventGroupHandle_t xEventGroup;
 
 	ListItem_t xBoundSocketListItem; /* Used to reference the socket from a bound sockets list. */
+	struct XSOCKET *pxPortHashNext; /* Next socket in the same bucket of a port hash table. */
 	TickType_t xReceiveBlockTime; /* if recv[to] is called while no data is available, wait this amount of time. Unit in clock-ticks */
 	TickType_t xSendBlockTime; /* if send[to] is called while there is not enough space to send, wait this amount of time. Unit in clock-ticks */
 
 	uint16_t usLocalPort;		/* Local port on this machine */
 	uint8_t ucSocketOptions;
 	uint8_t ucProtocol; /* choice of FREERTOS_IPPROTO_UDP/TCP */
+	#if( ipconfigUSE_TX_PRIORITY != 0 )
+		uint8_t ucTxPriority;	/* FREERTOS_SO_TX_PRIORITY, copied into every network buffer sent by this socket */
+	#endif /* ipconfigUSE_TX_PRIORITY */
 	#if( ipconfigSOCKET_HAS_USER_SEMAPHORE == 1 )
 		SemaphoreHandle_t pxUserSemaphore;
 	#endif /* ipconfigSOCKET_HAS_USER_SEMAPHORE */
@@ -682,6 +697,15 @@ typedef struct XSOCKET
  */
 FreeRTOS_Socket_t *pxUDPSocketLookup( UBaseType_t uxLocalPort );
 
+#if( ipconfigUSE_TCP == 1 )
+	/*
+	 * Move a bound TCP socket to the hash bucket of its current local port,
+	 * remote IP address and remote port.  Called by the IP-task after the
+	 * remote address was set.
+	 */
+	void vSocketTCPRehash( FreeRTOS_Socket_t *pxSocket );
+#endif /* ipconfigUSE_TCP */
+
 /*
  * Called when the application has generated a UDP packet to send.
  */
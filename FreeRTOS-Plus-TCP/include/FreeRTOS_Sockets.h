@@ -158,6 +158,10 @@ FreeRTOS_setsockopt(). */
 	#define FREERTOS_SO_UDP_MAX_RX_PACKETS	( 16 )		/* This option helps to limit the maximum number of packets a UDP socket will buffer */
 #endif
 
+#if( ipconfigUSE_TX_PRIORITY != 0 )
+	#define FREERTOS_SO_TX_PRIORITY		( 17 )		/* Transmit priority class of the packets sent by this socket: ipTX_PRIORITY_NORMAL or ipTX_PRIORITY_HIGH */
+#endif
+
 #define FREERTOS_NOT_LAST_IN_FRAGMENTED_PACKET 	( 0x80 )  /* For internal use only, but also part of an 8-bit bitwise value. */
 #define FREERTOS_FRAGMENTED_PACKET				( 0x40 )  /* For internal use only, but also part of an 8-bit bitwise value. */
 
@@ -200,6 +204,18 @@ struct freertos_sockaddr
 	uint32_t sin_addr;
 };
 
+/* One datagram of FreeRTOS_recvmulti() or FreeRTOS_sendmulti().  pvPayload
+is a zero-copy buffer: it is returned by FreeRTOS_recvmulti() and must be
+released with FreeRTOS_ReleaseUDPPayloadBuffer().  For FreeRTOS_sendmulti() it
+is obtained with FreeRTOS_GetUDPPayloadBuffer(), and it belongs to the stack
+once it has been sent. */
+struct freertos_mmsg
+{
+	void *pvPayload;
+	size_t xLength;
+	struct freertos_sockaddr xAddress;	/* Source or destination. */
+};
+
 #if ipconfigBYTE_ORDER == pdFREERTOS_LITTLE_ENDIAN
 
 	#define FreeRTOS_inet_addr_quick( ucOctet0, ucOctet1, ucOctet2, ucOctet3 )				\
@@ -249,6 +265,14 @@ int32_t FreeRTOS_recvfrom( Socket_t xSocket, void *pvBuffer, size_t xBufferLengt
 int32_t FreeRTOS_sendto( Socket_t xSocket, const void *pvBuffer, size_t xTotalDataLength, BaseType_t xFlags, const struct freertos_sockaddr *pxDestinationAddress, socklen_t xDestinationAddressLength );
 BaseType_t FreeRTOS_bind( Socket_t xSocket, struct freertos_sockaddr *pxAddress, socklen_t xAddressLength );
 
+/* Receive or send up to uxCount UDP datagrams in one call, with less overhead
+per datagram than FreeRTOS_recvfrom() and FreeRTOS_sendto().  recvmulti() only
+blocks until the first datagram has arrived, and returns the number of messages
+filled in.  sendmulti() returns the number of datagrams that were passed to the
+IP-task; the remaining payload buffers still belong to the caller. */
+int32_t FreeRTOS_recvmulti( Socket_t xSocket, struct freertos_mmsg *pxMessages, size_t uxCount, BaseType_t xFlags );
+int32_t FreeRTOS_sendmulti( Socket_t xSocket, const struct freertos_mmsg *pxMessages, size_t uxCount, BaseType_t xFlags );
+
 /* function to get the local address and IP port */
 size_t FreeRTOS_GetLocalAddress( Socket_t xSocket, struct freertos_sockaddr *pxAddress );
 
@@ -297,6 +321,10 @@ BaseType_t FreeRTOS_rx_size( Socket_t xSocket );
 BaseType_t FreeRTOS_tx_space( Socket_t xSocket );
 BaseType_t FreeRTOS_tx_size( Socket_t xSocket );
 
+/* Returns the number of segments that were retransmitted on this connection,
+after a time-out or a fast retransmit. */
+BaseType_t FreeRTOS_retransmits( Socket_t xSocket );
+
 /* Returns the number of outstanding bytes in txStream. */
 /* The function FreeRTOS_outstanding() was already implemented
 FreeRTOS_tx_size(). */
@@ -314,6 +342,14 @@ FreeRTOS_rx_size(). */
  */
 uint8_t *FreeRTOS_get_tx_head( Socket_t xSocket, BaseType_t *pxLength );
 
+/*
+ * For advanced applications only:
+ * The same, for the space that starts 'uxOffset' bytes after the head.  Data
+ * written to the transmit buffer directly is added (committed) by calling
+ * FreeRTOS_send() with a NULL buffer pointer, which only moves the head.
+ */
+uint8_t *FreeRTOS_get_tx_head_offset( Socket_t xSocket, size_t uxOffset, BaseType_t *pxLength );
+
 #endif /* ipconfigUSE_TCP */
 
 /*
@@ -258,6 +258,38 @@ size_t uxSize = uxStreamBufferGetSize( pxBuffer );
 
 	return FreeRTOS_min_uint32( uxSize, pxBuffer->LENGTH - uxNextTail );
 }
+/*-----------------------------------------------------------*/
+
+/*
+ * Peek at the free space of a stream buffer, uxOffset bytes past uxHead.
+ * Returns the number of bytes that can be written at '*ppucData' before the
+ * buffer wraps.  Once written, the data is added by calling uxStreamBufferAdd()
+ * with 'pucData' equal to NULL, which only advances uxHead.
+ */
+static portINLINE size_t uxStreamBufferGetHeadPtr( StreamBuffer_t *pxBuffer, size_t uxOffset, uint8_t **ppucData );
+static portINLINE size_t uxStreamBufferGetHeadPtr( StreamBuffer_t *pxBuffer, size_t uxOffset, uint8_t **ppucData )
+{
+size_t uxNextHead = pxBuffer->uxHead + uxOffset;
+size_t uxSpace = uxStreamBufferGetSpace( pxBuffer );
+
+	if( uxNextHead >= pxBuffer->LENGTH )
+	{
+		uxNextHead -= pxBuffer->LENGTH;
+	}
+
+	*ppucData = pxBuffer->ucArray + uxNextHead;
+
+	if( uxSpace > uxOffset )
+	{
+		uxSpace -= uxOffset;
+	}
+	else
+	{
+		uxSpace = 0u;
+	}
+
+	return FreeRTOS_min_uint32( uxSpace, pxBuffer->LENGTH - uxNextHead );
+}
 
 /*
  * Add bytes to a stream buffer.
@@ -222,4 +222,20 @@ http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_TCP/TCP_IP_Trace.html */
 	#define iptraceSENDTO_DATA_TOO_LONG()
 #endif
 
+#ifndef iptracePROCESSING_RECEIVED_PACKET
+	#define iptracePROCESSING_RECEIVED_PACKET( pxNetworkBuffer )
+#endif
+
+#ifndef iptraceRECVFROM_PACKET
+	#define iptraceRECVFROM_PACKET( pxNetworkBuffer )
+#endif
+
+#ifndef iptraceTCP_RX_DATA_STORED
+	#define iptraceTCP_RX_DATA_STORED( pxSocket, pxNetworkBuffer )
+#endif
+
+#ifndef iptraceRECV_DATA
+	#define iptraceRECV_DATA( pxSocket )
+#endif
+
 #endif /* UDP_TRACE_MACRO_DEFAULTS_H */
@@ -77,6 +77,24 @@ UBaseType_t uxGetNumberOfFreeNetworkBuffers( void );
 /* Get the lowest number of free network buffers. */
 UBaseType_t uxGetMinimumFreeNetworkBuffers( void );
 
+/* The size classes of the network buffers. */
+#define ipNETWORK_BUFFER_CLASS_MTU		0
+#define ipNETWORK_BUFFER_CLASS_SMALL	1
+#define ipNETWORK_BUFFER_CLASS_COUNT	2
+
+typedef struct xNETWORK_BUFFER_CLASS_STATS
+{
+	size_t uxBufferSize;		/* The largest frame a buffer of this class can hold. */
+	UBaseType_t uxCount;		/* The number of buffers in this class. */
+	UBaseType_t uxFree;			/* The number of free buffers. */
+	UBaseType_t uxMinimumFree;	/* The lowest number of free buffers seen. */
+	uint32_t ulFallbacks;		/* Requests that had to be served by the MTU class. */
+	uint32_t ulFailures;		/* Requests that found no free buffer. */
+} NetworkBufferClassStats_t;
+
+/* Get the statistics of one size class.  Returns pdFAIL for an unknown class. */
+BaseType_t xGetNetworkBufferClassStats( BaseType_t xClass, NetworkBufferClassStats_t *pxStats );
+
 /* Copy a network buffer into a bigger buffer. */
 NetworkBufferDescriptor_t *pxDuplicateNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer,
 	BaseType_t xNewLength);
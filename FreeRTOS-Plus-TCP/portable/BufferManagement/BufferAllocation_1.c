@@ -313,6 +313,18 @@ UBaseType_t uxCount;
 				}
 				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
 
+				#if( ipconfigUSE_TX_PRIORITY != 0 )
+				{
+					pxReturn->ucTxPriority = ( uint8_t ) ipTX_PRIORITY_NORMAL;
+				}
+				#endif /* ipconfigUSE_TX_PRIORITY */
+
+				#if( ipconfigUSE_RX_TIMESTAMPS != 0 )
+				{
+					pxReturn->ulRxTimestamp = 0ul;
+				}
+				#endif /* ipconfigUSE_RX_TIMESTAMPS */
+
 				if( xTCPWindowLoggingLevel > 3 )
 				{
 					FreeRTOS_debug_printf( ( "BUF_GET[%ld]: %p (%p)\n",
@@ -305,6 +305,18 @@ size_t uxCount;
 					pxReturn->pxNextBuffer = NULL;
 				}
 				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+				#if( ipconfigUSE_TX_PRIORITY != 0 )
+				{
+					pxReturn->ucTxPriority = ( uint8_t ) ipTX_PRIORITY_NORMAL;
+				}
+				#endif /* ipconfigUSE_TX_PRIORITY */
+
+				#if( ipconfigUSE_RX_TIMESTAMPS != 0 )
+				{
+					pxReturn->ulRxTimestamp = 0ul;
+				}
+				#endif /* ipconfigUSE_RX_TIMESTAMPS */
 			}
 		}
 		else
@@ -82,29 +82,61 @@
 be at least this number of buffers available. */
 #define ipINTERRUPT_BUFFER_GET_THRESHOLD	( 3 )
 
-/* A list of free (available) xNetworkBufferDescriptor_t structures. */
-static List_t xFreeBuffersList;
+/* The EMAC receives straight into the buffers (zero-copy RX), so every buffer occupies whole data cache lines
+that are never shared with a neighbour. */
+#define ipBUFFER_CACHE_LINE_SIZE	( 32u )
+#define ipBUFFER_ROUND_UP( x )		( ( ( x ) + ipBUFFER_CACHE_LINE_SIZE - 1u ) & ~( ipBUFFER_CACHE_LINE_SIZE - 1u ) )
+
+/* The buffers come in two size classes.  The MTU class holds a complete frame including the CRC and a VLAN tag,
+it is used for reception and for everything that does not fit in a small buffer.  The small class serves ARP
+packets, pure TCP acknowledgements and short UDP messages, so these do not tie up a full-sized buffer. */
+#define ipBUFFER_UNIT_SIZE			ipBUFFER_ROUND_UP( ipTOTAL_ETHERNET_FRAME_SIZE + ipBUFFER_PADDING )
+#define ipSMALL_BUFFER_UNIT_SIZE	ipBUFFER_ROUND_UP( ipconfigSMALL_NETWORK_BUFFER_SIZE + ipBUFFER_PADDING )
+
+#define ipTOTAL_NETWORK_BUFFERS		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + ipconfigNUM_SMALL_NETWORK_BUFFERS )
+
+#if( ipconfigNUM_SMALL_NETWORK_BUFFERS > 0 ) && ( ipconfigSMALL_NETWORK_BUFFER_SIZE < 64 )
+	/* The driver pads short frames to 60 bytes in place, and an ARP packet must fit too. */
+	#error ipconfigSMALL_NETWORK_BUFFER_SIZE must be at least 64
+#endif
+
+/* The free buffers of one size class. */
+typedef struct xNETWORK_BUFFER_POOL
+{
+	List_t xFreeList;						/* The free descriptors of this class. */
+	UBaseType_t uxMinimumFree;				/* The lowest number of free buffers seen (low-water mark). */
+	uint32_t ulFallbacks;					/* Small requests served by the MTU class. */
+	uint32_t ulFailures;					/* Requests that could not be served. */
+} NetworkBufferPool_t;
 
-/* Some statistics about the use of buffers. */
-static size_t uxMinimumFreeNetworkBuffers;
+static NetworkBufferPool_t xBufferPools[ ipNETWORK_BUFFER_CLASS_COUNT ];
 
 /* Declares the pool of xNetworkBufferDescriptor_t structures that are available to the
-system.  All the network buffers referenced from xFreeBuffersList exist in this
-array.  The array is not accessed directly except during initialisation, when
-the xFreeBuffersList is filled (as all the buffers are free when the system is
-booted). */
-static xNetworkBufferDescriptor_t xNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+system.  The MTU class owns the first ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS descriptors,
+the small class the remaining ones.  All the network buffers referenced from the free
+lists exist in this array.  The array is not accessed directly except during
+initialisation, when the free lists are filled (as all the buffers are free when the
+system is booted). */
+static xNetworkBufferDescriptor_t xNetworkBuffers[ ipTOTAL_NETWORK_BUFFERS ];
 
 //static uint8_t ucBuffers[ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS][UNIT_SIZE] __attribute__((aligned(8))) __attribute__ ((section(".sdram")));
-static uint8_t ucBuffers[ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS][MAX_TRANSFER_UNIT + ipBUFFER_PADDING] __attribute__((aligned(8)));
+static uint8_t ucBuffers[ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS][ipBUFFER_UNIT_SIZE] __attribute__((aligned(32)));
+
+#if( ipconfigNUM_SMALL_NETWORK_BUFFERS > 0 )
+	static uint8_t ucSmallBuffers[ipconfigNUM_SMALL_NETWORK_BUFFERS][ipSMALL_BUFFER_UNIT_SIZE] __attribute__((aligned(32)));
+#endif
 
 /* This constant is defined as true to let FreeRTOS_TCP_IP.c know that the network buffers
 have constant size, large enough to hold the biggest ethernet packet. No resizing will
-be done. */
+be done.  This still holds: a small buffer is only handed out when the requested size
+fits in it, and the TCP code always asks for a complete frame. */
 const BaseType_t xBufferAllocFixedSize = pdTRUE;
 
-/* The semaphore used to obtain network buffers. */
+/* Getting and releasing a buffer only takes a short critical section.  Tasks that
+want to wait for a buffer sleep on this semaphore, which is only given when there
+are waiters. */
 static SemaphoreHandle_t xNetworkBufferSemaphore = NULL;
+static volatile UBaseType_t uxBufferWaiters = 0u;
 
 #if !defined( ipconfigBUFFER_ALLOC_LOCK )
 	#define ipconfigBUFFER_ALLOC_INIT( ) do {} while (0)
@@ -132,6 +164,22 @@ static SemaphoreHandle_t xNetworkBufferSemaphore = NULL;
 
 #endif
 
+/*
+ * The size class of a descriptor, found from its position in xNetworkBuffers[].
+ */
+static BaseType_t prvBufferClass( const xNetworkBufferDescriptor_t *pxDescriptor );
+
+/*
+ * The first size class which can hold xRequestedSizeBytes.
+ */
+static BaseType_t prvRequestedClass( size_t xRequestedSizeBytes );
+
+/*
+ * Take a descriptor from the pool of xClass, or from the MTU pool when the small
+ * one is empty.  Must be called with the pools locked.  O(1).
+ */
+static xNetworkBufferDescriptor_t *prvTakeBuffer( BaseType_t xClass, UBaseType_t uxReserve );
+
 #if ipconfigTCP_IP_SANITY
 
 /* HT: SANITY code will be removed as soon as the library is stable
@@ -148,7 +196,7 @@ static char cIsLow = pdFALSE;
 BaseType_t prvIsFreeBuffer( const xNetworkBufferDescriptor_t *pxDescr )
 {
 	return ( bIsValidNetworkDescriptor( pxDescr ) != 0 ) &&
-		( listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxDescr->xBufferListItem ) ) != 0 );
+		( listIS_CONTAINED_WITHIN( &( xBufferPools[ prvBufferClass( pxDescr ) ].xFreeList ), &( pxDescr->xBufferListItem ) ) != 0 );
 }
 /*-----------------------------------------------------------*/
 
@@ -193,6 +241,66 @@ static void showWarnings( void )
 
 #endif /* ipconfigTCP_IP_SANITY */
 
+static BaseType_t prvBufferClass( const xNetworkBufferDescriptor_t *pxDescriptor )
+{
+	return ( ( pxDescriptor - xNetworkBuffers ) < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ) ?
+		ipNETWORK_BUFFER_CLASS_MTU : ipNETWORK_BUFFER_CLASS_SMALL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRequestedClass( size_t xRequestedSizeBytes )
+{
+	#if( ipconfigNUM_SMALL_NETWORK_BUFFERS > 0 )
+	{
+		if( xRequestedSizeBytes <= ( size_t ) ipconfigSMALL_NETWORK_BUFFER_SIZE )
+		{
+			return ipNETWORK_BUFFER_CLASS_SMALL;
+		}
+	}
+	#else
+	{
+		( void ) xRequestedSizeBytes;
+	}
+	#endif
+
+	return ipNETWORK_BUFFER_CLASS_MTU;
+}
+/*-----------------------------------------------------------*/
+
+static xNetworkBufferDescriptor_t *prvTakeBuffer( BaseType_t xClass, UBaseType_t uxReserve )
+{
+xNetworkBufferDescriptor_t *pxReturn = NULL;
+NetworkBufferPool_t *pxPool = &( xBufferPools[ xClass ] );
+UBaseType_t uxCount;
+
+	if( ( xClass == ipNETWORK_BUFFER_CLASS_SMALL ) && ( listCURRENT_LIST_LENGTH( &( pxPool->xFreeList ) ) <= uxReserve ) )
+	{
+		/* The small buffers are all in use, a full-sized one will do. */
+		pxPool->ulFallbacks++;
+		pxPool = &( xBufferPools[ ipNETWORK_BUFFER_CLASS_MTU ] );
+	}
+
+	uxCount = listCURRENT_LIST_LENGTH( &( pxPool->xFreeList ) );
+	if( uxCount > uxReserve )
+	{
+		pxReturn = ( xNetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxPool->xFreeList ) );
+		uxListRemove( &( pxReturn->xBufferListItem ) );
+
+		uxCount--;
+		if( pxPool->uxMinimumFree > uxCount )
+		{
+			pxPool->uxMinimumFree = uxCount;
+		}
+	}
+	else
+	{
+		pxPool->ulFailures++;
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t xNetworkBuffersInitialise( void )
 {
 BaseType_t xReturn, x;
@@ -203,33 +311,45 @@ BaseType_t xReturn, x;
 	{
 		/* In case alternative locking is used, the mutexes can be initialised here */
 		ipconfigBUFFER_ALLOC_INIT( );
-/*
- * HT: The use of counting semaphores is perfect, good invention
- * It is just that I didn't find the time yet to adopt the newer FreeRTOS kernel
- * which supports it. I tried it and it crashed. Must dive into it some day
- */
-		xNetworkBufferSemaphore = xSemaphoreCreateCounting( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS, ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS );
+
+		/* Counts the wake-ups of waiting tasks, it is never given more often than
+		there are buffers. */
+		xNetworkBufferSemaphore = xSemaphoreCreateCounting( ipTOTAL_NETWORK_BUFFERS, 0 );
 		configASSERT( xNetworkBufferSemaphore );
 
 		if( xNetworkBufferSemaphore != NULL )
 		{
-			vListInitialise( &xFreeBuffersList );
+			for( x = 0; x < ipNETWORK_BUFFER_CLASS_COUNT; x++ )
+			{
+				vListInitialise( &( xBufferPools[ x ].xFreeList ) );
+			}
 
 			/* Initialise all the network buffers.  The buffer storage comes
 			from the network interface, and different hardware has different
 			requirements. */
 			vNetworkInterfaceAllocateRAMToBuffers( xNetworkBuffers );
-			for( x = 0; x < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS; x++ )
+			#if( ipconfigNUM_SMALL_NETWORK_BUFFERS > 0 )
+			{
+				for( x = 0; x < ipconfigNUM_SMALL_NETWORK_BUFFERS; x++ )
+				{
+					xNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + x ].pucEthernetBuffer = &( ucSmallBuffers[ x ][ ipBUFFER_PADDING ] );
+					*( ( unsigned int * ) ( ( void * ) &ucSmallBuffers[ x ][ 0 ] ) ) = ( unsigned ) ( &xNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + x ] );
+				}
+			}
+			#endif
+
+			for( x = 0; x < ipTOTAL_NETWORK_BUFFERS; x++ )
 			{
 				/* Initialise and set the owner of the buffer list items. */
 				vListInitialiseItem( &( xNetworkBuffers[ x ].xBufferListItem ) );
 				listSET_LIST_ITEM_OWNER( &( xNetworkBuffers[ x ].xBufferListItem ), &xNetworkBuffers[ x ] );
 
 				/* Currently, all buffers are available for use. */
-				vListInsert( &xFreeBuffersList, &( xNetworkBuffers[ x ].xBufferListItem ) );
+				vListInsertEnd( &( xBufferPools[ prvBufferClass( &xNetworkBuffers[ x ] ) ].xFreeList ), &( xNetworkBuffers[ x ].xBufferListItem ) );
 			}
-			
-			uxMinimumFreeNetworkBuffers = ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
+
+			xBufferPools[ ipNETWORK_BUFFER_CLASS_MTU ].uxMinimumFree = ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
+			xBufferPools[ ipNETWORK_BUFFER_CLASS_SMALL ].uxMinimumFree = ipconfigNUM_SMALL_NETWORK_BUFFERS;
 		}
 	}
 
@@ -250,71 +370,90 @@ BaseType_t xReturn, x;
 xNetworkBufferDescriptor_t *pxGetNetworkBufferWithDescriptor( size_t xRequestedSizeBytes, TickType_t xBlockTimeTicks )
 {
 xNetworkBufferDescriptor_t *pxReturn = NULL;
-BaseType_t xInvalid = pdFALSE;
-size_t uxCount;
+BaseType_t xClass = prvRequestedClass( xRequestedSizeBytes );
+BaseType_t xWaiting = pdFALSE;
+TimeOut_t xTimeOut;
 
-	/* The current implementation only has a single size memory block, so
-	the requested size parameter is not used (yet). */
-	( void ) xRequestedSizeBytes;
 	if( xNetworkBufferSemaphore != NULL )
 	{
-		/* If there is a semaphore available, there is a network buffer available. */
-		if( xSemaphoreTake( xNetworkBufferSemaphore, xBlockTimeTicks ) == pdPASS )
+		vTaskSetTimeOutState( &xTimeOut );
+
+		for( ;; )
 		{
 			/* Protect the structure as it is accessed from tasks and interrupts. */
 			ipconfigBUFFER_ALLOC_LOCK();
 			{
-				pxReturn = ( xNetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xFreeBuffersList );
-				if( bIsValidNetworkDescriptor(pxReturn) &&
-					listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxReturn->xBufferListItem ) ) )
+				if( xWaiting != pdFALSE )
 				{
-					uxListRemove( &( pxReturn->xBufferListItem ) );
+					uxBufferWaiters--;
+					xWaiting = pdFALSE;
 				}
-				else
+
+				pxReturn = prvTakeBuffer( xClass, 0u );
+
+				if( ( pxReturn == NULL ) && ( xBlockTimeTicks > ( TickType_t ) 0 ) )
 				{
-					xInvalid = pdTRUE;
+					/* Register as a waiter while the lock is still held, so that a
+					buffer released from now on will wake this task up. */
+					uxBufferWaiters++;
+					xWaiting = pdTRUE;
 				}
 			}
 			ipconfigBUFFER_ALLOC_UNLOCK();
 
-			if( xInvalid )
+			if( ( xWaiting == pdFALSE ) || ( xTaskCheckForTimeOut( &xTimeOut, &xBlockTimeTicks ) != pdFALSE ) )
+			{
+				break;
+			}
+
+			/* A wake-up may be for a buffer of the other class, or another task may
+			have been quicker: try again until the time is up. */
+			( void ) xSemaphoreTake( xNetworkBufferSemaphore, xBlockTimeTicks );
+		}
+
+		if( xWaiting != pdFALSE )
+		{
+			ipconfigBUFFER_ALLOC_LOCK();
+			{
+				uxBufferWaiters--;
+			}
+			ipconfigBUFFER_ALLOC_UNLOCK();
+		}
+
+		if( pxReturn != NULL )
+		{
+			pxReturn->xDataLength = xRequestedSizeBytes;
+
+			#if( ipconfigTCP_IP_SANITY != 0 )
 			{
-				FreeRTOS_debug_printf( ( "pxGetNetworkBufferWithDescriptor: INVALID BUFFER: %p (valid %lu)\r\n",
-					pxReturn, bIsValidNetworkDescriptor( pxReturn ) ) );
-				pxReturn = NULL;
+				showWarnings();
 			}
-			else
+			#endif /* ipconfigTCP_IP_SANITY */
+
+			#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
 			{
-				{
-					/* Reading UBaseType_t, no critical section needed. */
-					uxCount = listCURRENT_LIST_LENGTH( &xFreeBuffersList );
-		
-					if( uxMinimumFreeNetworkBuffers > uxCount )
-					{
-						uxMinimumFreeNetworkBuffers = uxCount;
-					}		
-				}
-				pxReturn->xDataLength = xRequestedSizeBytes;
+				/* make sure the buffer is not linked */
+				pxReturn->pxNextBuffer = NULL;
+			}
+			#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
 
-				#if( ipconfigTCP_IP_SANITY != 0 )
-				{
-					showWarnings();
-				}
-				#endif /* ipconfigTCP_IP_SANITY */
+			#if( ipconfigUSE_TX_PRIORITY != 0 )
+			{
+				pxReturn->ucTxPriority = ( uint8_t ) ipTX_PRIORITY_NORMAL;
+			}
+			#endif /* ipconfigUSE_TX_PRIORITY */
 
-				#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
-				{
-					/* make sure the buffer is not linked */
-					pxReturn->pxNextBuffer = NULL;
-				}
-				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+			#if( ipconfigUSE_RX_TIMESTAMPS != 0 )
+			{
+				pxReturn->ulRxTimestamp = 0ul;
+			}
+			#endif /* ipconfigUSE_RX_TIMESTAMPS */
 
-				if( xTCPWindowLoggingLevel > 3 )
-				{
-					FreeRTOS_debug_printf( ( "BUF_GET[%ld]: %p (%p)\r\n",
-						bIsValidNetworkDescriptor( pxReturn ),
-						pxReturn, pxReturn->pucEthernetBuffer ) );
-				}
+			if( xTCPWindowLoggingLevel > 3 )
+			{
+				FreeRTOS_debug_printf( ( "BUF_GET[%ld]: %p (%p)\r\n",
+					bIsValidNetworkDescriptor( pxReturn ),
+					pxReturn, pxReturn->pucEthernetBuffer ) );
 			}
 			iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
 		}
@@ -331,33 +470,24 @@ size_t uxCount;
 xNetworkBufferDescriptor_t *pxNetworkBufferGetFromISR( size_t xRequestedSizeBytes )
 {
 xNetworkBufferDescriptor_t *pxReturn = NULL;
+BaseType_t xClass = prvRequestedClass( xRequestedSizeBytes );
 
-	/* The current implementation only has a single size memory block, so
-	the requested size parameter is not used (yet). */
-	( void ) xRequestedSizeBytes;
-
-	/* If there is a semaphore available then there is a buffer available, but,
-	as this is called from an interrupt, only take a buffer if there are at
+	/* As this is called from an interrupt, only take a buffer if there are at
 	least ipINTERRUPT_BUFFER_GET_THRESHOLD buffers remaining.  This prevents,
 	to a certain degree at least, a rapidly executing interrupt exhausting
 	buffer and in so doing preventing tasks from continuing. */
-	if( uxQueueMessagesWaitingFromISR( ( QueueHandle_t ) xNetworkBufferSemaphore ) > ipINTERRUPT_BUFFER_GET_THRESHOLD )
+	ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
 	{
-		if( xSemaphoreTakeFromISR( xNetworkBufferSemaphore, NULL ) == pdPASS )
-		{
-			/* Protect the structure as it is accessed from tasks and interrupts. */
-			ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
-			{
-				pxReturn = ( xNetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xFreeBuffersList );
-				uxListRemove( &( pxReturn->xBufferListItem ) );
-			}
-			ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
-
-			iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
-		}
+		pxReturn = prvTakeBuffer( xClass, ipINTERRUPT_BUFFER_GET_THRESHOLD );
 	}
+	ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
 
-	if( pxReturn == NULL )
+	if( pxReturn != NULL )
+	{
+		pxReturn->xDataLength = xRequestedSizeBytes;
+		iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
+	}
+	else
 	{
 		iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR();
 	}
@@ -369,16 +499,21 @@ xNetworkBufferDescriptor_t *pxReturn = NULL;
 BaseType_t vNetworkBufferReleaseFromISR( xNetworkBufferDescriptor_t * const pxNetworkBuffer )
 {
 BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+BaseType_t xWakeUp;
 
-	/* Ensure the buffer is returned to the list of free buffers before the
-	counting semaphore is 'given' to say a buffer is available. */
+	/* Ensure the buffer is returned to the list of free buffers before a
+	waiting task is woken up. */
 	ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
 	{
-		vListInsertEnd( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+		vListInsertEnd( &( xBufferPools[ prvBufferClass( pxNetworkBuffer ) ].xFreeList ), &( pxNetworkBuffer->xBufferListItem ) );
+		xWakeUp = ( uxBufferWaiters != 0u );
 	}
 	ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
 
-	xSemaphoreGiveFromISR( xNetworkBufferSemaphore, &xHigherPriorityTaskWoken );
+	if( xWakeUp != pdFALSE )
+	{
+		xSemaphoreGiveFromISR( xNetworkBufferSemaphore, &xHigherPriorityTaskWoken );
+	}
 	iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
 
 	return xHigherPriorityTaskWoken;
@@ -388,6 +523,8 @@ BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 void vReleaseNetworkBufferAndDescriptor( xNetworkBufferDescriptor_t * const pxNetworkBuffer )
 {
 BaseType_t xListItemAlreadyInFreeList;
+BaseType_t xWakeUp = pdFALSE;
+List_t *pxFreeList;
 
 #if( ipconfigIP_TASK_KEEPS_MESSAGE_BUFFER != 0 )
 	if( pxNetworkBuffer == pxIpTaskMessageBuffer )
@@ -399,16 +536,19 @@ BaseType_t xListItemAlreadyInFreeList;
 		FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: Invalid buffer %p\r\n", pxNetworkBuffer ) );
 		return ;
 	}
-	/* Ensure the buffer is returned to the list of free buffers before the
-	counting semaphore is 'given' to say a buffer is available. */
+	pxFreeList = &( xBufferPools[ prvBufferClass( pxNetworkBuffer ) ].xFreeList );
+
+	/* Ensure the buffer is returned to the list of free buffers before a
+	waiting task is woken up. */
 	ipconfigBUFFER_ALLOC_LOCK();
 	{
 		{
-			xListItemAlreadyInFreeList = listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+			xListItemAlreadyInFreeList = listIS_CONTAINED_WITHIN( pxFreeList, &( pxNetworkBuffer->xBufferListItem ) );
 
 			if( xListItemAlreadyInFreeList == pdFALSE )
 			{
-				vListInsertEnd( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+				vListInsertEnd( pxFreeList, &( pxNetworkBuffer->xBufferListItem ) );
+				xWakeUp = ( uxBufferWaiters != 0u );
 			}
 		}
 	}
@@ -421,7 +561,10 @@ BaseType_t xListItemAlreadyInFreeList;
 	}
 	if( !xListItemAlreadyInFreeList )
 	{
-		xSemaphoreGive( xNetworkBufferSemaphore );
+		if( xWakeUp != pdFALSE )
+		{
+			xSemaphoreGive( xNetworkBufferSemaphore );
+		}
 		showWarnings();
 		if( xTCPWindowLoggingLevel > 3 )
 			FreeRTOS_debug_printf( ( "BUF_PUT[%ld]: %p (%p) (now %lu)\r\n",
@@ -433,17 +576,51 @@ BaseType_t xListItemAlreadyInFreeList;
 }
 /*-----------------------------------------------------------*/
 
+/* The two functions below report the MTU class: those are the buffers that the
+driver needs for reception. */
 UBaseType_t uxGetMinimumFreeNetworkBuffers( void )
 {
-	return uxMinimumFreeNetworkBuffers;
+	return xBufferPools[ ipNETWORK_BUFFER_CLASS_MTU ].uxMinimumFree;
 }
 /*-----------------------------------------------------------*/
 
 UBaseType_t uxGetNumberOfFreeNetworkBuffers( void )
 {
-	return listCURRENT_LIST_LENGTH( &xFreeBuffersList );
+	return listCURRENT_LIST_LENGTH( &( xBufferPools[ ipNETWORK_BUFFER_CLASS_MTU ].xFreeList ) );
 }
+/*-----------------------------------------------------------*/
+
+BaseType_t xGetNetworkBufferClassStats( BaseType_t xClass, NetworkBufferClassStats_t *pxStats )
+{
+BaseType_t xReturn = pdFAIL;
 
+	if( ( xClass >= 0 ) && ( xClass < ipNETWORK_BUFFER_CLASS_COUNT ) )
+	{
+		if( xClass == ipNETWORK_BUFFER_CLASS_MTU )
+		{
+			pxStats->uxBufferSize = ipTOTAL_ETHERNET_FRAME_SIZE;
+			pxStats->uxCount = ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
+		}
+		else
+		{
+			pxStats->uxBufferSize = ipconfigSMALL_NETWORK_BUFFER_SIZE;
+			pxStats->uxCount = ipconfigNUM_SMALL_NETWORK_BUFFERS;
+		}
+
+		ipconfigBUFFER_ALLOC_LOCK();
+		{
+			pxStats->uxFree = listCURRENT_LIST_LENGTH( &( xBufferPools[ xClass ].xFreeList ) );
+			pxStats->uxMinimumFree = xBufferPools[ xClass ].uxMinimumFree;
+			pxStats->ulFallbacks = xBufferPools[ xClass ].ulFallbacks;
+			pxStats->ulFailures = xBufferPools[ xClass ].ulFailures;
+		}
+		ipconfigBUFFER_ALLOC_UNLOCK();
+
+		xReturn = pdPASS;
+	}
+
+	return xReturn;
+}
 /*-----------------------------------------------------------*/
 
 void vNetworkInterfaceAllocateRAMToBuffers(xNetworkBufferDescriptor_t pxNetworkBuffers[ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS])
@@ -50,14 +50,25 @@
 #include "HL_emac.h"
 #include "HL_mdio.h"
 #include "HL_phy_dp83640.h"
+#include "ptp_clock.h"
 #include "HL_sys_vim.h"
 #include "HL_gio.h"
 #include "HL_reg_het.h"
+#include "HL_system.h"
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_IP_Private.h"
 #include "NetworkBufferManagement.h"
+#if(ipconfigUSE_PCAP != 0)
+#include "pcap_capture.h"
+#endif
+#if(ipconfigUSE_EMAC_STATS != 0)
+#include "emac_stats.h"
+#endif
+#if(ipconfigUSE_RX_TIMESTAMPS != 0)
+#include "rti_runtimestats.h"
+#endif
 
 /* HALCoGen generated source. */
 #include "HL_emac.c"
@@ -97,10 +108,122 @@
 /* Number of TX and RX DMA buffers */
 /* Tx s RX EMAC DMA pufferek szma */
 #define EMAC_TXDMA_PBUF_START_ADDRESS	(EMAC_CTRL_RAM_BASE)
-//#define EMAC_TXDMA_PBUF_ALLOC 			((SIZE_EMAC_CTRL_RAM / 2) / sizeof(emac_tx_bd_t))
-#define EMAC_TXDMA_PBUF_ALLOC 			(3)
+/* The TX rings take the lower half of the CPPI RAM. xNetworkInterfaceOutput() only queues a frame, it never waits
+for a BD, so the rings should be deep enough to hold every frame the stack can have in flight. */
+/* A TX gyrk a CPPI RAM als felt hasznljk. Az xNetworkInterfaceOutput() csak sorba llt, BD-re sosem vr,
+ezrt a gyrk legyenek elg mlyek ahhoz, hogy a stack sszes ton lv csomagja elfrjen bennk. */
+#define EMAC_DMA_BD_SIZE				(16U)		/* sizeof(emac_tx_bd_t) s sizeof(emac_rx_bd_t), #if-ben is hasznlhat */
+#define EMAC_CACHE_LINE_SIZE			(32U)		/* Cortex-R5F L1 adat cache sor mrete */
+#define EMAC_TXDMA_BD_MAX				((SIZE_EMAC_CTRL_RAM / 2) / EMAC_DMA_BD_SIZE)
+#if(ipconfigUSE_TX_PRIORITY != 0)
+	#ifndef ipconfigETHERNET_DRIVER_TX_PRIORITY_BUFFERS
+		#define ipconfigETHERNET_DRIVER_TX_PRIORITY_BUFFERS	(8)
+	#endif
+	#define EMAC_TXDMA_HP_PBUF_ALLOC	(ipconfigETHERNET_DRIVER_TX_PRIORITY_BUFFERS)
+#else
+	#define EMAC_TXDMA_HP_PBUF_ALLOC	(0)
+#endif
+#ifndef ipconfigETHERNET_DRIVER_TX_BUFFERS
+	#define ipconfigETHERNET_DRIVER_TX_BUFFERS	(EMAC_TXDMA_BD_MAX - EMAC_TXDMA_HP_PBUF_ALLOC)
+#endif
+#if((ipconfigETHERNET_DRIVER_TX_BUFFERS + EMAC_TXDMA_HP_PBUF_ALLOC) > EMAC_TXDMA_BD_MAX)
+	#error The TX BDs do not fit into the lower half of the CPPI RAM
+#endif
+#define EMAC_TXDMA_PBUF_ALLOC 			(ipconfigETHERNET_DRIVER_TX_BUFFERS)
+#if(ipconfigUSE_TX_PRIORITY != 0)
+/* The BDs of the high priority TX channel follow the ones of the normal channel */
+/* A magas priorits TX csatorna BD-i a norml csatorna BD-i utn kvetkeznek */
+#define EMAC_TXDMA_HP_PBUF_START_ADDRESS	(EMAC_TXDMA_PBUF_START_ADDRESS + (EMAC_TXDMA_PBUF_ALLOC * sizeof(emac_tx_bd_t)))
+#endif
 #define EMAC_RXDMA_PBUF_START_ADDRESS	(EMAC_CTRL_RAM_BASE + (SIZE_EMAC_CTRL_RAM / 2))
-#define EMAC_RXDMA_PBUF_ALLOC			(MAX_RX_PBUF_ALLOC)				/* HALCoGen GUI rtk */
+/* The RX ring holds network buffers of the stack (zero-copy receive), so it takes them from ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS */
+/* Az RX gyr a stack hlzati puffereit tartja (zero-copy vtel), ezrt azok az ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS-bl fogynak */
+#ifndef ipconfigETHERNET_DRIVER_RX_BUFFERS
+	#define ipconfigETHERNET_DRIVER_RX_BUFFERS	(MAX_RX_PBUF_ALLOC)			/* HALCoGen GUI rtk */
+#endif
+#if(ipconfigETHERNET_DRIVER_RX_BUFFERS >= ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS)
+	#error ipconfigETHERNET_DRIVER_RX_BUFFERS must leave network buffers for the stack
+#endif
+#define EMAC_RXDMA_PBUF_ALLOC			(ipconfigETHERNET_DRIVER_RX_BUFFERS)
+
+/* Broadcast frames (ARP, DHCP, NetBIOS...) can be received on a channel of their own, with a ring, a network buffer
+reserve and an RX task priority of their own, so a broadcast storm cannot take the buffers of the unicast traffic.
+The CPGMAC classifies by destination address only (unicast address match, broadcast, multicast), so the time
+critical unicast frames (NTP, PTP) are told apart in software, see prvEmacRxIsTimeCritical(). */
+/* A broadcast csomagok (ARP, DHCP, NetBIOS...) sajt csatornra kerlhetnek, sajt gyrvel, hlzati puffer
+tartalkkal s RX taszk prioritssal, gy egy broadcast vihar nem veheti el a unicast forgalom puffereit.
+A CPGMAC csak a cl cm alapjn osztlyoz, ezrt az idkritikus unicast csomagokat (NTP, PTP) szoftver vlasztja kln. */
+#ifndef ipconfigETHERNET_DRIVER_RX_BROADCAST_BUFFERS
+	#define ipconfigETHERNET_DRIVER_RX_BROADCAST_BUFFERS	(0)			/* 0: a broadcast is a unicast csatornn rkezik */
+#endif
+#ifndef ipconfigETHERNET_DRIVER_RX_RESERVED_BUFFERS
+	#define ipconfigETHERNET_DRIVER_RX_RESERVED_BUFFERS		(0)
+#endif
+#if(ipconfigETHERNET_DRIVER_RX_BROADCAST_BUFFERS != 0)
+	#ifndef ipconfigETHERNET_DRIVER_RX_BROADCAST_CHANNEL
+		#define ipconfigETHERNET_DRIVER_RX_BROADCAST_CHANNEL	(1U)
+	#endif
+	#if(ipconfigETHERNET_DRIVER_RX_BROADCAST_CHANNEL == EMAC_CHANNELNUMBER) || (ipconfigETHERNET_DRIVER_RX_BROADCAST_CHANNEL > 7U)
+		#error ipconfigETHERNET_DRIVER_RX_BROADCAST_CHANNEL must differ from EMAC_CHANNELNUMBER and be at most 7
+	#endif
+	#ifndef ipconfigETHERNET_DRIVER_RX_BROADCAST_TASK_PRIORITY
+		#define ipconfigETHERNET_DRIVER_RX_BROADCAST_TASK_PRIORITY	(ipconfigETHERNET_DRIVER_RX_TASK_PRIORITY)
+	#endif
+	#ifndef ipconfigETHERNET_DRIVER_RX_BROADCAST_RESERVED_BUFFERS
+		#define ipconfigETHERNET_DRIVER_RX_BROADCAST_RESERVED_BUFFERS	(0)
+	#endif
+	#if((ipconfigETHERNET_DRIVER_RX_BUFFERS + ipconfigETHERNET_DRIVER_RX_BROADCAST_BUFFERS) >= ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS)
+		#error The RX rings must leave network buffers for the stack
+	#endif
+	#if((ipconfigETHERNET_DRIVER_RX_BUFFERS + ipconfigETHERNET_DRIVER_RX_BROADCAST_BUFFERS) > ((SIZE_EMAC_CTRL_RAM / 2) / EMAC_DMA_BD_SIZE))
+		#error The RX BDs do not fit into the upper half of the CPPI RAM
+	#endif
+	/* The BDs of the broadcast channel follow the ones of the unicast channel */
+	/* A broadcast csatorna BD-i a unicast csatorna BD-i utn kvetkeznek */
+	#define EMAC_RXDMA_BC_PBUF_START_ADDRESS	(EMAC_RXDMA_PBUF_START_ADDRESS + (EMAC_RXDMA_PBUF_ALLOC * EMAC_DMA_BD_SIZE))
+	#define EMAC_RXDMA_BC_PBUF_ALLOC		(ipconfigETHERNET_DRIVER_RX_BROADCAST_BUFFERS)
+	#define EMAC_RX_CHANNEL_BROADCAST		(1U)
+	#define EMAC_RX_CHANNEL_COUNT			(2U)
+#else
+	#define EMAC_RX_CHANNEL_COUNT			(1U)
+#endif
+#define EMAC_RX_CHANNEL_UNICAST			(0U)
+
+/* Time critical unicast frames, they may use the network buffer reserve of their channel */
+/* Idkritikus unicast csomagok, ezek a csatorna hlzati puffer tartalkt is felhasznlhatjk */
+#define EMAC_RX_NTP_PORT				(123U)
+#define EMAC_RX_PTP_EVENT_PORT			(319U)
+#define EMAC_RX_PTP_GENERAL_PORT		(320U)
+#define EMAC_RX_PTP_FRAME_TYPE			(0x88F7U)	/* IEEE 1588 over Ethernet */
+#define EMAC_RX_IP_FRAGMENT_OFFSET		(0x1FFFU)	/* IPv4 fragment offset field */
+
+/* Adaptive RX: at light load every frame raises an interrupt, under load the RX task masks the RX interrupt and
+polls the ring every ipconfigETHERNET_DRIVER_RX_POLL_PERIOD ticks until a poll finds it empty. */
+/* Adaptv vtel: kis terhelsnl minden csomag megszaktst okoz, nagy terhelsnl az RX taszk letiltja az RX
+megszaktst, s ipconfigETHERNET_DRIVER_RX_POLL_PERIOD tickenknt olvassa a gyrt, amg az res nem lesz. */
+#ifndef ipconfigETHERNET_DRIVER_RX_BUDGET
+	#define ipconfigETHERNET_DRIVER_RX_BUDGET			(EMAC_RXDMA_PBUF_ALLOC)		/* Egy menetben feldolgozott csomagok max. szma */
+#endif
+#ifndef ipconfigETHERNET_DRIVER_RX_POLL_THRESHOLD
+	#define ipconfigETHERNET_DRIVER_RX_POLL_THRESHOLD	(ipconfigETHERNET_DRIVER_RX_BUDGET / 2)	/* Ennyi csomag egy menetben -> polling md */
+#endif
+#ifndef ipconfigETHERNET_DRIVER_RX_POLL_PERIOD
+	#define ipconfigETHERNET_DRIVER_RX_POLL_PERIOD		(1)							/* Ticks */
+#endif
+#if(ipconfigETHERNET_DRIVER_RX_POLL_THRESHOLD < 1) || (ipconfigETHERNET_DRIVER_RX_POLL_THRESHOLD > ipconfigETHERNET_DRIVER_RX_BUDGET)
+	#error ipconfigETHERNET_DRIVER_RX_POLL_THRESHOLD must be between 1 and ipconfigETHERNET_DRIVER_RX_BUDGET
+#endif
+
+/* Hardware RX interrupt pacing of the EMAC control module (0: off, otherwise 2..63 interrupts / ms) */
+/* Az EMAC control modul RX megszakts ritktsa (0: ki, egybknt 2..63 megszakts / ms) */
+#ifndef ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS
+	#define ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS	(0)
+#endif
+#if(ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS != 0) && ((ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS < 2) || (ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS > 63))
+	#error ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS must be 0 or between 2 and 63
+#endif
+#define EMAC_CTRL_INTCONTROL_C0RXPACEEN	(0x00010000U)
+#define EMAC_CTRL_INTCONTROL_PRESCALE	((uint32)(VCLK3_FREQ * 4.0F))		/* VCLK3 peridusok szma 4 usec alatt */
 
 /* EMAC descriptor flags TX+RX */
 /* EMAC descriptor flag-ek TX+RX */
@@ -163,6 +286,56 @@
 
 #define _CPU_TMS570LS4357_
 
+/* TX channels used by the driver */
+/* A driver ltal hasznlt TX csatornk */
+#define EMAC_TX_CHANNEL_NORMAL			(0U)
+#if(ipconfigUSE_TX_PRIORITY != 0)
+	#ifndef ipconfigETHERNET_DRIVER_TX_PRIORITY_CHANNEL
+		#define ipconfigETHERNET_DRIVER_TX_PRIORITY_CHANNEL	(7U)
+	#endif
+	#if(ipconfigETHERNET_DRIVER_TX_PRIORITY_CHANNEL <= EMAC_CHANNELNUMBER) || (ipconfigETHERNET_DRIVER_TX_PRIORITY_CHANNEL > 7U)
+		#error ipconfigETHERNET_DRIVER_TX_PRIORITY_CHANNEL must be above EMAC_CHANNELNUMBER and at most 7
+	#endif
+	#define EMAC_TX_CHANNEL_HIGH		(1U)
+	#define EMAC_TX_CHANNEL_COUNT		(2U)
+#else
+	#define EMAC_TX_CHANNEL_COUNT		(1U)
+#endif
+
+/* State of an EMAC TX channel and its BD ring */
+/* Egy EMAC TX csatorna s a hozz tartoz BD gyr llapota */
+typedef struct xEMAC_TX_CHANNEL
+{
+	uint32 ulChannel;								/* EMAC TX channel number */
+	emac_tx_bd_t *pxFirstBufferDescriptor;			/* First BD of the ring in CPPI RAM */
+	uint32 ulBufferDescriptorCount;					/* Number of BDs in the ring */
+	emac_tx_bd_t *pxNextBufferDescriptor;			/* Next BD to be filled */
+	emac_tx_bd_t *pxLastQueuedBufferDescriptor;		/* Last BD handed over to the EMAC */
+	uint32 ulDroppedFrames;							/* Frames dropped because the ring was full */
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+	xNetworkBufferDescriptor_t * volatile *ppxNetworkBuffers;	/* Network buffer sent by each BD, NULL when the BD is free (read by the TX ISR) */
+	emac_tx_bd_t *pxNextBufferDescriptorToReclaim;	/* Oldest BD whose network buffer has not been released yet */
+#endif
+} xEMACTxChannel_t;
+
+/* State of an EMAC RX channel and its BD ring */
+/* Egy EMAC RX csatorna s a hozz tartoz BD gyr llapota */
+typedef struct xEMAC_RX_CHANNEL
+{
+	uint32 ulChannel;								/* EMAC RX channel number */
+	volatile emac_rx_bd_t *pxFirstBufferDescriptor;	/* First BD of the ring in CPPI RAM */
+	uint32 ulBufferDescriptorCount;					/* Number of BDs in the ring */
+	xNetworkBufferDescriptor_t **ppxNetworkBuffers;	/* Network buffer owned by each BD */
+	UBaseType_t uxReservedBuffers;					/* Free network buffers a frame of this channel must leave to the others */
+	const char *pcTaskName;							/* Name of the RX task of the channel */
+	UBaseType_t uxTaskPriority;						/* Priority of the RX task of the channel */
+	TaskHandle_t xTaskHandle;						/* RX task of the channel, notified by the RX ISR */
+	uint32 ulDroppedFrames;							/* Frames dropped for lack of network buffers */
+#if(ipconfigUSE_RX_TIMESTAMPS != 0)
+	volatile uint32 ulInterruptTimestamp;			/* RTIFRC0 at the last RX interrupt of the channel */
+#endif
+} xEMACRxChannel_t;
+
 void vFreeRTOSEMACMiscInterrupt(void);
 void vFreeRTOSEMACTxInterrupt(void);
 void vFreeRTOSEMACRxThrshInterrupt(void);
@@ -170,17 +343,89 @@ void vFreeRTOSEMACRxInterrupt(void);
 uint32 xFreeRTOSEMACHWInit(uint8_t macaddr[6U]);
 static void prvEmacRxTask(void *pvParameters);
 static void prvEmacDMAInit(hdkif_t *hdkif);
+static void prvEmacRxArmBufferDescriptor(volatile emac_rx_bd_t *pxBufferDescriptor, xNetworkBufferDescriptor_t *pxNetworkBuffer);
+static UBaseType_t prvEmacRxInvalidateSweep(xEMACRxChannel_t *pxRxChannel, volatile emac_rx_bd_t *pxBufferDescriptor);
+static BaseType_t prvEmacRxIsTimeCritical(const uint8_t *pucEthernetBuffer, size_t xLength);
+static void prvEmacRxDeliver(xNetworkBufferDescriptor_t *pxFirstBuffer);
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+static void prvEmacTxReclaimFromISR(xEMACTxChannel_t *pxTxChannel, BaseType_t *pxHigherPriorityTaskWoken);
+#endif
 static void prvDisableEMACInterrupts(void);
 static void prvEnableEMACInterrupts(void);
+static void prvEmacRxChannelIntDisable(uint32_t ulChannel);
+static void prvEmacRxChannelIntEnable(uint32_t ulChannel);
 
 static BaseType_t xEMACDriverLoggingLevel = 0;
 
 SemaphoreHandle_t xEMACMiscEventSemaphore = NULL;			/* Link, User, Stat, Host esemnyek szemafor */
 volatile unsigned int xEMACMiscEventBit = pdFALSE;			/* Link, User, Stat, Host esemnyek jelzbit */
 
-static xTaskHandle prvEmacRxTaskHandle = NULL;
 extern TaskHandle_t xIPTaskHandle;
-SemaphoreHandle_t xEMACTxEventSemaphore = NULL;
+
+/* Network buffers owned by the RX BDs, indexed with the position of the BD in the ring */
+/* Az RX BD-khez tartoz hlzati pufferek, a BD gyrbeli indexvel cmezve */
+static xNetworkBufferDescriptor_t *pxEMACRxNetworkBuffers[EMAC_RXDMA_PBUF_ALLOC];
+#if(EMAC_RX_CHANNEL_COUNT > 1)
+static xNetworkBufferDescriptor_t *pxEMACRxBcNetworkBuffers[EMAC_RXDMA_BC_PBUF_ALLOC];
+#endif
+
+static xEMACRxChannel_t xEMACRxChannels[EMAC_RX_CHANNEL_COUNT] =
+{
+	{
+		EMAC_CHANNELNUMBER,
+		(emac_rx_bd_t *)EMAC_RXDMA_PBUF_START_ADDRESS, EMAC_RXDMA_PBUF_ALLOC, pxEMACRxNetworkBuffers,
+		ipconfigETHERNET_DRIVER_RX_RESERVED_BUFFERS,
+		"EmacRx", ipconfigETHERNET_DRIVER_RX_TASK_PRIORITY, NULL,
+		0U
+	},
+#if(EMAC_RX_CHANNEL_COUNT > 1)
+	{
+		ipconfigETHERNET_DRIVER_RX_BROADCAST_CHANNEL,
+		(emac_rx_bd_t *)EMAC_RXDMA_BC_PBUF_START_ADDRESS, EMAC_RXDMA_BC_PBUF_ALLOC, pxEMACRxBcNetworkBuffers,
+		ipconfigETHERNET_DRIVER_RX_BROADCAST_RESERVED_BUFFERS,
+		"EmacRxBc", ipconfigETHERNET_DRIVER_RX_BROADCAST_TASK_PRIORITY, NULL,
+		0U
+	},
+#endif
+};
+
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+/* Network buffers attached to the TX BDs (zero-copy send) */
+/* A TX BD-khez csatolt hlzati pufferek (zero-copy klds) */
+static xNetworkBufferDescriptor_t * volatile pxEMACTxNetworkBuffers[EMAC_TXDMA_PBUF_ALLOC];
+#if(ipconfigUSE_TX_PRIORITY != 0)
+static xNetworkBufferDescriptor_t * volatile pxEMACTxHPNetworkBuffers[EMAC_TXDMA_HP_PBUF_ALLOC];
+#endif
+#else
+/* Copy buffers of the TX BDs, on whole data cache lines so cleaning a frame never touches a neighbour */
+/* A TX BD-k msol pufferei, teljes cache sorokon */
+#define EMAC_TX_BUFFER_SIZE		((ipTOTAL_ETHERNET_FRAME_SIZE + EMAC_CACHE_LINE_SIZE - 1U) & ~(EMAC_CACHE_LINE_SIZE - 1U))
+static uint8_t ucEMACTxBuffers[EMAC_TXDMA_PBUF_ALLOC + EMAC_TXDMA_HP_PBUF_ALLOC][EMAC_TX_BUFFER_SIZE] __attribute__((aligned(32)));
+#endif
+
+static xEMACTxChannel_t xEMACTxChannels[EMAC_TX_CHANNEL_COUNT] =
+{
+	{
+		EMAC_CHANNELNUMBER,
+		(emac_tx_bd_t *)EMAC_TXDMA_PBUF_START_ADDRESS, EMAC_TXDMA_PBUF_ALLOC,
+		(emac_tx_bd_t *)EMAC_TXDMA_PBUF_START_ADDRESS, (emac_tx_bd_t *)EMAC_TXDMA_PBUF_START_ADDRESS,
+		0U,
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+		pxEMACTxNetworkBuffers, (emac_tx_bd_t *)EMAC_TXDMA_PBUF_START_ADDRESS
+#endif
+	},
+#if(ipconfigUSE_TX_PRIORITY != 0)
+	{
+		ipconfigETHERNET_DRIVER_TX_PRIORITY_CHANNEL,
+		(emac_tx_bd_t *)EMAC_TXDMA_HP_PBUF_START_ADDRESS, EMAC_TXDMA_HP_PBUF_ALLOC,
+		(emac_tx_bd_t *)EMAC_TXDMA_HP_PBUF_START_ADDRESS, (emac_tx_bd_t *)EMAC_TXDMA_HP_PBUF_START_ADDRESS,
+		0U,
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+		pxEMACTxHPNetworkBuffers, (emac_tx_bd_t *)EMAC_TXDMA_HP_PBUF_START_ADDRESS
+#endif
+	},
+#endif
+};
 
 extern BaseType_t xEMACRxEventSemaphoreFulls;
 extern void _dcacheCleanRange_(unsigned int startAddress, unsigned int endAddress);
@@ -219,6 +464,40 @@ static void prvEnableEMACInterrupts(void)
 	vimREG->REQMASKSET2 = (uint32)1U << (C0_MISC_PULSE-64U) | (uint32)1U << (C0_TX_PULSE-64U) | (uint32)1U << (C0_THRSH_PULSE-64U) | (uint32)1U << (C0_RX_PULSE-64U);
 }
 
+/** ***************************************************************************************************
+ * @fn		static void prvEmacRxChannelIntDisable(uint32_t ulChannel)
+ * @brief	Disable the RX pulse interrupt of one channel.
+ * @details
+ * Az RX csatornk taszkjai (eltr prioritssal) egymstl fggetlenl vltanak polling mdba. A mask set/clear
+ * regiszterekbe csak a csatorna bitjt rjuk (a HAL EMACRxIntPulseDisable() |= mvelete a teljes maszkot
+ * visszarn, a tbbi csatornt is tiltva), a kzs C0RXEN mdostsa kritikus szakaszban trtnik.
+ */
+static void prvEmacRxChannelIntDisable(uint32_t ulChannel)
+{
+	HWREG(EMAC_0_BASE + EMAC_RXINTMASKCLEAR) = ((uint32)1U << ulChannel);
+
+	taskENTER_CRITICAL();
+	{
+		HWREG(EMAC_CTRL_0_BASE + EMAC_CTRL_CnRXEN(0U)) &= (~((uint32)1U << ulChannel));
+	}
+	taskEXIT_CRITICAL();
+}
+
+/** ***************************************************************************************************
+ * @fn		static void prvEmacRxChannelIntEnable(uint32_t ulChannel)
+ * @brief	Enable the RX pulse interrupt of one channel, see prvEmacRxChannelIntDisable().
+ */
+static void prvEmacRxChannelIntEnable(uint32_t ulChannel)
+{
+	HWREG(EMAC_0_BASE + EMAC_RXINTMASKSET) = ((uint32)1U << ulChannel);
+
+	taskENTER_CRITICAL();
+	{
+		HWREG(EMAC_CTRL_0_BASE + EMAC_CTRL_CnRXEN(0U)) |= ((uint32)1U << ulChannel);
+	}
+	taskEXIT_CRITICAL();
+}
+
 /** ***************************************************************************************************
  * @fn		BaseType_t xNetworkInterfaceInitialise(void)
  * @brief	High level function for initializing EMAC module for sending and receiving ethernet frames.
@@ -232,6 +511,8 @@ BaseType_t xNetworkInterfaceInitialise(void)
 {
 	BaseType_t xReturn = pdFAIL;
 	hdkif_t *hdkif = &hdkif_data[0U];
+	uint32 i;
+	BaseType_t xTasksCreated;
 
 	/* Disable all EMAC interrupts in VIM. */
 	/* Az sszes EMAC interrupt letiltsa  a VIM-ben. */
@@ -258,20 +539,24 @@ BaseType_t xNetworkInterfaceInitialise(void)
 			xEMACMiscEventSemaphore = xSemaphoreCreateBinary();
 			configASSERT(xEMACMiscEventSemaphore);
 		}
-		if(xEMACTxEventSemaphore == NULL)
-		{
-			xEMACTxEventSemaphore = xSemaphoreCreateBinary();
-			configASSERT(xEMACTxEventSemaphore);
-		}
-		if(prvEmacRxTaskHandle == NULL)
+		/* RX csatornnknt egy taszk */
+		xTasksCreated = pdTRUE;
+		for(i = 0; i < EMAC_RX_CHANNEL_COUNT; i++)
 		{
-			/* Az _dCacheInvalidateRange_() miatt kell privilegizlt mdban futtatni */
-			xTaskCreate(prvEmacRxTask, "EmacRx", ipconfigETHERNET_DRIVER_RX_TASK_STACK_SIZE_WORDS, NULL, ipconfigETHERNET_DRIVER_RX_TASK_PRIORITY, &prvEmacRxTaskHandle);
-			configASSERT(prvEmacRxTaskHandle);
+			if(xEMACRxChannels[i].xTaskHandle == NULL)
+			{
+				/* Az _dCacheInvalidateRange_() miatt kell privilegizlt mdban futtatni */
+				xTaskCreate(prvEmacRxTask, xEMACRxChannels[i].pcTaskName, ipconfigETHERNET_DRIVER_RX_TASK_STACK_SIZE_WORDS, &xEMACRxChannels[i], xEMACRxChannels[i].uxTaskPriority, &xEMACRxChannels[i].xTaskHandle);
+				configASSERT(xEMACRxChannels[i].xTaskHandle);
+			}
+			if(xEMACRxChannels[i].xTaskHandle == NULL)
+			{
+				xTasksCreated = pdFALSE;
+			}
 		}
 
 		/* Minden szksges taszk s szemafor rendben ltrejtt */
-		if(xEMACMiscEventSemaphore != NULL && prvEmacRxTaskHandle != NULL)
+		if(xEMACMiscEventSemaphore != NULL && xTasksCreated != pdFALSE)
 		{
 			/* IRQ engedlyezsek */
 			/* A MISC interrupt-ok (Link, HOST, STAT) engedlyezse */
@@ -283,10 +568,21 @@ BaseType_t xNetworkInterfaceInitialise(void)
 			HWREG(EMAC_BASE + EMAC_MACINTMASKSET) = EMAC_MACINTMASKSET_HOSTMASK | EMAC_MACINTMASKSET_STATMASK;
 
 			/* TX s RX megszaktsok engedlyezse */
-			HWREG(hdkif->emac_base + EMAC_TXINTMASKSET) |= ((uint32)1U << EMAC_CHANNELNUMBER);
-			HWREG(hdkif->emac_ctrl_base + EMAC_CTRL_CnTXEN(EMAC_CHANNELNUMBER)) |= ((uint32)1U << EMAC_CHANNELNUMBER);
-			HWREG(hdkif->emac_base + EMAC_RXINTMASKSET) |= ((uint32)1U << EMAC_CHANNELNUMBER);
-			HWREG(hdkif->emac_ctrl_base + EMAC_CTRL_CnRXEN(EMAC_CHANNELNUMBER)) |= ((uint32)1U << EMAC_CHANNELNUMBER);
+			for(i = 0; i < EMAC_TX_CHANNEL_COUNT; i++)
+			{
+				HWREG(hdkif->emac_base + EMAC_TXINTMASKSET) |= ((uint32)1U << xEMACTxChannels[i].ulChannel);
+				HWREG(hdkif->emac_ctrl_base + EMAC_CTRL_CnTXEN(0U)) |= ((uint32)1U << xEMACTxChannels[i].ulChannel);
+			}
+#if(ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS != 0)
+			/* RX megszakts ritkts belltsa */
+			HWREG(hdkif->emac_ctrl_base + EMAC_CTRL_C0RXIMAX) = ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS;
+			HWREG(hdkif->emac_ctrl_base + EMAC_CTRL_INTCONTROL) = EMAC_CTRL_INTCONTROL_C0RXPACEEN | EMAC_CTRL_INTCONTROL_PRESCALE;
+#endif
+			for(i = 0; i < EMAC_RX_CHANNEL_COUNT; i++)
+			{
+				HWREG(hdkif->emac_base + EMAC_RXINTMASKSET) |= ((uint32)1U << xEMACRxChannels[i].ulChannel);
+				HWREG(hdkif->emac_ctrl_base + EMAC_CTRL_CnRXEN(0U)) |= ((uint32)1U << xEMACRxChannels[i].ulChannel);
+			}
 
 			/* EMAC RX s TX engedlyezse */
 			HWREG(hdkif->emac_base + EMAC_RXCONTROL) = EMAC_RXCONTROL_RXEN;
@@ -295,8 +591,11 @@ BaseType_t xNetworkInterfaceInitialise(void)
 			/* Az sszes EMAC interrupt engedlyezse a VIM-ben. */
 			prvEnableEMACInterrupts();
 
-			/* Csomagok fogadsnak indtsa a HP belltsval */
-			HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER)) = EMAC_RXDMA_PBUF_START_ADDRESS;
+			/* Csomagok fogadsnak indtsa a HP belltsval (valamennyi RX csatornn) */
+			for(i = 0; i < EMAC_RX_CHANNEL_COUNT; i++)
+			{
+				HWREG(hdkif->emac_base + EMAC_RXHDP(xEMACRxChannels[i].ulChannel)) = (uint32)xEMACRxChannels[i].pxFirstBufferDescriptor;
+			}
 			xReturn = pdPASS;
 		}
 	}
@@ -307,6 +606,10 @@ BaseType_t xNetworkInterfaceInitialise(void)
 /** ***************************************************************************************************
  * @fn		BaseType_t xNetworkInterfaceOutput(xNetworkBufferDescriptor_t * const pxDescriptor, BaseType_t xReleaseAfterSend)
  * @brief	Send data over ethernet (EMAC) interface.
+ * @details
+ * Frames marked with ipTX_PRIORITY_HIGH (PTP, NTP, control traffic) are queued on the high priority
+ * TX channel. The EMAC uses fixed-priority channel selection, so they never wait behind the bulk
+ * frames queued on EMAC_CHANNELNUMBER.
  * @param	pxDescriptor pointer to the buffer descriptor
  * @param	xReleaseAfterSend Release the descriptor after send (pdPASS)
  * @return	pdFAIL Error
@@ -317,69 +620,126 @@ BaseType_t xNetworkInterfaceOutput(xNetworkBufferDescriptor_t * const pxDescript
     hdkif_t *hdkif = &hdkif_data[0U];
     uint32 xFlagsPktlen;
     uint16 xTotalLength;
-    static emac_tx_bd_t * pxTransmitBufferDescriptor  = (emac_tx_bd_t *)EMAC_TXDMA_PBUF_START_ADDRESS;
-    static emac_tx_bd_t * pxLastQueuedBufferDescriptor  = (emac_tx_bd_t *)EMAC_TXDMA_PBUF_START_ADDRESS;
+    xEMACTxChannel_t *pxTxChannel = &xEMACTxChannels[EMAC_TX_CHANNEL_NORMAL];
+    emac_tx_bd_t *pxTransmitBufferDescriptor;
+    xNetworkBufferDescriptor_t *pxNetworkBuffer = pxDescriptor;
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+    uint32 ulSlot;
+#endif
 
-    /* Is the previous transfer done yet? */
-    /* Befejezdtt mr az elz tvitel? */
-    while(EMAC_DSC_FLAG_OWNER == (BYTE_SWAP(pxTransmitBufferDescriptor->flags_pktlen) & EMAC_DSC_FLAG_OWNER))
+#if(ipconfigUSE_TX_PRIORITY != 0)
+    /* Time critical frames use the high priority channel. */
+    /* Az idkritikus csomagok a magas priorits csatornt hasznljk. */
+    if(pxDescriptor->ucTxPriority != ipTX_PRIORITY_NORMAL)
     {
-    	if(xSemaphoreTake(xEMACTxEventSemaphore, ipconfigETHERNET_DRIVER_TX_BLOCK_TIME) == pdFAIL)
+    	pxTxChannel = &xEMACTxChannels[EMAC_TX_CHANNEL_HIGH];
+    }
+#endif
+
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+    /* The BD keeps the network buffer until the EMAC has sent it, so a buffer still owned by the caller is sent from a copy. */
+    /* A BD a klds vgig megtartja a hlzati puffert, ezrt a hvnl marad puffer helyett egy msolatot kldnk. */
+    if(xReleaseAfterSend == pdFALSE)
+    {
+    	pxNetworkBuffer = pxDuplicateNetworkBufferWithDescriptor(pxDescriptor, (BaseType_t)pxDescriptor->xDataLength);
+    	if(pxNetworkBuffer == NULL)
     	{
-			iptraceWAITING_FOR_TX_DMA_DESCRIPTOR();
     		return(pdFAIL);
     	}
+    	xReleaseAfterSend = pdTRUE;
+    }
+#endif
+    pxTransmitBufferDescriptor = pxTxChannel->pxNextBufferDescriptor;
+
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+    /* Has the TX ISR released the network buffer of this BD yet? */
+    /* Felszabadtotta mr a TX ISR a BD hlzati puffert? */
+    ulSlot = (uint32)(pxTransmitBufferDescriptor - pxTxChannel->pxFirstBufferDescriptor);
+    if(pxTxChannel->ppxNetworkBuffers[ulSlot] != NULL)
+#else
+    /* Is the previous transfer done yet? */
+    /* Befejezdtt mr az elz tvitel? */
+    if(EMAC_DSC_FLAG_OWNER == (BYTE_SWAP(pxTransmitBufferDescriptor->flags_pktlen) & EMAC_DSC_FLAG_OWNER))
+#endif
+    {
+    	/* The ring is full: the frame is dropped instead of blocking the IP task, a buffer handed over to the driver must not be lost. */
+    	/* A gyr tele van: az IP taszk blokkolsa helyett a csomagot eldobjuk, de a driverre bzott puffert nem veszthetjk el. */
+		iptraceWAITING_FOR_TX_DMA_DESCRIPTOR();
+		pxTxChannel->ulDroppedFrames++;
+		if(xReleaseAfterSend != pdFALSE)
+		{
+			vReleaseNetworkBufferAndDescriptor(pxNetworkBuffer);
+		}
+		return(pdFAIL);
     }
 
 	/* We are going to send the non zero size packets from non zero address only. */
     /* Csak a nem 0 hossz csomagokat kldjk el a nem null cmrl. */
-	if(pxDescriptor->xDataLength != 0 && pxDescriptor->pucEthernetBuffer != NULL)
+	if(pxNetworkBuffer->xDataLength != 0 && pxNetworkBuffer->pucEthernetBuffer != NULL)
 	{
-		memcpy((void *)BYTE_SWAP(pxTransmitBufferDescriptor->bufptr), (void *)pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength);
-
 		/* Ha a csomag mret nem ri el a minimlis mretet, akkor ki kell egszteni */
 		/* If packet size is less than the minimum, it has to be padded */
-		while(pxDescriptor->xDataLength < MIN_ETHERNET_PACKET_SIZE)
+		while(pxNetworkBuffer->xDataLength < MIN_ETHERNET_PACKET_SIZE)
 		{
-			pxDescriptor->xDataLength++;
-			*(uint8_t *)(pxDescriptor->pucEthernetBuffer + pxDescriptor->xDataLength) = 0x00;
+			pxNetworkBuffer->pucEthernetBuffer[pxNetworkBuffer->xDataLength] = 0x00;
+			pxNetworkBuffer->xDataLength++;
 		}
-		_dcacheCleanRange_((uint32)BYTE_SWAP(pxTransmitBufferDescriptor->bufptr),(uint32)BYTE_SWAP(pxTransmitBufferDescriptor->bufptr) + MAX_TRANSFER_UNIT);
+
+#if(ipconfigUSE_PCAP != 0)
+		vPCAPCaptureFrame(pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength, pcapDIRECTION_TX);
+#endif
+
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+		/* The EMAC reads the frame straight from the network buffer. */
+		/* Az EMAC kzvetlenl a hlzati pufferbl olvassa a csomagot. */
+		_dcacheCleanRange_((uint32)pxNetworkBuffer->pucEthernetBuffer, (uint32)pxNetworkBuffer->pucEthernetBuffer + pxNetworkBuffer->xDataLength);
+		pxTransmitBufferDescriptor->bufptr = BYTE_SWAP((uint32)pxNetworkBuffer->pucEthernetBuffer);
+#else
+		memcpy((void *)BYTE_SWAP(pxTransmitBufferDescriptor->bufptr), (void *)pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength);
+		_dcacheCleanRange_((uint32)BYTE_SWAP(pxTransmitBufferDescriptor->bufptr),(uint32)BYTE_SWAP(pxTransmitBufferDescriptor->bufptr) + pxNetworkBuffer->xDataLength);
+#endif
 
 		/* Creating new BD. */
 		/* j BD ltrehozs */
-		pxTransmitBufferDescriptor->bufoff_len = BYTE_SWAP(pxDescriptor->xDataLength);
-		xTotalLength = pxDescriptor->xDataLength;
+		pxTransmitBufferDescriptor->bufoff_len = BYTE_SWAP(pxNetworkBuffer->xDataLength);
+		xTotalLength = pxNetworkBuffer->xDataLength;
 		xFlagsPktlen = ((uint32)(xTotalLength) | (EMAC_DSC_FLAG_SOP | EMAC_DSC_FLAG_EOP | EMAC_DSC_FLAG_OWNER));
-		pxTransmitBufferDescriptor->flags_pktlen = BYTE_SWAP(xFlagsPktlen);
-		pxTransmitBufferDescriptor->next = NULL;
 
 		prvDisableEMACInterrupts();			/* Start of the critcal section. */
-		if(HWREG(hdkif->emac_base + EMAC_TXHDP((uint32)EMAC_CHANNELNUMBER)) == NULL)
+		pxTransmitBufferDescriptor->flags_pktlen = BYTE_SWAP(xFlagsPktlen);
+		pxTransmitBufferDescriptor->next = NULL;
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+		/* The slot is published after the OWNER bit, with the TX interrupt masked and before the BD is linked to the
+		 * queue. Both stores are volatile, so the TX ISR sees either an empty slot or a BD owned by the EMAC. */
+		/* A slotot az OWNER bit utn, maszkolt TX megszakts mellett s a BD sorba fzse eltt rjuk. Mindkt rs
+		 * volatile, gy a TX ISR vagy res slotot, vagy az EMAC tulajdonban lev BD-t lt. */
+		pxTxChannel->ppxNetworkBuffers[ulSlot] = pxNetworkBuffer;
+#endif
+		if(HWREG(hdkif->emac_base + EMAC_TXHDP(pxTxChannel->ulChannel)) == NULL)
 		{
 			/* Elindtjuk az tvitelt az EMAC Tx Hdr DescPtr rsval... */
 			/* Start transmission by writing EMAC Tx Hdr DescPtr, if EMAC is not running... */
-			HWREG(hdkif->emac_base + EMAC_TXHDP((uint32)EMAC_CHANNELNUMBER)) = (uint32)(pxTransmitBufferDescriptor);
-			pxLastQueuedBufferDescriptor = pxTransmitBufferDescriptor;
+			HWREG(hdkif->emac_base + EMAC_TXHDP(pxTxChannel->ulChannel)) = (uint32)(pxTransmitBufferDescriptor);
+			pxTxChannel->pxLastQueuedBufferDescriptor = pxTransmitBufferDescriptor;
 		}
 		else
 		{
 			/* ... vagy hozzfzzk az j BD-t a lista vgre. */
 			/* ... or append the new BD to the end of the list. */
-			pxLastQueuedBufferDescriptor->next = (emac_tx_bd_t *)BYTE_SWAP((uint32_t)pxTransmitBufferDescriptor);
-			pxLastQueuedBufferDescriptor = pxTransmitBufferDescriptor;
+			pxTxChannel->pxLastQueuedBufferDescriptor->next = (emac_tx_bd_t *)BYTE_SWAP((uint32_t)pxTransmitBufferDescriptor);
+			pxTxChannel->pxLastQueuedBufferDescriptor = pxTransmitBufferDescriptor;
 		}
 		prvEnableEMACInterrupts();
 		/* End of the critical section. */
 
-		if(pxTransmitBufferDescriptor < (emac_tx_bd_t *)(EMAC_TXDMA_PBUF_START_ADDRESS + EMAC_TXDMA_PBUF_ALLOC))
+		/* Step to the next BD of the channel's ring. */
+		/* Tovbblpnk a csatorna gyrjnek kvetkez BD-jre. */
+		pxTransmitBufferDescriptor++;
+		if(pxTransmitBufferDescriptor >= pxTxChannel->pxFirstBufferDescriptor + pxTxChannel->ulBufferDescriptorCount)
 		{
-			pxTransmitBufferDescriptor++;
-		}
-		else
-		{
-			pxTransmitBufferDescriptor = (emac_tx_bd_t *)EMAC_TXDMA_PBUF_START_ADDRESS;
+			pxTransmitBufferDescriptor = pxTxChannel->pxFirstBufferDescriptor;
 		}
+		pxTxChannel->pxNextBufferDescriptor = pxTransmitBufferDescriptor;
 
 		/* Call the standard trace macro to log the send event. */
 		iptraceNETWORK_INTERFACE_TRANSMIT();
@@ -388,16 +748,19 @@ BaseType_t xNetworkInterfaceOutput(xNetworkBufferDescriptor_t * const pxDescript
 	{
 		/* Try to release the failed network BD */
 		/* Megprbljuk felszabadtani a hibs csomaglert */
-		xReleaseAfterSend = pdTRUE;
+		vReleaseNetworkBufferAndDescriptor(pxNetworkBuffer);
+		xReleaseAfterSend = pdFALSE;
 	}
 
 #if(ipconfigZERO_COPY_TX_DRIVER == 0)
 	if(xReleaseAfterSend != pdFALSE)
     {
-		vReleaseNetworkBufferAndDescriptor(pxDescriptor);
+		vReleaseNetworkBufferAndDescriptor(pxNetworkBuffer);
     }
 #else
-#error ipconfigZERO_COPY_TX_DRIVER not available yet
+	/* The network buffer is released by the TX ISR once the EMAC has sent it. */
+	/* A hlzati puffert a TX ISR szabadtja fel, amikor az EMAC elkldte. */
+	( void ) xReleaseAfterSend;
 #endif
 
     return pdTRUE;
@@ -439,8 +802,13 @@ void vFreeRTOSEMACMiscInterrupt(void)
     /* STAT(istic) interrupt */
 	if((HWREG(hdkif->emac_base + EMAC_MACINTSTATMASKED) & EMAC_MACINTSTATMASKED_STATPEND) == EMAC_MACINTSTATMASKED_STATPEND)
 	{
+#if(ipconfigUSE_EMAC_STATS != 0)
+		/* A szmllkat a 64 bites sszegekbe gyjtjk (write-to-decrement), gy a STATPEND trldik, a megszakts engedlyezve marad. */
+		vEMACStatsSampleFromISR();
+#else
 		/* Tiltjuk a megszaktst. Nyugtzni s jra engedlyezni majd az applikcinak kell. */
 		HWREG(hdkif->emac_base + EMAC_MACINTMASKCLEAR) =  EMAC_MACINTSTATMASKED_STATPEND;
+#endif
 		traceEMAC_INT_CORE0_MISC_STAT();			/* trace macro */
 	}
 
@@ -465,24 +833,37 @@ void vFreeRTOSEMACMiscInterrupt(void)
 void vFreeRTOSEMACTxInterrupt(void)
 {
     static hdkif_t *hdkif = &hdkif_data[0U];
-    static BaseType_t xHigherPriorityTaskWoken;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     emac_tx_bd_t *pxCurrentBufferDescriptor;
+    xEMACTxChannel_t *pxTxChannel;
+    uint32 xPendingChannels;
+    uint32 i;
 
-    /* Acknowledge EMAC by writing completion pointer. */
-    /* Nyugtzzuk az EMAC-nak BD feldolgozst. */
-    pxCurrentBufferDescriptor = (emac_tx_bd_t *)HWREG(hdkif->emac_base + EMAC_TXCP(EMAC_CHANNELNUMBER));
-    HWREG(hdkif->emac_base + EMAC_TXCP(EMAC_CHANNELNUMBER)) = (uint32_t)pxCurrentBufferDescriptor;
+    xPendingChannels = HWREG(hdkif->emac_base + EMAC_TXINTSTATMASKED);
 
-    /* Restart the transmission if there is more packet to transfer. */
-    /* jraindtjuk az tvitelt, ha van tovbbi tvitelre vr csomag. */
-    if(pxCurrentBufferDescriptor->next != NULL)
+    for(i = 0; i < EMAC_TX_CHANNEL_COUNT; i++)
     {
-    	HWREG(hdkif->emac_base + EMAC_TXHDP((uint32)EMAC_CHANNELNUMBER)) = BYTE_SWAP((uint32)(pxCurrentBufferDescriptor->next));
-    }
+    	pxTxChannel = &xEMACTxChannels[i];
+    	if((xPendingChannels & ((uint32)1U << pxTxChannel->ulChannel)) == 0U)
+    	{
+    		continue;
+    	}
 
-    if(xIPTaskHandle != NULL && xEMACTxEventSemaphore != NULL)
-    {
-    	xSemaphoreGiveFromISR(xEMACTxEventSemaphore, &xHigherPriorityTaskWoken);
+		/* Acknowledge EMAC by writing completion pointer. */
+		/* Nyugtzzuk az EMAC-nak BD feldolgozst. */
+		pxCurrentBufferDescriptor = (emac_tx_bd_t *)HWREG(hdkif->emac_base + EMAC_TXCP(pxTxChannel->ulChannel));
+		HWREG(hdkif->emac_base + EMAC_TXCP(pxTxChannel->ulChannel)) = (uint32_t)pxCurrentBufferDescriptor;
+
+		/* Restart the transmission if the EMAC stopped (EOQ) before the next BD was appended. */
+		/* jraindtjuk az tvitelt, ha az EMAC megllt (EOQ), mieltt a kvetkez BD-t hozzfztk. */
+		if(pxCurrentBufferDescriptor->next != NULL && (BYTE_SWAP(pxCurrentBufferDescriptor->flags_pktlen) & EMAC_DSC_FLAG_EOQ) == EMAC_DSC_FLAG_EOQ)
+		{
+			HWREG(hdkif->emac_base + EMAC_TXHDP(pxTxChannel->ulChannel)) = BYTE_SWAP((uint32)(pxCurrentBufferDescriptor->next));
+		}
+
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+		prvEmacTxReclaimFromISR(pxTxChannel, &xHigherPriorityTaskWoken);
+#endif
     }
 
     traceEMAC_INT_CORE0_TX();			/* trace macro */
@@ -493,6 +874,36 @@ void vFreeRTOSEMACTxInterrupt(void)
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+/** ***************************************************************************************************
+* @fn static void prvEmacTxReclaimFromISR(xEMACTxChannel_t *pxTxChannel, BaseType_t *pxHigherPriorityTaskWoken)
+* @brief Releases the network buffers of the TX BDs the EMAC has handed back (zero-copy send).
+* @details
+* The BDs are walked in ring order from the oldest one still holding a buffer, until a BD without a buffer
+* or one still owned by the EMAC is found.
+*/
+static void prvEmacTxReclaimFromISR(xEMACTxChannel_t *pxTxChannel, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	emac_tx_bd_t *pxBufferDescriptor = pxTxChannel->pxNextBufferDescriptorToReclaim;
+	uint32 ulSlot = (uint32)(pxBufferDescriptor - pxTxChannel->pxFirstBufferDescriptor);
+
+	while(pxTxChannel->ppxNetworkBuffers[ulSlot] != NULL && (BYTE_SWAP(pxBufferDescriptor->flags_pktlen) & EMAC_DSC_FLAG_OWNER) == 0U)
+	{
+		*pxHigherPriorityTaskWoken |= vNetworkBufferReleaseFromISR(pxTxChannel->ppxNetworkBuffers[ulSlot]);
+		pxTxChannel->ppxNetworkBuffers[ulSlot] = NULL;
+
+		pxBufferDescriptor++;
+		ulSlot++;
+		if(ulSlot >= pxTxChannel->ulBufferDescriptorCount)
+		{
+			pxBufferDescriptor = pxTxChannel->pxFirstBufferDescriptor;
+			ulSlot = 0U;
+		}
+	}
+	pxTxChannel->pxNextBufferDescriptorToReclaim = pxBufferDescriptor;
+}
+#endif
+
 /** ***************************************************************************************************
 * @fn void vFreeRTOSEMACRxThrshInterrupt(void)
 * @brief RX Threshold Interrupt for EMAC in FreeRTOS-Plus-TCP compatibility mode
@@ -519,145 +930,382 @@ void vFreeRTOSEMACRxThrshInterrupt(void)
 #pragma INTERRUPT(vFreeRTOSEMACRxInterrupt, IRQ)
 void vFreeRTOSEMACRxInterrupt(void)
 {
-	static BaseType_t xHigherPriorityTaskWoken;
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     static hdkif_t *hdkif = &hdkif_data[0U];
     emac_rx_bd_t *pxCurrentBufferDescriptor;
+    xEMACRxChannel_t *pxRxChannel;
+    uint32 xPendingChannels;
+    uint32 i;
+#if(ipconfigUSE_RX_TIMESTAMPS != 0)
+    uint32 ulTimestamp = RTI_FRC0_REG;
+#endif
 
-    if(prvEmacRxTaskHandle != NULL)
+    xPendingChannels = HWREG(hdkif->emac_base + EMAC_RXINTSTATMASKED);
+
+    for(i = 0; i < EMAC_RX_CHANNEL_COUNT; i++)
     {
-    	vTaskNotifyGiveFromISR(prvEmacRxTaskHandle, &xHigherPriorityTaskWoken);
+    	pxRxChannel = &xEMACRxChannels[i];
+    	if((xPendingChannels & ((uint32)1U << pxRxChannel->ulChannel)) == 0U)
+    	{
+    		continue;
+    	}
+
+#if(ipconfigUSE_RX_TIMESTAMPS != 0)
+		pxRxChannel->ulInterruptTimestamp = ulTimestamp;
+#endif
+		if(pxRxChannel->xTaskHandle != NULL)
+		{
+			vTaskNotifyGiveFromISR(pxRxChannel->xTaskHandle, &xHigherPriorityTaskWoken);
+		}
+		pxCurrentBufferDescriptor = (emac_rx_bd_t *)HWREG(hdkif->emac_base + EMAC_RXCP(pxRxChannel->ulChannel));
+		HWREG(hdkif->emac_base + EMAC_RXCP(pxRxChannel->ulChannel)) = (uint32_t)pxCurrentBufferDescriptor; 	// Nyugtzzuk az EMAC-nak BD feldolgozst.
     }
-    pxCurrentBufferDescriptor = (emac_rx_bd_t *)HWREG(hdkif->emac_base + EMAC_RXCP(EMAC_CHANNELNUMBER));
-	HWREG(hdkif->emac_base + EMAC_RXCP(EMAC_CHANNELNUMBER)) = (uint32_t)pxCurrentBufferDescriptor; 	// Nyugtzzuk az EMAC-nak BD feldolgozst.
 	EMACCoreIntAck(hdkif->emac_base, EMAC_INT_CORE0_RX);											// Nyugtzzuk az EMAC control modul RX megszaktst.
 
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
+/** ***************************************************************************************************
+* @fn static void prvEmacRxArmBufferDescriptor(volatile emac_rx_bd_t *pxBufferDescriptor, xNetworkBufferDescriptor_t *pxNetworkBuffer)
+* @brief Hands a network buffer of the stack over to an RX BD (zero-copy receive).
+* @details
+* The cache lines of the buffer are cleaned and invalidated before the EMAC gets it, so no dirty line
+* left behind by the stack can be written back over the received frame.
+*/
+static void prvEmacRxArmBufferDescriptor(volatile emac_rx_bd_t *pxBufferDescriptor, xNetworkBufferDescriptor_t *pxNetworkBuffer)
+{
+	_dcacheInvalidateRange_((uint32_t)pxNetworkBuffer->pucEthernetBuffer, (uint32_t)pxNetworkBuffer->pucEthernetBuffer + ipTOTAL_ETHERNET_FRAME_SIZE);
+
+	pxBufferDescriptor->bufptr = BYTE_SWAP((uint32_t)pxNetworkBuffer->pucEthernetBuffer);
+	pxBufferDescriptor->bufoff_len = BYTE_SWAP(ipTOTAL_ETHERNET_FRAME_SIZE);
+	pxBufferDescriptor->flags_pktlen = BYTE_SWAP(EMAC_BUF_DESC_OWNER);
+}
+
+/** ***************************************************************************************************
+* @fn static UBaseType_t prvEmacRxInvalidateSweep(xEMACRxChannel_t *pxRxChannel, volatile emac_rx_bd_t *pxBufferDescriptor)
+* @brief Invalidates the received frames of one RX sweep, starting at pxBufferDescriptor.
+* @details
+* Only the lines holding the received bytes are invalidated (the rest of the buffer was invalidated when the BD
+* was armed). At most ipconfigETHERNET_DRIVER_RX_BUDGET BDs are taken, the sweep must not go past the returned count,
+* as a BD completed later has not been invalidated.
+* @return The number of BDs the EMAC has handed over.
+*/
+static UBaseType_t prvEmacRxInvalidateSweep(xEMACRxChannel_t *pxRxChannel, volatile emac_rx_bd_t *pxBufferDescriptor)
+{
+	UBaseType_t uxReady;
+	uint32_t ulFlags;
+	xNetworkBufferDescriptor_t *pxNetworkBuffer;
+
+	for(uxReady = 0; uxReady < ipconfigETHERNET_DRIVER_RX_BUDGET && pxBufferDescriptor != NULL; uxReady++)
+	{
+		ulFlags = BYTE_SWAP(pxBufferDescriptor->flags_pktlen);
+		if((ulFlags & EMAC_BUF_DESC_OWNER) == EMAC_BUF_DESC_OWNER)
+		{
+			break;
+		}
+
+		pxNetworkBuffer = pxRxChannel->ppxNetworkBuffers[pxBufferDescriptor - pxRxChannel->pxFirstBufferDescriptor];
+		_dcacheInvalidateRange_((uint32_t)pxNetworkBuffer->pucEthernetBuffer, (uint32_t)pxNetworkBuffer->pucEthernetBuffer + (ulFlags & 0xffff));
+
+		/* A lnc vge (NEXT = NULL) a menet vge is */
+		pxBufferDescriptor = (volatile emac_rx_bd_t *)BYTE_SWAP((uint32_t)pxBufferDescriptor->next);
+	}
+
+	return uxReady;
+}
+
+/** ***************************************************************************************************
+* @fn static BaseType_t prvEmacRxIsTimeCritical(const uint8_t *pucEthernetBuffer, size_t xLength)
+* @brief Tells whether a received frame belongs to the time synchronisation (NTP, PTP over UDP or Ethernet).
+* @details
+* These frames may use the network buffer reserve of their RX channel, so bulk traffic filling the pool
+* cannot delay the time synchronisation. The UDP header is found through the IHL field, and only read when the
+* frame is long enough and is not a non-first fragment.
+*/
+static BaseType_t prvEmacRxIsTimeCritical(const uint8_t *pucEthernetBuffer, size_t xLength)
+{
+	const EthernetHeader_t *pxEthernetHeader = (const EthernetHeader_t *)pucEthernetBuffer;
+	const IPHeader_t *pxIPHeader = (const IPHeader_t *)(pucEthernetBuffer + ipSIZE_OF_ETH_HEADER);
+	const UDPHeader_t *pxUDPHeader;
+	size_t xIPHeaderLength;
+	uint16_t usPort;
+
+	if(xLength < ipSIZE_OF_ETH_HEADER)
+	{
+		return pdFALSE;
+	}
+	if(pxEthernetHeader->usFrameType == FreeRTOS_htons(EMAC_RX_PTP_FRAME_TYPE))
+	{
+		return pdTRUE;
+	}
+	if(pxEthernetHeader->usFrameType != ipIPv4_FRAME_TYPE || xLength < ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER)
+	{
+		return pdFALSE;
+	}
+
+	/* IP opcik esetn a fejlc hosszabb; a portok csak a nem tredkelt, vagy az els tredkben vannak */
+	xIPHeaderLength = (size_t)(pxIPHeader->ucVersionHeaderLength & 0x0FU) * 4U;
+	if(pxIPHeader->ucProtocol != ipPROTOCOL_UDP || xIPHeaderLength < ipSIZE_OF_IPv4_HEADER ||
+	   (FreeRTOS_ntohs(pxIPHeader->usFragmentOffset) & EMAC_RX_IP_FRAGMENT_OFFSET) != 0U ||
+	   xLength < ipSIZE_OF_ETH_HEADER + xIPHeaderLength + ipSIZE_OF_UDP_HEADER)
+	{
+		return pdFALSE;
+	}
+	pxUDPHeader = (const UDPHeader_t *)(pucEthernetBuffer + ipSIZE_OF_ETH_HEADER + xIPHeaderLength);
+
+	usPort = FreeRTOS_ntohs(pxUDPHeader->usDestinationPort);
+	if(usPort == EMAC_RX_NTP_PORT || usPort == EMAC_RX_PTP_EVENT_PORT || usPort == EMAC_RX_PTP_GENERAL_PORT)
+	{
+		return pdTRUE;
+	}
+
+	/* NTP vlasz: a forrs port 123 */
+	return (FreeRTOS_ntohs(pxUDPHeader->usSourcePort) == EMAC_RX_NTP_PORT) ? pdTRUE : pdFALSE;
+}
+
+/** ***************************************************************************************************
+* @fn static void prvEmacRxDeliver(xNetworkBufferDescriptor_t *pxFirstBuffer)
+* @brief Passes received frames to the IP task with one eNetworkRxEvent.
+* @details
+* With ipconfigUSE_LINKED_RX_MESSAGES the frames are chained through pxNextBuffer and the IP task walks the
+* chain, so a whole sweep of the ring costs one queue send and one context switch. If the event queue is
+* full every buffer of the chain is released.
+*/
+static void prvEmacRxDeliver(xNetworkBufferDescriptor_t *pxFirstBuffer)
+{
+	xIPStackEvent_t xRxEvent;								/* A FreeRTOS-Plus-TCP esemny lerja */
+#if(ipconfigUSE_LINKED_RX_MESSAGES != 0)
+	xNetworkBufferDescriptor_t *pxNextBuffer;
+#endif
+
+	/* The event about to be sent to the TCP/IP is an Rx event. */
+	xRxEvent.eEventType = eNetworkRxEvent;
+
+	/* pvData is used to point to the network buffer descriptor that references the received data. */
+	xRxEvent.pvData = (void *) pxFirstBuffer;
+
+	if(xSendEventStructToIPTask(&xRxEvent, 0) == pdFALSE)
+	{
+		/* Nem sikerlt tadni a puffer(eke)t, ezrt felszabadtjuk */
+#if(ipconfigUSE_LINKED_RX_MESSAGES != 0)
+		while(pxFirstBuffer != NULL)
+		{
+			pxNextBuffer = pxFirstBuffer->pxNextBuffer;
+			pxFirstBuffer->pxNextBuffer = NULL;
+			vReleaseNetworkBufferAndDescriptor(pxFirstBuffer);
+			pxFirstBuffer = pxNextBuffer;
+		}
+#else
+		vReleaseNetworkBufferAndDescriptor(pxFirstBuffer);
+#endif
+
+		/* s logoljuk az esemnyt.. */
+		iptraceETHERNET_RX_EVENT_LOST();
+	}
+	else
+	{
+		/* The message was successfully sent to the TCP/IP stack.
+		Call the standard trace macro to log the occurrence. */
+		iptraceNETWORK_INTERFACE_RECEIVE();
+	}
+}
+
 /** ***************************************************************************************************
 * @fn void prvEmacRxTask(void *pvParameters)
 * @brief defered EMAC RX interrupt handler task.
+* @details
+* Zero-copy receive: the RX BDs point into network buffers of the stack. A filled buffer is passed to the
+* IP task as it is and the BD is re-armed with a fresh network buffer. If no fresh buffer is available
+* the frame is dropped and the BD keeps its buffer, so the ring never runs empty.
+*
+* A pass handles at most ipconfigETHERNET_DRIVER_RX_BUDGET frames. When a pass handles at least
+* ipconfigETHERNET_DRIVER_RX_POLL_THRESHOLD frames the RX interrupt is masked and the ring is polled every
+* ipconfigETHERNET_DRIVER_RX_POLL_PERIOD ticks, so a flood of small frames cannot keep the CPU in the ISR and
+* the task; the frames the task cannot take in time are dropped (or paused) by the EMAC itself. The first poll
+* that finds the ring empty unmasks the interrupt again.
+*
+* Every RX channel has a task of its own (pvParameters: its xEMACRxChannel_t). A frame is passed to the stack only
+* if more than uxReservedBuffers network buffers stay free, except the time critical frames.
 */
 void prvEmacRxTask(void *pvParameters)
 {
 	hdkif_t *hdkif = &hdkif_data[0U];						/* EMAC pointerek */
-	volatile rxch_t *pxRxChannelDMA = &(hdkif->rxchptr);	/* RX DMA pointerek */
+	xEMACRxChannel_t *pxRxChannel = (xEMACRxChannel_t *)pvParameters;	/* A taszkhoz tartoz RX csatorna */
 	volatile emac_rx_bd_t *pxCurrentBufferDescriptor; 		/* Az aktulis host feldolgozs alatt ll BD cme */
 	volatile emac_rx_bd_t *pxCurrentBufferDescTemp; 		/* Az aktulis host feldolgozs alatt ll BD cmnek mentsre szolgll vltoz */
     volatile emac_rx_bd_t *pxTailBufferDescriptor;			/* A lncolt lista utols eleme (NEXT = NULL) */
     unsigned int xPacketSize;								/* Az rkezett csomag mrete byte-okban */
+    uint32_t ulFlags;										/* Az aktulis BD flag-jei */
+    uint32_t ulSlot;										/* Az aktulis BD indexe a gyrben */
     xNetworkBufferDescriptor_t *pxBufferDescriptor;			/* A FreeRTOS-Plus-TCP csomaglerja, ezen keresztl kerl tadsra az rkezett csomag */
-    xIPStackEvent_t xRxEvent;								/* A FreeRTOS-Plus-TCP esemny lerja */
+    xNetworkBufferDescriptor_t *pxNewBufferDescriptor;		/* Az tadott puffer helyre kerl j hlzati puffer */
+#if(ipconfigUSE_LINKED_RX_MESSAGES != 0)
+    xNetworkBufferDescriptor_t *pxChainHead;				/* Az aktulis menetben vett csomagok lnca (pxNextBuffer) */
+    xNetworkBufferDescriptor_t *pxChainTail;
+#endif
+    UBaseType_t uxProcessed;								/* Az aktulis menetben feldolgozott BD-k szma */
+    UBaseType_t uxReady;									/* Az aktulis menetben invalidlt (feldolgozhat) BD-k szma */
+    BaseType_t xPolling = pdFALSE;							/* pdTRUE: polling md, az RX megszakts tiltva */
+#if(ipconfigUSE_RX_TIMESTAMPS != 0)
+    uint32_t ulRxTimestamp;									/* A menet csomagjainak idblyege (RTIFRC0 | 1, a 0 jelentse: nincs) */
+#endif
 
-    pxCurrentBufferDescriptor = pxRxChannelDMA->active_head;
-    pxTailBufferDescriptor = (emac_rx_bd_t *)(0xfc521130);
+    pxCurrentBufferDescriptor = pxRxChannel->pxFirstBufferDescriptor;
+    pxTailBufferDescriptor = pxRxChannel->pxFirstBufferDescriptor + (pxRxChannel->ulBufferDescriptorCount - 1U);
 
     while(1)
     {
-    	if(ulTaskNotifyTake(pdTRUE, ipconfigETHERNET_DRIVER_RX_TASK_BLOCK_TIME) > 0)
+    	if(xPolling != pdFALSE)
+    	{
+    		vTaskDelay(ipconfigETHERNET_DRIVER_RX_POLL_PERIOD);
+    	}
+
+    	if(xPolling != pdFALSE || ulTaskNotifyTake(pdTRUE, ipconfigETHERNET_DRIVER_RX_TASK_BLOCK_TIME) > 0)
 		{
-			while(1)
+#if(ipconfigUSE_LINKED_RX_MESSAGES != 0)
+			pxChainHead = NULL;
+			pxChainTail = NULL;
+#endif
+#if(ipconfigUSE_RX_TIMESTAMPS != 0)
+			/* Megszaktsos mdban a megszakts ideje, polling mdban a menet kezdete */
+			ulRxTimestamp = ((xPolling != pdFALSE) ? RTI_FRC0_REG : pxRxChannel->ulInterruptTimestamp) | 1U;
+#endif
+			/* Az EMAC ltal mr tadott BD-k puffereit a menet elejn egyben invalidljuk, csak ezeket dolgozzuk fel */
+			uxReady = prvEmacRxInvalidateSweep(pxRxChannel, pxCurrentBufferDescriptor);
+
+			for(uxProcessed = 0; uxProcessed < uxReady; uxProcessed++)
 			{
-				/* Megnzzk mekkora csomag rkezett */
-				xPacketSize = BYTE_SWAP(pxCurrentBufferDescriptor->flags_pktlen) & 0xffff;
+				ulFlags = BYTE_SWAP(pxCurrentBufferDescriptor->flags_pktlen);
 
-				/* Invalidljuk a cache-t, hogy az memriban lv j csomagba ne zavarjon bele */
-				_dcacheInvalidateRange_(BYTE_SWAP((uint32_t)pxCurrentBufferDescriptor->bufptr), BYTE_SWAP((uint32_t)pxCurrentBufferDescriptor->bufptr) + xPacketSize);
+				ulSlot = (uint32_t)(pxCurrentBufferDescriptor - pxRxChannel->pxFirstBufferDescriptor);
+				pxBufferDescriptor = pxRxChannel->ppxNetworkBuffers[ulSlot];
 
-				/* Csak akkor llunk neki feldolgozni a csomagot, ha az EMAC tadta az adott BD-t s a SOP (Start Of Packet bit is be van lltva */
-				if((BYTE_SWAP(pxCurrentBufferDescriptor->flags_pktlen) & EMAC_BUF_DESC_OWNER) != EMAC_BUF_DESC_OWNER && (BYTE_SWAP(pxCurrentBufferDescriptor->flags_pktlen) & EMAC_BUF_DESC_SOP) == EMAC_BUF_DESC_SOP)
-				{
-    				if(xEMACDriverLoggingLevel > 1)FreeRTOS_debug_printf(("EMACRX: Packet arrived, BD: %p, RXHP: %p\r\n", pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER))));
+				/* Megnzzk mekkora csomag rkezett */
+				xPacketSize = ulFlags & 0xffff;
 
-					if((BYTE_SWAP(pxCurrentBufferDescriptor->flags_pktlen) & EMAC_BUF_DESC_EOP) != EMAC_BUF_DESC_EOP)
-					{
-						FreeRTOS_debug_printf(("EMACRX: NO EOP: %p, RXHP: %p\r\n", pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER))));
-						// Itt mit kne csinlni ??
-					}
+				if(xEMACDriverLoggingLevel > 1)FreeRTOS_debug_printf(("EMACRX: Packet arrived, BD: %p, RXHP: %p\r\n", pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(pxRxChannel->ulChannel))));
 
+				/* Egy pufferbe mindig teljes keret fr, SOP s EOP nlkli BD csak hibs keretnl fordulhat el */
+				if((ulFlags & (EMAC_BUF_DESC_SOP | EMAC_BUF_DESC_EOP)) != (EMAC_BUF_DESC_SOP | EMAC_BUF_DESC_EOP))
+				{
+					FreeRTOS_debug_printf(("EMACRX: NO SOP/EOP: %p, RXHP: %p\r\n", pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(pxRxChannel->ulChannel))));
+				}
+				else
+				{
+#if(ipconfigUSE_PCAP != 0)
+					/* Az eldobott keretek is a rgztsbe kerlnek */
+					vPCAPCaptureFrame(pxBufferDescriptor->pucEthernetBuffer, xPacketSize, pcapDIRECTION_RX);
+#endif
 					/* Csomagkezels */
-					if(eConsiderFrameForProcessing((const uint8_t *)BYTE_SWAP((uint32_t)pxCurrentBufferDescriptor->bufptr)) == eProcessBuffer)
+					if(eConsiderFrameForProcessing(pxBufferDescriptor->pucEthernetBuffer) == eProcessBuffer)
 					{
-						if(xEMACDriverLoggingLevel > 1)FreeRTOS_debug_printf(("EMACRX: BD processing: %p, RXHP: %p\r\n", pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER))));
+						if(xEMACDriverLoggingLevel > 1)FreeRTOS_debug_printf(("EMACRX: BD processing: %p, RXHP: %p\r\n", pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(pxRxChannel->ulChannel))));
 
-						/* Krnk a FreeRTOS+TCP stack-tl egy megfelel mret leirt s puffert */
-						pxBufferDescriptor = pxGetNetworkBufferWithDescriptor(xPacketSize, (TickType_t)ipconfigTCP_MAX_RECV_BLOCK_TIME_TICKS);
-
-						if(pxBufferDescriptor != NULL)
+						/* j puffer a BD szmra; ha nincs (vagy a csatorna tartalka fogyna), a keretet eldobjuk s a rgi puffer marad a BD-ben. */
+						if(uxGetNumberOfFreeNetworkBuffers() > pxRxChannel->uxReservedBuffers || prvEmacRxIsTimeCritical(pxBufferDescriptor->pucEthernetBuffer, xPacketSize) != pdFALSE)
 						{
+							pxNewBufferDescriptor = pxGetNetworkBufferWithDescriptor(ipTOTAL_ETHERNET_FRAME_SIZE, (TickType_t)0);
+						}
+						else
+						{
+							pxNewBufferDescriptor = NULL;
+						}
 
-		    				if(xEMACDriverLoggingLevel > 1)FreeRTOS_debug_printf(("EMACRX: Network buffer allocated. NP: %p, BD: %p, RXHP: %p\r\n", pxBufferDescriptor, pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER))));
+						if(pxNewBufferDescriptor != NULL)
+						{
+		    				if(xEMACDriverLoggingLevel > 1)FreeRTOS_debug_printf(("EMACRX: Network buffer allocated. NP: %p, BD: %p, RXHP: %p\r\n", pxNewBufferDescriptor, pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(pxRxChannel->ulChannel))));
 
-		    				memcpy((void *)pxBufferDescriptor->pucEthernetBuffer,(void *)(BYTE_SWAP(pxCurrentBufferDescriptor->bufptr)),xPacketSize);
+							pxRxChannel->ppxNetworkBuffers[ulSlot] = pxNewBufferDescriptor;
 							pxBufferDescriptor->xDataLength = xPacketSize;
+#if(ipconfigUSE_RX_TIMESTAMPS != 0)
+							pxBufferDescriptor->ulRxTimestamp = ulRxTimestamp;
+#endif
 
-							/* The event about to be sent to the TCP/IP is an Rx event. */
-							xRxEvent.eEventType = eNetworkRxEvent;
-
-							/* pvData is used to point to the network buffer descriptor that references the received data. */
-							xRxEvent.pvData = (void *) pxBufferDescriptor;
-
-							/* tadjuk feldolgozsra a kapcsott csomagot */
-							if(xSendEventStructToIPTask(&xRxEvent, 0) == pdFALSE)
+#if(ipconfigUSE_LINKED_RX_MESSAGES != 0)
+							/* A csomagot a menet lncnak vgre fzzk, a lncot a menet vgn egyben adjuk t */
+							pxBufferDescriptor->pxNextBuffer = NULL;
+							if(pxChainHead == NULL)
 							{
-								/* Nem sikerlt tadni a puffert, ezrt felszabadtjuk*/
-								vReleaseNetworkBufferAndDescriptor(pxBufferDescriptor);
-
-								/* s logoljuk az esemnyt.. */
-								iptraceETHERNET_RX_EVENT_LOST();
+								pxChainHead = pxBufferDescriptor;
 							}
 							else
 							{
-								/* The message was successfully sent to the TCP/IP stack.
-								Call the standard trace macro to log the occurrence. */
-								iptraceNETWORK_INTERFACE_RECEIVE();
+								pxChainTail->pxNextBuffer = pxBufferDescriptor;
 							}
+							pxChainTail = pxBufferDescriptor;
+#else
+							/* tadjuk feldolgozsra a kapcsott csomagot */
+							prvEmacRxDeliver(pxBufferDescriptor);
+#endif
+							pxBufferDescriptor = pxNewBufferDescriptor;
 						}
 						else
 						{
+							pxRxChannel->ulDroppedFrames++;
 							FreeRTOS_debug_printf(("EMACRX: No more free pxBufferDescriptor.\n\r"));
 						}
 					}
 					else
 					{
-						if(xEMACDriverLoggingLevel > 0)FreeRTOS_debug_printf(("EMACRX: BD %p dropped, RXHP: %p\r\n", pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER))));
+						if(xEMACDriverLoggingLevel > 0)FreeRTOS_debug_printf(("EMACRX: BD %p dropped, RXHP: %p\r\n", pxCurrentBufferDescriptor, HWREG(hdkif->emac_base + EMAC_RXHDP(pxRxChannel->ulChannel))));
 					}
+				}
 
-					/* Aktulis BD felszabadtsa */
-					pxCurrentBufferDescriptor->bufoff_len = BYTE_SWAP(ipTOTAL_ETHERNET_FRAME_SIZE);
-					pxCurrentBufferDescriptor->flags_pktlen = BYTE_SWAP(EMAC_BUF_DESC_OWNER);
-					pxCurrentBufferDescTemp = (emac_rx_bd_t *)BYTE_SWAP((uint32_t)pxCurrentBufferDescriptor->next);
-					pxCurrentBufferDescriptor->next = NULL;
+				/* Aktulis BD felszabadtsa (jralests a hozz tartoz pufferrel) */
+				prvEmacRxArmBufferDescriptor(pxCurrentBufferDescriptor, pxBufferDescriptor);
+				pxCurrentBufferDescTemp = (emac_rx_bd_t *)BYTE_SWAP((uint32_t)pxCurrentBufferDescriptor->next);
+				pxCurrentBufferDescriptor->next = NULL;
 
-					/* Jelezzk a Threshold mehanizmus szmra, hogy felszabadult egy puffer. */
-					if(HWREG(hdkif->emac_base + EMAC_RXFREEBUFFER(EMAC_CHANNELNUMBER)) < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS)HWREG(hdkif->emac_base + EMAC_RXFREEBUFFER(EMAC_CHANNELNUMBER)) = 1;
+				/* Jelezzk a Threshold mehanizmus szmra, hogy felszabadult egy puffer. */
+				if(HWREG(hdkif->emac_base + EMAC_RXFREEBUFFER(pxRxChannel->ulChannel)) < pxRxChannel->ulBufferDescriptorCount)HWREG(hdkif->emac_base + EMAC_RXFREEBUFFER(pxRxChannel->ulChannel)) = 1;
 
-					/* A lncolt lista vgt frisstjk az pp felszabadtott BD cmvel */
-					pxTailBufferDescriptor->next = (emac_rx_bd_t *)BYTE_SWAP((uint32_t)pxCurrentBufferDescriptor);
+				/* A lncolt lista vgt frisstjk az pp felszabadtott BD cmvel */
+				pxTailBufferDescriptor->next = (emac_rx_bd_t *)BYTE_SWAP((uint32_t)pxCurrentBufferDescriptor);
 
-					/* Ellenrzzk, hogy idkzben nem hasznlta e fel az EMAC a lnc vgt is, ebben az esetben az EOQ bit be van lltva */
-					if((BYTE_SWAP(pxTailBufferDescriptor->flags_pktlen) & EMAC_BUF_DESC_EOQ) == EMAC_BUF_DESC_EOQ)
-					{
-						while(HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER)) != 0);
-						HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER)) = (uint32_t)pxCurrentBufferDescriptor;
-						if(xEMACDriverLoggingLevel > 0)FreeRTOS_debug_printf(("EMACRX: RX restarted at BD: %p\r\n", pxCurrentBufferDescriptor));
-					}
-					pxTailBufferDescriptor = pxCurrentBufferDescriptor;
-					pxCurrentBufferDescriptor = pxCurrentBufferDescTemp;
+				/* Ellenrzzk, hogy idkzben nem hasznlta e fel az EMAC a lnc vgt is, ebben az esetben az EOQ bit be van lltva */
+				if((BYTE_SWAP(pxTailBufferDescriptor->flags_pktlen) & EMAC_BUF_DESC_EOQ) == EMAC_BUF_DESC_EOQ)
+				{
+					while(HWREG(hdkif->emac_base + EMAC_RXHDP(pxRxChannel->ulChannel)) != 0);
+					HWREG(hdkif->emac_base + EMAC_RXHDP(pxRxChannel->ulChannel)) = (uint32_t)pxCurrentBufferDescriptor;
+					if(xEMACDriverLoggingLevel > 0)FreeRTOS_debug_printf(("EMACRX: RX restarted at BD: %p\r\n", pxCurrentBufferDescriptor));
 				}
-				else
+				pxTailBufferDescriptor = pxCurrentBufferDescriptor;
+				pxCurrentBufferDescriptor = pxCurrentBufferDescTemp;
+			}
+
+#if(ipconfigUSE_LINKED_RX_MESSAGES != 0)
+			/* A menetben vett sszes csomag egyetlen eNetworkRxEvent-tel kerl az IP taszkhoz */
+			if(pxChainHead != NULL)
+			{
+				prvEmacRxDeliver(pxChainHead);
+			}
+#endif
+
+			if(xPolling == pdFALSE)
+			{
+				if(uxProcessed >= ipconfigETHERNET_DRIVER_RX_POLL_THRESHOLD)
 				{
-					break;
+					/* Nagy terhels: az RX megszaktst tiltjuk, a gyrt periodikusan olvassuk */
+					prvEmacRxChannelIntDisable(pxRxChannel->ulChannel);
+					xPolling = pdTRUE;
+					if(xEMACDriverLoggingLevel > 1)FreeRTOS_debug_printf(("EMACRX: polling mode\r\n"));
 				}
 			}
+			else if(uxProcessed == 0)
+			{
+				/* res gyr: vissza megszaktsos mdba. A kzben rkezett csomag miatt fgg megszakts azonnal kivltdik. */
+				prvEmacRxChannelIntEnable(pxRxChannel->ulChannel);
+				xPolling = pdFALSE;
+				if(xEMACDriverLoggingLevel > 1)FreeRTOS_debug_printf(("EMACRX: interrupt mode\r\n"));
+			}
 		}
 		else
 		{
 			/* Nem kaptunk szemafor-t az adott blocking time-on bell, de head pointer tovbb lpett az utols ellenrzs ta -> IRQ elveszett */
-			if(HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER)) == 0)
+			if(HWREG(hdkif->emac_base + EMAC_RXHDP(pxRxChannel->ulChannel)) == 0)
 			{
 				/* Ebben az esetben jraindtjuk az EMAC vtelt a head pointer rsval */
-				HWREG(hdkif->emac_base + EMAC_RXHDP(EMAC_CHANNELNUMBER)) = (uint32_t)pxCurrentBufferDescriptor;
+				HWREG(hdkif->emac_base + EMAC_RXHDP(pxRxChannel->ulChannel)) = (uint32_t)pxCurrentBufferDescriptor;
 				if(xEMACDriverLoggingLevel > 0)FreeRTOS_debug_printf(("EMACRX: RX restarted at BD: %p\r\n", pxCurrentBufferDescriptor));
 			}
 		}
@@ -711,14 +1359,23 @@ uint32 xFreeRTOSEMACHWInit(uint8_t macaddr[6U])
         HWREG(hdkif->emac_base + EMAC_TXCP(i)) = 0U;
     }
 
-    /* Flow control hasznlathoz szksges regiszterek belltsa csak a hasznlt csatornn. */
-    HWREG(hdkif->emac_base + EMAC_RXFREEBUFFER(EMAC_CHANNELNUMBER)) = ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
-    HWREG(hdkif->emac_base + EMAC_RXFLOWTHRESH(EMAC_CHANNELNUMBER)) &= (0x0U);
+    /* Flow control hasznlathoz szksges regiszterek belltsa. Kszb csak a unicast csatornn van,
+    egy broadcast vihar gy nem kldhet PAUSE kereteket. */
+    for(i = 0; i < EMAC_RX_CHANNEL_COUNT; i++)
+    {
+    	HWREG(hdkif->emac_base + EMAC_RXFREEBUFFER(xEMACRxChannels[i].ulChannel)) = xEMACRxChannels[i].ulBufferDescriptorCount;
+    	HWREG(hdkif->emac_base + EMAC_RXFLOWTHRESH(xEMACRxChannels[i].ulChannel)) = 0U;
+    }
     HWREG(hdkif->emac_base + EMAC_RXFLOWTHRESH(EMAC_CHANNELNUMBER)) |= ipconfigRX_FLOWCONTROL_START_LEVEL;
 	#if(ipconfigETHERNET_DRIVER_RX_FLOW_CONTROLL == 1)
     HWREG(hdkif->emac_base + EMAC_MACCONTROL) |= EMAC_MACCONTROL_RXBUFFERFLOWEN;			/* Flow control engedlyezse */
 	#endif
 
+	#if(ipconfigUSE_TX_PRIORITY != 0)
+    /* Fixed-priority TX channel selection (channel 7 highest), the high priority channel always goes first. */
+    EMACTxPrioritySelect(hdkif->emac_base, 1U);
+	#endif
+
     /* Valamennyi csatornn tiltjuk a TX/RX megszaktsokat */
     HWREG(hdkif->emac_base + EMAC_TXINTMASKCLEAR) = 0xFFU;
     HWREG(hdkif->emac_base + EMAC_RXINTMASKCLEAR) = 0xFFU;
@@ -730,12 +1387,17 @@ uint32 xFreeRTOSEMACHWInit(uint8_t macaddr[6U])
     /* AZ RX descriptorok SOP mezjnek offset rtke. */
     HWREG(hdkif->emac_base + EMAC_RXBUFFEROFFSET) = 0U;
 
+    /* Az MDIO a PTP ra kezeljvel kzs, a PHY elrsek a zrral vdve (a link belltsig). */
+    /* MDIO is shared with the PTP clock code, the PHY accesses below hold its lock up to the link setup. */
+	vPTPClockMDIOTake();
+
     /* Az MDIO modul inicializlsa, State Machine engedlyezse, clock belltsa. */
 	MDIOInit(hdkif->mdio_base, MDIO_FREQ_INPUT, MDIO_FREQ_OUTPUT);
 
 	/* az MDIO init kzben van id belltani az EMAC MAC cmeket. */
 	EMACMACSrcAddrSet(hdkif->emac_base, hdkif->mac_addr);
-	for(i=0;i<8U;i++){EMACMACAddrSet(hdkif->emac_base, i, hdkif->mac_addr, EMAC_MACADDR_MATCH);}
+	/* Csak a unicast csatornhoz rendeljk a MAC cmet, a unicast keretek mind oda kerlnek */
+	EMACMACAddrSet(hdkif->emac_base, (uint32)EMAC_CHANNELNUMBER, hdkif->mac_addr, EMAC_MACADDR_MATCH);
 
 	/* PHY ID kiolvassa */
 	do
@@ -760,6 +1422,7 @@ uint32 xFreeRTOSEMACHWInit(uint8_t macaddr[6U])
 	{
 		xReturn = EMAC_ERR_CONNECT;
 	}
+	vPTPClockMDIOGive();
 
 	/* RX s TX Buffer Descriptorok kialaktsa */
 	if(xFirstInit)
@@ -769,7 +1432,7 @@ uint32 xFreeRTOSEMACHWInit(uint8_t macaddr[6U])
 		}
 
 	EMACMIIEnable(hdkif->emac_base);
-	EMACRxBroadCastEnable(hdkif->emac_base, (uint32)EMAC_CHANNELNUMBER);
+	EMACRxBroadCastEnable(hdkif->emac_base, xEMACRxChannels[EMAC_RX_CHANNEL_COUNT - 1U].ulChannel);	/* Az utols RX csatorna a broadcast- */
 	EMACRxUnicastSet(hdkif->emac_base, (uint32)EMAC_CHANNELNUMBER);
 	EMACDisableLoopback(hdkif->emac_base);
 
@@ -788,7 +1451,10 @@ static void prvEmacDMAInit(hdkif_t *hdkif)
       txch_t *pxTxChannelDMA;
       rxch_t *pxRxChannelDMA;
 	  volatile emac_rx_bd_t *pxCurrentBD;			/* BD linkelt lista buffer kialaktshoz az aktulis elem cme */
-	  unsigned int i;
+	  unsigned int i, j;
+#if(ipconfigZERO_COPY_TX_DRIVER == 0)
+	  unsigned int ulTxBuffer = 0U;
+#endif
 
 	  pxTxChannelDMA = &(hdkif->txchptr);
 	  pxRxChannelDMA = &(hdkif->rxchptr);
@@ -798,36 +1464,46 @@ static void prvEmacDMAInit(hdkif_t *hdkif)
 	  pxTxChannelDMA->next_bd_to_process = (void *)pxCurrentBD;
 	  pxTxChannelDMA->active_tail = NULL;
 
-	  /* TX Buffer descriptor lncolt lista kialaktsa */
-      for(i = 0; i < EMAC_TXDMA_PBUF_ALLOC; i++)
+	  /* TX Buffer descriptor lncolt lista kialaktsa (valamennyi TX csatornra) */
+      for(j = 0; j < EMAC_TX_CHANNEL_COUNT; j++)
       {
-    	  pxCurrentBD->next = NULL;	/* lncolt lista vge */
-    	  pxCurrentBD->bufptr = BYTE_SWAP((uint32)pvPortMalloc(ipTOTAL_ETHERNET_FRAME_SIZE));
-    	  pxCurrentBD->bufoff_len = BYTE_SWAP(ipTOTAL_ETHERNET_FRAME_SIZE);
-    	  pxCurrentBD->flags_pktlen = 0;
-    	  pxCurrentBD++;
+    	  pxCurrentBD = (void *)xEMACTxChannels[j].pxFirstBufferDescriptor;
+    	  for(i = 0; i < xEMACTxChannels[j].ulBufferDescriptorCount; i++)
+    	  {
+    		  pxCurrentBD->next = NULL;	/* lncolt lista vge */
+#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+    		  pxCurrentBD->bufptr = NULL;	/* Zero-copy klds: a hlzati puffert a kldskor kapja meg */
+#else
+    		  pxCurrentBD->bufptr = BYTE_SWAP((uint32)ucEMACTxBuffers[ulTxBuffer++]);
+#endif
+    		  pxCurrentBD->bufoff_len = BYTE_SWAP(ipTOTAL_ETHERNET_FRAME_SIZE);
+    		  pxCurrentBD->flags_pktlen = 0;
+    		  pxCurrentBD++;
+    	  }
       }
 
       pxCurrentBD = (void *)EMAC_RXDMA_PBUF_START_ADDRESS;
-
-      /* RX Buffer descriptor lncolt lista kialaktsa */
       pxRxChannelDMA->active_head = pxRxChannelDMA->active_tail = pxRxChannelDMA->free_head = pxCurrentBD;
-      for(i = 0; i < EMAC_RXDMA_PBUF_ALLOC; i++)
-      {
-    	  if (i < (EMAC_RXDMA_PBUF_ALLOC - 1))pxCurrentBD->next = (emac_rx_bd_t *)BYTE_SWAP((uint32)(pxCurrentBD + 1));
-    	  else pxCurrentBD->next = NULL;	/* Lncolt lista vge */
-
-    	  //TODO: Hibakeresshez malloc() hasznlata
-    	  pxCurrentBD->bufptr = BYTE_SWAP((uint32)pvPortMalloc(ipTOTAL_ETHERNET_FRAME_SIZE));
 
-    	  //pxCurrentBD->bufoff_len = BYTE_SWAP(MAX_TRANSFER_UNIT);
-    	  pxCurrentBD->bufoff_len = BYTE_SWAP(ipTOTAL_ETHERNET_FRAME_SIZE);
-    	  pxCurrentBD->flags_pktlen = BYTE_SWAP(EMAC_BUF_DESC_OWNER);
-    	  pxCurrentBD++;
+      /* RX Buffer descriptor lncolt lista kialaktsa (valamennyi RX csatornra, egyms utn) */
+      for(j = 0; j < EMAC_RX_CHANNEL_COUNT; j++)
+      {
+    	  pxCurrentBD = xEMACRxChannels[j].pxFirstBufferDescriptor;
+    	  for(i = 0; i < xEMACRxChannels[j].ulBufferDescriptorCount; i++)
+    	  {
+    		  if (i < (xEMACRxChannels[j].ulBufferDescriptorCount - 1))pxCurrentBD->next = (emac_rx_bd_t *)BYTE_SWAP((uint32)(pxCurrentBD + 1));
+    		  else pxCurrentBD->next = NULL;	/* Lncolt lista vge */
+
+    		  /* Zero-copy vtel: a BD-k a stack hlzati puffereibe rnak */
+    		  xEMACRxChannels[j].ppxNetworkBuffers[i] = pxGetNetworkBufferWithDescriptor(ipTOTAL_ETHERNET_FRAME_SIZE, (TickType_t)0);
+    		  configASSERT(xEMACRxChannels[j].ppxNetworkBuffers[i]);
+    		  prvEmacRxArmBufferDescriptor(pxCurrentBD, xEMACRxChannels[j].ppxNetworkBuffers[i]);
+    		  pxCurrentBD++;
+    	  }
       }
 
-      /* DMA BD maradk terlet nullzsa */
-      for(; i<(SIZE_EMAC_CTRL_RAM) / sizeof(emac_tx_bd_t); i++)
+      /* DMA BD maradk terlet nullzsa (a CPPI RAM RX fele) */
+      for(i = (uint32)(pxCurrentBD - (emac_rx_bd_t *)EMAC_RXDMA_PBUF_START_ADDRESS); i<(SIZE_EMAC_CTRL_RAM / 2) / sizeof(emac_rx_bd_t); i++)
       {
     	  pxCurrentBD->next = NULL;
     	  pxCurrentBD->bufptr = NULL;
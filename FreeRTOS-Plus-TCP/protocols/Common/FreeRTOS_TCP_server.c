@@ -64,6 +64,8 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "os_task.h"
+#include "os_queue.h"
+#include "os_semphr.h"
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
@@ -77,7 +79,22 @@
 #endif
 
 
-static void prvReceiveNewClient( TCPServer_t *pxServer, BaseType_t xIndex, Socket_t xNexSocket );
+/* The period after which select() is called again when it only reported
+sockets of clients that are still being worked on. */
+#define tcpserverBUSY_POLL_TICKS	pdMS_TO_TICKS( ipconfigTCP_SERVER_BUSY_POLL_MS )
+
+/* A task which works on the clients of one server, with its own buffers. */
+typedef struct xTCP_WORKER
+{
+	TCPServer_t *pxServer;
+	QueueHandle_t xWorkQueue;
+	TCPBuffers_t xBuffers;
+} TCPWorker_t;
+
+static void prvReceiveNewClient( TCPServer_t *pxServer, BaseType_t xIndex, Socket_t xNexSocket, TickType_t xBlockingTime );
+static BaseType_t prvCreateWorkers( TCPServer_t *pxServer, BaseType_t xIndex, const struct xSERVER_CONFIG *pxConfig );
+static void prvWorkerTask( void *pvParameters );
+static BaseType_t prvClientReady( xTCPClient *pxClient, TickType_t xBlockingTime );
 static char *strnew( const char *pcString );
 static void prvRemoveSlash( char *pcDir );
 
@@ -107,6 +124,13 @@ SocketSet_t xSocketSet;
 			pxServer->xServerCount = xCount;
 			pxServer->xSocketSet = xSocketSet;
 
+			#if( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+			{
+				pxServer->xHTTPCacheMutex = xSemaphoreCreateMutex();
+				configASSERT( pxServer->xHTTPCacheMutex != NULL );
+			}
+			#endif
+
 			for( xIndex = 0; xIndex < xCount; xIndex++ )
 			{
 			BaseType_t xPortNumber = pxConfigs[ xIndex ].xPortNumber;
@@ -154,6 +178,11 @@ SocketSet_t xSocketSet;
 						pxServer->xServers[ xIndex ].eType = pxConfigs[ xIndex ].eType;
 						pxServer->xServers[ xIndex ].pcRootDir = strnew( pxConfigs[ xIndex ].pcRootDir );
 						prvRemoveSlash( ( char * ) pxServer->xServers[ xIndex ].pcRootDir );
+
+						if( pxConfigs[ xIndex ].xWorkerCount > 0 )
+						{
+							prvCreateWorkers( pxServer, xIndex, &( pxConfigs[ xIndex ] ) );
+						}
 					}
 				}
 			}
@@ -174,7 +203,119 @@ SocketSet_t xSocketSet;
 }
 /*-----------------------------------------------------------*/
 
-static void prvReceiveNewClient( TCPServer_t *pxServer, BaseType_t xIndex, Socket_t xNexSocket )
+static BaseType_t prvCreateWorkers( TCPServer_t *pxServer, BaseType_t xIndex, const struct xSERVER_CONFIG *pxConfig )
+{
+QueueHandle_t xWorkQueue;
+TCPWorker_t *pxWorker;
+BaseType_t xWorker;
+BaseType_t xCreated = 0;
+const char *pcName = ( pxConfig->eType == eSERVER_HTTP ) ? "HTTPw" : "FTPw";
+
+	/* A client is in the queue at most once, and a server has at most
+	'xBackLog' clients. */
+	xWorkQueue = xQueueCreate( ( UBaseType_t ) pxConfig->xBackLog, sizeof( xTCPClient * ) );
+
+	if( xWorkQueue != NULL )
+	{
+		for( xWorker = 0; xWorker < pxConfig->xWorkerCount; xWorker++ )
+		{
+			pxWorker = ( TCPWorker_t * ) pvPortMallocLarge( sizeof( *pxWorker ) );
+
+			if( pxWorker == NULL )
+			{
+				break;
+			}
+
+			memset( pxWorker, '\0', sizeof( *pxWorker ) );
+			pxWorker->pxServer = pxServer;
+			pxWorker->xWorkQueue = xWorkQueue;
+
+			if( xTaskCreate( prvWorkerTask, pcName, ipconfigTCP_SERVER_WORKER_STACK_SIZE, ( void * ) pxWorker, pxConfig->uxWorkerPriority, NULL ) != pdPASS )
+			{
+				vPortFreeLarge( pxWorker );
+				break;
+			}
+
+			xCreated++;
+		}
+
+		if( xCreated != 0 )
+		{
+			pxServer->xServers[ xIndex ].xWorkQueue = xWorkQueue;
+		}
+		else
+		{
+			/* FreeRTOS_TCPServerWork() will work on the clients itself. */
+			vQueueDelete( xWorkQueue );
+		}
+	}
+
+	FreeRTOS_printf( ( "TCP-server: %ld %s workers\n", xCreated, pcName ) );
+
+	return xCreated;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void *pvParameters )
+{
+TCPWorker_t *pxWorker = ( TCPWorker_t * ) pvParameters;
+TCPServer_t *pxServer = pxWorker->pxServer;
+xTCPClient *pxClient;
+BaseType_t xRc;
+
+	for( ;; )
+	{
+		if( xQueueReceive( pxWorker->xWorkQueue, &pxClient, portMAX_DELAY ) != pdFALSE )
+		{
+			pxClient->pxBuffers = &( pxWorker->xBuffers );
+			xRc = pxClient->fWorkFunction( pxClient );
+
+			/* Hand the client back.  It may be deleted as soon as 'xBusy' is
+			cleared, so it is not touched after that. */
+			pxClient->xWorkResult = xRc;
+			pxClient->xBusy = pdFALSE;
+
+			if( pxServer->xServerTask != NULL )
+			{
+				xTaskNotifyGive( pxServer->xServerTask );
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvClientReady( xTCPClient *pxClient, TickType_t xBlockingTime )
+{
+SocketSet_t xSocketSet = pxClient->pxParent->xSocketSet;
+BaseType_t xReady = pdFALSE;
+
+	/* The work functions expect to be called regularly, also when nothing
+	happens, e.g. to send a greeting or to check a time-out. */
+	if( ( xTaskGetTickCount() - pxClient->xLastWork ) >= xBlockingTime )
+	{
+		xReady = pdTRUE;
+	}
+	else if( ( pxClient->xSocket != FREERTOS_NO_SOCKET ) && ( FreeRTOS_FD_ISSET( pxClient->xSocket, xSocketSet ) != 0 ) )
+	{
+		xReady = pdTRUE;
+	}
+	#if( ipconfigUSE_FTP != 0 )
+	else if( pxClient->eType == eSERVER_FTP )
+	{
+	xFTPClient *pxFTPClient = ( xFTPClient * ) pxClient;
+
+		if( ( pxFTPClient->xTransferSocket != FREERTOS_NO_SOCKET ) && ( FreeRTOS_FD_ISSET( pxFTPClient->xTransferSocket, xSocketSet ) != 0 ) )
+		{
+			xReady = pdTRUE;
+		}
+	}
+	#endif /* ipconfigUSE_FTP != 0 */
+
+	return xReady;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReceiveNewClient( TCPServer_t *pxServer, BaseType_t xIndex, Socket_t xNexSocket, TickType_t xBlockingTime )
 {
 xTCPClient *pxClient = NULL;
 BaseType_t xSize = 0;
@@ -226,6 +367,9 @@ const char *pcType = "Unknown";
 		pxClient->pxNextClient = pxServer->pxClients;
 		pxClient->fWorkFunction = fWorkFunc;
 		pxClient->fDeleteFunction = fDeleteFunc;
+		pxClient->xWorkQueue = pxServer->xServers[ xIndex ].xWorkQueue;
+		/* Work on it in the first cycle, the FTP server sends a greeting. */
+		pxClient->xLastWork = xTaskGetTickCount() - xBlockingTime;
 
 		pxServer->pxClients = pxClient;
 
@@ -249,11 +393,16 @@ void FreeRTOS_TCPServerWork( TCPServer_t *pxServer, TickType_t xBlockingTime )
 xTCPClient **ppxClient;
 BaseType_t xIndex;
 BaseType_t xRc;
+BaseType_t xSelected;
+BaseType_t xHandled = 0;
+
+	/* The workers will notify this task when they finish a client. */
+	pxServer->xServerTask = xTaskGetCurrentTaskHandle();
 
 	/* Let the server do one working cycle */
-	xRc = FreeRTOS_select( pxServer->xSocketSet, xBlockingTime );
+	xSelected = FreeRTOS_select( pxServer->xSocketSet, xBlockingTime );
 
-	if( xRc != 0 )
+	if( xSelected != 0 )
 	{
 		for( xIndex = 0; xIndex < pxServer->xServerCount; xIndex++ )
 		{
@@ -271,7 +420,8 @@ BaseType_t xRc;
 
 			if( ( xNexSocket != FREERTOS_NO_SOCKET ) && ( xNexSocket != FREERTOS_INVALID_SOCKET ) )
 			{
-				prvReceiveNewClient( pxServer, xIndex, xNexSocket );
+				prvReceiveNewClient( pxServer, xIndex, xNexSocket, xBlockingTime );
+				xHandled++;
 			}
 		}
 	}
@@ -282,22 +432,60 @@ BaseType_t xRc;
 	{
 	xTCPClient *pxThis = *ppxClient;
 
-		/* Almost C++ */
-		xRc = pxThis->fWorkFunction( pxThis );
+		if( pxThis->xBusy != pdFALSE )
+		{
+			/* A worker owns this client. */
+			ppxClient = &( pxThis->pxNextClient );
+			continue;
+		}
+
+		if( pxThis->xWorkQueue == NULL )
+		{
+			/* Almost C++ */
+			pxThis->pxBuffers = &( pxServer->xBuffers );
+			xRc = pxThis->fWorkFunction( pxThis );
+			xHandled++;
+		}
+		else
+		{
+			/* The result of the last call made by a worker. */
+			xRc = pxThis->xWorkResult;
+
+			if( ( xRc >= 0 ) && ( prvClientReady( pxThis, xBlockingTime ) != pdFALSE ) )
+			{
+				pxThis->xLastWork = xTaskGetTickCount();
+				pxThis->xBusy = pdTRUE;
+
+				if( xQueueSend( pxThis->xWorkQueue, &pxThis, 0u ) != pdPASS )
+				{
+					pxThis->xBusy = pdFALSE;
+				}
+				xHandled++;
+			}
+		}
 
 		if (xRc < 0 )
 		{
 			*ppxClient = pxThis->pxNextClient;
 			/* Close handles, resources */
+			pxThis->pxBuffers = &( pxServer->xBuffers );
 			pxThis->fDeleteFunction( pxThis );
 			/* Free the space */
 			vPortFreeLarge( pxThis );
+			xHandled++;
 		}
 		else
 		{
 			ppxClient = &( pxThis->pxNextClient );
 		}
 	}
+
+	if( ( xSelected != 0 ) && ( xHandled == 0 ) )
+	{
+		/* The events belong to clients which are still being worked on, and
+		select() would return immediately.  Wait for a worker to finish. */
+		ulTaskNotifyTake( pdTRUE, tcpserverBUSY_POLL_TICKS );
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -317,6 +505,76 @@ char *pxBuffer;
 }
 /*-----------------------------------------------------------*/
 
+BaseType_t FreeRTOS_sendfile( Socket_t xSocket, FF_FILE *pxFile, size_t uxCount )
+{
+uint8_t *pucBuffer = NULL;
+BaseType_t xLength = 0;
+BaseType_t xResult;
+size_t uxOffset = 0u;
+size_t uxChunk, uxRead;
+uint32_t ulSectorMask = ( uint32_t ) pxFile->pxIOManager->usSectorSize - 1ul;
+uint32_t ulEnd;
+
+	/* The free space of the TX stream wraps at most once, so this loop runs
+	once or twice, and a few more times when a read ends on a sector boundary
+	short of the wrap. */
+	while( uxOffset < uxCount )
+	{
+		/* Peek: the free space that follows what was read already. */
+		pucBuffer = FreeRTOS_get_tx_head_offset( xSocket, uxOffset, &xLength );
+
+		if( ( pucBuffer == NULL ) || ( xLength <= 0 ) )
+		{
+			break;
+		}
+
+		uxChunk = FreeRTOS_min_uint32( ( uint32_t ) xLength, ( uint32_t ) ( uxCount - uxOffset ) );
+
+		if( uxChunk < ( uxCount - uxOffset ) )
+		{
+			/* More reads will follow: end this one on a sector boundary of the
+			file, so the next starts aligned and FreeRTOS+FAT can transfer whole
+			sectors into the stream without passing its sector cache. */
+			ulEnd = ( pxFile->ulFilePointer + ( uint32_t ) uxChunk ) & ~ulSectorMask;
+
+			if( ulEnd > pxFile->ulFilePointer )
+			{
+				uxChunk = ( size_t ) ( ulEnd - pxFile->ulFilePointer );
+			}
+		}
+
+		uxRead = ff_fread( pucBuffer, 1, uxChunk, pxFile );
+		uxOffset += uxRead;
+
+		if( uxRead != uxChunk )
+		{
+			FreeRTOS_printf( ( "FreeRTOS_sendfile: Got %u Expected %u\n", ( unsigned ) uxRead, ( unsigned ) uxChunk ) );
+			break;
+		}
+	}
+
+	if( uxOffset > 0u )
+	{
+		/* Commit: with a NULL buffer, FreeRTOS_send() only moves the head of
+		the stream over the data read above.  It is done once, so a FIN requested
+		with FREERTOS_SO_CLOSE_AFTER_SEND will go with the last byte. */
+		xResult = FreeRTOS_send( xSocket, NULL, uxOffset, FREERTOS_MSG_DONTWAIT );
+	}
+	else if( ( pucBuffer != NULL ) && ( xLength > 0 ) )
+	{
+		/* There was space, but nothing could be read. */
+		xResult = -pdFREERTOS_ERRNO_EIO;
+	}
+	else
+	{
+		/* No space, or the socket can not be used: let FreeRTOS_send() tell. */
+		xResult = FreeRTOS_send( xSocket, NULL, 0u, FREERTOS_MSG_DONTWAIT );
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
 static void prvRemoveSlash( char *pcDir )
 {
 BaseType_t xLength = strlen( pcDir );
@@ -0,0 +1,507 @@
+/*
+	A small gzip encoder for FreeRTOS+FAT files, see FreeRTOS_gzip.h
+*/
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "os_task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_gzip.h"
+
+/* FreeRTOS+FAT includes. */
+#include "ff_stdio.h"
+
+#if !defined( ARRAY_SIZE )
+	#define ARRAY_SIZE(x) ( BaseType_t ) (sizeof ( x ) / sizeof ( x )[ 0 ] )
+#endif
+
+/* Matches are searched for in the last gzipWINDOW_SIZE bytes.  The buffer
+holds two windows: the history and the data still to be compressed. */
+#define gzipWINDOW_SIZE		( 4096u )
+#define gzipWINDOW_MASK		( gzipWINDOW_SIZE - 1u )
+#define gzipHASH_BITS		( 10u )
+#define gzipHASH_SIZE		( 1u << gzipHASH_BITS )
+#define gzipMIN_MATCH		( 3u )
+#define gzipMAX_MATCH		( 258u )
+#define gzipMIN_LOOKAHEAD	( gzipMAX_MATCH + gzipMIN_MATCH + 1u )
+#define gzipMAX_CHAIN		( 32u )		/* The maximum number of candidates for a match. */
+#define gzipGOOD_MATCH		( 64u )		/* Stop searching when a match is this long. */
+#define gzipOUTPUT_SIZE		( 512u )
+#define gzipNIL				( 0u )		/* The end of a hash chain. */
+
+typedef struct xGZIP_STATE
+{
+	uint8_t ucWindow[ 2u * gzipWINDOW_SIZE ];
+	uint16_t usHead[ gzipHASH_SIZE ];		/* The latest position for each hash value. */
+	uint16_t usPrev[ gzipWINDOW_SIZE ];		/* The previous position with the same hash value. */
+	uint8_t ucOutput[ gzipOUTPUT_SIZE ];
+	size_t uxOutputLength;
+	uint32_t ulBits;						/* Bits not yet written, LSB first. */
+	uint32_t ulBitCount;
+	FF_FILE *pxOutFile;
+	int32_t lWritten;
+	BaseType_t xError;
+} GzipState_t;
+
+static void prvPutByte( GzipState_t *pxState, uint8_t ucByte );
+static void prvFlush( GzipState_t *pxState );
+static void prvPutBits( GzipState_t *pxState, uint32_t ulValue, uint32_t ulCount );
+static void prvPutCode( GzipState_t *pxState, uint32_t ulCode, uint32_t ulLength );
+static void prvPutSymbol( GzipState_t *pxState, uint32_t ulSymbol );
+static void prvPutMatch( GzipState_t *pxState, uint32_t ulLength, uint32_t ulDistance );
+static uint32_t prvHash( const uint8_t *pucData );
+static void prvInsert( GzipState_t *pxState, size_t uxPos, size_t uxEnd );
+static size_t prvLongestMatch( GzipState_t *pxState, size_t uxPos, size_t uxEnd, size_t *puxDistance );
+static void prvSlide( GzipState_t *pxState );
+static uint32_t prvCRC32( uint32_t ulCRC, const uint8_t *pucData, size_t uxLength );
+
+/* The base values and the number of extra bits of the length codes 257..285
+and of the distance codes 0..29, RFC 1951 section 3.2.5. */
+static const uint16_t usLengthBase[ 29 ] =
+{
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t ucLengthExtra[ 29 ] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t usDistanceBase[ 30 ] =
+{
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t ucDistanceExtra[ 30 ] =
+{
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/* CRC-32 of gzip (polynomial 0xEDB88320), calculated per nibble. */
+static const uint32_t ulCRCTable[ 16 ] =
+{
+	0x00000000uL, 0x1DB71064uL, 0x3B6E20C8uL, 0x26D930ACuL,
+	0x76DC4190uL, 0x6B6B51F4uL, 0x4DB26158uL, 0x5005713CuL,
+	0xEDB88320uL, 0xF00F9344uL, 0xD6D6A3E8uL, 0xCB61B38CuL,
+	0x9B64C2B0uL, 0x86D3D2D4uL, 0xA00AE278uL, 0xBDBDF21CuL
+};
+
+/* The file types which are worth compressing. */
+static const char * const pcTextTypes[ ] =
+{
+	"html", "htm", "css", "js", "txt", "json", "svg", "xml", "csv"
+};
+
+int32_t FreeRTOS_gzip( const char *pcSource, const char *pcDestination )
+{
+/* ID1, ID2, CM = deflate, no flags, no time, no extra flags, OS unknown. */
+static const uint8_t ucHeader[ 10 ] = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff };
+GzipState_t *pxState;
+FF_FILE *pxInFile;
+uint32_t ulCRC = 0xFFFFFFFFuL, ulSize = 0uL;
+size_t uxPos = 0u, uxEnd = 0u, uxCount, uxLength, uxDistance = 0u, x;
+BaseType_t xEOF = pdFALSE;
+int32_t lResult;
+
+	pxState = ( GzipState_t * ) pvPortMallocLarge( sizeof( *pxState ) );
+
+	if( pxState == NULL )
+	{
+		return -pdFREERTOS_ERRNO_ENOMEM;
+	}
+
+	memset( pxState->usHead, '\0', sizeof( pxState->usHead ) );
+	memset( pxState->usPrev, '\0', sizeof( pxState->usPrev ) );
+	pxState->uxOutputLength = 0u;
+	pxState->ulBits = 0uL;
+	pxState->ulBitCount = 0uL;
+	pxState->lWritten = 0;
+	pxState->xError = pdFALSE;
+	pxState->pxOutFile = NULL;
+
+	pxInFile = ff_fopen( pcSource, "rb" );
+
+	if( pxInFile != NULL )
+	{
+		pxState->pxOutFile = ff_fopen( pcDestination, "wb" );
+	}
+
+	if( ( pxInFile == NULL ) || ( pxState->pxOutFile == NULL ) )
+	{
+		FreeRTOS_printf( ( "FreeRTOS_gzip: open %s: %s\n", ( pxInFile == NULL ) ? pcSource : pcDestination,
+			( const char * ) strerror( stdioGET_ERRNO() ) ) );
+		lResult = -( int32_t ) stdioGET_ERRNO();
+	}
+	else
+	{
+		for( x = 0u; x < sizeof( ucHeader ); x++ )
+		{
+			prvPutByte( pxState, ucHeader[ x ] );
+		}
+
+		/* A single final block, compressed with the fixed Huffman codes. */
+		prvPutBits( pxState, 1uL, 1uL );	/* BFINAL */
+		prvPutBits( pxState, 1uL, 2uL );	/* BTYPE = 01 */
+
+		while( pxState->xError == pdFALSE )
+		{
+			if( ( xEOF == pdFALSE ) && ( ( uxEnd - uxPos ) < gzipMIN_LOOKAHEAD ) )
+			{
+				/* Make sure that a match of the maximum length can be tested. */
+				if( uxPos >= gzipWINDOW_SIZE )
+				{
+					prvSlide( pxState );
+					uxPos -= gzipWINDOW_SIZE;
+					uxEnd -= gzipWINDOW_SIZE;
+				}
+
+				uxCount = ff_fread( pxState->ucWindow + uxEnd, 1, sizeof( pxState->ucWindow ) - uxEnd, pxInFile );
+
+				if( uxCount == 0u )
+				{
+					xEOF = pdTRUE;
+				}
+				else
+				{
+					ulCRC = prvCRC32( ulCRC, pxState->ucWindow + uxEnd, uxCount );
+					ulSize += uxCount;
+					uxEnd += uxCount;
+				}
+				continue;
+			}
+
+			if( uxPos >= uxEnd )
+			{
+				break;
+			}
+
+			uxLength = prvLongestMatch( pxState, uxPos, uxEnd, &uxDistance );
+
+			if( uxLength >= gzipMIN_MATCH )
+			{
+				prvPutMatch( pxState, uxLength, uxDistance );
+
+				for( x = 1u; x < uxLength; x++ )
+				{
+					prvInsert( pxState, uxPos + x, uxEnd );
+				}
+				uxPos += uxLength;
+			}
+			else
+			{
+				prvPutSymbol( pxState, pxState->ucWindow[ uxPos ] );
+				uxPos++;
+			}
+		}
+
+		/* End of block, then pad to a whole byte. */
+		prvPutSymbol( pxState, 256uL );
+		prvPutBits( pxState, 0uL, ( 8uL - pxState->ulBitCount ) & 7uL );
+
+		/* The trailer is little-endian: CRC32 and ISIZE. */
+		ulCRC ^= 0xFFFFFFFFuL;
+		for( x = 0u; x < 4u; x++ )
+		{
+			prvPutByte( pxState, ( uint8_t ) ( ulCRC >> ( 8u * x ) ) );
+		}
+		for( x = 0u; x < 4u; x++ )
+		{
+			prvPutByte( pxState, ( uint8_t ) ( ulSize >> ( 8u * x ) ) );
+		}
+		prvFlush( pxState );
+
+		if( ( pxState->xError != pdFALSE ) || ( ulSize != pxInFile->ulFileSize ) )
+		{
+			lResult = -pdFREERTOS_ERRNO_EIO;
+		}
+		else
+		{
+			lResult = pxState->lWritten;
+		}
+	}
+
+	if( pxInFile != NULL )
+	{
+		ff_fclose( pxInFile );
+	}
+
+	if( pxState->pxOutFile != NULL )
+	{
+		ff_fclose( pxState->pxOutFile );
+
+		if( lResult < 0 )
+		{
+			/* Do not leave a truncated file behind. */
+			ff_remove( pcDestination );
+		}
+	}
+
+	vPortFreeLarge( pxState );
+
+	return lResult;
+}
+/*-----------------------------------------------------------*/
+
+int32_t FreeRTOS_gzip_sibling( const char *pcFileName )
+{
+char pcSibling[ ffconfigMAX_FILENAME ];
+FF_Stat_t xStat;
+int32_t lResult;
+
+	if( snprintf( pcSibling, sizeof( pcSibling ), "%s%s", pcFileName, gzipSUFFIX ) >= ( int ) sizeof( pcSibling ) )
+	{
+		return -pdFREERTOS_ERRNO_ENAMETOOLONG;
+	}
+
+	lResult = FreeRTOS_gzip( pcFileName, pcSibling );
+
+	if( ( lResult >= 0 ) && ( ff_stat( pcFileName, &xStat ) == 0 ) && ( ( uint32_t ) lResult >= xStat.st_size ) )
+	{
+		/* Nothing gained, the original will be sent. */
+		ff_remove( pcSibling );
+		lResult = 0;
+	}
+
+	FreeRTOS_printf( ( "FreeRTOS_gzip_sibling: %s: %ld\n", pcSibling, ( long ) lResult ) );
+
+	return lResult;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_gzip_wanted( const char *pcFileName )
+{
+const char *pcDot = strrchr( pcFileName, '.' );
+BaseType_t xResult = pdFALSE;
+BaseType_t x;
+
+	if( ( pcDot != NULL ) && ( strchr( pcDot, '/' ) == NULL ) )
+	{
+		for( x = 0; x < ARRAY_SIZE( pcTextTypes ); x++ )
+		{
+			if( strcasecmp( pcDot + 1, pcTextTypes[ x ] ) == 0 )
+			{
+				xResult = pdTRUE;
+				break;
+			}
+		}
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFlush( GzipState_t *pxState )
+{
+	if( pxState->uxOutputLength != 0u )
+	{
+		if( ff_fwrite( pxState->ucOutput, 1, pxState->uxOutputLength, pxState->pxOutFile ) != pxState->uxOutputLength )
+		{
+			pxState->xError = pdTRUE;
+		}
+		pxState->lWritten += ( int32_t ) pxState->uxOutputLength;
+		pxState->uxOutputLength = 0u;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPutByte( GzipState_t *pxState, uint8_t ucByte )
+{
+	pxState->ucOutput[ pxState->uxOutputLength++ ] = ucByte;
+
+	if( pxState->uxOutputLength == sizeof( pxState->ucOutput ) )
+	{
+		prvFlush( pxState );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPutBits( GzipState_t *pxState, uint32_t ulValue, uint32_t ulCount )
+{
+	/* Deflate packs its bits starting at the LSB of each byte. */
+	pxState->ulBits |= ulValue << pxState->ulBitCount;
+	pxState->ulBitCount += ulCount;
+
+	while( pxState->ulBitCount >= 8uL )
+	{
+		prvPutByte( pxState, ( uint8_t ) pxState->ulBits );
+		pxState->ulBits >>= 8;
+		pxState->ulBitCount -= 8uL;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPutCode( GzipState_t *pxState, uint32_t ulCode, uint32_t ulLength )
+{
+uint32_t ulReversed = 0uL;
+uint32_t x;
+
+	/* Huffman codes are stored starting with their MSB. */
+	for( x = 0uL; x < ulLength; x++ )
+	{
+		ulReversed = ( ulReversed << 1 ) | ( ulCode & 1uL );
+		ulCode >>= 1;
+	}
+	prvPutBits( pxState, ulReversed, ulLength );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPutSymbol( GzipState_t *pxState, uint32_t ulSymbol )
+{
+	/* The fixed literal / length code, RFC 1951 section 3.2.6. */
+	if( ulSymbol < 144uL )
+	{
+		prvPutCode( pxState, 0x30uL + ulSymbol, 8uL );
+	}
+	else if( ulSymbol < 256uL )
+	{
+		prvPutCode( pxState, 0x190uL + ( ulSymbol - 144uL ), 9uL );
+	}
+	else if( ulSymbol < 280uL )
+	{
+		prvPutCode( pxState, ulSymbol - 256uL, 7uL );
+	}
+	else
+	{
+		prvPutCode( pxState, 0xC0uL + ( ulSymbol - 280uL ), 8uL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPutMatch( GzipState_t *pxState, uint32_t ulLength, uint32_t ulDistance )
+{
+BaseType_t x;
+
+	for( x = ARRAY_SIZE( usLengthBase ) - 1; usLengthBase[ x ] > ulLength; x-- )
+	{
+	}
+	prvPutSymbol( pxState, 257uL + ( uint32_t ) x );
+	prvPutBits( pxState, ulLength - usLengthBase[ x ], ucLengthExtra[ x ] );
+
+	for( x = ARRAY_SIZE( usDistanceBase ) - 1; usDistanceBase[ x ] > ulDistance; x-- )
+	{
+	}
+	/* The fixed distance codes are 5 bits wide. */
+	prvPutCode( pxState, ( uint32_t ) x, 5uL );
+	prvPutBits( pxState, ulDistance - usDistanceBase[ x ], ucDistanceExtra[ x ] );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvHash( const uint8_t *pucData )
+{
+uint32_t ulValue = ( ( uint32_t ) pucData[ 0 ] << 16 ) | ( ( uint32_t ) pucData[ 1 ] << 8 ) | pucData[ 2 ];
+
+	ulValue *= 0x9E3779B1uL;
+
+	return ( ulValue & 0xFFFFFFFFuL ) >> ( 32u - gzipHASH_BITS );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsert( GzipState_t *pxState, size_t uxPos, size_t uxEnd )
+{
+uint32_t ulHash;
+
+	if( uxPos + gzipMIN_MATCH <= uxEnd )
+	{
+		ulHash = prvHash( pxState->ucWindow + uxPos );
+		pxState->usPrev[ uxPos & gzipWINDOW_MASK ] = pxState->usHead[ ulHash ];
+		pxState->usHead[ ulHash ] = ( uint16_t ) uxPos;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvLongestMatch( GzipState_t *pxState, size_t uxPos, size_t uxEnd, size_t *puxDistance )
+{
+const uint8_t *pucWindow = pxState->ucWindow;
+size_t uxMax = uxEnd - uxPos;
+size_t uxBest = 0u, uxLength, uxCandidate, uxNext, uxLimit;
+uint32_t ulHash, ulChain = gzipMAX_CHAIN;
+
+	if( uxMax < gzipMIN_MATCH )
+	{
+		return 0u;
+	}
+	if( uxMax > gzipMAX_MATCH )
+	{
+		uxMax = gzipMAX_MATCH;
+	}
+
+	ulHash = prvHash( pucWindow + uxPos );
+	uxCandidate = pxState->usHead[ ulHash ];
+	pxState->usPrev[ uxPos & gzipWINDOW_MASK ] = ( uint16_t ) uxCandidate;
+	pxState->usHead[ ulHash ] = ( uint16_t ) uxPos;
+
+	/* Distances are limited to the size of the window. */
+	uxLimit = ( uxPos > gzipWINDOW_SIZE ) ? ( uxPos - gzipWINDOW_SIZE ) : 0u;
+
+	while( ( uxCandidate != gzipNIL ) && ( uxCandidate > uxLimit ) && ( ulChain-- != 0uL ) )
+	{
+		if( pucWindow[ uxCandidate + uxBest ] == pucWindow[ uxPos + uxBest ] )
+		{
+			for( uxLength = 0u; ( uxLength < uxMax ) && ( pucWindow[ uxCandidate + uxLength ] == pucWindow[ uxPos + uxLength ] ); uxLength++ )
+			{
+			}
+
+			if( uxLength > uxBest )
+			{
+				uxBest = uxLength;
+				*puxDistance = uxPos - uxCandidate;
+
+				if( ( uxBest >= uxMax ) || ( uxBest >= gzipGOOD_MATCH ) )
+				{
+					break;
+				}
+			}
+		}
+
+		/* An entry of usPrev[] may have been reused by a newer position. */
+		uxNext = pxState->usPrev[ uxCandidate & gzipWINDOW_MASK ];
+		if( uxNext >= uxCandidate )
+		{
+			break;
+		}
+		uxCandidate = uxNext;
+	}
+
+	return uxBest;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSlide( GzipState_t *pxState )
+{
+size_t x;
+
+	/* Drop the oldest window, the positions move down by gzipWINDOW_SIZE. */
+	memmove( pxState->ucWindow, pxState->ucWindow + gzipWINDOW_SIZE, gzipWINDOW_SIZE );
+
+	for( x = 0u; x < gzipHASH_SIZE; x++ )
+	{
+		pxState->usHead[ x ] = ( pxState->usHead[ x ] >= gzipWINDOW_SIZE ) ? ( uint16_t ) ( pxState->usHead[ x ] - gzipWINDOW_SIZE ) : ( uint16_t ) gzipNIL;
+	}
+	for( x = 0u; x < gzipWINDOW_SIZE; x++ )
+	{
+		pxState->usPrev[ x ] = ( pxState->usPrev[ x ] >= gzipWINDOW_SIZE ) ? ( uint16_t ) ( pxState->usPrev[ x ] - gzipWINDOW_SIZE ) : ( uint16_t ) gzipNIL;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCRC32( uint32_t ulCRC, const uint8_t *pucData, size_t uxLength )
+{
+	while( uxLength-- != 0u )
+	{
+		ulCRC ^= *( pucData++ );
+		ulCRC = ( ulCRC >> 4 ) ^ ulCRCTable[ ulCRC & 0x0Fu ];
+		ulCRC = ( ulCRC >> 4 ) ^ ulCRCTable[ ulCRC & 0x0Fu ];
+	}
+
+	return ulCRC;
+}
+/*-----------------------------------------------------------*/
@@ -98,9 +98,9 @@
 #endif
 
 /* Some defines to make the code more readbale */
-#define pcCOMMAND_BUFFER	pxClient->pxParent->pcCommandBuffer
-#define pcNEW_DIR			pxClient->pxParent->pcNewDir
-#define pcFILE_BUFFER		pxClient->pxParent->pcFileBuffer
+#define pcCOMMAND_BUFFER	pxClient->pxBuffers->pcCommandBuffer
+#define pcNEW_DIR			pxClient->pxBuffers->pcNewDir
+#define pcFILE_BUFFER		pxClient->pxBuffers->pcFileBuffer
 
 /* This FTP server will only do binary transfers */
 #define TMODE_BINARY	1
@@ -113,9 +113,11 @@
 #endif
 
 /*
- * ipconfigFTP_ZERO_COPY_ALIGNED_WRITES : experimental optimisation option.
+ * ipconfigFTP_ZERO_COPY_ALIGNED_WRITES : optimisation option.
  * If non-zero, receiving data will be done with the zero-copy method and also
- * writes to disk will be done with sector-alignment as much as possible.
+ * writes to disk will end on a sector boundary of the file as much as possible.
+ * Data that wraps around the end of the RX stream is copied through the file
+ * buffer, so every write stays sector-aligned.
  */
 #ifndef ipconfigFTP_ZERO_COPY_ALIGNED_WRITES
 	#define ipconfigFTP_ZERO_COPY_ALIGNED_WRITES			0
@@ -1319,16 +1321,30 @@ int iErrorNo;
 
 	static BaseType_t prvStoreFileWork( xFTPClient *pxClient )
 	{
-	BaseType_t xRc, xWritten;
+	BaseType_t xRc, xWritten, xCount, xSectorSize;
+
+		if( pxClient->pxWriteHandle == NULL )
+		{
+			/* No file is being received (any more), drop the data. */
+			xRc = FreeRTOS_recvcount( pxClient->xTransferSocket );
+			if( xRc > 0 )
+			{
+				FreeRTOS_recv( pxClient->xTransferSocket, ( void * ) NULL, xRc, 0 );
+			}
+			return xRc;
+		}
+
+		xSectorSize = ( BaseType_t ) pxClient->pxWriteHandle->pxIOManager->usSectorSize;
 
 		/* Read from the data socket until all has been read or until a negative value
 		is returned. */
 		for( ; ; )
 		{
 		char *pcBuffer;
-		UBaseType_t xStatus;
 
-			/* The "zero-copy" method: */
+			/* The "zero-copy" method: pcBuffer will point to the tail of the RX
+			stream, xRc is the number of bytes up to the end of the circular
+			buffer. */
 			xRc = FreeRTOS_recv( pxClient->xTransferSocket, ( void * ) &pcBuffer,
 				0x20000u, FREERTOS_ZERO_COPY | FREERTOS_MSG_DONTWAIT );
 
@@ -1337,51 +1353,46 @@ int iErrorNo;
 				/* There are no data or the connection is closed. */
 				break;
 			}
-			xStatus = FreeRTOS_connstatus( pxClient->xTransferSocket );
-			if( xStatus != eESTABLISHED )
-			{
-				/* The connection is not established (any more),
-				therefore accept any amount of bytes, probably
-				the last few bytes. */
-			}
-			else
+
+			if( FreeRTOS_connstatus( pxClient->xTransferSocket ) == eESTABLISHED )
 			{
-				if( xRc >= 512 )
-				{
-					/* More than a sector to write, round
-					down to a multiple of 512 bytes. */
-					xRc &= ~( 512 - 1 );
-				}
-				else
-				{
-				const struct xSTREAM_BUFFER *pxBuffer = FreeRTOS_get_rx_buf( pxClient->xTransferSocket );
+				/* Let each write end on a sector boundary of the file, so
+				ff_fwrite() passes whole sectors and clusters straight from
+				the RX stream to the disk, without using the sector cache. */
+				xRc -= ( BaseType_t ) ( ( pxClient->pxWriteHandle->ulFilePointer + ( uint32_t ) xRc ) % ( uint32_t ) xSectorSize );
 
-					int32_t lTail = pxBuffer->uxTail;
-					if( pxBuffer->LENGTH - lTail >= 512 )
+				if( xRc <= 0 )
+				{
+					/* Less than a sector is left before the end of the circular
+					buffer, or less than a sector has been received.  Copy the
+					data that wraps around, up to a sector boundary, through
+					the file buffer. */
+					xCount = FreeRTOS_min_int32( FreeRTOS_recvcount( pxClient->xTransferSocket ), sizeof( pcFILE_BUFFER ) );
+					xCount -= ( BaseType_t ) ( ( pxClient->pxWriteHandle->ulFilePointer + ( uint32_t ) xCount ) % ( uint32_t ) xSectorSize );
+
+					if( xCount <= 0 )
 					{
-						/* At this moment there are les than 512 bytes in the RX buffer,
-						but there is space for more. Just return and wait for more. */
+						/* Wait for more data, or for the closure of the connection. */
 						xRc = 0;
+						break;
 					}
-					else
+
+					pcBuffer = pcFILE_BUFFER;
+					xRc = FreeRTOS_recv( pxClient->xTransferSocket, ( void * ) pcBuffer, xCount, FREERTOS_MSG_DONTWAIT );
+
+					if( xRc <= 0 )
 					{
-						/* Now reading beyond the end of the circular buffer,
-						use a normal read. */
-						pcBuffer = pcFILE_BUFFER;
-						xRc = FreeRTOS_recvcount( pxClient->xTransferSocket );
-						xRc &= ~( 512 - 1 );
-						if( xRc > 0 )
-						{
-							xRc = FreeRTOS_recv( pxClient->xTransferSocket, ( void * ) pcBuffer,
-								sizeof( pcBuffer ), FREERTOS_MSG_DONTWAIT );
-						}
+						break;
 					}
 				}
 			}
-			if( xRc == 0 )
+			else
 			{
-				break;
+				/* The connection is not established (any more),
+				therefore accept any amount of bytes, probably
+				the last few bytes. */
 			}
+
 			pxClient->ulRecvBytes += xRc;
 
 			xWritten = ff_fwrite( pcBuffer, 1, xRc, pxClient->pxWriteHandle );
@@ -1510,28 +1521,24 @@ size_t ulFileSize;
 static BaseType_t prvRetrieveFileWork( xFTPClient *pxClient )
 {
 size_t xSpace;
-size_t xCount, xItemsRead;
+size_t xCount;
 BaseType_t xRc = 0;
 BaseType_t xSetEvent = pdFALSE;
 
 	do
 	{
-	#if( ipconfigFTP_TX_ZERO_COPY != 0 )
-		char *pcBuffer;
-		BaseType_t xBufferLength;
+	#if( ipconfigFTP_TX_ZERO_COPY == 0 )
+		size_t xItemsRead;
 	#endif /* ipconfigFTP_TX_ZERO_COPY */
 
 		/* Take the lesser of the two: tx_space (number of bytes that can be queued for
 		transmission) and xBytesLeft (the number of bytes left to read from the file) */
 		xSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
 
-		if( xSpace == 0 )
-		{
-			FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE | eSELECT_EXCEPT );
-			xRc = FreeRTOS_select( pxClient->pxParent->xSocketSet, 200 );
-			xSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
-		}
-
+		/* When the TX stream is full, eSELECT_WRITE will be set below and the
+		server task calls again as soon as there is space.  Blocking in
+		FreeRTOS_select() here would consume the events of the other sockets
+		of the server. */
 		xCount = FreeRTOS_min_int32( pxClient->xBytesLeft, xSpace );
 
 		if( xCount <= 0 )
@@ -1563,62 +1570,33 @@ BaseType_t xSetEvent = pdFALSE;
 
 		xRc = FreeRTOS_send( pxClient->xTransferSocket, pcFILE_BUFFER, xCount, 0 );
 #else /* ipconfigFTP_TX_ZERO_COPY != 0 */
-		/* Use zero-copy transmission:
-		FreeRTOS_get_tx_head() returns a direct pointer to the TX stream and
-		set xBufferLength to know how much space there is left. */
-		pcBuffer = ( char * )FreeRTOS_get_tx_head( pxClient->xTransferSocket, &xBufferLength );
-		if( ( pcBuffer != NULL ) && ( xBufferLength >= 512 ) )
-		{
-			/* Will read disk data directly to the TX stream of the socket. */
-			xCount = FreeRTOS_min_int32( xCount, xBufferLength );
-			if( xCount > ( BaseType_t ) 0x40000 )
-			{
-				xCount = ( BaseType_t ) 0x40000;
-			}
-		}
-		else
+		if( ( size_t ) pxClient->xBytesLeft == xCount )
 		{
-			/* Use the normal file i/o buffer. */
-			pcBuffer = pcFILE_BUFFER;
-			if( xCount > ( BaseType_t ) sizeof pcFILE_BUFFER )
-			{
-				xCount = ( BaseType_t ) sizeof pcFILE_BUFFER;
-			}
-		}
-
-		if ( pxClient->xBytesLeft >= 1024 )
-		{
-			xCount &= ~( 512 - 1 );
-		}
+		BaseType_t xTrueValue = 1;
 
-		if( xCount <= 0 )
-		{
-			/* Nothing to send after rounding down to a multiple of a sector size. */
-			break;
+			/* The rest of the file fits: FreeRTOS_sendfile() will queue it
+			with a single commit, so the FIN can go with the last data. */
+			FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
 		}
 
-		xItemsRead = ff_fread( pcBuffer, 1, xCount, pxClient->pxReadHandle );
+		/* Use zero-copy transmission: the file is read straight into the TX
+		stream of the data socket, in sector-aligned pieces. */
+		xRc = FreeRTOS_sendfile( pxClient->xTransferSocket, pxClient->pxReadHandle, xCount );
 
-		if( xItemsRead != xCount )
+		/* The space can only have grown since tx_space() was called, so less
+		than xCount bytes means that the file could not be read. */
+		if( ( xRc == -pdFREERTOS_ERRNO_EIO ) || ( ( xRc >= 0 ) && ( ( size_t ) xRc != xCount ) ) )
 		{
-			FreeRTOS_printf( ( "prvRetrieveFileWork: Got %d Expected %d\n", ( int )xItemsRead, ( int ) xCount ) );
+			FreeRTOS_printf( ( "prvRetrieveFileWork: Got %d Expected %d\n", ( int ) xRc, ( int ) xCount ) );
 			xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
 			pxClient->xBytesLeft = 0;
 			break;
 		}
-		pxClient->xBytesLeft -= xCount;
 
-		if( pxClient->xBytesLeft == 0 )
-		{
-		BaseType_t xTrueValue = 1;
-
-			FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
-		}
-		if( pcBuffer != pcFILE_BUFFER )
+		if( xRc > 0 )
 		{
-			pcBuffer = NULL;
+			pxClient->xBytesLeft -= ( uint32_t ) xRc;
 		}
-		xRc = FreeRTOS_send( pxClient->xTransferSocket, pcBuffer, xCount, 0 );
 #endif /* ipconfigFTP_TX_ZERO_COPY */
 
 		if( xRc < 0 )
@@ -1643,7 +1621,7 @@ BaseType_t xSetEvent = pdFALSE;
 
 		for( x = 0; x < 5; x++ )
 		{
-			xRc = FreeRTOS_recv( pxClient->xTransferSocket, pxClient->pxParent->pcFileBuffer, sizeof pxClient->pxParent->pcFileBuffer, 0 );
+			xRc = FreeRTOS_recv( pxClient->xTransferSocket, pcFILE_BUFFER, sizeof pcFILE_BUFFER, 0 );
 			if( xRc < 0 )
 			{
 				break;
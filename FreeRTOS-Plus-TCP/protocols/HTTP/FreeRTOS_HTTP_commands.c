@@ -86,6 +86,8 @@ const char *webCodename (int aCode)
 		return "OK";
 	case WEB_NO_CONTENT:    // 204
 		return "No content";
+	case WEB_NOT_MODIFIED:	// 304
+		return "Not Modified";
 	case WEB_BAD_REQUEST:	//  = 400,
 		return "Bad request";
 	case WEB_UNAUTHORIZED:	//  = 401,
@@ -96,6 +98,8 @@ const char *webCodename (int aCode)
 		return "Done";
 	case WEB_PRECONDITION_FAILED:	//  = 412,
 		return "Precondition Failed";
+	case WEB_REQUEST_HEADER_TOO_LARGE:	//  = 431,
+		return "Request Header Fields Too Large";
 	case WEB_INTERNAL_SERVER_ERROR:	//  = 500,
 		return "Internal Server Error";
 	}
@@ -58,10 +58,12 @@
 /* Standard includes. */
 #include <stdio.h>
 #include <stdlib.h>
+#include <ctype.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "os_task.h"
+#include "os_semphr.h"
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
@@ -71,6 +73,7 @@
 #include "FreeRTOS_HTTP_commands.h"
 #include "FreeRTOS_TCP_server.h"
 #include "FreeRTOS_server_private.h"
+#include "FreeRTOS_gzip.h"
 
 /* FreeRTOS+FAT includes. */
 #include "ff_stdio.h"
@@ -96,9 +99,17 @@
 #endif
 
 /* Some defines to make the code more readbale */
-#define pcCOMMAND_BUFFER	pxClient->pxParent->pcCommandBuffer
-#define pcNEW_DIR			pxClient->pxParent->pcNewDir
-#define pcFILE_BUFFER		pxClient->pxParent->pcFileBuffer
+#define pcCOMMAND_BUFFER	pxClient->pxBuffers->pcCommandBuffer
+#define pcNEW_DIR			pxClient->pxBuffers->pcNewDir
+#define pcFILE_BUFFER		pxClient->pxBuffers->pcFileBuffer
+
+/* The period after which a cached file is compared with the disk again. */
+#define httpCACHE_VALIDATE_TICKS	pdMS_TO_TICKS( ipconfigHTTP_CACHE_VALIDATE_MS )
+
+/* The cache is shared by all clients of the server, which may be worked on by
+several tasks at the same time. */
+#define httpCACHE_LOCK( pxClient )		( void ) xSemaphoreTake( ( pxClient )->pxParent->xHTTPCacheMutex, portMAX_DELAY )
+#define httpCACHE_UNLOCK( pxClient )	( void ) xSemaphoreGive( ( pxClient )->pxParent->xHTTPCacheMutex )
 
 static void prvFileClose( xHTTPClient *pxClient );
 static BaseType_t prvProcessCmd( xHTTPClient *pxClient, BaseType_t xIndex );
@@ -106,10 +117,28 @@ static const char *pcGetContentsType( const char *apFname );
 static BaseType_t prvOpenUrl( xHTTPClient *pxClient );
 static BaseType_t prvSendFile( xHTTPClient *pxClient );
 static BaseType_t prvSendReply( xHTTPClient *pxClient, BaseType_t xCode );
+static BaseType_t prvSendHeader( xHTTPClient *pxClient, BaseType_t xCode, const char *pcHeaders, const uint8_t *pucBody, size_t uxBodyLength );
+static size_t prvFormatHeaders( xHTTPClient *pxClient, char *pcBuffer, size_t uxSize, BaseType_t xCode, size_t uxLength );
+static void prvReplyDone( xHTTPClient *pxClient );
+static BaseType_t prvReplyBusy( xHTTPClient *pxClient );
+static const char *prvGetHeader( const char *pcHeaders, const char *pcEnd, const char *pcName, size_t *puxLength );
+static BaseType_t prvKeepAlive( const char *pcRestData, const char *pcEnd );
+static void prvSetValidators( xHTTPClient *pxClient, uint32_t ulSize, uint32_t ulModified );
+static BaseType_t prvNotModified( xHTTPClient *pxClient );
 
+#if( ipconfigHTTP_USE_GZIP != 0 )
+	static BaseType_t prvAcceptGzip( const char *pcRestData, const char *pcEndOfCmd );
+	static void prvSelectGzip( xHTTPClient *pxClient );
+#endif
 
+#if( ipconfigHTTP_CACHE_ENTRIES > 0 )
+	static HTTPCacheEntry_t *prvCacheFind( xHTTPClient *pxClient );
+	static HTTPCacheEntry_t *prvCacheAdd( xHTTPClient *pxClient, uint32_t ulSize, uint32_t ulModified );
+	static void prvCacheDrop( HTTPCacheEntry_t *pxEntry );
+#endif
 
-static const char pcEmptyString[1] = { '\0' };
+static const char * const pcDayNames[ 7 ] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static const char * const pcMonthNames[ 12 ] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
 
 void vHTTPClientDelete( xTCPClient *pxTCPClient )
 {
@@ -134,109 +163,583 @@ static void prvFileClose( xHTTPClient *pxClient )
 		ff_fclose( pxClient->pxFileHandle );
 		pxClient->pxFileHandle = NULL;
 	}
+
+	#if( ipconfigHTTP_CACHE_ENTRIES > 0 )
+	{
+	HTTPCacheEntry_t *pxEntry = pxClient->pxCacheEntry;
+
+		if( pxEntry != NULL )
+		{
+			pxClient->pxCacheEntry = NULL;
+			httpCACHE_LOCK( pxClient );
+			pxEntry->uxUsers--;
+
+			if( pxEntry->xStale != pdFALSE )
+			{
+				prvCacheDrop( pxEntry );
+			}
+			httpCACHE_UNLOCK( pxClient );
+		}
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvSendReply( xHTTPClient *pxClient, BaseType_t xCode )
+static BaseType_t prvReplyBusy( xHTTPClient *pxClient )
+{
+BaseType_t xBusy = ( pxClient->pxFileHandle != NULL );
+
+	#if( ipconfigHTTP_CACHE_ENTRIES > 0 )
+	{
+		xBusy |= ( pxClient->pxCacheEntry != NULL );
+	}
+	#endif
+
+	return xBusy;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplyDone( xHTTPClient *pxClient )
 {
-struct xTCP_SERVER *pxParent = pxClient->pxParent;
+	prvFileClose( pxClient );
+
+	/* Writing is ready, no need for further 'eSELECT_WRITE' events.  Wake up
+	for the next request, or for the closure of the connection. */
+	FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+	FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_READ );
+
+	if( pxClient->bits.bKeepAlive == pdFALSE )
+	{
+		/* The FIN will follow the last byte of the reply. */
+		FreeRTOS_shutdown( pxClient->xSocket, FREERTOS_SHUT_RDWR );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFormatHeaders( xHTTPClient *pxClient, char *pcBuffer, size_t uxSize, BaseType_t xCode, size_t uxLength )
+{
+TCPBuffers_t *pxBuffers = pxClient->pxBuffers;
+size_t uxLength1 = 0u;
+
+	/* The entity header lines of a reply: everything that depends on the
+	file only, so they can be stored in the cache. */
+	if( xCode != WEB_NOT_MODIFIED )
+	{
+		uxLength1 += snprintf( pcBuffer, uxSize,
+			"Content-Type: %s\r\n"
+			"Content-Length: %lu\r\n",
+			pxBuffers->pcContentsType[0] ? pxBuffers->pcContentsType : "text/html",
+			( unsigned long ) uxLength );
+	}
+	if( pxBuffers->pcETag[0] != '\0' )
+	{
+		uxLength1 += snprintf( pcBuffer + uxLength1, uxSize - uxLength1,
+			"ETag: %s\r\n"
+			"Last-Modified: %s\r\n",
+			pxBuffers->pcETag,
+			pxBuffers->pcLastModified );
+
+		#if( ipconfigHTTP_USE_GZIP != 0 )
+		{
+			/* The reply depends on the Accept-Encoding of the request. */
+			uxLength1 += snprintf( pcBuffer + uxLength1, uxSize - uxLength1,
+				"%s"
+				"Vary: Accept-Encoding\r\n",
+				pxClient->bits.bGzip ? "Content-Encoding: gzip\r\n" : "" );
+		}
+		#endif
+	}
+
+	return uxLength1;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendHeader( xHTTPClient *pxClient, BaseType_t xCode, const char *pcHeaders, const uint8_t *pucBody, size_t uxBodyLength )
+{
+TCPBuffers_t *pxBuffers = pxClient->pxBuffers;
 BaseType_t xRc;
+size_t uxLength, uxCopy;
 
 	// A normal command reply on the main socket (port 21)
-	char *pcBuffer = pxParent->pcFileBuffer;
+	char *pcBuffer = pxBuffers->pcFileBuffer;
 
-	xRc = snprintf( pcBuffer, sizeof( pxParent->pcFileBuffer ),
+	uxLength = snprintf( pcBuffer, sizeof( pxBuffers->pcFileBuffer ),
 		"HTTP/1.1 %d %s\r\n"
 #if	USE_HTML_CHUNKS
 		"Transfer-Encoding: chunked\r\n"
 #endif
-		"Content-Type: %s\r\n"
-		"Connection: keep-alive\r\n"
-		"%s\r\n",
-		( int ) xCode,
-		webCodename (xCode),
-		pxParent->pcContentsType[0] ? pxParent->pcContentsType : "text/html",
-		pxParent->pcExtraContents );
-
-	pxParent->pcContentsType[0] = '\0';
-	pxParent->pcExtraContents[0] = '\0';
-
-	xRc = FreeRTOS_send( pxClient->xSocket, ( const void * ) pcBuffer, xRc, 0 );
+		, ( int ) xCode,
+		webCodename (xCode) );
+
+	if( pcHeaders != NULL )
+	{
+		uxLength += snprintf( pcBuffer + uxLength, sizeof( pxBuffers->pcFileBuffer ) - uxLength, "%s", pcHeaders );
+	}
+	else
+	{
+		uxLength += prvFormatHeaders( pxClient, pcBuffer + uxLength, sizeof( pxBuffers->pcFileBuffer ) - uxLength, xCode, pxClient->xBytesLeft );
+	}
+
+	uxLength += snprintf( pcBuffer + uxLength, sizeof( pxBuffers->pcFileBuffer ) - uxLength,
+		"%s"
+		"Connection: %s\r\n"
+		"\r\n",
+		pxBuffers->pcExtraContents,
+		pxClient->bits.bKeepAlive ? "keep-alive" : "close" );
+
+	pxBuffers->pcContentsType[0] = '\0';
+	pxBuffers->pcExtraContents[0] = '\0';
+	pxBuffers->pcETag[0] = '\0';
+
+	/* Let the first part of the body share the packet with the header. */
+	uxCopy = FreeRTOS_min_uint32( uxBodyLength, sizeof( pxBuffers->pcFileBuffer ) - uxLength );
+	if( uxCopy != 0u )
+	{
+		memcpy( pcBuffer + uxLength, pucBody, uxCopy );
+	}
+
+	xRc = FreeRTOS_send( pxClient->xSocket, ( const void * ) pcBuffer, uxLength + uxCopy, 0 );
 	pxClient->bits.bReplySent = pdTRUE;
 
+	if( xRc >= 0 )
+	{
+		/* Return the number of body bytes that were sent. */
+		xRc = ( ( size_t ) xRc > uxLength ) ? ( BaseType_t ) ( ( size_t ) xRc - uxLength ) : 0;
+	}
+
+	return xRc;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendReply( xHTTPClient *pxClient, BaseType_t xCode )
+{
+BaseType_t xRc;
+
+	/* A reply without a body. */
+	pxClient->xBytesLeft = 0u;
+	xRc = prvSendHeader( pxClient, xCode, NULL, NULL, 0u );
+	prvReplyDone( pxClient );
+
 	return xRc;
 }
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvSendFile( xHTTPClient *pxClient )
 {
-size_t xSpace;
-size_t xCount;
 BaseType_t xRc = 0;
 
-	if( pxClient->bits.bReplySent == pdFALSE )
+	#if( ipconfigHTTP_CACHE_ENTRIES > 0 )
+	if( pxClient->pxCacheEntry != NULL )
 	{
-		pxClient->bits.bReplySent = pdTRUE;
+	HTTPCacheEntry_t *pxEntry = pxClient->pxCacheEntry;
 
-		strcpy( pxClient->pxParent->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
-		snprintf( pxClient->pxParent->pcExtraContents, sizeof pxClient->pxParent->pcExtraContents,
-			"Content-Length: %d\r\n", ( int ) pxClient->xBytesLeft);
+		/* The contents are in RAM already. */
+		if( pxClient->xBytesLeft > 0u )
+		{
+			xRc = FreeRTOS_send( pxClient->xSocket, pxEntry->pucData + ( pxEntry->ulSize - pxClient->xBytesLeft ), pxClient->xBytesLeft, FREERTOS_MSG_DONTWAIT );
 
-		xRc = prvSendReply( pxClient, WEB_REPLY_OK );	/* "Requested file action OK" */
+			if( xRc > 0 )
+			{
+				pxClient->xBytesLeft -= ( size_t ) xRc;
+			}
+		}
 	}
+	else
+	#endif /* ipconfigHTTP_CACHE_ENTRIES */
+	{
+		while( pxClient->xBytesLeft > 0u )
+		{
+			/* The file is read straight into the TX stream of the socket, as
+			much as there is space for. */
+			xRc = FreeRTOS_sendfile( pxClient->xSocket, pxClient->pxFileHandle, pxClient->xBytesLeft );
+
+			if( xRc == -pdFREERTOS_ERRNO_EIO )
+			{
+				/* The promised Content-Length can not be delivered. */
+				FreeRTOS_printf( ( "prvSendFile: read error %s\n", pxClient->pcCurrentFilename ) );
+				pxClient->bits.bKeepAlive = pdFALSE;
+				pxClient->xBytesLeft = 0u;
+			}
 
-	if( xRc >= 0 ) do
+			if( xRc <= 0 )
+			{
+				break;
+			}
+
+			pxClient->xBytesLeft -= ( size_t ) xRc;
+		}
+	}
+
+	if( ( pxClient->xBytesLeft == 0u ) || ( xRc < 0 ) )
 	{
-		xSpace = FreeRTOS_tx_space( pxClient->xSocket );
+		prvReplyDone( pxClient );
+	}
+	else
+	{
+		/* Wake up the TCP task as soon as this socket may be written to.  The
+		next request will be read when this reply has been sent. */
+		FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_READ );
+		FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+	}
 
-		if( pxClient->xBytesLeft < xSpace )
+	return xRc;
+}
+/*-----------------------------------------------------------*/
+
+static const char *prvGetHeader( const char *pcHeaders, const char *pcEnd, const char *pcName, size_t *puxLength )
+{
+const char *pcLine = pcHeaders;
+const char *pcValue = NULL;
+size_t uxNameLength = strlen( pcName );
+size_t x;
+
+	/* Look for a line "<pcName>: <value>" in the request headers, the name is
+	not case sensitive.  The scan never goes beyond pcEnd. */
+	while( ( pcLine = memchr( pcLine, '\n', ( size_t ) ( pcEnd - pcLine ) ) ) != NULL )
+	{
+		pcLine++;
+
+		if( ( size_t ) ( pcEnd - pcLine ) <= uxNameLength )
 		{
-			xCount = pxClient->xBytesLeft;
+			break;
 		}
-		else
+
+		for( x = 0u; x < uxNameLength; x++ )
 		{
-			xCount = xSpace;
+			if( tolower( ( unsigned char ) pcLine[ x ] ) != tolower( ( unsigned char ) pcName[ x ] ) )
+			{
+				break;
+			}
 		}
 
-		if( xCount > 0 )
+		if( ( x == uxNameLength ) && ( pcLine[ x ] == ':' ) )
 		{
-			if( xCount > sizeof( pxClient->pxParent->pcFileBuffer ) )
+			pcValue = pcLine + x + 1;
+			while( ( pcValue < pcEnd ) && ( ( *pcValue == ' ' ) || ( *pcValue == '\t' ) ) )
 			{
-				xCount = sizeof( pxClient->pxParent->pcFileBuffer );
+				pcValue++;
 			}
-			ff_fread( pxClient->pxParent->pcFileBuffer, 1, xCount, pxClient->pxFileHandle );
-			pxClient->xBytesLeft -= xCount;
 
-			xRc = FreeRTOS_send( pxClient->xSocket, pxClient->pxParent->pcFileBuffer, xCount, 0 );
-			if( xRc < 0 )
+			for( x = 0u; ( pcValue + x < pcEnd ) && ( pcValue[ x ] != '\0' ) && ( pcValue[ x ] != '\r' ) && ( pcValue[ x ] != '\n' ); x++ )
 			{
-				break;
 			}
+			*puxLength = x;
+			break;
+		}
+	}
+
+	return pcValue;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvKeepAlive( const char *pcRestData, const char *pcEnd )
+{
+const char *pcValue;
+size_t uxLength;
+BaseType_t xResult;
+
+	/* HTTP/1.1 connections are persistent unless the client says otherwise,
+	HTTP/1.0 connections only when the client asks for it. */
+	xResult = ( strncmp( pcRestData, "HTTP/1.0", 8 ) != 0 );
+
+	pcValue = prvGetHeader( pcRestData, pcEnd, "Connection", &uxLength );
+
+	if( pcValue != NULL )
+	{
+		if( ( uxLength >= 5u ) && ( tolower( ( unsigned char ) pcValue[ 0 ] ) == 'c' ) )
+		{
+			/* "close" */
+			xResult = pdFALSE;
+		}
+		else if( ( uxLength >= 10u ) && ( tolower( ( unsigned char ) pcValue[ 0 ] ) == 'k' ) )
+		{
+			/* "keep-alive" */
+			xResult = pdTRUE;
 		}
-	} while( xCount > 0 );
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetValidators( xHTTPClient *pxClient, uint32_t ulSize, uint32_t ulModified )
+{
+TCPBuffers_t *pxBuffers = pxClient->pxBuffers;
+FF_TimeStruct_t xTimeStruct;
+time_t xTime = ( time_t ) ulModified;
 
-	if( pxClient->xBytesLeft <= 0 )
+	/* The ETag changes with the size or the modification time of the file. */
+	snprintf( pxBuffers->pcETag, sizeof( pxBuffers->pcETag ), "\"%lx-%lx\"", ( unsigned long ) ulSize, ( unsigned long ) ulModified );
+
+	FreeRTOS_gmtime_r( &xTime, &xTimeStruct );
+	snprintf( pxBuffers->pcLastModified, sizeof( pxBuffers->pcLastModified ), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+		pcDayNames[ xTimeStruct.tm_wday % 7 ],
+		xTimeStruct.tm_mday,
+		pcMonthNames[ xTimeStruct.tm_mon % 12 ],
+		xTimeStruct.tm_year + 1900,
+		xTimeStruct.tm_hour,
+		xTimeStruct.tm_min,
+		xTimeStruct.tm_sec );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNotModified( xHTTPClient *pxClient )
+{
+TCPBuffers_t *pxBuffers = pxClient->pxBuffers;
+const char *pcValue;
+size_t uxLength, uxTagLength, x;
+BaseType_t xResult = pdFALSE;
+
+	pcValue = prvGetHeader( pxClient->pcRestData, pxClient->pcEndOfCmd, "If-None-Match", &uxLength );
+
+	if( pcValue != NULL )
 	{
-		/* Writing is ready, no need for further 'eSELECT_WRITE' events. */
-		FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
-		prvFileClose( pxClient );
+		/* A list of ETags, or "*".  If-Modified-Since is ignored now. */
+		uxTagLength = strlen( pxBuffers->pcETag );
+
+		if( ( uxLength == 1u ) && ( pcValue[ 0 ] == '*' ) )
+		{
+			xResult = pdTRUE;
+		}
+
+		for( x = 0u; ( xResult == pdFALSE ) && ( x + uxTagLength <= uxLength ); x++ )
+		{
+			if( memcmp( pcValue + x, pxBuffers->pcETag, uxTagLength ) == 0 )
+			{
+				xResult = pdTRUE;
+			}
+		}
 	}
 	else
 	{
-		/* Wake up the TCP task as soon as this socket may be written to. */
-		FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+		/* Browsers return the Last-Modified date as it was received. */
+		pcValue = prvGetHeader( pxClient->pcRestData, pxClient->pcEndOfCmd, "If-Modified-Since", &uxLength );
+
+		if( ( pcValue != NULL ) && ( uxLength == strlen( pxBuffers->pcLastModified ) ) &&
+			( memcmp( pcValue, pxBuffers->pcLastModified, uxLength ) == 0 ) )
+		{
+			xResult = pdTRUE;
+		}
 	}
 
-	return xRc;
+	return xResult;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigHTTP_USE_GZIP != 0 )
+
+	static BaseType_t prvAcceptGzip( const char *pcRestData, const char *pcEndOfCmd )
+	{
+	const char *pcValue;
+	const char *pcEnd;
+	size_t uxLength;
+	BaseType_t xResult = pdFALSE;
+
+		pcValue = prvGetHeader( pcRestData, pcEndOfCmd, "Accept-Encoding", &uxLength );
+
+		if( pcValue != NULL )
+		{
+			pcEnd = pcValue + uxLength;
+
+			/* Look for "gzip", which may be followed by a quality value.  A
+			quality of zero means that gzip is not acceptable. */
+			for( ; pcValue + 4 <= pcEnd; pcValue++ )
+			{
+				if( ( tolower( ( unsigned char ) pcValue[ 0 ] ) == 'g' ) && ( tolower( ( unsigned char ) pcValue[ 1 ] ) == 'z' ) &&
+					( tolower( ( unsigned char ) pcValue[ 2 ] ) == 'i' ) && ( tolower( ( unsigned char ) pcValue[ 3 ] ) == 'p' ) )
+				{
+					xResult = pdTRUE;
+
+					for( pcValue += 4; ( pcValue < pcEnd ) && ( ( *pcValue == ' ' ) || ( *pcValue == ';' ) ); pcValue++ )
+					{
+					}
+
+					if( ( pcValue + 2 < pcEnd ) && ( tolower( ( unsigned char ) pcValue[ 0 ] ) == 'q' ) && ( pcValue[ 1 ] == '=' ) && ( pcValue[ 2 ] == '0' ) )
+					{
+						/* "q=0", "q=0.0" or "q=0.000" rejects, "q=0.5" accepts. */
+						xResult = pdFALSE;
+						for( pcValue += 3; ( pcValue < pcEnd ) && ( ( *pcValue == '.' ) || ( *pcValue == '0' ) ); pcValue++ )
+						{
+						}
+						if( ( pcValue < pcEnd ) && ( *pcValue >= '1' ) && ( *pcValue <= '9' ) )
+						{
+							xResult = pdTRUE;
+						}
+					}
+					break;
+				}
+			}
+		}
+
+		return xResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSelectGzip( xHTTPClient *pxClient )
+	{
+	FF_Stat_t xStat, xGzipStat;
+	size_t uxLength = strlen( pxClient->pcCurrentFilename );
+
+		pxClient->bits.bGzip = pdFALSE_UNSIGNED;
+
+		if( ( uxLength + sizeof( gzipSUFFIX ) <= sizeof( pxClient->pcCurrentFilename ) ) &&
+			( FreeRTOS_gzip_wanted( pxClient->pcCurrentFilename ) != pdFALSE ) &&
+			( prvAcceptGzip( pxClient->pcRestData, pxClient->pcEndOfCmd ) != pdFALSE ) )
+		{
+			strcpy( pxClient->pcCurrentFilename + uxLength, gzipSUFFIX );
+
+			/* A sibling that is older than the original is not used, it was
+			not made from the current contents. */
+			if( ( ff_stat( pxClient->pcCurrentFilename, &xGzipStat ) == 0 ) &&
+				( ( xGzipStat.st_mode & FF_IFDIR ) == 0u ) )
+			{
+				pxClient->pcCurrentFilename[ uxLength ] = '\0';
+
+				if( ( ff_stat( pxClient->pcCurrentFilename, &xStat ) == 0 ) && ( xGzipStat.st_mtime >= xStat.st_mtime ) )
+				{
+					pxClient->pcCurrentFilename[ uxLength ] = gzipSUFFIX[ 0 ];
+					pxClient->bits.bGzip = pdTRUE_UNSIGNED;
+				}
+			}
+			else
+			{
+				pxClient->pcCurrentFilename[ uxLength ] = '\0';
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigHTTP_USE_GZIP */
+
+#if( ipconfigHTTP_CACHE_ENTRIES > 0 )
+
+	static HTTPCacheEntry_t *prvCacheFind( xHTTPClient *pxClient )
+	{
+	HTTPCacheEntry_t *pxEntry = pxClient->pxParent->xHTTPCache;
+	HTTPCacheEntry_t *pxResult = NULL;
+	BaseType_t x;
+
+		for( x = 0; x < ipconfigHTTP_CACHE_ENTRIES; x++, pxEntry++ )
+		{
+			if( ( pxEntry->pcFileName != NULL ) && ( pxEntry->xStale == pdFALSE ) &&
+				( strcmp( pxEntry->pcFileName, pxClient->pcCurrentFilename ) == 0 ) )
+			{
+				pxResult = pxEntry;
+				break;
+			}
+		}
+
+		return pxResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCacheDrop( HTTPCacheEntry_t *pxEntry )
+	{
+		if( pxEntry->uxUsers == 0u )
+		{
+			vPortFreeLarge( pxEntry->pcFileName );
+			memset( pxEntry, '\0', sizeof( *pxEntry ) );
+		}
+		else
+		{
+			/* Clients are still sending the old contents, the last one will
+			free the entry. */
+			pxEntry->xStale = pdTRUE;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static HTTPCacheEntry_t *prvCacheAdd( xHTTPClient *pxClient, uint32_t ulSize, uint32_t ulModified )
+	{
+	HTTPCacheEntry_t *pxEntry = NULL;
+	HTTPCacheEntry_t *pxCandidate = pxClient->pxParent->xHTTPCache;
+	TickType_t xNow = xTaskGetTickCount();
+	FF_FILE *pxFile;
+	char *pcBlob;
+	size_t uxNameLength, uxHeaderLength;
+	BaseType_t x;
+
+		/* Use a free entry, or else the least recently used one that is not
+		being sent. */
+		for( x = 0; x < ipconfigHTTP_CACHE_ENTRIES; x++, pxCandidate++ )
+		{
+			if( pxCandidate->pcFileName == NULL )
+			{
+				pxEntry = pxCandidate;
+				break;
+			}
+			if( ( pxCandidate->uxUsers == 0u ) &&
+				( ( pxEntry == NULL ) || ( ( xNow - pxCandidate->xLastUsed ) > ( xNow - pxEntry->xLastUsed ) ) ) )
+			{
+				pxEntry = pxCandidate;
+			}
+		}
+
+		if( pxEntry != NULL )
+		{
+			pxFile = ff_fopen( pxClient->pcCurrentFilename, "rb" );
+
+			if( pxFile == NULL )
+			{
+				pxEntry = NULL;
+			}
+			else
+			{
+				if( pxEntry->pcFileName != NULL )
+				{
+					prvCacheDrop( pxEntry );
+				}
+
+				/* The name, the header lines and the contents are stored in a
+				single allocation.  The header lines are formatted in the file
+				buffer first, to learn their length. */
+				uxNameLength = strlen( pxClient->pcCurrentFilename ) + 1u;
+				uxHeaderLength = prvFormatHeaders( pxClient, pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), WEB_REPLY_OK, ulSize ) + 1u;
+				pcBlob = ( char * ) pvPortMallocLarge( uxNameLength + uxHeaderLength + ulSize );
+
+				if( ( pcBlob != NULL ) &&
+					( ff_fread( pcBlob + uxNameLength + uxHeaderLength, 1, ulSize, pxFile ) == ulSize ) )
+				{
+					memcpy( pcBlob, pxClient->pcCurrentFilename, uxNameLength );
+					memcpy( pcBlob + uxNameLength, pcFILE_BUFFER, uxHeaderLength );
+					pxEntry->pcFileName = pcBlob;
+					pxEntry->pcHeaders = pcBlob + uxNameLength;
+					pxEntry->pucData = ( const uint8_t * ) ( pcBlob + uxNameLength + uxHeaderLength );
+					pxEntry->ulSize = ulSize;
+					pxEntry->ulModified = ulModified;
+					pxEntry->xValidated = xNow;
+					FreeRTOS_printf( ( "HTTP cache: %s (%lu bytes)\n", pxEntry->pcFileName, ulSize ) );
+				}
+				else
+				{
+					if( pcBlob != NULL )
+					{
+						vPortFreeLarge( pcBlob );
+					}
+					pxEntry = NULL;
+				}
+
+				ff_fclose( pxFile );
+			}
+		}
+
+		return pxEntry;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigHTTP_CACHE_ENTRIES */
+
 static BaseType_t prvOpenUrl( xHTTPClient *pxClient )
 {
 BaseType_t xRc;
 char pcSlash[ 2 ];
+FF_Stat_t xStat;
+int iStatus;
+#if( ipconfigHTTP_CACHE_ENTRIES > 0 )
+	HTTPCacheEntry_t *pxEntry;
+#endif
 
-	pxClient->bits.ulFlags = 0;
+	pxClient->bits.bReplySent = pdFALSE;
 
 	if( pxClient->pcUrlData[ 0 ] != '/' )
 	{
@@ -254,6 +757,116 @@ char pcSlash[ 2 ];
 		pcSlash,
 		pxClient->pcUrlData);
 
+	/* The type of the contents follows the name in the URL. */
+	strcpy( pxClient->pxBuffers->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
+
+	#if( ipconfigHTTP_USE_GZIP != 0 )
+	{
+		prvSelectGzip( pxClient );
+	}
+	#endif
+
+	#if( ipconfigHTTP_CACHE_ENTRIES > 0 )
+	{
+		httpCACHE_LOCK( pxClient );
+		pxEntry = prvCacheFind( pxClient );
+
+		if( ( pxEntry != NULL ) && ( ( xTaskGetTickCount() - pxEntry->xValidated ) < httpCACHE_VALIDATE_TICKS ) )
+		{
+			/* Checked recently, no need to look at the disk. */
+			xStat.st_size = pxEntry->ulSize;
+			xStat.st_mtime = pxEntry->ulModified;
+			xStat.st_mode = 0u;
+			iStatus = 0;
+		}
+		else
+		{
+			iStatus = ff_stat( pxClient->pcCurrentFilename, &xStat );
+
+			if( pxEntry != NULL )
+			{
+				if( ( iStatus == 0 ) && ( xStat.st_size == pxEntry->ulSize ) && ( xStat.st_mtime == pxEntry->ulModified ) )
+				{
+					pxEntry->xValidated = xTaskGetTickCount();
+				}
+				else
+				{
+					prvCacheDrop( pxEntry );
+					pxEntry = NULL;
+				}
+			}
+		}
+
+		if( pxEntry != NULL )
+		{
+			/* Claim the entry before the lock is released, prvFileClose()
+			will release it again. */
+			pxEntry->uxUsers++;
+			pxEntry->xLastUsed = xTaskGetTickCount();
+			pxClient->pxCacheEntry = pxEntry;
+		}
+		httpCACHE_UNLOCK( pxClient );
+	}
+	#else
+	{
+		iStatus = ff_stat( pxClient->pcCurrentFilename, &xStat );
+	}
+	#endif /* ipconfigHTTP_CACHE_ENTRIES */
+
+	if( ( iStatus != 0 ) || ( ( xStat.st_mode & FF_IFDIR ) != 0u ) )
+	{
+		FreeRTOS_printf( ( "Open file '%s': %s\n", pxClient->pcCurrentFilename, strerror( stdioGET_ERRNO() ) ) );
+		pxClient->pxBuffers->pcContentsType[0] = '\0';
+		return prvSendReply( pxClient, WEB_NOT_FOUND );	/* "404 File not found" */
+	}
+
+	prvSetValidators( pxClient, xStat.st_size, xStat.st_mtime );
+
+	if( prvNotModified( pxClient ) != pdFALSE )
+	{
+		/* The client has this version already. */
+		return prvSendReply( pxClient, WEB_NOT_MODIFIED );	/* "304 Not Modified" */
+	}
+
+	#if( ipconfigHTTP_CACHE_ENTRIES > 0 )
+	{
+		if( ( pxEntry == NULL ) && ( xStat.st_size <= ( uint32_t ) ipconfigHTTP_CACHE_MAX_FILE_SIZE ) )
+		{
+			/* The file is read while holding the lock, it is small. */
+			httpCACHE_LOCK( pxClient );
+			pxEntry = prvCacheAdd( pxClient, xStat.st_size, xStat.st_mtime );
+
+			if( pxEntry != NULL )
+			{
+				pxEntry->uxUsers++;
+				pxEntry->xLastUsed = xTaskGetTickCount();
+				pxClient->pxCacheEntry = pxEntry;
+			}
+			httpCACHE_UNLOCK( pxClient );
+		}
+
+		if( pxEntry != NULL )
+		{
+			/* Send the prebuilt reply from RAM. */
+			pxClient->xBytesLeft = pxEntry->ulSize;
+
+			xRc = prvSendHeader( pxClient, WEB_REPLY_OK, pxEntry->pcHeaders, pxEntry->pucData, pxEntry->ulSize );
+
+			if( xRc >= 0 )
+			{
+				pxClient->xBytesLeft -= ( size_t ) xRc;
+				xRc = prvSendFile( pxClient );
+			}
+			else
+			{
+				prvReplyDone( pxClient );
+			}
+
+			return xRc;
+		}
+	}
+	#endif /* ipconfigHTTP_CACHE_ENTRIES */
+
 	pxClient->pxFileHandle = ff_fopen( pxClient->pcCurrentFilename, "rb" );
 
 	FreeRTOS_printf( ( "Open file '%s': %s\n", pxClient->pcCurrentFilename,
@@ -261,12 +874,22 @@ char pcSlash[ 2 ];
 
 	if( pxClient->pxFileHandle == NULL )
 	{
+		pxClient->pxBuffers->pcETag[0] = '\0';
 		xRc = prvSendReply( pxClient, WEB_NOT_FOUND );	/* "404 File not found" */
 	}
 	else
 	{
 		pxClient->xBytesLeft = pxClient->pxFileHandle->ulFileSize;
-		xRc = prvSendFile( pxClient );
+		xRc = prvSendHeader( pxClient, WEB_REPLY_OK, NULL, NULL, 0u );	/* "Requested file action OK" */
+
+		if( xRc >= 0 )
+		{
+			xRc = prvSendFile( pxClient );
+		}
+		else
+		{
+			prvReplyDone( pxClient );
+		}
 	}
 
 	return xRc;
@@ -309,33 +932,116 @@ BaseType_t xHTTPClientWork( xTCPClient *pxTCPClient )
 BaseType_t xRc;
 xHTTPClient *pxClient = ( xHTTPClient * ) pxTCPClient;
 
-	if( pxClient->pxFileHandle != NULL )
+	if( prvReplyBusy( pxClient ) != pdFALSE )
 	{
-		prvSendFile( pxClient );
+		xRc = prvSendFile( pxClient );
+
+		if( xRc < 0 )
+		{
+			/* The connection will be closed and the client will be deleted */
+			return xRc;
+		}
+
+		if( prvReplyBusy( pxClient ) != pdFALSE )
+		{
+			/* A persistent connection: the next request waits in the RX
+			stream until this reply has been sent. */
+			return 0;
+		}
+	}
+
+	if( ( FreeRTOS_tx_size( pxClient->xSocket ) > 0 ) &&
+		( FreeRTOS_tx_space( pxClient->xSocket ) < ( BaseType_t ) sizeof( pcFILE_BUFFER ) ) )
+	{
+		/* The previous reply is still filling the TX stream, make sure the
+		header of the next one fits in. */
+		FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_READ );
+		FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+		return 0;
 	}
+	FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+	FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_READ );
 
-	xRc = FreeRTOS_recv( pxClient->xSocket, ( void * )pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ), 0 );
+	/* The server does not use request bodies, skip the body of the previous
+	request before looking for the next one. */
+	if( pxClient->uxBodyLeft != 0u )
+	{
+		xRc = FreeRTOS_recv( pxClient->xSocket, ( void * )pcCOMMAND_BUFFER,
+			( pxClient->uxBodyLeft < sizeof( pcCOMMAND_BUFFER ) ) ? pxClient->uxBodyLeft : sizeof( pcCOMMAND_BUFFER ), 0 );
+
+		if( xRc <= 0 )
+		{
+			return xRc;
+		}
+
+		pxClient->uxBodyLeft -= ( size_t ) xRc;
+
+		if( pxClient->uxBodyLeft != 0u )
+		{
+			return 0;
+		}
+	}
+
+	/* Only peek: the request is taken from the stream when it is complete,
+	and a pipelined next request stays there.  Leave room for the
+	terminating nul. */
+	xRc = FreeRTOS_recv( pxClient->xSocket, ( void * )pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ) - 1, FREERTOS_MSG_PEEK );
 
 	if( xRc > 0 )
 	{
 	BaseType_t xIndex;
-	const char *pcEndOfCmd;
+	BaseType_t xConsumed;
+	char *pcEndOfCmd;
+	const char *pcValue;
+	size_t uxLength;
 	const struct xWEB_COMMAND *curCmd;
 	char *pcBuffer = pcCOMMAND_BUFFER;
 
-		if( xRc < ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) )
+		pcBuffer[ xRc ] = '\0';
+
+		/* The request line and the headers end with an empty line. */
+		for( pcEndOfCmd = strchr( pcBuffer, '\n' ); pcEndOfCmd != NULL; pcEndOfCmd = strchr( pcEndOfCmd, '\n' ) )
 		{
-			pcBuffer[ xRc ] = '\0';
+			pcEndOfCmd++;
+			if( ( pcEndOfCmd[ 0 ] == '\n' ) || ( ( pcEndOfCmd[ 0 ] == '\r' ) && ( pcEndOfCmd[ 1 ] == '\n' ) ) )
+			{
+				break;
+			}
 		}
-		while( xRc && ( pcBuffer[ xRc - 1 ] == 13 || pcBuffer[ xRc - 1 ] == 10 ) )
+
+		if( pcEndOfCmd == NULL )
 		{
-			pcBuffer[ --xRc ] = '\0';
+			if( ( xRc < ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) - 1 ) && ( FreeRTOS_issocketconnected( pxClient->xSocket ) != pdFALSE ) )
+			{
+				/* The rest of the headers is still on its way.  The data stays
+				in the stream, stop selecting the socket so that it is looked
+				at again in the next periodic work cycle. */
+				FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_READ );
+				return 0;
+			}
+
+			/* The headers do not fit in the buffer, or the client stopped
+			sending before the empty line.  The connection is closed after
+			the reply. */
+			FreeRTOS_printf( ( "xHTTPClientWork: incomplete request (%ld bytes)\n", xRc ) );
+			pxClient->bits.bKeepAlive = pdFALSE;
+			return prvSendReply( pxClient, ( xRc == ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) - 1 ) ? WEB_REQUEST_HEADER_TOO_LARGE : WEB_BAD_REQUEST );
 		}
-		pcEndOfCmd = pcBuffer + xRc;
+
+		/* Take the request from the stream, up to and including the empty
+		line.  The same bytes are copied over themselves. */
+		xConsumed = ( BaseType_t ) ( pcEndOfCmd - pcBuffer ) + ( ( pcEndOfCmd[ 0 ] == '\r' ) ? 2 : 1 );
+		( void ) FreeRTOS_recv( pxClient->xSocket, ( void * )pcBuffer, xConsumed, 0 );
+
+		/* Anything after the empty line belongs to the body or to the next
+		request. */
+		*pcEndOfCmd = '\0';
+		xRc = ( BaseType_t ) ( pcEndOfCmd - pcBuffer );
+		pxClient->pcEndOfCmd = pcEndOfCmd;
 
 		curCmd = xWebCommands;
 		pxClient->pcUrlData = pcBuffer;			/* Pointing to "/index.html HTTP/1.1" */
-		pxClient->pcRestData = pcEmptyString;	/* Pointing to "HTTP/1.1" */
+		pxClient->pcRestData = pcEndOfCmd;		/* Pointing to "HTTP/1.1" */
 
 		// Last entry is "ECMD_UNK"
 		for( xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++ )
@@ -361,6 +1067,11 @@ xHTTPClient *pxClient = ( xHTTPClient * ) pxTCPClient;
 				break;
 			}
 		}
+		pxClient->bits.bKeepAlive = prvKeepAlive( pxClient->pcRestData, pcEndOfCmd );
+
+		pcValue = prvGetHeader( pxClient->pcRestData, pcEndOfCmd, "Content-Length", &uxLength );
+		pxClient->uxBodyLeft = ( pcValue != NULL ) ? ( size_t ) strtoul( pcValue, NULL, 10 ) : 0u;
+
 		xRc = prvProcessCmd( pxClient, xIndex );
 	}
 	else if( xRc < 0 )
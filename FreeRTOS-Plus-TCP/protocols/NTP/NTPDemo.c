@@ -181,6 +181,14 @@ void vStartNTPTask( uint16_t usTaskStackSize, UBaseType_t uxTaskPriority )
 
 			FreeRTOS_bind( xUDPSocket, &xAddress, sizeof( xAddress ) );
 			FreeRTOS_setsockopt( xUDPSocket, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
+			#if( ipconfigUSE_TX_PRIORITY != 0 )
+			{
+			/* NTP requests are time critical, they must not wait behind bulk traffic. */
+			BaseType_t xHighPriority = pdTRUE;
+
+				FreeRTOS_setsockopt( xUDPSocket, 0, FREERTOS_SO_TX_PRIORITY, &xHighPriority, sizeof( xHighPriority ) );
+			}
+			#endif
 			xTaskCreate( 	prvNTPTask,						/* The function that implements the task. */
 							( const char * ) "NtpClient",	/* Just a text name for the task to aid debugging. */
 							usTaskStackSize,				/* The stack size is defined in FreeRTOSIPConfig.h. */
@@ -60,11 +60,13 @@
 enum {
 	WEB_REPLY_OK = 200,
 	WEB_NO_CONTENT = 204,
+	WEB_NOT_MODIFIED = 304,
 	WEB_BAD_REQUEST = 400,
 	WEB_UNAUTHORIZED = 401,
 	WEB_NOT_FOUND = 404,
 	WEB_GONE = 410,
 	WEB_PRECONDITION_FAILED = 412,
+	WEB_REQUEST_HEADER_TOO_LARGE = 431,
 	WEB_INTERNAL_SERVER_ERROR = 500,
 };
 
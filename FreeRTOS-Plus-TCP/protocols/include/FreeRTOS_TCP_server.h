@@ -105,12 +105,19 @@ struct xSERVER_CONFIG
 	BaseType_t xPortNumber;			/* e.g. 80, 8080, 21 */
 	BaseType_t xBackLog;			/* e.g. 10, maximum number of connected TCP clients */
 	const char * const pcRootDir;	/* Treat this directory as the root directory */
+	BaseType_t xWorkerCount;		/* e.g. 2, tasks that work on the clients.  0: FreeRTOS_TCPServerWork() does it */
+	UBaseType_t uxWorkerPriority;	/* The priority of those tasks */
 };
 
 struct xTCP_SERVER;
 typedef struct xTCP_SERVER TCPServer_t;
 
 TCPServer_t *FreeRTOS_CreateTCPServer( const struct xSERVER_CONFIG *pxConfigs, BaseType_t xCount );
+
+/* One working cycle: wait at most xBlockingTime for events, accept new clients
+and work on the clients.  Clients of a server with workers are passed to those
+tasks, so a slow file operation of one client does not hold up the others.  A
+client is owned by at most one task at a time. */
 void FreeRTOS_TCPServerWork( TCPServer_t *pxServer, TickType_t xBlockingTime );
 
 #if( ipconfigSUPPORT_SIGNALS != 0 )
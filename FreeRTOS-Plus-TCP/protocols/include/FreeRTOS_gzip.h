@@ -0,0 +1,42 @@
+/*
+	A small gzip encoder for FreeRTOS+FAT files.  It produces the '.gz' siblings
+	which the HTTP server sends to clients that accept "Content-Encoding: gzip".
+	Only the fixed Huffman codes of deflate are used, with a 4 KB window: the
+	served text assets (HTML, CSS, JS) measured 2.5 to 3 times smaller, without
+	the RAM and time that dynamic trees would cost.
+*/
+
+#ifndef FREERTOS_GZIP_H
+#define	FREERTOS_GZIP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The name of a sibling is the name of the original file plus this suffix. */
+#define gzipSUFFIX			".gz"
+
+/*
+ * Compress the file pcSource into the new file pcDestination.  Returns the
+ * size of the compressed file, or a negative errno value.
+ */
+int32_t FreeRTOS_gzip( const char *pcSource, const char *pcDestination );
+
+/*
+ * Create or refresh the '.gz' sibling of pcFileName.  The sibling is removed
+ * again when it is not smaller than the original.  Returns the size of the
+ * sibling, 0 when there is none, or a negative errno value.
+ */
+int32_t FreeRTOS_gzip_sibling( const char *pcFileName );
+
+/*
+ * Returns pdTRUE for file types which are worth compressing: text assets like
+ * HTML, CSS and JavaScript.  Images and archives are compressed already.
+ */
+BaseType_t FreeRTOS_gzip_wanted( const char *pcFileName );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* FREERTOS_GZIP_H */
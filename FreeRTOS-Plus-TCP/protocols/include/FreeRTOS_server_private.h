@@ -64,6 +64,10 @@
 
 #define FREERTOS_NO_SOCKET		NULL
 
+/* FreeRTOS includes. */
+#include "os_queue.h"
+#include "os_semphr.h"
+
 /* FreeRTOS+FAT */
 #include "ff_stdio.h"
 
@@ -88,18 +92,75 @@
 	#define ipconfigTCP_FILE_BUFFER_SIZE	( 2048 )
 #endif
 
+/*
+ * The HTTP server keeps small files in RAM, together with the prebuilt header
+ * lines of their reply.  ipconfigHTTP_CACHE_ENTRIES is the number of files, 0
+ * disables the cache.  Files larger than ipconfigHTTP_CACHE_MAX_FILE_SIZE are
+ * always read from the disk.  A cached file is compared with the disk (using
+ * ff_stat()) when it was last checked more than ipconfigHTTP_CACHE_VALIDATE_MS
+ * ago.
+ */
+#ifndef ipconfigHTTP_CACHE_ENTRIES
+	#define ipconfigHTTP_CACHE_ENTRIES		( 8 )
+#endif
+
+#ifndef ipconfigHTTP_CACHE_MAX_FILE_SIZE
+	#define ipconfigHTTP_CACHE_MAX_FILE_SIZE	( 4096 )
+#endif
+
+#ifndef ipconfigHTTP_CACHE_VALIDATE_MS
+	#define ipconfigHTTP_CACHE_VALIDATE_MS	( 1000 )
+#endif
+
+/*
+ * When ipconfigHTTP_USE_GZIP is non-zero, the HTTP server sends the '.gz'
+ * sibling of a text file with "Content-Encoding: gzip" to the clients that
+ * accept it.  Siblings are made with FreeRTOS_gzip_sibling(), and are only
+ * used when they are not older than the original file.
+ */
+#ifndef ipconfigHTTP_USE_GZIP
+	#define ipconfigHTTP_USE_GZIP			( 1 )
+#endif
+
+/*
+ * A server with 'xWorkerCount' set in its xSERVER_CONFIG hands its clients to
+ * worker tasks: FreeRTOS_TCPServerWork() keeps calling select() and accept(),
+ * and passes a client to a worker when one of its sockets has an event, or
+ * when it was not worked on during the blocking time.
+ * ipconfigTCP_SERVER_WORKER_STACK_SIZE is the stack size of a worker, in
+ * words.  When select() only reports sockets of clients which are still being
+ * worked on, FreeRTOS_TCPServerWork() waits at most
+ * ipconfigTCP_SERVER_BUSY_POLL_MS for a worker to finish, instead of calling
+ * select() again right away.
+ */
+#ifndef ipconfigTCP_SERVER_WORKER_STACK_SIZE
+	#define ipconfigTCP_SERVER_WORKER_STACK_SIZE	( configMINIMAL_STACK_SIZE * 12 )
+#endif
+
+#ifndef ipconfigTCP_SERVER_BUSY_POLL_MS
+	#define ipconfigTCP_SERVER_BUSY_POLL_MS		( 10 )
+#endif
+
 struct xTCP_CLIENT;
 
 typedef BaseType_t ( * FTCPWorkFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
 typedef void ( * FTCPDeleteFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
 
+/* 'pxBuffers' is set before each call to 'fWorkFunction': it points to the
+buffers of the task which does the work.  'xBusy' is pdTRUE while a worker owns
+the client, the worker leaves the result of 'fWorkFunction' in 'xWorkResult'. */
 #define	TCP_CLIENT_FIELDS \
 	enum eSERVER_TYPE eType; \
 	struct xTCP_SERVER *pxParent; \
+	struct xTCP_BUFFERS *pxBuffers; \
 	Socket_t xSocket; \
 	const char *pcRootDir; \
 	FTCPWorkFunction fWorkFunction; \
 	FTCPDeleteFunction fDeleteFunction; \
+	QueueHandle_t xWorkQueue; \
+	TickType_t xLastWork; \
+	volatile BaseType_t xBusy; \
+	volatile BaseType_t xWorkResult; \
 	struct xTCP_CLIENT *pxNextClient
 
 typedef struct xTCP_CLIENT
@@ -118,13 +179,20 @@ struct xHTTP_CLIENT
 
 	const char *pcUrlData;
 	const char *pcRestData;
+	const char *pcEndOfCmd;		/* End of the request headers, the header scans stop here. */
+	size_t uxBodyLeft;			/* Bytes of the request body still to be skipped. */
 	char pcCurrentFilename[ ffconfigMAX_FILENAME ];
 	size_t xBytesLeft;
 	FF_FILE *pxFileHandle;
+	#if( ipconfigHTTP_CACHE_ENTRIES > 0 )
+		struct xHTTP_CACHE_ENTRY *pxCacheEntry;	/* The cached file that is being sent. */
+	#endif
 	union {
 		struct {
 			uint32_t
-				bReplySent : 1;
+				bReplySent : 1,
+				bKeepAlive : 1,		/* Read the next request when the reply has been sent. */
+				bGzip : 1;			/* pcCurrentFilename is the '.gz' sibling of the URL. */
 		};
 		uint32_t ulFlags;
 	} bits;
@@ -132,6 +200,19 @@ struct xHTTP_CLIENT
 
 typedef struct xHTTP_CLIENT xHTTPClient;
 
+typedef struct xHTTP_CACHE_ENTRY
+{
+	char *pcFileName;			/* The full path, NULL when the entry is free.  The same allocation holds pcHeaders and pucData. */
+	const char *pcHeaders;		/* The prebuilt entity header lines of the reply. */
+	const uint8_t *pucData;		/* The contents of the file. */
+	uint32_t ulSize;			/* st_size and st_mtime when the file was read. */
+	uint32_t ulModified;
+	TickType_t xValidated;		/* The time the file was last compared with the disk. */
+	TickType_t xLastUsed;		/* The least recently used entry is replaced first. */
+	UBaseType_t uxUsers;		/* The number of clients sending pucData right now. */
+	BaseType_t xStale;			/* The file has changed: free the entry when it is no longer used. */
+} HTTPCacheEntry_t;
+
 struct xFTP_CLIENT
 {
 	/* This define contains fields which must come first within each of the client structs */
@@ -187,9 +268,20 @@ void vFTPClientDelete( xTCPClient *pxClient );
 
 BaseType_t xMakeAbsolute( struct xFTP_CLIENT *pxClient, char *pcBuffer, BaseType_t xBufferLength, const char *pcFileName );
 
-struct xTCP_SERVER
+/*
+ * Read at most uxCount bytes from the current position of pxFile directly into
+ * the TX stream of the TCP socket xSocket, without an intermediate buffer.  It
+ * does not block: only the space that is free now is used.  Returns the number
+ * of bytes queued, or a negative errno value (-pdFREERTOS_ERRNO_EIO when the
+ * file could not be read).
+ */
+BaseType_t FreeRTOS_sendfile( Socket_t xSocket, FF_FILE *pxFile, size_t uxCount );
+
+/* The buffers which a client only uses during a call to its work function.
+The server has one set for the clients it works on itself, each worker task
+has its own set. */
+typedef struct xTCP_BUFFERS
 {
-	SocketSet_t xSocketSet;
 	/* A buffer to receive and send TCP commands, either HTTP of FTP. */
 	char pcCommandBuffer[ ipconfigTCP_COMMAND_BUFFER_SIZE ];
 	/* A buffer to access the file system: read or write data. */
@@ -201,7 +293,20 @@ struct xTCP_SERVER
 	#if( ipconfigUSE_HTTP != 0 )
 		char pcContentsType[40];	/* Space for the msg: "text/javascript" */
 		char pcExtraContents[40];	/* Space for the msg: "Content-Length: 346500" */
+		char pcETag[24];			/* Space for the msg: "\"1f2a-5a0b7c31\"" */
+		char pcLastModified[32];	/* Space for the msg: "Sun, 06 Nov 1994 08:49:37 GMT" */
+	#endif
+} TCPBuffers_t;
+
+struct xTCP_SERVER
+{
+	SocketSet_t xSocketSet;
+	TCPBuffers_t xBuffers;
+	#if( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+		HTTPCacheEntry_t xHTTPCache[ ipconfigHTTP_CACHE_ENTRIES ];
+		SemaphoreHandle_t xHTTPCacheMutex;	/* The cache is shared by the workers. */
 	#endif
+	TaskHandle_t xServerTask;	/* The task calling FreeRTOS_TCPServerWork(), woken up by the workers. */
 	BaseType_t xServerCount;
 	xTCPClient *pxClients;
 	struct xSERVER
@@ -209,6 +314,7 @@ struct xTCP_SERVER
 		enum eSERVER_TYPE eType;		/* eSERVER_HTTP | eSERVER_FTP */
 		const char *pcRootDir;
 		Socket_t xSocket;
+		QueueHandle_t xWorkQueue;		/* Clients to be worked on, NULL when the server has no workers. */
 	} xServers[ 1 ];
 };
 
@@ -197,8 +197,45 @@ http://www.freertos.org/Stacks-and-stack-overflow-checking.html */
 #define ipconfigETHERNET_DRIVER_RX_TASK_PRIORITY			( (configMAX_PRIORITIES - 4)  | portPRIVILEGE_BIT)
 #define ipconfigETHERNET_DRIVER_RX_TASK_STACK_SIZE_WORDS	( configMINIMAL_STACK_SIZE * 3 )
 
-/* EMAC_TX block time */
-#define ipconfigETHERNET_DRIVER_TX_BLOCK_TIME			2
+/* Az EMAC RX gyrben tartott hlzati pufferek szma (zero-copy vtel), ezek az
+ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS kzl foglaltak. */
+#define ipconfigETHERNET_DRIVER_RX_BUFFERS					( 12 )
+
+/* Adaptv vtel: ha egy menetben legalbb ipconfigETHERNET_DRIVER_RX_POLL_THRESHOLD csomag jtt, az RX taszk
+tiltja az RX megszaktst s ipconfigETHERNET_DRIVER_RX_POLL_PERIOD tickenknt, menetenknt legfeljebb
+ipconfigETHERNET_DRIVER_RX_BUDGET csomagot olvas, amg a gyr ki nem rl. Megszaktsos mdban az EMAC
+legfeljebb ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS RX megszaktst ad milliszekundumonknt. */
+#define ipconfigETHERNET_DRIVER_RX_BUDGET					( 12 )
+#define ipconfigETHERNET_DRIVER_RX_POLL_THRESHOLD			( 4 )
+#define ipconfigETHERNET_DRIVER_RX_POLL_PERIOD				( 1 )	/* Ticks */
+#define ipconfigETHERNET_DRIVER_RX_MAX_INT_PER_MS			( 16 )
+
+/* Az RX taszk egy menetben vett csomagjait pxNextBuffer-rel lncolva, egyetlen eNetworkRxEvent-tel adja t az IP taszknak. */
+#define ipconfigUSE_LINKED_RX_MESSAGES						1
+
+/* A broadcast csomagok sajt EMAC RX csatornn (gyr, taszk) rkeznek. Egy csatorna csak akkor ad t csomagot
+a stacknek, ha utna tbb mint ..._RESERVED_BUFFERS szabad hlzati puffer marad; az idkritikus (NTP, PTP)
+csomagokra ez nem vonatkozik. */
+#define ipconfigETHERNET_DRIVER_RX_RESERVED_BUFFERS			( 2 )
+#define ipconfigETHERNET_DRIVER_RX_BROADCAST_CHANNEL		( 1U )
+#define ipconfigETHERNET_DRIVER_RX_BROADCAST_BUFFERS		( 4 )
+#define ipconfigETHERNET_DRIVER_RX_BROADCAST_RESERVED_BUFFERS	( 8 )
+#define ipconfigETHERNET_DRIVER_RX_BROADCAST_TASK_PRIORITY	( (configMAX_PRIORITIES - 5)  | portPRIVILEGE_BIT)
+
+/* Zero-copy klds: a TX BD kzvetlenl a hlzati pufferre mutat, amelyet a TX
+megszakts szabadt fel, amikor az EMAC visszaadta a BD-t. */
+#define ipconfigZERO_COPY_TX_DRIVER						1
+
+/* Az EMAC TX gyrk mrete (BD, CPPI RAM). Az xNetworkInterfaceOutput() nem vr szabad BD-re,
+tele gyrnl eldobja a csomagot, ezrt a norml gyr nagyobb, mint ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS. */
+#define ipconfigETHERNET_DRIVER_TX_BUFFERS					( 64 )
+#define ipconfigETHERNET_DRIVER_TX_PRIORITY_BUFFERS			( 8 )
+
+/* Frames of sockets with FREERTOS_SO_TX_PRIORITY set (PTP, NTP) are sent on a
+separate EMAC TX channel. The EMAC uses fixed-priority channel selection where
+channel 7 is the highest, so this channel must be above the normal channel (0). */
+#define ipconfigUSE_TX_PRIORITY							1
+#define ipconfigETHERNET_DRIVER_TX_PRIORITY_CHANNEL		(7U)
 
 /* ipconfigRAND32() is called by the IP stack to generate random numbers for
 things such as a DHCP transaction number or initial sequence number.  Random
@@ -263,8 +300,10 @@ address the MAC address and IP address are added to the ARP cache.  When a UDP
 message is sent to a remote IP address that does not already appear in the ARP
 cache then the UDP message is replaced by a ARP message that solicits the
 required MAC address information.  ipconfigARP_CACHE_ENTRIES defines the maximum
-number of entries that can exist in the ARP table at any one time. */
-#define ipconfigARP_CACHE_ENTRIES		6
+number of entries that can exist in the ARP table at any one time.  The cache is
+hash indexed, so it is sized for the many peers of the synchronised network. */
+#define ipconfigARP_CACHE_ENTRIES		256
+#define ipconfigARP_HASH_BUCKETS		64
 
 /* ARP requests that do not result in an ARP response will be re-transmitted a
 maximum of ipconfigMAX_ARP_RETRANSMISSIONS times before the ARP request is
@@ -278,6 +317,11 @@ age.  ipconfigMAX_ARP_AGE is specified in tens of seconds, so a value of 150 is
 equal to 1500 seconds (or 25 minutes). */
 #define ipconfigMAX_ARP_AGE			150
 
+/* Entries used for sending are refreshed with unicast ARP requests from this
+age on (60 seconds before expiry), at most 16 requests per 10 second period. */
+#define ipconfigARP_REFRESH_AGE				6
+#define ipconfigARP_MAX_REFRESH_PER_PERIOD	16
+
 /* Implementing FreeRTOS_inet_addr() necessitates the use of string handling
 routines, which are relatively large.  To save code space the full
 FreeRTOS_inet_addr() implementation is made optional, and a smaller and faster
@@ -294,7 +338,13 @@ not set to 1 then only FreeRTOS_indet_addr_quick() is available. */
 are available to the IP stack.  The total number of network buffers is limited
 to ensure the total amount of RAM that can be consumed by the IP stack is capped
 to a pre-determinable value. */
-#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS		(20)
+#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS		(32)
+
+/* Kis pufferek ARP csomagokhoz, TCP nyugtkhoz s rvid UDP zenetekhez, a fenti
+teljes mret pufferek mellett.  Small buffers for ARP, TCP ACK's and short UDP
+messages, in addition to the full-sized buffers above. */
+#define ipconfigNUM_SMALL_NETWORK_BUFFERS			(16)
+#define ipconfigSMALL_NETWORK_BUFFER_SIZE			(128)
 
 /* FLow controll related defines */
 #define ipconfigETHERNET_DRIVER_RX_FLOW_CONTROLL	(1)
@@ -309,7 +359,7 @@ to a pre-determinable value. */
 stack.  ipconfigEVENT_QUEUE_LENGTH sets the maximum number of events that can
 be queued for processing at any one time.  The event queue must be a minimum of
 5 greater than the total number of network buffers. */
-#define ipconfigEVENT_QUEUE_LENGTH		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + 5 )
+#define ipconfigEVENT_QUEUE_LENGTH		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + ipconfigNUM_SMALL_NETWORK_BUFFERS + 5 )
 
 /* The address of a socket is the combination of its IP address and its port
 number.  FreeRTOS_bind() is used to manually allocate a port number to a socket
@@ -335,6 +385,10 @@ aborted. */
 /* USE_WIN: Let TCP use windowing mechanism. */
 #define ipconfigUSE_TCP_WIN			( 1 )
 
+/* Number of buckets in the socket lookup hash tables (power of 2).  Many client
+connections run next to the FTP, HTTP, NTP, CLI and streaming sockets. */
+#define ipconfigSOCKET_HASH_BUCKETS	( 64 )
+
 /* The MTU is the maximum number of bytes the payload of a network frame can
 contain.  For normal Ethernet V2 frames the maximum MTU is 1500.  Setting a
 lower value can save RAM, depending on the buffer management scheme used.  If
@@ -421,6 +475,16 @@ disconnecting stage will timeout after a period of non-activity. */
 #define ipconfigHTTP_RX_BUFSIZE				( 4 * ipconfigTCP_MSS )
 #define ipconfigHTTP_RX_WINSIZE				( 4 )
 
+/* Kis fjlok (a /ram/web oldalai) a memriban, a fejlccel egytt trolva. */
+#define ipconfigHTTP_CACHE_ENTRIES			( 8 )
+#define ipconfigHTTP_CACHE_MAX_FILE_SIZE	( 8192 )
+#define ipconfigHTTP_CACHE_VALIDATE_MS		( 1000 )
+
+/* A szveges fjlok .gz testvrt kldjk, ha a bngsz elfogadja (Content-Encoding: gzip).
+Az FTP-vel a configHTTP_ROOT al feltlttt fjlokhoz a testvrt a vApplicationFTPReceivedHook() kszti. */
+#define ipconfigHTTP_USE_GZIP				1
+#define ipconfigFTP_HAS_RECEIVED_HOOK		1
+
 #define ipconfigFTP_TX_BUFSIZE				( 4 * ipconfigTCP_MSS )
 #define ipconfigFTP_TX_WINSIZE				( 4 )
 #define ipconfigFTP_RX_BUFSIZE				( 4 * ipconfigTCP_MSS )
@@ -436,9 +500,44 @@ disconnecting stage will timeout after a period of non-activity. */
 #define ipconfigUSE_TCP_TIMESTAMPS				0
 #define ipconfigSUPPORT_SIGNALS					0
 
-#define ipconfigFTP_TX_ZERO_COPY 0
-#define ipconfigFTP_ZERO_COPY_ALIGNED_WRITES	0	// TODO: kiderteni, hogy mirt fagy, ha == 1
+#define ipconfigFTP_TX_ZERO_COPY 1					// RETR: a fjl kzvetlenl a TX streambe olvasva (FreeRTOS_sendfile)
+#define ipconfigFTP_ZERO_COPY_ALIGNED_WRITES	1	// STOR: szektorhatrra igaztott rs kzvetlenl az RX streambl
 #define ipconfigTCP_IP_SANITY 					0
 
+/* Csomagrgzts a /ram/capN.pcapng fjlokba, a "pcap" paranccsal indthat.
+Packet capture to /ram/capN.pcapng, controlled by the "pcap" command. */
+#define ipconfigUSE_PCAP						1
+#define ipconfigPCAP_RING_SIZE					( 16384 )
+#define ipconfigPCAP_SNAPLEN					( 128 )
+#define ipconfigPCAP_FILE_SIZE					( 32768 )
+#define ipconfigPCAP_FILE_COUNT					( 3 )
+
+/* iperf2 kompatibilis sebessgmrs (TCP s UDP, 5001-es port), az "iperf" paranccsal indthat.
+iperf2 compatible throughput test on port 5001, controlled by the "iperf" command. */
+#define ipconfigUSE_IPERF						1
+#define ipconfigIPERF_TX_BUFSIZE				( 16 * ipconfigTCP_MSS )
+#define ipconfigIPERF_TX_WINSIZE				( 12 )
+#define ipconfigIPERF_RX_BUFSIZE				( 16 * ipconfigTCP_MSS )
+#define ipconfigIPERF_RX_WINSIZE				( 12 )
+
+/* Az EMAC szmllk 64 bites sszegei s sebessgei, vteli ksleltets hisztogramok, az "emacstat" paranccsal olvashatk.
+EMAC counter totals and rates, receive latency histograms, shown by the "emacstat" command. */
+#define ipconfigUSE_EMAC_STATS					1
+#define ipconfigUSE_RX_TIMESTAMPS				ipconfigUSE_EMAC_STATS
+#define ipconfigEMAC_STATS_PERIOD_MS			( 1000 )
+
+#if( ipconfigUSE_EMAC_STATS != 0 )
+	extern void vEMACStatsIPTaskLatency( uint32_t *pulTimestamp );
+	extern void vEMACStatsSocketLatency( uint32_t *pulTimestamp );
+	extern void vEMACStatsKeepTimestamp( uint32_t *pulTimestamp, uint32_t ulTimestamp );
+	extern void vEMACStatsRxEventLost( void );
+
+	#define iptracePROCESSING_RECEIVED_PACKET( pxNetworkBuffer )		vEMACStatsIPTaskLatency( &( ( pxNetworkBuffer )->ulRxTimestamp ) )
+	#define iptraceRECVFROM_PACKET( pxNetworkBuffer )					vEMACStatsSocketLatency( &( ( pxNetworkBuffer )->ulRxTimestamp ) )
+	#define iptraceTCP_RX_DATA_STORED( pxSocket, pxNetworkBuffer )		vEMACStatsKeepTimestamp( &( ( pxSocket )->u.xTCP.ulRxTimestamp ), ( pxNetworkBuffer )->ulRxTimestamp )
+	#define iptraceRECV_DATA( pxSocket )								vEMACStatsSocketLatency( &( ( pxSocket )->u.xTCP.ulRxTimestamp ) )
+	#define iptraceETHERNET_RX_EVENT_LOST()								vEMACStatsRxEventLost()
+#endif
+
 
 #endif /* FREERTOS_IP_CONFIG_H */
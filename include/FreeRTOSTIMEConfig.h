@@ -10,5 +10,35 @@
 
 #define configTIME_START_EPOCH_TIME		1451606400			/* 2016.01.01 */
 #define configTIME_TIME_ZONE			1					/* GMT+1 */
+#define configTIME_TRIGGER_MAX_WAITERS	4					/* vTaskDelayUntilTime()-ban egyszerre vrakoz taszkok max. szma */
+
+/* GNSS 1PPS bemenet (eCAP) s a PHY ra szablyozsa */
+#define configPPS_ENABLE				1
+#define configPPS_ECAP					ecapREG1			/* A PPS jelet fogad eCAP modul (pinmux: HALCoGen) */
+#define configPPS_ECAP_CLOCK_HZ			75000000UL			/* eCAP rajel: VCLK3 */
+#define configPPS_POLL_PERIOD_MS		20					/* Az eCAP esemny lekrdezsi peridusa */
+#define configPPS_STEP_THRESHOLD_NS		100000				/* Ennl nagyobb eltrsnl az rt lptetjk */
+#define configPPS_LOCK_THRESHOLD_NS		1000				/* Ennl kisebb eltrsnl tekintjk szinkronnak */
+#define configPPS_SERVO_KP				0.7					/* PI szablyoz arnyos tag (ppb/ns) */
+#define configPPS_SERVO_KI				0.3					/* PI szablyoz integrl tag (ppb/ns) */
+#define configPPS_MAX_FREQUENCY_PPB		500000				/* Frekvencia korrekci korltja */
+
+/* PTP idhz igaztott ETPWM rajel kimenetek (pinmux: HALCoGen) */
+#define configCLKOUT_ENABLE				1
+#define configCLKOUT_MAX_OUTPUTS		4
+#define configCLKOUT_ETPWM_CLOCK_HZ		75000000UL			/* ETPWM rajel: VCLK3 */
+#define configCLKOUT_PPS_ETPWM			etpwmREG1			/* PPS kimenet */
+#define configCLKOUT_PPS_CARRIER_NS		10000000UL			/* A PPS leit ad szmll peridusa */
+#define configCLKOUT_PPS_WIDTH_MS		100					/* PPS impulzus szlessg, a viv tbbszrse */
+#define configCLKOUT_FREQ_ETPWM			etpwmREG2			/* Frekvencia kimenet */
+#define configCLKOUT_FREQ_HZ			1000000UL			/* A VCLK3 egsz osztja kell legyen (pl. 10 MHz nem llthat el) */
+
+/* PHY ra - RTIFRC0 kereszt-idblyegzs */
+#define configXTS_ENABLE				1
+#define configXTS_PERIOD_MS				1000				/* Mintavteli peridus (az RTIFRC0 114 sec alatt fordul krbe) */
+#define configXTS_SAMPLES				4					/* Prostott olvassok szma, a legkisebb ablak marad */
+#define configXTS_MAX_WINDOW_NS			50000				/* Ennl nagyobb bizonytalansg mintt eldobunk */
+#define configXTS_MAX_RATE_PPB			1000000				/* Ennl nagyobb mrt sebessg eltrs hibs mintt jelez */
+#define configXTS_RATE_FILTER			4					/* A sebessg becsls szrsi egytthatja (1/N) */
 
 #endif /* INCLUDE_FREERTOSTIMECONFIG_H_ */
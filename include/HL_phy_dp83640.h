@@ -124,6 +124,48 @@ extern void Dp83640DisableLoopback(uint32 mdioBaseAddr, uint32 phyAddr);
 /* USER CODE BEGIN (2) */
 #undef DP83640_PHY_ID
 #define DP83640_PHY_ID  (0x20005CE1u)
+
+/* Extended register page select and IEEE 1588 register offsets (page 4) */
+#define PHY_PAGESEL                       (0x13u)
+#define DP83640_PAGE_BASE                 (0u)
+#define DP83640_PAGE_PTP                  (4u)
+#define PHY_PTP_CTL                       (0x14u)
+#define PHY_PTP_TDR                       (0x15u)
+#define PHY_PTP_STS                       (0x16u)
+#define PHY_PTP_TSTS                      (0x17u)
+#define PHY_PTP_RATEL                     (0x18u)
+#define PHY_PTP_RATEH                     (0x19u)
+#define PHY_PTP_ESTS                      (0x1Eu)
+#define PHY_PTP_EDATA                     (0x1Fu)
+
+/* PTP_CTL bit definitions */
+#define DP83640_PTP_TRIG_SEL_SHIFT        (10u)
+#define DP83640_PTP_TRIG_DIS              (0x0200u)
+#define DP83640_PTP_TRIG_EN               (0x0100u)
+#define DP83640_PTP_TRIG_READ             (0x0080u)
+#define DP83640_PTP_TRIG_LOAD             (0x0040u)
+#define DP83640_PTP_RD_CLK                (0x0020u)
+#define DP83640_PTP_LOAD_CLK              (0x0010u)
+#define DP83640_PTP_STEP_CLK              (0x0008u)
+#define DP83640_PTP_ENABLE                (0x0004u)
+#define DP83640_PTP_DISABLE               (0x0002u)
+#define DP83640_PTP_RESET                 (0x0001u)
+
+/* PTP_RATEH bit definitions */
+#define DP83640_PTP_RATE_DIR              (0x8000u)
+#define DP83640_PTP_RATE_HI_MASK          (0x03FFu)
+
+/* Largest frequency adjustment the 26 bit rate register can hold (ppb) */
+#define DP83640_PTP_MAX_ADJ_PPB           (1953124)
+
+extern void Dp83640SelectPage(uint32 mdioBaseAddr, uint32 phyAddr, uint16 page);
+extern void Dp83640PtpEnable(uint32 mdioBaseAddr, uint32 phyAddr);
+extern void Dp83640PtpClockLatch(uint32 mdioBaseAddr, uint32 phyAddr);
+extern void Dp83640PtpClockGetLatched(uint32 mdioBaseAddr, uint32 phyAddr, uint32 *seconds, uint32 *nanoseconds);
+extern void Dp83640PtpClockRead(uint32 mdioBaseAddr, uint32 phyAddr, uint32 *seconds, uint32 *nanoseconds);
+extern void Dp83640PtpClockLoad(uint32 mdioBaseAddr, uint32 phyAddr, uint32 seconds, uint32 nanoseconds);
+extern void Dp83640PtpClockStep(uint32 mdioBaseAddr, uint32 phyAddr, sint64 offsetNs);
+extern void Dp83640PtpRateSet(uint32 mdioBaseAddr, uint32 phyAddr, sint32 ppb);
 /* USER CODE END */
 
 #ifdef __cplusplus
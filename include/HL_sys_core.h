@@ -278,12 +278,12 @@ void _dCacheInvalidate_(void);
 void _iCacheInvalidate_(void);
 
 /** @fn void _dcacheCleanRange_(unsigned int startAddress, unsigned int endAddress);
-*   @brief clean data cache address range
+*   @brief clean data cache address range (whole 32 byte lines containing [startAddress, endAddress))
 */
 void _dcacheCleanRange_(unsigned int startAddress, unsigned int endAddress);
 
 /** @fn void _dcacheInvalidateRange_(unsigned int startAddress, unsigned int endAddress);
-*   @brief invalidate data cache address range
+*   @brief invalidate data cache address range (whole 32 byte lines, partially covered end lines are cleaned first)
 */
 void _dcacheInvalidateRange_(unsigned int startAddress, unsigned int endAddress);
 
@@ -0,0 +1,36 @@
+/* clock_output.h */
+
+#ifndef __CLOCK_OUTPUT_H__
+#define __CLOCK_OUTPUT_H__
+
+#include "FreeRTOS.h"
+#include "HL_etpwm.h"
+
+/*
+ * PTP idhz szinkronizlt rajel kimenetek (ETPWMxA).
+ * ETPWM generated PPS and frequency outputs. The phase of every output is re-aligned once per second
+ * against the PHY IEEE 1588 clock, so the edges follow the disciplined PHY time instead of the free running VCLK3.
+ */
+
+typedef struct xCLOCK_OUTPUT_STATUS
+{
+	etpwmBASE_t *pxEtpwm;			/* A kimenetet ad ETPWM modul */
+	uint32_t ulPeriodNs;			/* A kimenet peridusa (PPS esetn 1 sec) */
+	uint32_t ulTickPs;				/* A szmll felbontsa (ps) */
+	BaseType_t xIsPPS;				/* pdTRUE, ha PPS kimenet */
+	int32_t lLastPhaseErrorNs;		/* Az utols mrt fzishiba a korrekci eltt */
+	uint32_t ulAlignments;			/* Fzis korrekcik szma */
+	uint32_t ulPulses;				/* Kiadott PPS impulzusok */
+} ClockOutputStatus_t;
+
+/*
+ * Kimenet hozzadsa, vStartClockOutputTask() eltt hvand. ulPeriodNs: 1000000000 esetn PPS,
+ * egybknt 50% kitlts ngyszgjel. A peridusnak osztania kell az 1 sec-ot, s a VCLK3-bl
+ * egsz szm temmel elllthatnak kell lennie, klnben pdFAIL a visszatrsi rtk.
+ * A ngyszgjel peridusa legfeljebb 100 usec lehet (a fzis igazts a nulltmenetre vr).
+ */
+BaseType_t xClockOutputAdd(etpwmBASE_t *pxEtpwm, uint32_t ulPeriodNs);
+void vStartClockOutputTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority);
+BaseType_t xClockOutputGetStatus(BaseType_t xIndex, ClockOutputStatus_t *pxStatus);	/* pdFAIL, ha nincs ilyen kimenet */
+
+#endif
@@ -0,0 +1,92 @@
+/* emac_stats.h */
+
+#ifndef __EMAC_STATS_H__
+#define __EMAC_STATS_H__
+
+#include "FreeRTOS.h"
+#include "FreeRTOSIPConfig.h"
+
+/*
+ * Hlzati statisztika az EMAC hardver szmllibl, ksleltets hisztogramok.
+ * The EMAC statistics registers are write-to-decrement counters: they are folded into 64-bit totals on the STATPEND
+ * interrupt (a counter reached 0x80000000) and every ipconfigEMAC_STATS_PERIOD_MS by the statistics task, which
+ * also computes the per-second rates. The latency histograms are recorded through the iptrace hooks from the RTIFRC0
+ * stamps of the network buffers (ipconfigUSE_RX_TIMESTAMPS): RX interrupt -> IP task and IP task -> socket owner.
+ */
+
+#ifndef ipconfigEMAC_STATS_PERIOD_MS
+	#define ipconfigEMAC_STATS_PERIOD_MS	( 1000 )		/* A sebessgek szmtsnak peridusa */
+#endif
+
+#if( ipconfigUSE_EMAC_STATS != 0 ) && ( ipconfigUSE_RX_TIMESTAMPS == 0 )
+	#error ipconfigUSE_EMAC_STATS needs ipconfigUSE_RX_TIMESTAMPS
+#endif
+
+/* A szmllk: 0..35 az EMAC statisztika regiszterek (EMACReadNetStatRegisters() sorszma), utna a szoftveres szmllk */
+#define emacstatsRXGOODFRAMES			( 0U )
+#define emacstatsRXCRCERRORS			( 4U )
+#define emacstatsRXALIGNCODEERRORS		( 5U )
+#define emacstatsRXOVERSIZED			( 6U )
+#define emacstatsRXJABBER				( 7U )
+#define emacstatsRXUNDERSIZED			( 8U )
+#define emacstatsRXFRAGMENTS			( 9U )
+#define emacstatsRXFILTERED				( 10U )
+#define emacstatsRXOCTETS				( 12U )
+#define emacstatsTXGOODFRAMES			( 13U )
+#define emacstatsTXCOLLISION			( 18U )
+#define emacstatsTXEXCESSIVECOLL		( 21U )
+#define emacstatsTXLATECOLL				( 22U )
+#define emacstatsTXUNDERRUN				( 23U )
+#define emacstatsTXCARRIERSENSE			( 24U )
+#define emacstatsTXOCTETS				( 25U )
+#define emacstatsRXSOFOVERRUNS			( 33U )
+#define emacstatsRXMOFOVERRUNS			( 34U )
+#define emacstatsRXDMAOVERRUNS			( 35U )
+#define emacstatsHW_COUNTERS			( 36U )
+#define emacstatsRXEVENTLOST			( 36U )			/* Tele IP esemny sor miatt eldobott vtelek (iptraceETHERNET_RX_EVENT_LOST) */
+#define emacstatsCOUNTERS				( 37U )
+
+/* Ksleltets hisztogramok */
+#define emacstatsLATENCY_ISR_TO_IP		( 0 )			/* RX megszakts -> az IP taszk elkezdi a keret feldolgozst */
+#define emacstatsLATENCY_IP_TO_SOCKET	( 1 )			/* IP taszk -> a socket tulajdonosa kiolvassa (recvfrom / recv) */
+#define emacstatsLATENCIES				( 2 )
+#define emacstatsHISTOGRAM_BUCKETS		( 16U )
+
+typedef struct xEMAC_LATENCY
+{
+	uint32_t ulBuckets[emacstatsHISTOGRAM_BUCKETS];	/* [0]: < 1 us, [n]: 2^(n-1) .. 2^n - 1 us, az utols: minden nagyobb */
+	uint32_t ulCount;				/* Mrsek szma */
+	uint64_t ullSumUs;				/* Az tlaghoz */
+	uint32_t ulMaxUs;				/* Maximum a trls ta */
+	uint32_t ulPeriodMaxUs;			/* Maximum az utols peridusban */
+} EMACLatency_t;
+
+void vStartEMACStatsTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority);
+
+/*
+ * A hardver szmllk sszegyjtse, a STATPEND megszakts hvja. A regiszterek a kiolvasott rtkkel cskkennek,
+ * gy a STATPEND trldik s a megszakts engedlyezve maradhat.
+ */
+void vEMACStatsSampleFromISR(void);
+
+/*
+ * sszeg a trls ta s az utols peridusban mrt sebessg (1/sec, az oktett szmllknl byte/sec).
+ */
+uint64_t ullEMACStatsGetTotal(uint32_t ulCounter);
+uint32_t ulEMACStatsGetRate(uint32_t ulCounter);
+const char *pcEMACStatsGetName(uint32_t ulCounter);
+void vEMACStatsGetLatency(BaseType_t xLatency, EMACLatency_t *pxLatency);
+void vEMACStatsReset(void);
+
+/*
+ * Az iptrace makrk hvjk, a FreeRTOSIPConfig.h kti be ket. Az idblyeg RTIFRC0 | 1, a 0 azt jelenti, hogy nincs.
+ *   vEMACStatsIPTaskLatency(): az IP taszk tvette a keretet, az idblyeget az tvtel idejre cserli.
+ *   vEMACStatsSocketLatency(): a socket tulajdonosa kiolvasta az adatot, az idblyeget trli.
+ *   vEMACStatsKeepTimestamp(): a TCP rxStream legrgebbi olvasatlan adatnak idblyege.
+ */
+void vEMACStatsIPTaskLatency(uint32_t *pulTimestamp);
+void vEMACStatsSocketLatency(uint32_t *pulTimestamp);
+void vEMACStatsKeepTimestamp(uint32_t *pulTimestamp, uint32_t ulTimestamp);
+void vEMACStatsRxEventLost(void);
+
+#endif
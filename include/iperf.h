@@ -0,0 +1,79 @@
+/* iperf.h */
+
+#ifndef __IPERF_H__
+#define __IPERF_H__
+
+#include "FreeRTOS.h"
+#include "FreeRTOSIPConfig.h"
+
+/*
+ * tviteli sebessg mrse iperf2 kompatibilis TCP s UDP vgponttal.
+ * The server accepts "iperf -c <board> [-u]" from a PC, the client runs against "iperf -s [-u]" on a PC. TCP is
+ * received and sent directly in the socket streams (zero-copy), UDP datagrams are taken from and given to the
+ * network buffers with FreeRTOS_recvmulti() / FreeRTOS_sendmulti(). The report contains the throughput, the TCP
+ * retransmissions and the CPU load (idle task and IP task) from the run-time stats.
+ */
+
+#ifndef ipconfigIPERF_PORT
+	#define ipconfigIPERF_PORT				( 5001 )				/* Az iperf2 alaprtelmezett portja */
+#endif
+#ifndef ipconfigIPERF_TX_BUFSIZE
+	#define ipconfigIPERF_TX_BUFSIZE		( 8 * ipconfigTCP_MSS )	/* TCP stream s ablak mretek */
+#endif
+#ifndef ipconfigIPERF_TX_WINSIZE
+	#define ipconfigIPERF_TX_WINSIZE		( 6 )
+#endif
+#ifndef ipconfigIPERF_RX_BUFSIZE
+	#define ipconfigIPERF_RX_BUFSIZE		( 8 * ipconfigTCP_MSS )
+#endif
+#ifndef ipconfigIPERF_RX_WINSIZE
+	#define ipconfigIPERF_RX_WINSIZE		( 6 )
+#endif
+#ifndef ipconfigIPERF_UDP_LENGTH
+	#define ipconfigIPERF_UDP_LENGTH		( 1470 )				/* Alaprtelmezett UDP datagram hossz (iperf2 -l) */
+#endif
+#ifndef ipconfigIPERF_UDP_BANDWIDTH
+	#define ipconfigIPERF_UDP_BANDWIDTH		( 1000000 )				/* Alaprtelmezett UDP sebessg bit/sec (iperf2 -b) */
+#endif
+#ifndef ipconfigIPERF_TIME_SEC
+	#define ipconfigIPERF_TIME_SEC			( 10 )					/* Alaprtelmezett mrsi id (iperf2 -t) */
+#endif
+
+typedef struct xIPERF_REPORT
+{
+	BaseType_t xActive;				/* pdTRUE, ha a szerver vagy a kliens fut */
+	BaseType_t xServer;				/* pdTRUE: szerver, pdFALSE: kliens */
+	BaseType_t xUDP;				/* pdTRUE: UDP, pdFALSE: TCP */
+	BaseType_t xRunning;			/* pdTRUE, ha egy mrs ppen folyik */
+	uint32_t ulRemoteIP;			/* A partner cme (hlzati byte sorrendben) */
+	uint64_t ullBytes;				/* tvitt byte-ok */
+	uint32_t ulDurationMs;			/* A mrs hossza */
+	uint32_t ulRetransmits;			/* TCP: jrakldtt szegmensek */
+	uint32_t ulDatagrams;			/* UDP: fogadott (szerver) vagy elkldtt (kliens) datagramok */
+	uint32_t ulLost;				/* UDP: elveszett datagramok (kliensnl a szerver jelentsbl) */
+	uint32_t ulOutOfOrder;			/* UDP: sorrenden kvl rkezett datagramok */
+	uint32_t ulJitterUs;			/* UDP: jitter (RFC 1889) */
+	uint32_t ulCPULoad;				/* CPU terhels a mrs alatt, 0.1% egysgben */
+	uint32_t ulIPTaskLoad;			/* Az IP taszk rszesedse, 0.1% egysgben */
+} IperfReport_t;
+
+void vStartIperfTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority);
+
+/*
+ * Szerver indtsa a ipconfigIPERF_PORT porton. A kliensek egyms utn mrhetnek, vIperfStop()-ig fut.
+ */
+BaseType_t xIperfStartServer(BaseType_t xUDP);
+
+/*
+ * Kliens indtsa. ulSeconds == 0: ipconfigIPERF_TIME_SEC. UDP-nl ulBandwidth (bit/sec) s ulLength is hasznlt,
+ * 0 esetn az alaprtelmezett rtkekkel. Ha mr fut egy mrs, pdFAIL.
+ */
+BaseType_t xIperfStartClient(uint32_t ulIPAddress, BaseType_t xUDP, uint32_t ulSeconds, uint32_t ulBandwidth, uint32_t ulLength);
+void vIperfStop(void);
+
+/*
+ * A foly mrs llsa, vagy az utols mrs eredmnye.
+ */
+void vIperfGetReport(IperfReport_t *pxReport);
+
+#endif
@@ -0,0 +1,77 @@
+/* pcap_capture.h */
+
+#ifndef __PCAP_CAPTURE_H__
+#define __PCAP_CAPTURE_H__
+
+#include "FreeRTOS.h"
+#include "FreeRTOSIPConfig.h"
+
+/*
+ * Csomagrgzts pcapng fjlba a RAM lemezen.
+ * The EMAC driver copies the first bytes of every received and sent frame into a ring, a background task writes
+ * the ring to rotating pcapng files on the RAM disk (/ram/capN.pcapng), which can be fetched over FTP.
+ * Frames are stamped with RTIFRC0 and converted to PHY (PTP) time with the cross-timestamp mapping when it is
+ * valid, otherwise to system time.
+ */
+
+#ifndef ipconfigPCAP_RING_SIZE
+	#define ipconfigPCAP_RING_SIZE			( 16384 )		/* A gyr mrete byte-okban, 4 tbbszrse */
+#endif
+#ifndef ipconfigPCAP_SNAPLEN
+	#define ipconfigPCAP_SNAPLEN			( 128 )			/* Alaprtelmezett rgztsi hossz */
+#endif
+#ifndef ipconfigPCAP_FILE_SIZE
+	#define ipconfigPCAP_FILE_SIZE			( 32768 )		/* Egy fjl maximlis mrete */
+#endif
+#ifndef ipconfigPCAP_FILE_COUNT
+	#define ipconfigPCAP_FILE_COUNT			( 3 )			/* Ennyi fjlt hasznlunk krbe */
+#endif
+#ifndef ipconfigPCAP_FLUSH_PERIOD_MS
+	#define ipconfigPCAP_FLUSH_PERIOD_MS	( 1000 )		/* A gyr rtsnek peridusa (az RTIFRC0 114 sec alatt fordul krbe) */
+#endif
+
+#if( ( ipconfigPCAP_RING_SIZE & 3 ) != 0 ) || ( ipconfigPCAP_RING_SIZE > 65532 )
+	#error ipconfigPCAP_RING_SIZE must be a multiple of 4, at most 65532
+#endif
+
+#define pcapDIRECTION_RX		( 1U )
+#define pcapDIRECTION_TX		( 2U )
+
+typedef struct xPCAP_STATUS
+{
+	BaseType_t xActive;				/* pdTRUE, ha a rgzts fut */
+	uint32_t ulSnapLength;			/* Csomagonknt rgztett byte-ok */
+	uint32_t ulCaptured;			/* A gyrbe msolt csomagok */
+	uint32_t ulFiltered;			/* A szr ltal elvetett csomagok */
+	uint32_t ulDropped;				/* Tele gyr miatt elveszett csomagok */
+	uint32_t ulWritten;				/* Fjlba rt csomagok */
+	uint32_t ulWriteErrors;			/* Sikertelen fjl mveletek */
+	uint32_t ulFileIndex;			/* Az aktulis fjl sorszma */
+	uint32_t ulFileSize;			/* Az aktulis fjl mrete */
+} PCAPStatus_t;
+
+void vStartPCAPCaptureTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority);
+
+/*
+ * Rgzts indtsa (ulSnapLength == 0: ipconfigPCAP_SNAPLEN) s lelltsa. Indtskor a /ram/cap0.pcapng-vel kezdnk.
+ * Az indtst az rt taszk vgzi: kirja az elz rgzts maradkt, trli a gyrt s a statisztikt.
+ */
+BaseType_t xPCAPStart(uint32_t ulSnapLength);
+void vPCAPStop(void);
+
+/*
+ * Szr belltsa. A kifejezs elemei S kapcsolatban vannak, "not" az elejn az egszet tagadja:
+ *   rx | tx | arp | ip | icmp | tcp | udp | ptp | ether <type> | host <a.b.c.d> | port <n>
+ * res kifejezs: minden csomag. Hibs kifejezsnl pdFAIL, a rgi szr marad.
+ * Ha kzben egy msik konzolrl is szrt lltanak, szintn pdFAIL.
+ */
+BaseType_t xPCAPSetFilter(const char *pcExpression);
+void vPCAPGetFilter(char *pcBuffer, size_t uxLength);
+void vPCAPGetStatus(PCAPStatus_t *pxStatus);
+
+/*
+ * Csomag rgztse, az RX taszk s az xNetworkInterfaceOutput() hvja. Kikapcsolt rgztsnl egyetlen sszehasonlts.
+ */
+void vPCAPCaptureFrame(const uint8_t *pucFrame, size_t uxLength, uint8_t ucDirection);
+
+#endif
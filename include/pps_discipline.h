@@ -0,0 +1,28 @@
+/* pps_discipline.h */
+
+#ifndef __PPS_DISCIPLINE_H__
+#define __PPS_DISCIPLINE_H__
+
+#include "FreeRTOS.h"
+
+/*
+ * GNSS 1PPS bemenet (eCAP) alap PHY ra szablyozs.
+ * Disciplines the PHY IEEE 1588 clock to an external 1PPS signal captured by an eCAP module,
+ * so the board can serve as a GNSS-referenced time source for the cluster.
+ */
+
+typedef struct xPPS_STATUS
+{
+	BaseType_t xLocked;				/* pdTRUE, ha az eltrs a configPPS_LOCK_THRESHOLD_NS alatt van */
+	uint32_t ulPulseCount;			/* Feldolgozott PPS impulzusok */
+	uint32_t ulMissedPulses;		/* Kimaradt impulzusok (holdover) */
+	uint32_t ulSteps;				/* ra lptetsek szma */
+	int64_t xLastOffsetNs;			/* PHY id - PPS utols eltrse */
+	int32_t lFrequencyPpb;			/* Aktulis frekvencia korrekci */
+	uint32_t ulPairWindowNs;		/* Az utols prostott mintavtel bizonytalansga */
+} PPSStatus_t;
+
+void vStartPPSDisciplineTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority);
+void vPPSGetStatus(PPSStatus_t *pxStatus);
+
+#endif
@@ -0,0 +1,32 @@
+/* ptp_clock.h */
+
+#ifndef __PTP_CLOCK_H__
+#define __PTP_CLOCK_H__
+
+#include "FreeRTOS.h"
+
+/*
+ * A PHY (DP83640) IEEE 1588 rjnak kezelse.
+ * Access to the IEEE 1588 clock of the DP83640 PHY. The MDIO accesses are serialised with a mutex, which the network
+ * driver takes as well. The time scale is the one of the system time (nanoseconds since EPOCH).
+ */
+
+/* Helyi szmll olvas fggvny a prostott (PHY id, szmll) mintavtelhez */
+typedef unsigned int (*PTPClockCounter_t)(void);
+
+void vPTPClockInit(void);							/* Mutex ltrehozsa, az temez indtsa eltt hvand */
+void vPTPClockMDIOTake(void);						/* Az MDIO zr, minden MDIO hozzfrs krl (a hlzati meghajtban is) */
+void vPTPClockMDIOGive(void);
+void vPTPClockEnable(void);							/* A PHY ra engedlyezse s betltse a rendszeridvel (hlzat fel kell legyen) */
+BaseType_t xPTPClockIsEnabled(void);				/* pdTRUE, ha a PHY ra mr fut */
+
+uint64_t xPTPClockGetTime(void);					/* PHY id (ns) */
+/* PHY id (ns) s a hozz tartoz szmll rtk. *pulWindow: a mintavteli ablak szmll temekben (bizonytalansg) */
+uint64_t xPTPClockGetTimePaired(PTPClockCounter_t pxCounter, unsigned int *pulCounter, unsigned int *pulWindow);
+void vPTPClockSetTime(uint64_t uxTimeNs);			/* PHY ra betltse */
+void vPTPClockStep(int64_t xOffsetNs);				/* PHY ra lptetse eljeles rtkkel */
+void vPTPClockAdjustFrequency(long lPpb);			/* PHY ra frekvencia korrekci (ppb, pozitv = gyorsts) */
+long xPTPClockGetFrequency(void);					/* Az utoljra belltott frekvencia korrekci (ppb) */
+unsigned long ulPTPClockGetStepCount(void);			/* Lptetsek s betltsek szma, a kapcsold lekpezsek rvnytelentshez */
+
+#endif
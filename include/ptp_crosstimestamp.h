@@ -0,0 +1,35 @@
+/* ptp_crosstimestamp.h */
+
+#ifndef __PTP_CROSSTIMESTAMP_H__
+#define __PTP_CROSSTIMESTAMP_H__
+
+#include "FreeRTOS.h"
+
+/*
+ * PHY ra - RTIFRC0 kereszt-idblyegzs.
+ * Periodically pairs the PHY IEEE 1588 time with the RTIFRC0 counter and keeps a linear mapping between them,
+ * so any code (interrupt handlers included) can convert a counter reading to PTP time without MDIO access.
+ */
+
+typedef struct xPTP_CROSSTIMESTAMP_STATUS
+{
+	BaseType_t xValid;				/* pdTRUE, ha van rvnyes lekpezs */
+	uint32_t ulSamples;				/* Elfogadott mintavtelek */
+	uint32_t ulRejected;			/* Tl nagy ablak miatt eldobott mintavtelek */
+	uint32_t ulRebases;				/* Az ra ugrsa miatti jrakezdsek */
+	uint32_t ulWindowNs;			/* Az utols elfogadott minta bizonytalansga */
+	int32_t lRatePpb;				/* A PHY ra sebessge az RTIFRC0-hoz kpest (ppb) */
+	int32_t lLastErrorNs;			/* Az elz lekpezs hibja az j mintnl */
+} PTPCrossTimestampStatus_t;
+
+void vStartPTPCrossTimestampTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority);
+void vPTPCrossTimestampGetStatus(PTPCrossTimestampStatus_t *pxStatus);
+BaseType_t xPTPCrossTimestampIsValid(void);
+
+/*
+ * RTIFRC0 rtk tvltsa PTP idre (ns). Megszaktsbl is hvhat, a lekpezs bzistl +/- 57 sec-en bell rvnyes.
+ */
+uint64_t xPTPCrossTimestampFromFRC0(uint32_t ulFRC0);
+uint64_t xPTPCrossTimestampNow(void);		/* Aktulis PTP id egyetlen regiszter olvasssal */
+
+#endif
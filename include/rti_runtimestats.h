@@ -1,7 +1,9 @@
 /* RTI__runtimestats.h */
 
 #ifndef __RTI__RUNTIMESTATS_H__
-#define __RTI__RUNTIMESTATS__
+#define __RTI__RUNTIMESTATS_H__
+
+#include "FreeRTOS.h"
 
 /* RTI regiszterek */
 #define RTI_GCTRL_REG 			(*((volatile uint32_t *)0xfffffc00)) /* RTI Global Control Register */
@@ -53,10 +55,17 @@
 #define RTI_OVERFLOW_1			7U
 #define RTI_TIMEBASE_1			8U
 
+/* RTIFRC0 szmll (rendszerid, Compare 1) frekvencija s tvltsok */
+#define RTI_FRC0_FREQUENCY_HZ		( configCPU_CLOCK_HZ / 2 )
+#define RTI_FRC0_TICKS_PER_MSEC		( RTI_FRC0_FREQUENCY_HZ / 1000 )
+#define RTI_FRC0_TICKS_TO_NS(x)		( ( (uint64_t)(x) * 1000000000ULL ) / RTI_FRC0_FREQUENCY_HZ )
+#define RTI_FRC0_NS_TO_TICKS(x)		( ( (uint64_t)(x) * RTI_FRC0_FREQUENCY_HZ ) / 1000000000ULL )
+
 
 void vConfigureTimerForRunTimeStats(void);			/* RTI konfigurlsa a runtime statisztikk kiszolglshoz */
 void vConfigureTimerForSysTime(void);				/* RTI konfigurlsa a rendszerid kiszolglshoz */
-unsigned long long xGetHighResolutionTime(void);	/* usec felbonts relatv id */
+uint64_t xGetHighResolutionTime(void);				/* usec felbonts relatv id */
 void vFreeRTOSRTIOverFlow1Interrupt(void);			/* OverFlow 1 interrupt kezel rutin*/
 void vFreeRTOSRTICmp1Interrupt(void);				/* Compare 1 interrupt kezel rutin*/
+uint64_t xGetSysTimeNs(unsigned int *pulFRC0);		/* nsec felbonts rendszerid (EPOCH), RTIFRC0 mintval */
 #endif
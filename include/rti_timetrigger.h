@@ -0,0 +1,32 @@
+/* rti_timetrigger.h */
+
+#ifndef __RTI_TIMETRIGGER_H__
+#define __RTI_TIMETRIGGER_H__
+
+#include "FreeRTOS.h"
+
+/*
+ * Idztett (abszolt rendszeridhz kttt) taszk indts.
+ * Time-triggered task release aligned to the (NTP/PTP disciplined) system time.
+ *
+ * A durva vrakozs az OS tick-kel trtnik, az utols 1..3 tick-et az RTI Compare 2
+ * egylvet megszaktsa mri ki az RTIFRC0 szmlln, gy az breds nem kerekl a
+ * 1 ms-os tick-re. Az breszts a hv taszk notification-jt hasznlja.
+ */
+
+void vConfigureTimerForTimeTrigger(void);			/* RTI Compare 2 konfigurlsa az idztett indtshoz */
+void vFreeRTOSRTICmp2Interrupt(void);				/* Compare 2 interrupt kezel rutin */
+
+/* Vrakozs a megadott abszolt rendszeridig (ns, EPOCH ta). */
+void vTaskDelayUntilTime(uint64_t uxWakeTimeNs);
+
+/* Periodikus indts: *puxPreviousWakeTimeNs + uxPeriodNs idpontig vr, majd frissti *puxPreviousWakeTimeNs-t.
+ * pdFALSE-t ad vissza, ha peridus(ok) kimaradtak vagy a rendszerid ugrott; ilyenkor a fzist megtartva
+ * a kvetkez peridushatrhoz igazt. */
+BaseType_t xTaskDelayUntilTimePeriodic(uint64_t *puxPreviousWakeTimeNs, uint64_t uxPeriodNs);
+
+/* A most utni els (k * uxPeriodNs + uxPhaseNs) idpont. Azonos rendszeridvel rendelkez
+ * csompontokon ugyanazt az rtket adja, gy a periodikus taszkok fzisban futnak. */
+uint64_t xTimeTriggerGetNextAlignedTime(uint64_t uxPeriodNs, uint64_t uxPhaseNs);
+
+#endif
@@ -412,5 +412,197 @@ uint64 Dp83640GetTimeStamp(uint32 mdioBaseAddr, uint32 phyAddr, phyTimeStamp_t t
 }
 
 /* USER CODE BEGIN (2) */
+/**
+ * \brief   Selects the extended register page of the PHY.
+ *
+ * \param   mdioBaseAddr  Base Address of the MDIO Module Registers.
+ * \param   phyAddr       PHY Adress.
+ * \param   page          Register page (0 - 6). Registers 0x00 - 0x13 are
+ *                        accessible on every page.
+ *
+ * \return  No return value.
+ **/
+void Dp83640SelectPage(uint32 mdioBaseAddr, uint32 phyAddr, uint16 page)
+{
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PAGESEL, page);
+}
+
+/**
+ * \brief   Enables the IEEE 1588 clock of the PHY.
+ *
+ * \param   mdioBaseAddr  Base Address of the MDIO Module Registers.
+ * \param   phyAddr       PHY Adress.
+ *
+ * \return  No return value.
+ *
+ * \note    Like the other PTP helpers, it selects the PTP register page (4)
+ *          and restores the base page (0) before it returns, so the link
+ *          status reads of the driver (BMSR, PHYSTS) are not affected.
+ **/
+void Dp83640PtpEnable(uint32 mdioBaseAddr, uint32 phyAddr)
+{
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_PTP);
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_CTL, DP83640_PTP_ENABLE);
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_BASE);
+}
+
+/**
+ * \brief   Latches the IEEE 1588 clock into the PTP_TDR register.
+ *
+ * \param   mdioBaseAddr  Base Address of the MDIO Module Registers.
+ * \param   phyAddr       PHY Adress.
+ *
+ * \return  No return value.
+ *
+ * \note    The PTP register page must already be selected. The clock is
+ *          latched at the end of the MDIO write frame, the function returns
+ *          right after it, so a local counter sampled on return is paired
+ *          with the latched time.
+ **/
+void Dp83640PtpClockLatch(uint32 mdioBaseAddr, uint32 phyAddr)
+{
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_CTL, DP83640_PTP_RD_CLK);
+}
+
+/**
+ * \brief   Reads the time latched by Dp83640PtpClockLatch.
+ *
+ * \param   mdioBaseAddr  Base Address of the MDIO Module Registers.
+ * \param   phyAddr       PHY Adress.
+ * \param   seconds       Seconds part of the latched time.
+ * \param   nanoseconds   Nanoseconds part of the latched time.
+ *
+ * \return  No return value.
+ *
+ * \note    The PTP register page must already be selected, the base page
+ *          (0) is restored on return.
+ **/
+void Dp83640PtpClockGetLatched(uint32 mdioBaseAddr, uint32 phyAddr, uint32 *seconds, uint32 *nanoseconds)
+{
+	uint16 data[4U] = {0U, 0U, 0U, 0U};
+	uint32 i;
+
+	/* ns[15:0], ns[31:16], sec[15:0], sec[31:16] */
+	for(i = 0U; i < 4U; i++)
+	{
+		(void)MDIOPhyRegRead(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_TDR, &data[i]);
+	}
+
+	*nanoseconds = ((uint32)data[1U] << 16U) | (uint32)data[0U];
+	*seconds = ((uint32)data[3U] << 16U) | (uint32)data[2U];
+
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_BASE);
+}
+
+/**
+ * \brief   Reads the IEEE 1588 clock of the PHY.
+ *
+ * \param   mdioBaseAddr  Base Address of the MDIO Module Registers.
+ * \param   phyAddr       PHY Adress.
+ * \param   seconds       Seconds part of the clock.
+ * \param   nanoseconds   Nanoseconds part of the clock.
+ *
+ * \return  No return value.
+ **/
+void Dp83640PtpClockRead(uint32 mdioBaseAddr, uint32 phyAddr, uint32 *seconds, uint32 *nanoseconds)
+{
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_PTP);
+	Dp83640PtpClockLatch(mdioBaseAddr, phyAddr);
+	Dp83640PtpClockGetLatched(mdioBaseAddr, phyAddr, seconds, nanoseconds);
+}
+
+/**
+ * \brief   Loads a new value into the IEEE 1588 clock of the PHY.
+ *
+ * \param   mdioBaseAddr  Base Address of the MDIO Module Registers.
+ * \param   phyAddr       PHY Adress.
+ * \param   seconds       Seconds part of the new time.
+ * \param   nanoseconds   Nanoseconds part of the new time (0 - 999999999).
+ *
+ * \return  No return value.
+ **/
+void Dp83640PtpClockLoad(uint32 mdioBaseAddr, uint32 phyAddr, uint32 seconds, uint32 nanoseconds)
+{
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_PTP);
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_TDR, (uint16)(nanoseconds & 0xFFFFU));
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_TDR, (uint16)(nanoseconds >> 16U));
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_TDR, (uint16)(seconds & 0xFFFFU));
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_TDR, (uint16)(seconds >> 16U));
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_CTL, DP83640_PTP_LOAD_CLK);
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_BASE);
+}
+
+/**
+ * \brief   Steps the IEEE 1588 clock of the PHY by a signed offset.
+ *
+ * \param   mdioBaseAddr  Base Address of the MDIO Module Registers.
+ * \param   phyAddr       PHY Adress.
+ * \param   offsetNs      Offset to add to the clock in nanoseconds.
+ *
+ * \return  No return value.
+ **/
+void Dp83640PtpClockStep(uint32 mdioBaseAddr, uint32 phyAddr, sint64 offsetNs)
+{
+	sint32 seconds = (sint32)(offsetNs / 1000000000);
+	sint32 nanoseconds = (sint32)(offsetNs % 1000000000);
+
+	/* The nanoseconds field must be positive, the seconds carry the sign. */
+	if(nanoseconds < 0)
+	{
+		nanoseconds += 1000000000;
+		seconds -= 1;
+	}
+
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_PTP);
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_TDR, (uint16)((uint32)nanoseconds & 0xFFFFU));
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_TDR, (uint16)((uint32)nanoseconds >> 16U));
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_TDR, (uint16)((uint32)seconds & 0xFFFFU));
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_TDR, (uint16)((uint32)seconds >> 16U));
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_CTL, DP83640_PTP_STEP_CLK);
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_BASE);
+}
+
+/**
+ * \brief   Sets the frequency adjustment of the IEEE 1588 clock.
+ *
+ * \param   mdioBaseAddr  Base Address of the MDIO Module Registers.
+ * \param   phyAddr       PHY Adress.
+ * \param   ppb           Frequency offset in parts per billion, positive
+ *                        values speed the clock up. Limited to
+ *                        +/- DP83640_PTP_MAX_ADJ_PPB.
+ *
+ * \return  No return value.
+ *
+ * \note    The rate register holds the correction in units of 2^-32 ns per
+ *          8 ns clock period: rate = ppb * 2^26 / 1953125.
+ **/
+void Dp83640PtpRateSet(uint32 mdioBaseAddr, uint32 phyAddr, sint32 ppb)
+{
+	uint64 rate;
+	uint16 hi;
+	boolean negative = FALSE;
+
+	if(ppb < 0)
+	{
+		negative = TRUE;
+		ppb = -ppb;
+	}
+	if(ppb > DP83640_PTP_MAX_ADJ_PPB)
+	{
+		ppb = DP83640_PTP_MAX_ADJ_PPB;
+	}
+
+	rate = ((uint64)ppb << 26U) / 1953125U;
+	hi = (uint16)((rate >> 16U) & DP83640_PTP_RATE_HI_MASK);
+	if(negative == TRUE)
+	{
+		hi |= DP83640_PTP_RATE_DIR;
+	}
+
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_PTP);
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_RATEH, hi);
+	MDIOPhyRegWrite(mdioBaseAddr, phyAddr, (uint32)PHY_PTP_RATEL, (uint16)(rate & 0xFFFFU));
+	Dp83640SelectPage(mdioBaseAddr, phyAddr, DP83640_PAGE_BASE);
+}
 /* USER CODE END */
 /**************************** End Of File ***********************************/
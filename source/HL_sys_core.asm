@@ -663,9 +663,9 @@ _iCacheInvalidate_
 		.def  _dcacheCleanRange_
         .asmfunc
 _dcacheCleanRange_
-		BIC   R0, R0, #7					; data cache line size -1
+		BIC   R0, R0, #31					; data cache line size -1
 loop:	MCR	  P15, #0, R0, C7, C10, #1		; clean D entry
-		ADD	  R0, R0, #8					; data cache line size
+		ADD	  R0, R0, #32					; data cache line size
 		CMP	  R0, R1
 		BLO	  loop
 		MCR	  P15, #0, R0, C7, C10, #4		; data Synchronization Barrier
@@ -675,16 +675,17 @@ loop:	MCR	  P15, #0, R0, C7, C10, #1		; clean D entry
 ;-------------------------------------------------------------------------------
 ; dcacheInvalidateRange
 ; void _dcacheInvalidateRange_(unsigned int startAddress, unsigned int endAddress);
+; Partially covered lines at the ends are cleaned first, so data next to the range is not lost.
 		.def  _dcacheInvalidateRange_
         .asmfunc
 _dcacheInvalidateRange_
-		TST	  R0, #7						; data cache line size -1
-		MCR	  P15, #0, R0, C7, C10, #1		; clean D entry
-		TST	  R1, #7						; data cache line size -1
-		MCR	  P15, #0, R1, C7, c10, #1		; clean D entry
-		BIC	  R0, R0, #8					; data cache line size -1
+		TST	  R0, #31						; data cache line size -1
+		MCRNE P15, #0, R0, C7, C10, #1		; clean D entry
+		TST	  R1, #31						; data cache line size -1
+		MCRNE P15, #0, R1, C7, c10, #1		; clean D entry
+		BIC	  R0, R0, #31					; data cache line size -1
 loop2:	MCR   P15, #0, R0, C7, C6, #1		; invalidate D entry
-		ADD	  R0, R0, #8					; data cache line size
+		ADD	  R0, R0, #32					; data cache line size
 		CMP	  R0, R1
 		BLO   loop2
 		MCR	  P15, #0, R0, C7, C10, #4		; data Synchronization Barrier
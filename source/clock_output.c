@@ -0,0 +1,374 @@
+#include "FreeRTOS.h"
+#include "os_task.h"
+#include "FreeRTOSTIMEConfig.h"
+#include "FreeRTOS_IP.h"
+#include "HL_etpwm.h"
+#include "rti_runtimestats.h"
+#include "rti_timetrigger.h"
+#include "ptp_clock.h"
+#include "clock_output.h"
+
+#define clkoutNS_PER_SECOND			1000000000ULL
+#define clkoutMAX_PERIOD_TICKS		65536UL				/* TBPRD 16 bites */
+
+#define clkoutAQ_ZRO_SET			0x0002U				/* AQCTLA: CTR = 0 -> magas */
+#define clkoutAQ_CAU_CLEAR			0x0010U				/* AQCTLA: CTR = CMPA (fel) -> alacsony */
+#define clkoutCSFA_LOW				0x0001U				/* AQCSFRC: folyamatos knyszerts alacsonyra */
+#define clkoutCSFA_HIGH				0x0002U				/* AQCSFRC: folyamatos knyszerts magasra */
+#define clkoutRLDCSF_IMMEDIATE		0x00C0U				/* AQSFRC: az AQCSFRC azonnal tltdik, egybknt CTR = 0-kor */
+#define clkoutPHSDIR_UP				0x2000U				/* TBCTL: szinkron utn felfel szmol */
+#define clkoutPRDLD_IMMEDIATE		0x0008U				/* TBCTL: a TBPRD azonnal tltdik, egybknt CTR = 0-kor */
+#define clkoutMAX_STRETCH_PERIOD_NS	100000UL			/* A ngyszgjel igaztsa legfeljebb kt peridusig vr */
+
+#if( ( configCLKOUT_PPS_WIDTH_MS * 1000000UL ) % configCLKOUT_PPS_CARRIER_NS ) != 0
+	#error configCLKOUT_PPS_WIDTH_MS must be a multiple of configCLKOUT_PPS_CARRIER_NS
+#endif
+
+typedef struct xCLOCK_OUTPUT
+{
+	uint32_t ulCounterPeriodNs;		/* A szmll peridusa (PPS esetn a viv) */
+	uint32_t ulPeriodTicks;			/* TBPRD + 1 */
+	uint32_t ulPrescale;			/* HSPCLKDIV * CLKDIV */
+	uint32_t ulSyncLatencyTicks;	/* PPS: a TBCTR olvass s a szoftveres szinkron kzti kss, indulskor mrve */
+	ClockOutputStatus_t xStatus;
+} ClockOutput_t;
+
+static ClockOutput_t xClockOutputs[configCLKOUT_MAX_OUTPUTS];
+static BaseType_t xClockOutputCount = 0;
+static etpwmBASE_t *pxClockOutputPaired = NULL;	/* A prostott olvass alatt mintavtelezett modul */
+
+static const uint16 usClockOutputHspDiv[8] = { 1U, 2U, 4U, 6U, 8U, 10U, 12U, 14U };
+
+static BaseType_t prvClockOutputSetTimebase(ClockOutput_t *pxOutput);
+static unsigned int prvClockOutputReadCounter(void);
+static uint32_t prvClockOutputMeasureSyncLatency(ClockOutput_t *pxOutput);
+static void prvClockOutputStretchPeriod(ClockOutput_t *pxOutput, int32_t lErrorTicks);
+static int64_t prvClockOutputAlign(ClockOutput_t *pxOutput);
+static void prvClockOutputForcePPS(uint16 usForce);
+static void prvClockOutputTask(void *pvParameters);
+
+/*
+ * A legkisebb eloszt keresse, amellyel a peridus pontosan (egsz temszmmal) s 16 biten elllthat.
+ */
+static BaseType_t prvClockOutputSetTimebase(ClockOutput_t *pxOutput)
+{
+	uint64_t uxCycles = (uint64_t)pxOutput->ulCounterPeriodNs * configCLKOUT_ETPWM_CLOCK_HZ;
+	uint64_t uxDivisor;
+	uint32_t ulBest = 0U;
+	uint16 usTBCTLDiv = 0U;
+	uint16 usClkDiv, usHsp;
+
+	for(usClkDiv = 0U; usClkDiv < 8U; usClkDiv++)
+	{
+		for(usHsp = 0U; usHsp < 8U; usHsp++)
+		{
+			uint32_t ulPrescale = (uint32_t)usClockOutputHspDiv[usHsp] << usClkDiv;
+			uxDivisor = clkoutNS_PER_SECOND * ulPrescale;
+			if(((uxCycles % uxDivisor) == 0U) && ((uxCycles / uxDivisor) <= clkoutMAX_PERIOD_TICKS) &&
+			   ((ulBest == 0U) || (ulPrescale < ulBest)))
+			{
+				ulBest = ulPrescale;
+				usTBCTLDiv = (uint16)((usClkDiv << 10U) | (usHsp << 7U));
+			}
+		}
+	}
+
+	if(ulBest == 0U)
+	{
+		return pdFAIL;
+	}
+
+	pxOutput->ulPrescale = ulBest;
+	pxOutput->ulPeriodTicks = (uint32_t)(uxCycles / (clkoutNS_PER_SECOND * ulBest));
+	pxOutput->xStatus.ulTickPs = (uint32_t)((1000000000000ULL * ulBest) / configCLKOUT_ETPWM_CLOCK_HZ);
+
+	etpwmSetCounterMode(pxOutput->xStatus.pxEtpwm, CounterMode_Stop);
+	etpwmSetClkDiv(pxOutput->xStatus.pxEtpwm, (etpwmClkDiv_t)(usTBCTLDiv & 0x1C00U), (etpwmHspClkDiv_t)(usTBCTLDiv & 0x0380U));
+	return pdPASS;
+}
+
+BaseType_t xClockOutputAdd(etpwmBASE_t *pxEtpwm, uint32_t ulPeriodNs)
+{
+	ClockOutput_t *pxOutput;
+
+	if((xClockOutputCount >= configCLKOUT_MAX_OUTPUTS) || (ulPeriodNs == 0U) || ((clkoutNS_PER_SECOND % ulPeriodNs) != 0U) ||
+	   ((ulPeriodNs != clkoutNS_PER_SECOND) && (ulPeriodNs > clkoutMAX_STRETCH_PERIOD_NS)))
+	{
+		return pdFAIL;
+	}
+
+	pxOutput = &xClockOutputs[xClockOutputCount];
+	pxOutput->xStatus.pxEtpwm = pxEtpwm;
+	pxOutput->xStatus.ulPeriodNs = ulPeriodNs;
+	pxOutput->xStatus.xIsPPS = (ulPeriodNs == clkoutNS_PER_SECOND) ? pdTRUE : pdFALSE;
+	pxOutput->ulCounterPeriodNs = (pxOutput->xStatus.xIsPPS != pdFALSE) ? configCLKOUT_PPS_CARRIER_NS : ulPeriodNs;
+
+	if(prvClockOutputSetTimebase(pxOutput) == pdFAIL)
+	{
+		return pdFAIL;
+	}
+
+	/* Felfel szmlls, a sajt szinkron impulzus nem megy tovbb a lncban. A peridus azonnal tltdik be,
+	 * utna rnykregiszteres (CTR = 0-kor tltdik) marad a ngyszgjel igaztshoz. */
+	pxEtpwm->TBCTL |= clkoutPRDLD_IMMEDIATE;
+	etpwmSetTimebasePeriod(pxEtpwm, (uint16)(pxOutput->ulPeriodTicks - 1U));
+	pxEtpwm->TBCTL &= (uint16)~clkoutPRDLD_IMMEDIATE;
+	etpwmSetCount(pxEtpwm, 0U);
+	etpwmSetSyncOut(pxEtpwm, SyncOut_Disable);
+	etpwmDisableCounterLoadOnSync(pxEtpwm);
+	etpwmSetRunMode(pxEtpwm, RunMode_FreeRun);
+
+	if(pxOutput->xStatus.xIsPPS != pdFALSE)
+	{
+		/* PPS: a kimenetet csak a folyamatos szoftveres knyszerts vezrli, a viv CTR = 0 esemnyei adjk az leket. */
+		pxEtpwm->AQCTLA = 0U;
+		pxEtpwm->AQSFRC = clkoutRLDCSF_IMMEDIATE;
+		pxEtpwm->AQCSFRC = clkoutCSFA_LOW;
+		pxEtpwm->AQSFRC = 0U;
+	}
+	else
+	{
+		etpwmSetCmpA(pxEtpwm, (uint16)(pxOutput->ulPeriodTicks / 2U));
+		pxEtpwm->AQCTLA = clkoutAQ_ZRO_SET | clkoutAQ_CAU_CLEAR;
+		pxEtpwm->AQCSFRC = 0U;
+	}
+
+	etpwmSetCounterMode(pxEtpwm, CounterMode_Up);
+	etpwmStartTBCLK();
+
+	if(pxOutput->xStatus.xIsPPS != pdFALSE)
+	{
+		pxOutput->ulSyncLatencyTicks = prvClockOutputMeasureSyncLatency(pxOutput);
+	}
+
+	xClockOutputCount++;
+	return pdPASS;
+}
+
+void vStartClockOutputTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority)
+{
+	xTaskCreate(prvClockOutputTask, "ClkOut", usTaskStackSize, NULL, uxTaskPriority, NULL);
+}
+
+BaseType_t xClockOutputGetStatus(BaseType_t xIndex, ClockOutputStatus_t *pxStatus)
+{
+	if((xIndex < 0) || (xIndex >= xClockOutputCount))
+	{
+		return pdFAIL;
+	}
+
+	taskENTER_CRITICAL();
+	{
+		*pxStatus = xClockOutputs[xIndex].xStatus;
+	}
+	taskEXIT_CRITICAL();
+	return pdPASS;
+}
+
+static unsigned int prvClockOutputReadCounter(void)
+{
+	return pxClockOutputPaired->TBCTR;
+}
+
+/*
+ * A TBCTR olvass s a szoftveres szinkron kzti kss mrse: ugyanaz a regiszter sorozat fut le egyszer szinkronnal,
+ * egyszer helyette egy hatstalan TBCTL rssal. A szmll ltal a kt esetben megtett t klnbsge a kss.
+ */
+static uint32_t prvClockOutputMeasureSyncLatency(ClockOutput_t *pxOutput)
+{
+	etpwmBASE_t *pxEtpwm = pxOutput->xStatus.pxEtpwm;
+	uint32_t ulStart, ulWithSync, ulWithoutSync;
+
+	portENTER_CRITICAL();
+	{
+		ulStart = pxEtpwm->TBCTR;
+		etpwmEnableCounterLoadOnSync(pxEtpwm, (uint16)ulStart, clkoutPHSDIR_UP);
+		etpwmTriggerSWSync(pxEtpwm);
+		etpwmDisableCounterLoadOnSync(pxEtpwm);
+		ulWithSync = ((uint32_t)pxEtpwm->TBCTR + pxOutput->ulPeriodTicks - ulStart) % pxOutput->ulPeriodTicks;
+
+		ulStart = pxEtpwm->TBCTR;
+		etpwmEnableCounterLoadOnSync(pxEtpwm, (uint16)ulStart, clkoutPHSDIR_UP);
+		pxEtpwm->TBCTL |= 0U;
+		etpwmDisableCounterLoadOnSync(pxEtpwm);
+		ulWithoutSync = ((uint32_t)pxEtpwm->TBCTR + pxOutput->ulPeriodTicks - ulStart) % pxOutput->ulPeriodTicks;
+	}
+	portEXIT_CRITICAL();
+
+	return (ulWithoutSync > ulWithSync) ? (ulWithoutSync - ulWithSync) : 0U;
+}
+
+/*
+ * Ngyszgjel igaztsa egyetlen peridus hossznak mdostsval. A TBPRD rnykregiszterbl a kvetkez CTR = 0-kor
+ * tltdik be, gy a szmll nem ugrik s l sem maradhat ki; a nulltmenet utn a nvleges peridus kerl vissza.
+ * A mdostott peridus nem lehet rvidebb a CMPA-nl, a maradk hibt a kvetkez igazts javtja.
+ * A nulltmenetet engedlyezett megszaktsok mellett vrjuk, csak a TBPRD rsok vannak kritikus szakaszban. Ha a
+ * taszk kzben egy peridusnl tovbb llt, az RTIFRC0 alapjn abbahagyjuk a vrakozst; ekkor a mdostott
+ * rtk tbb peridusra is rvnyes lehetett, ezt szintn a kvetkez igazts javtja.
+ */
+static void prvClockOutputStretchPeriod(ClockOutput_t *pxOutput, int32_t lErrorTicks)
+{
+	etpwmBASE_t *pxEtpwm = pxOutput->xStatus.pxEtpwm;
+	int32_t lMin = (int32_t)(pxOutput->ulPeriodTicks / 2U) + 1 - (int32_t)pxOutput->ulPeriodTicks;
+	int32_t lMax = (int32_t)clkoutMAX_PERIOD_TICKS - (int32_t)pxOutput->ulPeriodTicks;
+	uint16 usPrevious, usCounter;
+	uint32_t ulStart, ulLimit;
+
+	if(lErrorTicks < lMin)
+	{
+		lErrorTicks = lMin;
+	}
+	else if(lErrorTicks > lMax)
+	{
+		lErrorTicks = lMax;
+	}
+
+	/* A nulltmenet legksbb a foly (nvleges) peridus vgn jn: annak hossza RTIFRC0 temekben, egy tem tartalkkal */
+	ulLimit = (uint32_t)RTI_FRC0_NS_TO_TICKS(pxOutput->ulCounterPeriodNs) + 1U;
+
+	portENTER_CRITICAL();
+	{
+		/* Ha a nulltmenet a TBCTR olvass s a TBPRD rs kz esik, most nem korriglunk. */
+		ulStart = RTI_FRC0_REG;
+		usPrevious = pxEtpwm->TBCTR;
+		pxEtpwm->TBPRD = (uint16)((int32_t)pxOutput->ulPeriodTicks - 1 + lErrorTicks);
+	}
+	portEXIT_CRITICAL();
+
+	while(((usCounter = pxEtpwm->TBCTR) >= usPrevious) && ((RTI_FRC0_REG - ulStart) < ulLimit))
+	{
+		usPrevious = usCounter;
+	}
+
+	portENTER_CRITICAL();
+	{
+		pxEtpwm->TBPRD = (uint16)(pxOutput->ulPeriodTicks - 1U);
+	}
+	portEXIT_CRITICAL();
+}
+
+/*
+ * Egy kimenet fzisnak igaztsa a PHY idhz tartoz elvrt szmll rtk s a prostva mintavtelezett TBCTR
+ * klnbsge alapjn. Visszatrsi rtk: rendszerid - PHY id.
+ * PPS: a TBPHS s a szoftveres szinkron lltja t a szmllt. A feladat a viv kzepn hvja (fl vivperidussal
+ * a lefut l utn), gy az ugrs nem visz t CTR = 0 esemnyt. Ngyszgjel: egy peridus nyjtsa vagy rvidtse.
+ */
+static int64_t prvClockOutputAlign(ClockOutput_t *pxOutput)
+{
+	etpwmBASE_t *pxEtpwm = pxOutput->xStatus.pxEtpwm;
+	uint64_t uxPhy, uxSys;
+	unsigned int ulCounter;
+	uint32_t ulExpected, ulError, ulNew;
+	int32_t lErrorTicks;
+
+	pxClockOutputPaired = pxEtpwm;
+	uxPhy = xPTPClockGetTimePaired(prvClockOutputReadCounter, &ulCounter, NULL);
+	/* Az MDIO olvassok miatt ~100 usec-kel ksbb: csak az bresztsek temezshez hasznljuk. */
+	uxSys = xGetSysTimeNs(NULL);
+
+	ulExpected = (uint32_t)(((uxPhy % pxOutput->ulCounterPeriodNs) * configCLKOUT_ETPWM_CLOCK_HZ) / (clkoutNS_PER_SECOND * pxOutput->ulPrescale));
+	ulError = ((uint32_t)ulCounter + pxOutput->ulPeriodTicks - ulExpected) % pxOutput->ulPeriodTicks;
+	lErrorTicks = (ulError >= (pxOutput->ulPeriodTicks / 2U)) ? (int32_t)ulError - (int32_t)pxOutput->ulPeriodTicks : (int32_t)ulError;
+
+	if((ulError != 0U) && (pxOutput->xStatus.xIsPPS != pdFALSE))
+	{
+		portENTER_CRITICAL();
+		{
+			ulNew = ((uint32_t)pxEtpwm->TBCTR + pxOutput->ulPeriodTicks - ulError + pxOutput->ulSyncLatencyTicks) % pxOutput->ulPeriodTicks;
+			etpwmEnableCounterLoadOnSync(pxEtpwm, (uint16)ulNew, clkoutPHSDIR_UP);
+			etpwmTriggerSWSync(pxEtpwm);
+			etpwmDisableCounterLoadOnSync(pxEtpwm);
+		}
+		portEXIT_CRITICAL();
+	}
+	else if(ulError != 0U)
+	{
+		prvClockOutputStretchPeriod(pxOutput, lErrorTicks);
+	}
+
+	taskENTER_CRITICAL();
+	{
+		pxOutput->xStatus.lLastPhaseErrorNs = (int32_t)(((int64_t)lErrorTicks * (int64_t)pxOutput->xStatus.ulTickPs) / 1000);
+		pxOutput->xStatus.ulAlignments++;
+	}
+	taskEXIT_CRITICAL();
+
+	return (int64_t)(uxSys - uxPhy);
+}
+
+/*
+ * A PPS kimenetek knyszertett szintjnek bersa. rnykregiszter: a kvetkez CTR = 0 esemnykor lp letbe.
+ */
+static void prvClockOutputForcePPS(uint16 usForce)
+{
+	BaseType_t x;
+
+	for(x = 0; x < xClockOutputCount; x++)
+	{
+		if(xClockOutputs[x].xStatus.xIsPPS != pdFALSE)
+		{
+			xClockOutputs[x].xStatus.pxEtpwm->AQCSFRC = usForce;
+			if(usForce == clkoutCSFA_LOW)
+			{
+				xClockOutputs[x].xStatus.ulPulses++;
+			}
+		}
+	}
+}
+
+static void prvClockOutputTask(void *pvParameters)
+{
+	const uint64_t uxHalfCarrier = configCLKOUT_PPS_CARRIER_NS / 2U;
+	const uint64_t uxWidth = (uint64_t)configCLKOUT_PPS_WIDTH_MS * 1000000ULL;
+	BaseType_t x, xHavePPS = pdFALSE;
+	int64_t xSysMinusPhy = 0;
+	uint64_t uxPhyNow, uxBoundary;
+
+	(void)pvParameters;
+
+	/* A PHY-t a hlzati interfsz inicializlja, addig vrunk. */
+	while(FreeRTOS_IsNetworkUp() == pdFALSE)
+	{
+		vTaskDelay(pdMS_TO_TICKS(500));
+	}
+	vPTPClockEnable();
+
+	for(x = 0; x < xClockOutputCount; x++)
+	{
+		if(xClockOutputs[x].xStatus.xIsPPS != pdFALSE)
+		{
+			xHavePPS = pdTRUE;
+		}
+	}
+
+	for(;;)
+	{
+		for(x = 0; x < xClockOutputCount; x++)
+		{
+			xSysMinusPhy = prvClockOutputAlign(&xClockOutputs[x]);
+		}
+
+		/* A kvetkez egsz PHY msodperc, legalbb egy vivperidus tartalkkal. */
+		uxPhyNow = (uint64_t)((int64_t)xGetSysTimeNs(NULL) - xSysMinusPhy);
+		uxBoundary = ((uxPhyNow / clkoutNS_PER_SECOND) + 1U) * clkoutNS_PER_SECOND;
+		if((uxBoundary - uxPhyNow) < (2U * configCLKOUT_PPS_CARRIER_NS))
+		{
+			uxBoundary += clkoutNS_PER_SECOND;
+		}
+
+		if(xHavePPS != pdFALSE)
+		{
+			/* lests fl vivperidussal az l eltt, a kimenet a hatron lv CTR = 0-kor vlt. */
+			vTaskDelayUntilTime((uint64_t)((int64_t)(uxBoundary - uxHalfCarrier) + xSysMinusPhy));
+			prvClockOutputForcePPS(clkoutCSFA_HIGH);
+			vTaskDelayUntilTime((uint64_t)((int64_t)(uxBoundary + uxWidth - uxHalfCarrier) + xSysMinusPhy));
+			prvClockOutputForcePPS(clkoutCSFA_LOW);
+			/* A lefut l utn igaztunk jra. */
+			vTaskDelayUntilTime((uint64_t)((int64_t)(uxBoundary + uxWidth + uxHalfCarrier) + xSysMinusPhy));
+		}
+		else
+		{
+			vTaskDelayUntilTime((uint64_t)((int64_t)uxBoundary + xSysMinusPhy));
+		}
+	}
+}
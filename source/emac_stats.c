@@ -0,0 +1,225 @@
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "os_task.h"
+#include "FreeRTOS_IP.h"
+#include "HL_emac.h"
+#include "HL_hw_reg_access.h"
+#include "rti_runtimestats.h"
+#include "emac_stats.h"
+
+/* RTIFRC0 temek -> usec (a 64 bites tvlts a ~114 sec-es krbefordulsig helyes) */
+#define emacstatsTICKS_TO_US(x)		( ( uint32_t ) ( RTI_FRC0_TICKS_TO_NS( x ) / 1000U ) )
+
+static const char * const pcEMACStatsNames[emacstatsCOUNTERS] =
+{
+	"RXGOODFRAMES", "RXBCASTFRAMES", "RXMCASTFRAMES", "RXPAUSEFRAMES", "RXCRCERRORS", "RXALIGNCODEERRORS",
+	"RXOVERSIZED", "RXJABBER", "RXUNDERSIZED", "RXFRAGMENTS", "RXFILTERED", "RXQOSFILTERED", "RXOCTETS",
+	"TXGOODFRAMES", "TXBCASTFRAMES", "TXMCASTFRAMES", "TXPAUSEFRAMES", "TXDEFERRED", "TXCOLLISION", "TXSINGLECOLL",
+	"TXMULTICOLL", "TXEXCESSIVECOLL", "TXLATECOLL", "TXUNDERRUN", "TXCARRIERSENSE", "TXOCTETS",
+	"FRAME64", "FRAME65T127", "FRAME128T255", "FRAME256T511", "FRAME512T1023", "FRAME1024TUP", "NETOCTETS",
+	"RXSOFOVERRUNS", "RXMOFOVERRUNS", "RXDMAOVERRUNS", "RXEVENTLOST"
+};
+
+static uint64_t ullEMACStatsTotal[emacstatsCOUNTERS];		/* sszegek a trls ta (megszaktsbl is rva) */
+static uint64_t ullEMACStatsSnapshot[emacstatsCOUNTERS];	/* Az sszegek a peridus vgn, a taszk szmol bellk */
+static uint64_t ullEMACStatsPrevious[emacstatsCOUNTERS];	/* Az sszegek az elz peridus vgn */
+static uint32_t ulEMACStatsRate[emacstatsCOUNTERS];			/* Sebessgek az utols peridusban, 1/sec */
+static EMACLatency_t xEMACStatsLatency[emacstatsLATENCIES];
+static uint32_t ulEMACStatsRunningMaxUs[emacstatsLATENCIES];	/* A foly peridus maximuma */
+
+static void prvEMACStatsAccumulate(void);
+static void prvEMACStatsRecord(BaseType_t xLatency, uint32_t ulTimestamp, uint32_t ulNow);
+static void prvEMACStatsTask(void *pvParameters);
+
+void vStartEMACStatsTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority)
+{
+	xTaskCreate(prvEMACStatsTask, "EMACStat", usTaskStackSize, NULL, uxTaskPriority, NULL);
+}
+
+/*
+ * A hardver szmllk hozzadsa az sszegekhez. Megszaktsbl, vagy tiltott megszaktsok mellett hvhat.
+ */
+static void prvEMACStatsAccumulate(void)
+{
+	uint32_t ulCounter, ulValue;
+
+	for(ulCounter = 0U; ulCounter < emacstatsHW_COUNTERS; ulCounter++)
+	{
+		ulValue = EMACReadNetStatRegisters(EMAC_BASE, ulCounter);
+		if(ulValue != 0U)
+		{
+			/* Write-to-decrement: a kiolvass ta rkezett esemnyek a regiszterben maradnak */
+			HWREG(EMAC_BASE + EMAC_NETSTATREGS(ulCounter)) = ulValue;
+			ullEMACStatsTotal[ulCounter] += ulValue;
+		}
+	}
+}
+
+void vEMACStatsSampleFromISR(void)
+{
+	prvEMACStatsAccumulate();
+}
+
+void vEMACStatsRxEventLost(void)
+{
+	taskENTER_CRITICAL();
+	{
+		ullEMACStatsTotal[emacstatsRXEVENTLOST]++;
+	}
+	taskEXIT_CRITICAL();
+}
+
+uint64_t ullEMACStatsGetTotal(uint32_t ulCounter)
+{
+	uint64_t ullTotal = 0U;
+
+	if(ulCounter < emacstatsCOUNTERS)
+	{
+		taskENTER_CRITICAL();
+		{
+			/* A hardverben lev, mg nem sszegzett rtkkel egytt */
+			prvEMACStatsAccumulate();
+			ullTotal = ullEMACStatsTotal[ulCounter];
+		}
+		taskEXIT_CRITICAL();
+	}
+	return ullTotal;
+}
+
+uint32_t ulEMACStatsGetRate(uint32_t ulCounter)
+{
+	return (ulCounter < emacstatsCOUNTERS) ? ulEMACStatsRate[ulCounter] : 0U;
+}
+
+const char *pcEMACStatsGetName(uint32_t ulCounter)
+{
+	return (ulCounter < emacstatsCOUNTERS) ? pcEMACStatsNames[ulCounter] : "";
+}
+
+void vEMACStatsGetLatency(BaseType_t xLatency, EMACLatency_t *pxLatency)
+{
+	taskENTER_CRITICAL();
+	{
+		*pxLatency = xEMACStatsLatency[xLatency];
+	}
+	taskEXIT_CRITICAL();
+}
+
+void vEMACStatsReset(void)
+{
+	taskENTER_CRITICAL();
+	{
+		prvEMACStatsAccumulate();
+		memset(ullEMACStatsTotal, 0, sizeof(ullEMACStatsTotal));
+		memset(ullEMACStatsPrevious, 0, sizeof(ullEMACStatsPrevious));
+		memset(ulEMACStatsRate, 0, sizeof(ulEMACStatsRate));
+		memset(xEMACStatsLatency, 0, sizeof(xEMACStatsLatency));
+		memset(ulEMACStatsRunningMaxUs, 0, sizeof(ulEMACStatsRunningMaxUs));
+	}
+	taskEXIT_CRITICAL();
+}
+
+/*
+ * Egy ksleltets hozzadsa a hisztogramhoz. Az IP taszk s a socketeket olvas taszkok is hvjk.
+ */
+static void prvEMACStatsRecord(BaseType_t xLatency, uint32_t ulTimestamp, uint32_t ulNow)
+{
+	EMACLatency_t *pxLatency = &xEMACStatsLatency[xLatency];
+	uint32_t ulUs = emacstatsTICKS_TO_US(ulNow - ulTimestamp);
+	uint32_t ulBucket = 0U, ulValue = ulUs;
+
+	while((ulValue != 0U) && (ulBucket < (emacstatsHISTOGRAM_BUCKETS - 1U)))
+	{
+		ulValue >>= 1;
+		ulBucket++;
+	}
+
+	taskENTER_CRITICAL();
+	{
+		pxLatency->ulBuckets[ulBucket]++;
+		pxLatency->ulCount++;
+		pxLatency->ullSumUs += ulUs;
+		if(ulUs > pxLatency->ulMaxUs)
+		{
+			pxLatency->ulMaxUs = ulUs;
+		}
+		if(ulUs > ulEMACStatsRunningMaxUs[xLatency])
+		{
+			ulEMACStatsRunningMaxUs[xLatency] = ulUs;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+
+void vEMACStatsIPTaskLatency(uint32_t *pulTimestamp)
+{
+	uint32_t ulNow = RTI_FRC0_REG;
+
+	/* A driveren kvlrl rkez pufferekben nincs idblyeg */
+	if(*pulTimestamp != 0U)
+	{
+		prvEMACStatsRecord(emacstatsLATENCY_ISR_TO_IP, *pulTimestamp, ulNow);
+	}
+	*pulTimestamp = ulNow | 1U;
+}
+
+void vEMACStatsSocketLatency(uint32_t *pulTimestamp)
+{
+	uint32_t ulTimestamp = *pulTimestamp;
+
+	if(ulTimestamp != 0U)
+	{
+		*pulTimestamp = 0U;
+		prvEMACStatsRecord(emacstatsLATENCY_IP_TO_SOCKET, ulTimestamp, RTI_FRC0_REG);
+	}
+}
+
+void vEMACStatsKeepTimestamp(uint32_t *pulTimestamp, uint32_t ulTimestamp)
+{
+	/* A korbbi, mg ki nem olvasott adat idblyege marad */
+	if(*pulTimestamp == 0U)
+	{
+		*pulTimestamp = ulTimestamp;
+	}
+}
+
+static void prvEMACStatsTask(void *pvParameters)
+{
+	TickType_t xLastWakeTime = xTaskGetTickCount();
+	uint32_t ulCounter;
+	BaseType_t xLatency;
+
+	(void)pvParameters;
+
+	for(;;)
+	{
+		vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(ipconfigEMAC_STATS_PERIOD_MS));
+
+		taskENTER_CRITICAL();
+		{
+			prvEMACStatsAccumulate();
+			memcpy(ullEMACStatsSnapshot, ullEMACStatsTotal, sizeof(ullEMACStatsSnapshot));
+			for(xLatency = 0; xLatency < emacstatsLATENCIES; xLatency++)
+			{
+				xEMACStatsLatency[xLatency].ulPeriodMaxUs = ulEMACStatsRunningMaxUs[xLatency];
+				ulEMACStatsRunningMaxUs[xLatency] = 0U;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		/* Az osztsok mr a kritikus szakaszon kvl. Kzbejtt trls utn az els peridus 0. */
+		for(ulCounter = 0U; ulCounter < emacstatsCOUNTERS; ulCounter++)
+		{
+			if(ullEMACStatsSnapshot[ulCounter] >= ullEMACStatsPrevious[ulCounter])
+			{
+				ulEMACStatsRate[ulCounter] = (uint32_t) (((ullEMACStatsSnapshot[ulCounter] - ullEMACStatsPrevious[ulCounter]) * 1000U) / ipconfigEMAC_STATS_PERIOD_MS);
+			}
+			else
+			{
+				ulEMACStatsRate[ulCounter] = 0U;
+			}
+			ullEMACStatsPrevious[ulCounter] = ullEMACStatsSnapshot[ulCounter];
+		}
+	}
+}
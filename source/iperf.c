@@ -0,0 +1,849 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "os_task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_Sockets.h"
+#include "rti_runtimestats.h"
+#include "iperf.h"
+
+#define iperfPOLL_MS				( 250U )		/* Ilyen gyakran nzzk a lelltsi krst */
+#define iperfCONNECT_TIMEOUT_MS		( 3000U )
+#define iperfDRAIN_TIMEOUT_US		( 5000000ULL )	/* TCP kliens: ennyit vrunk a nyugtkra a mrs vgn */
+#define iperfUDP_IDLE_US			( 2000000ULL )	/* UDP szerver: ennyi csend utn a mrst lezrjuk */
+#define iperfPUBLISH_US				( 100000ULL )	/* A CLI ltal ltott lls frisstse */
+#define iperfUDP_BATCH				( 8U )			/* recvmulti() / sendmulti() egy hvssal */
+#define iperfFIN_RETRIES			( 10 )			/* UDP kliens: ennyiszer krjk a szerver jelentst */
+
+/* iperf2 protokoll elemek (hlzati byte sorrend) */
+#define iperfUDP_HEADER_LENGTH		( 12U )			/* UDP_datagram: id, tv_sec, tv_usec */
+#define iperfSERVER_HEADER_LENGTH	( 40U )			/* server_hdr: flags, total_len1/2, stop_sec/usec, error_cnt, outorder_cnt, datagrams, jitter1/2 */
+#define iperfUDP_REPORT_LENGTH		( iperfUDP_HEADER_LENGTH + iperfSERVER_HEADER_LENGTH )
+#define iperfHEADER_VERSION1		( 0x80000000UL )
+
+#define iperfMODE_IDLE				( 0U )
+#define iperfMODE_SERVER			( 1U )
+#define iperfMODE_CLIENT			( 2U )
+
+/* A futsi statisztikk egy mintja */
+typedef struct xIPERF_CPU
+{
+	uint32_t ulTotal;
+	uint32_t ulIdle;
+	uint32_t ulIPTask;
+} IperfCPU_t;
+
+/* Az UDP szerver llapota egy klienshez */
+typedef struct xIPERF_UDP_PEER
+{
+	uint32_t ulIP;
+	uint16_t usPort;
+	BaseType_t xFinished;			/* A kliens lezrta a mrst, a FIN-ekre a jelentssel vlaszolunk */
+	int32_t lLastID;				/* A legnagyobb eddig ltott sorszm */
+	int64_t llLastTransit;			/* Az elz datagram klds-rkezs klnbsge (usec) */
+	int64_t llJitter16;				/* A jitter 16-szorosa (usec) */
+	uint64_t ullFirstUs;
+	uint64_t ullLastUs;
+} IperfUDPPeer_t;
+
+static TaskHandle_t xIperfTaskHandle = NULL;
+static volatile uint8_t ucIperfMode = iperfMODE_IDLE;
+static volatile BaseType_t xIperfStopRequested = pdFALSE;
+
+/* A krs paramterei, a taszk olvassa indtskor */
+static BaseType_t xIperfUDP;
+static uint32_t ulIperfIP;
+static uint32_t ulIperfSeconds;
+static uint32_t ulIperfBandwidth;
+static uint32_t ulIperfLength;
+
+static IperfReport_t xIperfReport;					/* A CLI ezt ltja, kritikus szakaszban msoljuk */
+static IperfReport_t xIperfSession;					/* A foly mrs, csak a taszk rja */
+static IperfCPU_t xIperfCPUStart;
+static uint64_t ullIperfStartUs;
+static uint64_t ullIperfPublishUs;
+
+static BaseType_t prvIperfRequest(uint8_t ucMode, BaseType_t xUDP, uint32_t ulIPAddress, uint32_t ulSeconds, uint32_t ulBandwidth, uint32_t ulLength);
+static void prvIperfSampleCPU(IperfCPU_t *pxSample);
+static void prvIperfBegin(uint32_t ulRemoteIP, uint64_t ullNowUs);
+static void prvIperfEnd(uint64_t ullEndUs, Socket_t xTCPSocket);
+static void prvIperfPublish(uint64_t ullNowUs, BaseType_t xForce);
+static void prvIperfPrint(void);
+static void prvIperfSetWinProperties(Socket_t xSocket);
+static void prvIperfTCPServer(void);
+static void prvIperfTCPClient(void);
+static void prvIperfUDPServer(void);
+static void prvIperfUDPClient(void);
+static void prvIperfUDPReceived(Socket_t xSocket, IperfUDPPeer_t *pxPeer, const struct freertos_mmsg *pxMessage, uint64_t ullNowUs);
+static void prvIperfUDPReport(Socket_t xSocket, const IperfUDPPeer_t *pxPeer, const uint8_t *pucHeader);
+static uint32_t prvIperfRead32(const uint8_t *pucData);
+static void prvIperfWrite32(uint8_t *pucData, uint32_t ulValue);
+static void prvIperfTask(void *pvParameters);
+
+void vStartIperfTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority)
+{
+	xTaskCreate(prvIperfTask, "IPERF", usTaskStackSize, NULL, uxTaskPriority, &xIperfTaskHandle);
+}
+
+BaseType_t xIperfStartServer(BaseType_t xUDP)
+{
+	return prvIperfRequest(iperfMODE_SERVER, xUDP, 0U, 0U, 0U, 0U);
+}
+
+BaseType_t xIperfStartClient(uint32_t ulIPAddress, BaseType_t xUDP, uint32_t ulSeconds, uint32_t ulBandwidth, uint32_t ulLength)
+{
+	if(ulSeconds == 0U)
+	{
+		ulSeconds = ipconfigIPERF_TIME_SEC;
+	}
+	if(ulBandwidth == 0U)
+	{
+		ulBandwidth = ipconfigIPERF_UDP_BANDWIDTH;
+	}
+	if(ulLength == 0U)
+	{
+		ulLength = ipconfigIPERF_UDP_LENGTH;
+	}
+	/* A datagramba a szerver jelentse is belefrjen, s ne legyen trdelve */
+	if((ulIPAddress == 0U) || (ulSeconds > 3600U) || (ulLength < iperfUDP_REPORT_LENGTH) || (ulLength > ipMAX_UDP_PAYLOAD_LENGTH))
+	{
+		return pdFAIL;
+	}
+
+	return prvIperfRequest(iperfMODE_CLIENT, xUDP, ulIPAddress, ulSeconds, ulBandwidth, ulLength);
+}
+
+void vIperfStop(void)
+{
+	/* A taszk legfeljebb iperfPOLL_MS mlva szreveszi */
+	xIperfStopRequested = pdTRUE;
+}
+
+void vIperfGetReport(IperfReport_t *pxReport)
+{
+	taskENTER_CRITICAL();
+	{
+		*pxReport = xIperfReport;
+	}
+	taskEXIT_CRITICAL();
+}
+
+static BaseType_t prvIperfRequest(uint8_t ucMode, BaseType_t xUDP, uint32_t ulIPAddress, uint32_t ulSeconds, uint32_t ulBandwidth, uint32_t ulLength)
+{
+	BaseType_t xResult = pdFAIL;
+
+	if(xIperfTaskHandle == NULL)
+	{
+		return pdFAIL;
+	}
+
+	taskENTER_CRITICAL();
+	{
+		/* Egyszerre csak egy mrs futhat */
+		if(ucIperfMode == iperfMODE_IDLE)
+		{
+			xIperfUDP = xUDP;
+			ulIperfIP = ulIPAddress;
+			ulIperfSeconds = ulSeconds;
+			ulIperfBandwidth = ulBandwidth;
+			ulIperfLength = ulLength;
+			xIperfStopRequested = pdFALSE;
+			ucIperfMode = ucMode;
+
+			memset(&xIperfReport, 0, sizeof(xIperfReport));
+			xIperfReport.xActive = pdTRUE;
+			xIperfReport.xServer = (ucMode == iperfMODE_SERVER) ? pdTRUE : pdFALSE;
+			xIperfReport.xUDP = xUDP;
+			xIperfReport.ulRemoteIP = ulIPAddress;
+			xResult = pdPASS;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if(xResult == pdPASS)
+	{
+		xTaskNotifyGive(xIperfTaskHandle);
+	}
+
+	return xResult;
+}
+
+/*
+ * Az IDLE s az IP taszk futsi ideje, valamint a teljes futsi id (a run-time stats szmllja 1 MHz-es).
+ */
+static void prvIperfSampleCPU(IperfCPU_t *pxSample)
+{
+	TaskStatus_t *pxStatus;
+	UBaseType_t uxCount;
+	UBaseType_t x;
+
+	memset(pxSample, 0, sizeof(*pxSample));
+
+	/* Ha kzben j taszk jn ltre, az uxTaskGetSystemState() 0-t ad, a terhels akkor nem ismert */
+	uxCount = uxTaskGetNumberOfTasks();
+	pxStatus = (TaskStatus_t *) pvPortMalloc(uxCount * sizeof(TaskStatus_t));
+	if(pxStatus != NULL)
+	{
+		uxCount = uxTaskGetSystemState(pxStatus, uxCount, &pxSample->ulTotal);
+		for(x = 0; x < uxCount; x++)
+		{
+			if(strcmp(pxStatus[x].pcTaskName, "IDLE") == 0)
+			{
+				pxSample->ulIdle = pxStatus[x].ulRunTimeCounter;
+			}
+			else if(strcmp(pxStatus[x].pcTaskName, "IP-task") == 0)
+			{
+				pxSample->ulIPTask = pxStatus[x].ulRunTimeCounter;
+			}
+		}
+		vPortFree(pxStatus);
+	}
+}
+
+static void prvIperfBegin(uint32_t ulRemoteIP, uint64_t ullNowUs)
+{
+	memset(&xIperfSession, 0, sizeof(xIperfSession));
+	xIperfSession.xActive = pdTRUE;
+	xIperfSession.xServer = (ucIperfMode == iperfMODE_SERVER) ? pdTRUE : pdFALSE;
+	xIperfSession.xUDP = xIperfUDP;
+	xIperfSession.xRunning = pdTRUE;
+	xIperfSession.ulRemoteIP = ulRemoteIP;
+
+	prvIperfSampleCPU(&xIperfCPUStart);
+	ullIperfStartUs = ullNowUs;
+	prvIperfPublish(ullNowUs, pdTRUE);
+}
+
+static void prvIperfEnd(uint64_t ullEndUs, Socket_t xTCPSocket)
+{
+	IperfCPU_t xCPUEnd;
+	uint32_t ulTotal;
+	uint32_t ulIdle;
+
+	prvIperfSampleCPU(&xCPUEnd);
+
+	/* A 32 bites szmllk klnbsge 71 percig helyes */
+	ulTotal = xCPUEnd.ulTotal - xIperfCPUStart.ulTotal;
+	ulIdle = xCPUEnd.ulIdle - xIperfCPUStart.ulIdle;
+	if((ulTotal != 0U) && (xCPUEnd.ulTotal != 0U) && (xIperfCPUStart.ulTotal != 0U) && (ulIdle <= ulTotal))
+	{
+		xIperfSession.ulCPULoad = 1000U - (uint32_t) (((uint64_t) ulIdle * 1000U) / ulTotal);
+		xIperfSession.ulIPTaskLoad = (uint32_t) (((uint64_t) (xCPUEnd.ulIPTask - xIperfCPUStart.ulIPTask) * 1000U) / ulTotal);
+	}
+
+	if(xTCPSocket != NULL)
+	{
+		BaseType_t xRetransmits = FreeRTOS_retransmits(xTCPSocket);
+
+		xIperfSession.ulRetransmits = (xRetransmits > 0) ? (uint32_t) xRetransmits : 0U;
+	}
+
+	xIperfSession.xRunning = pdFALSE;
+	prvIperfPublish(ullEndUs, pdTRUE);
+	prvIperfPrint();
+}
+
+static void prvIperfPublish(uint64_t ullNowUs, BaseType_t xForce)
+{
+	if((xForce == pdFALSE) && ((ullNowUs - ullIperfPublishUs) < iperfPUBLISH_US))
+	{
+		return;
+	}
+	ullIperfPublishUs = ullNowUs;
+	xIperfSession.ulDurationMs = (uint32_t) ((ullNowUs - ullIperfStartUs) / 1000U);
+
+	taskENTER_CRITICAL();
+	{
+		xIperfReport = xIperfSession;
+	}
+	taskEXIT_CRITICAL();
+}
+
+static void prvIperfPrint(void)
+{
+	char cIP[16];
+	uint32_t ulRate;
+	uint32_t ulTotal;
+
+	FreeRTOS_inet_ntoa(xIperfSession.ulRemoteIP, cIP);
+	/* A szerver a fogadott datagramokat szmolja, a kliens az elkldtteket */
+	ulTotal = xIperfSession.ulDatagrams + ((xIperfSession.xServer != pdFALSE) ? xIperfSession.ulLost : 0U);
+	ulRate = (xIperfSession.ulDurationMs != 0U) ? (uint32_t) ((xIperfSession.ullBytes * 8U) / xIperfSession.ulDurationMs) : 0U;
+
+	if(xIperfSession.xUDP == pdFALSE)
+	{
+		FreeRTOS_printf(("iperf: TCP %s %s: %u kB in %u ms, %u kbit/s, retransmits %u, CPU %u.%u%% (IP-task %u.%u%%)\n",
+			(xIperfSession.xServer != pdFALSE) ? "from" : "to", cIP,
+			(unsigned) (xIperfSession.ullBytes / 1024U), (unsigned) xIperfSession.ulDurationMs, (unsigned) ulRate,
+			(unsigned) xIperfSession.ulRetransmits,
+			(unsigned) (xIperfSession.ulCPULoad / 10U), (unsigned) (xIperfSession.ulCPULoad % 10U),
+			(unsigned) (xIperfSession.ulIPTaskLoad / 10U), (unsigned) (xIperfSession.ulIPTaskLoad % 10U)));
+	}
+	else
+	{
+		FreeRTOS_printf(("iperf: UDP %s %s: %u kB in %u ms, %u kbit/s, lost %u/%u, out-of-order %u, jitter %u us, CPU %u.%u%% (IP-task %u.%u%%)\n",
+			(xIperfSession.xServer != pdFALSE) ? "from" : "to", cIP,
+			(unsigned) (xIperfSession.ullBytes / 1024U), (unsigned) xIperfSession.ulDurationMs, (unsigned) ulRate,
+			(unsigned) xIperfSession.ulLost, (unsigned) ulTotal,
+			(unsigned) xIperfSession.ulOutOfOrder, (unsigned) xIperfSession.ulJitterUs,
+			(unsigned) (xIperfSession.ulCPULoad / 10U), (unsigned) (xIperfSession.ulCPULoad % 10U),
+			(unsigned) (xIperfSession.ulIPTaskLoad / 10U), (unsigned) (xIperfSession.ulIPTaskLoad % 10U)));
+	}
+}
+
+static void prvIperfSetWinProperties(Socket_t xSocket)
+{
+	WinProperties_t xWinProps;
+
+	/* A figyel socket belltsait a gyerek socketek rklik */
+	memset(&xWinProps, 0, sizeof(xWinProps));
+	xWinProps.lTxBufSize = ipconfigIPERF_TX_BUFSIZE;
+	xWinProps.lTxWinSize = ipconfigIPERF_TX_WINSIZE;
+	xWinProps.lRxBufSize = ipconfigIPERF_RX_BUFSIZE;
+	xWinProps.lRxWinSize = ipconfigIPERF_RX_WINSIZE;
+	FreeRTOS_setsockopt(xSocket, 0, FREERTOS_SO_WIN_PROPERTIES, (void *) &xWinProps, sizeof(xWinProps));
+}
+
+/*
+ * TCP szerver: a berkez adatot kzvetlenl az RX streamben "fogyasztjuk el", msols nlkl.
+ */
+static void prvIperfTCPServer(void)
+{
+	Socket_t xListen;
+	Socket_t xClient;
+	struct freertos_sockaddr xAddress;
+	socklen_t xSize = sizeof(xAddress);
+	TickType_t xTimeout = pdMS_TO_TICKS(iperfPOLL_MS);
+	uint8_t *pucData;
+	int32_t lBytes;
+	uint64_t ullNowUs;
+
+	xListen = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP);
+	if(xListen == FREERTOS_INVALID_SOCKET)
+	{
+		return;
+	}
+	prvIperfSetWinProperties(xListen);
+	FreeRTOS_setsockopt(xListen, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof(xTimeout));
+
+	memset(&xAddress, 0, sizeof(xAddress));
+	xAddress.sin_port = FreeRTOS_htons(ipconfigIPERF_PORT);
+	if((FreeRTOS_bind(xListen, &xAddress, sizeof(xAddress)) != 0) || (FreeRTOS_listen(xListen, 1) != 0))
+	{
+		FreeRTOS_closesocket(xListen);
+		return;
+	}
+
+	while(xIperfStopRequested == pdFALSE)
+	{
+		xClient = FreeRTOS_accept(xListen, &xAddress, &xSize);
+		if((xClient == NULL) || (xClient == FREERTOS_INVALID_SOCKET))
+		{
+			continue;
+		}
+		FreeRTOS_setsockopt(xClient, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof(xTimeout));
+
+		ullNowUs = xGetHighResolutionTime();
+		prvIperfBegin(xAddress.sin_addr, ullNowUs);
+
+		while(xIperfStopRequested == pdFALSE)
+		{
+			lBytes = FreeRTOS_recv(xClient, (void *) &pucData, 0x20000u, FREERTOS_ZERO_COPY);
+			ullNowUs = xGetHighResolutionTime();
+			if(lBytes > 0)
+			{
+				/* Az adat csak eldoband, a fogyaszts a tail lptetse */
+				FreeRTOS_recv(xClient, NULL, (size_t) lBytes, 0);
+				xIperfSession.ullBytes += (uint64_t) lBytes;
+				prvIperfPublish(ullNowUs, pdFALSE);
+			}
+			else if(lBytes < 0)
+			{
+				/* A kliens lezrta a kapcsolatot */
+				break;
+			}
+		}
+
+		prvIperfEnd(ullNowUs, xClient);
+		FreeRTOS_closesocket(xClient);
+	}
+
+	FreeRTOS_closesocket(xListen);
+}
+
+/*
+ * TCP kliens: a TX streambe kzvetlenl runk, s FreeRTOS_send(NULL)-lal csak a head-et lptetjk. A stream minden byte-jt
+ * az els krben nullzzuk: gy az elejn az iperf2 client_hdr is nulla (nincs ktirny mrs), utna nincs mit rni.
+ */
+static void prvIperfTCPClient(void)
+{
+	Socket_t xSocket;
+	SocketSet_t xSocketSet;
+	struct freertos_sockaddr xAddress;
+	TickType_t xTimeout = pdMS_TO_TICKS(iperfCONNECT_TIMEOUT_MS);
+	uint8_t *pucHead;
+	BaseType_t xLength;
+	int32_t lBytes;
+	uint64_t ullNowUs;
+	uint64_t ullEndUs;
+	BaseType_t xTries;
+
+	xSocket = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP);
+	if(xSocket == FREERTOS_INVALID_SOCKET)
+	{
+		return;
+	}
+	xSocketSet = FreeRTOS_CreateSocketSet();
+	if(xSocketSet == NULL)
+	{
+		FreeRTOS_closesocket(xSocket);
+		return;
+	}
+	prvIperfSetWinProperties(xSocket);
+	FreeRTOS_setsockopt(xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof(xTimeout));
+	FreeRTOS_setsockopt(xSocket, 0, FREERTOS_SO_SNDTIMEO, &xTimeout, sizeof(xTimeout));
+
+	memset(&xAddress, 0, sizeof(xAddress));
+	xAddress.sin_addr = ulIperfIP;
+	xAddress.sin_port = FreeRTOS_htons(ipconfigIPERF_PORT);
+	if(FreeRTOS_connect(xSocket, &xAddress, sizeof(xAddress)) != 0)
+	{
+		FreeRTOS_printf(("iperf: connect failed\n"));
+		FreeRTOS_DeleteSocketSet(xSocketSet);
+		FreeRTOS_closesocket(xSocket);
+		return;
+	}
+	xTimeout = pdMS_TO_TICKS(iperfPOLL_MS);
+	FreeRTOS_setsockopt(xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof(xTimeout));
+	FreeRTOS_FD_SET(xSocket, xSocketSet, eSELECT_WRITE | eSELECT_EXCEPT);
+
+	ullNowUs = xGetHighResolutionTime();
+	ullEndUs = ullNowUs + ((uint64_t) ulIperfSeconds * 1000000ULL);
+	prvIperfBegin(ulIperfIP, ullNowUs);
+
+	while((xIperfStopRequested == pdFALSE) && (ullNowUs < ullEndUs))
+	{
+		pucHead = FreeRTOS_get_tx_head(xSocket, &xLength);
+		if(pucHead == NULL)
+		{
+			/* Nincs TX stream: a kapcsolat megszakadt */
+			break;
+		}
+		if(xLength > 0)
+		{
+			if(xIperfSession.ullBytes < (2U * ipconfigIPERF_TX_BUFSIZE))
+			{
+				memset(pucHead, 0, (size_t) xLength);
+			}
+			lBytes = FreeRTOS_send(xSocket, NULL, (size_t) xLength, FREERTOS_MSG_DONTWAIT);
+			if(lBytes < 0)
+			{
+				break;
+			}
+			xIperfSession.ullBytes += (uint64_t) lBytes;
+		}
+		else
+		{
+			/* A stream tele, vrunk a nyugtkra */
+			FreeRTOS_select(xSocketSet, pdMS_TO_TICKS(iperfPOLL_MS));
+			if(FreeRTOS_issocketconnected(xSocket) == pdFALSE)
+			{
+				break;
+			}
+		}
+		ullNowUs = xGetHighResolutionTime();
+		prvIperfPublish(ullNowUs, pdFALSE);
+	}
+
+	/* Az id akkor ll meg, amikor a partner minden byte-ot nyugtzott */
+	ullEndUs = ullNowUs;
+	while((FreeRTOS_tx_size(xSocket) > 0) && (FreeRTOS_issocketconnected(xSocket) != pdFALSE) &&
+		  ((ullNowUs - ullEndUs) < iperfDRAIN_TIMEOUT_US) && (xIperfStopRequested == pdFALSE))
+	{
+		vTaskDelay(1);
+		ullNowUs = xGetHighResolutionTime();
+	}
+	prvIperfEnd(ullNowUs, xSocket);
+
+	/* Rendezett lezrs: megvrjuk a partner FIN-jt */
+	FreeRTOS_shutdown(xSocket, FREERTOS_SHUT_RDWR);
+	for(xTries = 0; xTries < 4; xTries++)
+	{
+		if(FreeRTOS_recv(xSocket, (void *) &pucHead, 0x20000u, FREERTOS_ZERO_COPY) < 0)
+		{
+			break;
+		}
+	}
+	FreeRTOS_DeleteSocketSet(xSocketSet);
+	FreeRTOS_closesocket(xSocket);
+}
+
+/*
+ * UDP szerver: a datagramokat a hlzati pufferekben dolgozzuk fel, a sorszmokbl vesztesget s sorrendcsert,
+ * a kldsi idblyegekbl jittert szmolunk. A negatv sorszm (FIN) datagramokra a jelentssel vlaszolunk.
+ */
+static void prvIperfUDPServer(void)
+{
+	Socket_t xSocket;
+	struct freertos_sockaddr xAddress;
+	struct freertos_mmsg xMessages[iperfUDP_BATCH];
+	IperfUDPPeer_t xPeer;
+	TickType_t xTimeout = pdMS_TO_TICKS(iperfPOLL_MS);
+	int32_t lCount;
+	int32_t x;
+	uint64_t ullNowUs;
+
+	xSocket = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP);
+	if(xSocket == FREERTOS_INVALID_SOCKET)
+	{
+		return;
+	}
+	FreeRTOS_setsockopt(xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof(xTimeout));
+	FreeRTOS_setsockopt(xSocket, 0, FREERTOS_SO_SNDTIMEO, &xTimeout, sizeof(xTimeout));
+
+	memset(&xAddress, 0, sizeof(xAddress));
+	xAddress.sin_port = FreeRTOS_htons(ipconfigIPERF_PORT);
+	if(FreeRTOS_bind(xSocket, &xAddress, sizeof(xAddress)) != 0)
+	{
+		FreeRTOS_closesocket(xSocket);
+		return;
+	}
+
+	memset(&xPeer, 0, sizeof(xPeer));
+	xPeer.xFinished = pdTRUE;
+
+	while(xIperfStopRequested == pdFALSE)
+	{
+		lCount = FreeRTOS_recvmulti(xSocket, xMessages, iperfUDP_BATCH, 0);
+		ullNowUs = xGetHighResolutionTime();
+		for(x = 0; x < lCount; x++)
+		{
+			prvIperfUDPReceived(xSocket, &xPeer, &xMessages[x], ullNowUs);
+			FreeRTOS_ReleaseUDPPayloadBuffer(xMessages[x].pvPayload);
+		}
+
+		if(xPeer.xFinished == pdFALSE)
+		{
+			if((ullNowUs - xPeer.ullLastUs) > iperfUDP_IDLE_US)
+			{
+				/* A FIN elveszett vagy a kliens lellt */
+				xPeer.xFinished = pdTRUE;
+				prvIperfEnd(xPeer.ullLastUs, NULL);
+			}
+			else
+			{
+				prvIperfPublish(ullNowUs, pdFALSE);
+			}
+		}
+	}
+
+	if(xPeer.xFinished == pdFALSE)
+	{
+		prvIperfEnd(xPeer.ullLastUs, NULL);
+	}
+	FreeRTOS_closesocket(xSocket);
+}
+
+static void prvIperfUDPReceived(Socket_t xSocket, IperfUDPPeer_t *pxPeer, const struct freertos_mmsg *pxMessage, uint64_t ullNowUs)
+{
+	const uint8_t *pucData = (const uint8_t *) pxMessage->pvPayload;
+	BaseType_t xSamePeer;
+	int32_t lID;
+	int64_t llTransit;
+	int64_t llDelta;
+
+	if(pxMessage->xLength < iperfUDP_HEADER_LENGTH)
+	{
+		return;
+	}
+
+	lID = (int32_t) prvIperfRead32(pucData);
+	xSamePeer = ((pxPeer->ulIP == pxMessage->xAddress.sin_addr) && (pxPeer->usPort == pxMessage->xAddress.sin_port)) ? pdTRUE : pdFALSE;
+
+	if(lID < 0)
+	{
+		/* FIN: a mrs vge, a kliens a jelentsnkre vr (tbbszr is krheti) */
+		if(xSamePeer != pdFALSE)
+		{
+			if(pxPeer->xFinished == pdFALSE)
+			{
+				pxPeer->xFinished = pdTRUE;
+				prvIperfEnd(pxPeer->ullLastUs, NULL);
+			}
+			prvIperfUDPReport(xSocket, pxPeer, pucData);
+		}
+		return;
+	}
+
+	if((xSamePeer == pdFALSE) || (pxPeer->xFinished != pdFALSE))
+	{
+		/* j mrs. Egyszerre egy klienst mrnk, a tbbiek datagramjait eldobjuk. */
+		if(pxPeer->xFinished == pdFALSE)
+		{
+			return;
+		}
+		memset(pxPeer, 0, sizeof(*pxPeer));
+		pxPeer->ulIP = pxMessage->xAddress.sin_addr;
+		pxPeer->usPort = pxMessage->xAddress.sin_port;
+		pxPeer->lLastID = lID - 1;
+		pxPeer->ullFirstUs = ullNowUs;
+		prvIperfBegin(pxPeer->ulIP, ullNowUs);
+	}
+
+	xIperfSession.ullBytes += pxMessage->xLength;
+	xIperfSession.ulDatagrams++;
+	pxPeer->ullLastUs = ullNowUs;
+
+	/* Vesztesg s sorrendcsere az iperf2 szerver szerint */
+	if(lID > (pxPeer->lLastID + 1))
+	{
+		xIperfSession.ulLost += (uint32_t) (lID - pxPeer->lLastID - 1);
+		pxPeer->lLastID = lID;
+	}
+	else if(lID < (pxPeer->lLastID + 1))
+	{
+		xIperfSession.ulOutOfOrder++;
+		if(xIperfSession.ulLost > 0U)
+		{
+			xIperfSession.ulLost--;
+		}
+	}
+	else
+	{
+		pxPeer->lLastID = lID;
+	}
+
+	/* Jitter (RFC 1889): J += (|D| - J) / 16, a kt ra eltolsa kiesik */
+	llTransit = (int64_t) ullNowUs - (((int64_t) prvIperfRead32(&pucData[4]) * 1000000LL) + (int64_t) prvIperfRead32(&pucData[8]));
+	if(xIperfSession.ulDatagrams > 1U)
+	{
+		llDelta = llTransit - pxPeer->llLastTransit;
+		if(llDelta < 0)
+		{
+			llDelta = -llDelta;
+		}
+		pxPeer->llJitter16 += llDelta - (pxPeer->llJitter16 / 16);
+		xIperfSession.ulJitterUs = (uint32_t) (pxPeer->llJitter16 / 16);
+	}
+	pxPeer->llLastTransit = llTransit;
+}
+
+static void prvIperfUDPReport(Socket_t xSocket, const IperfUDPPeer_t *pxPeer, const uint8_t *pucHeader)
+{
+	struct freertos_sockaddr xAddress;
+	uint8_t *pucReport;
+	uint64_t ullDurationUs = pxPeer->ullLastUs - pxPeer->ullFirstUs;
+
+	pucReport = (uint8_t *) FreeRTOS_GetUDPPayloadBuffer(iperfUDP_REPORT_LENGTH, 0);
+	if(pucReport == NULL)
+	{
+		/* A kliens jra kri */
+		return;
+	}
+
+	/* UDP_datagram visszakldve, utna a server_hdr */
+	memcpy(pucReport, pucHeader, iperfUDP_HEADER_LENGTH);
+	prvIperfWrite32(&pucReport[12], iperfHEADER_VERSION1);
+	prvIperfWrite32(&pucReport[16], (uint32_t) (xIperfSession.ullBytes >> 32));
+	prvIperfWrite32(&pucReport[20], (uint32_t) xIperfSession.ullBytes);
+	prvIperfWrite32(&pucReport[24], (uint32_t) (ullDurationUs / 1000000U));
+	prvIperfWrite32(&pucReport[28], (uint32_t) (ullDurationUs % 1000000U));
+	prvIperfWrite32(&pucReport[32], xIperfSession.ulLost);
+	prvIperfWrite32(&pucReport[36], xIperfSession.ulOutOfOrder);
+	prvIperfWrite32(&pucReport[40], xIperfSession.ulDatagrams + xIperfSession.ulLost);
+	prvIperfWrite32(&pucReport[44], xIperfSession.ulJitterUs / 1000000U);
+	prvIperfWrite32(&pucReport[48], xIperfSession.ulJitterUs % 1000000U);
+
+	xAddress.sin_addr = pxPeer->ulIP;
+	xAddress.sin_port = pxPeer->usPort;
+	if(FreeRTOS_sendto(xSocket, pucReport, iperfUDP_REPORT_LENGTH, FREERTOS_ZERO_COPY, &xAddress, sizeof(xAddress)) == 0)
+	{
+		FreeRTOS_ReleaseUDPPayloadBuffer(pucReport);
+	}
+}
+
+/*
+ * UDP kliens: a datagramokat a hlzati pufferekben lltjuk ssze, s csomagban adjuk t az IP taszknak. A sebessget
+ * az eltelt idhz igaztjuk, tickenknt legfeljebb iperfUDP_BATCH datagramot kldnk egy hvssal.
+ */
+static void prvIperfUDPClient(void)
+{
+	Socket_t xSocket;
+	struct freertos_sockaddr xAddress;
+	struct freertos_sockaddr xFrom;
+	socklen_t xFromSize = sizeof(xFrom);
+	struct freertos_mmsg xMessages[iperfUDP_BATCH];
+	TickType_t xTimeout = pdMS_TO_TICKS(iperfPOLL_MS);
+	uint8_t *pucPayload;
+	uint64_t ullNowUs;
+	uint64_t ullEndUs;
+	uint64_t ullDue;
+	uint64_t ullTimeNs;
+	int32_t lID = 0;
+	int32_t lSent;
+	int32_t lBytes;
+	size_t uxCount;
+	size_t x;
+	BaseType_t xTries;
+
+	xSocket = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP);
+	if(xSocket == FREERTOS_INVALID_SOCKET)
+	{
+		return;
+	}
+	FreeRTOS_setsockopt(xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof(xTimeout));
+	FreeRTOS_setsockopt(xSocket, 0, FREERTOS_SO_SNDTIMEO, &xTimeout, sizeof(xTimeout));
+
+	memset(&xAddress, 0, sizeof(xAddress));
+	xAddress.sin_addr = ulIperfIP;
+	xAddress.sin_port = FreeRTOS_htons(ipconfigIPERF_PORT);
+
+	ullNowUs = xGetHighResolutionTime();
+	ullEndUs = ullNowUs + ((uint64_t) ulIperfSeconds * 1000000ULL);
+	prvIperfBegin(ulIperfIP, ullNowUs);
+
+	while((xIperfStopRequested == pdFALSE) && (ullNowUs < ullEndUs))
+	{
+		/* Az eddig esedkes datagramok szma */
+		ullDue = (((ullNowUs - ullIperfStartUs) * ulIperfBandwidth) / (8ULL * ulIperfLength * 1000000ULL)) + 1U;
+		if(ullDue <= (uint64_t) lID)
+		{
+			vTaskDelay(1);
+			ullNowUs = xGetHighResolutionTime();
+			continue;
+		}
+		uxCount = (size_t) (ullDue - (uint64_t) lID);
+		if(uxCount > iperfUDP_BATCH)
+		{
+			uxCount = iperfUDP_BATCH;
+		}
+
+		ullTimeNs = xGetSysTimeNs(NULL);
+		for(x = 0; x < uxCount; x++)
+		{
+			pucPayload = (uint8_t *) FreeRTOS_GetUDPPayloadBuffer(ulIperfLength, pdMS_TO_TICKS(iperfPOLL_MS));
+			if(pucPayload == NULL)
+			{
+				break;
+			}
+			/* Nullk: a datagram utni client_hdr se krjen ktirny mrst */
+			memset(pucPayload, 0, ulIperfLength);
+			prvIperfWrite32(&pucPayload[0], (uint32_t) (lID + (int32_t) x));
+			prvIperfWrite32(&pucPayload[4], (uint32_t) (ullTimeNs / 1000000000ULL));
+			prvIperfWrite32(&pucPayload[8], (uint32_t) ((ullTimeNs % 1000000000ULL) / 1000U));
+			xMessages[x].pvPayload = pucPayload;
+			xMessages[x].xLength = ulIperfLength;
+			xMessages[x].xAddress = xAddress;
+		}
+		uxCount = x;
+
+		lSent = FreeRTOS_sendmulti(xSocket, xMessages, uxCount, 0);
+		if(lSent < 0)
+		{
+			lSent = 0;
+		}
+		/* A el nem kldtt pufferek a mieink maradtak, a sorszmukat jra kiosztjuk */
+		for(x = (size_t) lSent; x < uxCount; x++)
+		{
+			FreeRTOS_ReleaseUDPPayloadBuffer(xMessages[x].pvPayload);
+		}
+		lID += lSent;
+		xIperfSession.ulDatagrams += (uint32_t) lSent;
+		xIperfSession.ullBytes += (uint64_t) lSent * ulIperfLength;
+
+		ullNowUs = xGetHighResolutionTime();
+		prvIperfPublish(ullNowUs, pdFALSE);
+	}
+	ullEndUs = ullNowUs;
+
+	/* FIN: negatv sorszm, amg a szerver jelentse meg nem rkezik */
+	for(xTries = 0; (xTries < iperfFIN_RETRIES) && (lID > 0) && (xIperfStopRequested == pdFALSE); xTries++)
+	{
+		pucPayload = (uint8_t *) FreeRTOS_GetUDPPayloadBuffer(ulIperfLength, pdMS_TO_TICKS(iperfPOLL_MS));
+		if(pucPayload != NULL)
+		{
+			ullTimeNs = xGetSysTimeNs(NULL);
+			memset(pucPayload, 0, ulIperfLength);
+			prvIperfWrite32(&pucPayload[0], (uint32_t) -lID);
+			prvIperfWrite32(&pucPayload[4], (uint32_t) (ullTimeNs / 1000000000ULL));
+			prvIperfWrite32(&pucPayload[8], (uint32_t) ((ullTimeNs % 1000000000ULL) / 1000U));
+			if(FreeRTOS_sendto(xSocket, pucPayload, ulIperfLength, FREERTOS_ZERO_COPY, &xAddress, sizeof(xAddress)) == 0)
+			{
+				FreeRTOS_ReleaseUDPPayloadBuffer(pucPayload);
+			}
+		}
+
+		lBytes = FreeRTOS_recvfrom(xSocket, (void *) &pucPayload, 0, FREERTOS_ZERO_COPY, &xFrom, &xFromSize);
+		if(lBytes > 0)
+		{
+			if(lBytes >= (int32_t) iperfUDP_REPORT_LENGTH)
+			{
+				/* A szerver oldali vesztesg s jitter kerl a jelentsbe */
+				xIperfSession.ulLost = prvIperfRead32(&pucPayload[32]);
+				xIperfSession.ulOutOfOrder = prvIperfRead32(&pucPayload[36]);
+				xIperfSession.ulJitterUs = (prvIperfRead32(&pucPayload[44]) * 1000000U) + prvIperfRead32(&pucPayload[48]);
+				xTries = iperfFIN_RETRIES;
+			}
+			FreeRTOS_ReleaseUDPPayloadBuffer(pucPayload);
+		}
+	}
+
+	prvIperfEnd(ullEndUs, NULL);
+	FreeRTOS_closesocket(xSocket);
+}
+
+static uint32_t prvIperfRead32(const uint8_t *pucData)
+{
+	return ((uint32_t)pucData[0] << 24) | ((uint32_t)pucData[1] << 16) | ((uint32_t)pucData[2] << 8) | (uint32_t)pucData[3];
+}
+
+static void prvIperfWrite32(uint8_t *pucData, uint32_t ulValue)
+{
+	pucData[0] = (uint8_t)(ulValue >> 24);
+	pucData[1] = (uint8_t)(ulValue >> 16);
+	pucData[2] = (uint8_t)(ulValue >> 8);
+	pucData[3] = (uint8_t)ulValue;
+}
+
+static void prvIperfTask(void *pvParameters)
+{
+	(void) pvParameters;
+
+	for(;;)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		if(ucIperfMode == iperfMODE_SERVER)
+		{
+			if(xIperfUDP == pdFALSE)
+			{
+				prvIperfTCPServer();
+			}
+			else
+			{
+				prvIperfUDPServer();
+			}
+		}
+		else if(ucIperfMode == iperfMODE_CLIENT)
+		{
+			if(xIperfUDP == pdFALSE)
+			{
+				prvIperfTCPClient();
+			}
+			else
+			{
+				prvIperfUDPClient();
+			}
+		}
+
+		taskENTER_CRITICAL();
+		{
+			xIperfReport.xActive = pdFALSE;
+			xIperfReport.xRunning = pdFALSE;
+			ucIperfMode = iperfMODE_IDLE;
+		}
+		taskEXIT_CRITICAL();
+	}
+}
@@ -37,6 +37,12 @@
 
 /* Time related functions */
 #include "rti_runtimestats.h"
+#include "rti_timetrigger.h"
+#include "FreeRTOSTIMEConfig.h"
+#include "pps_discipline.h"
+#include "clock_output.h"
+#include "ptp_crosstimestamp.h"
+#include "ptp_clock.h"
 
 /* CLI related headers */
 #include "FreeRTOS_CLI.h"
@@ -50,6 +56,10 @@
 #include "FreeRTOS_IP_Private.h"
 #include "NetworkBufferManagement.h"
 #include "FreeRTOS_TCP_server.h"
+#include "FreeRTOS_gzip.h"
+#include "pcap_capture.h"
+#include "iperf.h"
+#include "emac_stats.h"
 
 /* FreeRTOS+FAT includes. */
 #include "ff_headers.h"
@@ -90,13 +100,22 @@ float xConvertAdcValueToNtcTemperature(uint16_t xAdcValue, uint16_t xAdcMaxValue
 /* Hook functions */
 BaseType_t xApplicationDNSQueryHook( const char *pcName );
 const char *pcApplicationHostnameHook( void );
+#if( ipconfigFTP_HAS_RECEIVED_HOOK != 0 )
+void vApplicationFTPReceivedHook( const char *pcFileName, uint32_t ulSize, struct xFTP_CLIENT *pxFTPClient );
+#endif
 void vApplicationTickHook(void);
 void vApplicationIdleHook(void);
 void vApplicationStackOverflowHook(TaskHandle_t xTask, signed char *pcTaskName);
 
-/* FTP and HTTP servers execute in the TCP server work task. */
+/* FTP and HTTP servers accept clients in the TCP server work task, worker tasks
+serve them.  The HTTP workers run above the FTP worker, so the web pages stay
+responsive while a file is being transferred. */
 #define mainTCP_SERVER_TASK_PRIORITY	( tskIDLE_PRIORITY + 2 )
 #define	mainTCP_SERVER_STACK_SIZE		( configMINIMAL_STACK_SIZE * 12 )
+#define mainHTTP_WORKERS				2
+#define mainHTTP_WORKER_PRIORITY		( ( tskIDLE_PRIORITY + 3 ) | portPRIVILEGE_BIT )
+#define mainFTP_WORKERS					1
+#define mainFTP_WORKER_PRIORITY			( ( tskIDLE_PRIORITY + 2 ) | portPRIVILEGE_BIT )
 
 /* RAM disk parameters */
 #define mainRAM_DISK_SECTOR_SIZE	512UL
@@ -133,6 +152,12 @@ void main(void)
 	FreeRTOS_CLIRegisterCommand( &xPing );
 	FreeRTOS_CLIRegisterCommand( &xNetStat );
 	FreeRTOS_CLIRegisterCommand( &xReset );
+	FreeRTOS_CLIRegisterCommand( &xPPS );
+	FreeRTOS_CLIRegisterCommand( &xClkOut );
+	FreeRTOS_CLIRegisterCommand( &xXTS );
+	FreeRTOS_CLIRegisterCommand( &xCksum );
+	FreeRTOS_CLIRegisterCommand( &xPCAP );
+	FreeRTOS_CLIRegisterCommand( &xIperf );
 
 	/* Register some more filesystem related commands, like dir, cd, pwd ... */
 	vRegisterFileSystemCLICommands();
@@ -142,6 +167,10 @@ void main(void)
 	val=val|(1<<13);
 	MDIOPhyRegWrite(EMAC_0_BASE, 1U, 28, val);*/
 
+	/* Az MDIO zr a hlzati meghajt indulsa eltt kell. */
+	/* The MDIO lock is taken by the network driver, create it before the IP task starts. */
+	vPTPClockInit();
+
 	xTaskCreate(vTask1, "HeartBeat", configMINIMAL_STACK_SIZE * 10, NULL, tskIDLE_PRIORITY + 3  | portPRIVILEGE_BIT, &xTask1Handle);
 	FreeRTOS_IPInit(ucIPAddress, ucNetMask, ucGatewayAddress, ucDNSServerAddress, emacAddress);
 	xTaskCreate(vUDPSendUsingStandardInterface, "UDPsend", configMINIMAL_STACK_SIZE * 20, NULL, tskIDLE_PRIORITY + 3  | portPRIVILEGE_BIT, &xTask1Handle);
@@ -616,12 +645,15 @@ static void vServerWorkTask(void *pvParameters)
 {
 TCPServer_t *pxTCPServer = NULL;
 const TickType_t xInitialBlockTime = pdMS_TO_TICKS(200UL);
+#if( configCLKOUT_ENABLE == 1 )
+BaseType_t xResult;
+#endif
 
 static const struct xSERVER_CONFIG xServerConfiguration[] =
 	{
-	/* Server type,		port number,	backlog, 	root dir. */
-	{ eSERVER_HTTP, 	80, 			10, 		"/ram/web" },
-	{ eSERVER_FTP,  	21, 			10, 		 "" }
+	/* Server type,		port number,	backlog, 	root dir,	workers,			worker priority. */
+	{ eSERVER_HTTP, 	80, 			10, 		"/ram/web",	mainHTTP_WORKERS,	mainHTTP_WORKER_PRIORITY },
+	{ eSERVER_FTP,  	21, 			10, 		 "",		mainFTP_WORKERS,	mainFTP_WORKER_PRIORITY }
 	};
 
 	/* Remove compiler warning about unused parameter. */
@@ -629,7 +661,36 @@ static const struct xSERVER_CONFIG xServerConfiguration[] =
 
 	/* Configuring RTI timer for serving system time. */
 	vConfigureTimerForSysTime();
+	vConfigureTimerForTimeTrigger();
 	vStartNTPTask(configMINIMAL_STACK_SIZE * 2, 4);
+#if( configPPS_ENABLE == 1 )
+	/* GNSS 1PPS discipline of the PHY clock. */
+	vStartPPSDisciplineTask(configMINIMAL_STACK_SIZE * 4, tskIDLE_PRIORITY + 4);
+#endif
+#if( configCLKOUT_ENABLE == 1 )
+	/* PPS and frequency outputs phase-locked to the PHY clock. */
+	xResult = xClockOutputAdd(configCLKOUT_PPS_ETPWM, 1000000000UL);
+	configASSERT( xResult == pdPASS );
+	xResult = xClockOutputAdd(configCLKOUT_FREQ_ETPWM, 1000000000UL / configCLKOUT_FREQ_HZ);
+	configASSERT( xResult == pdPASS );
+	vStartClockOutputTask(configMINIMAL_STACK_SIZE * 4, tskIDLE_PRIORITY + 5);
+#endif
+#if( configXTS_ENABLE == 1 )
+	/* PHY clock to RTIFRC0 mapping for timestamping in interrupt handlers. */
+	vStartPTPCrossTimestampTask(configMINIMAL_STACK_SIZE * 2, tskIDLE_PRIORITY + 4);
+#endif
+#if( ipconfigUSE_PCAP != 0 )
+	/* Packet capture to the RAM disk, started with the "pcap" command. */
+	vStartPCAPCaptureTask(configMINIMAL_STACK_SIZE * 4, tskIDLE_PRIORITY + 1 | portPRIVILEGE_BIT);
+#endif
+#if( ipconfigUSE_IPERF != 0 )
+	/* Throughput test, started with the "iperf" command. */
+	vStartIperfTask(configMINIMAL_STACK_SIZE * 8, tskIDLE_PRIORITY + 2 | portPRIVILEGE_BIT);
+#endif
+#if( ipconfigUSE_EMAC_STATS != 0 )
+	/* EMAC counter totals and per second rates for the "emacstat" command. */
+	vStartEMACStatsTask(configMINIMAL_STACK_SIZE * 2, tskIDLE_PRIORITY + 2 | portPRIVILEGE_BIT);
+#endif
 
 	/* Create the servers defined by the xServerConfiguration array above. */
 	pxTCPServer = FreeRTOS_CreateTCPServer( xServerConfiguration, sizeof( xServerConfiguration ) / sizeof( xServerConfiguration[ 0 ] ) );
@@ -741,6 +802,25 @@ const char *pcApplicationHostnameHook(void)
 	return mainDEVICE_NICK_NAME;
 }
 
+#if( ipconfigFTP_HAS_RECEIVED_HOOK != 0 )
+/** ***************************************************************************************************
+ * @fn		void vApplicationFTPReceivedHook(const char *pcFileName, uint32_t ulSize, struct xFTP_CLIENT *pxFTPClient)
+ * @brief	FTP upload hook function.
+ * @details
+ * Text files uploaded below configHTTP_ROOT get a compressed ".gz" sibling, the HTTP server sends it to browsers accepting gzip.
+ */
+void vApplicationFTPReceivedHook(const char *pcFileName, uint32_t ulSize, struct xFTP_CLIENT *pxFTPClient)
+{
+	(void)ulSize;
+	(void)pxFTPClient;
+
+	if((strncmp(pcFileName, configHTTP_ROOT "/", sizeof(configHTTP_ROOT)) == 0) && (FreeRTOS_gzip_wanted(pcFileName) != pdFALSE))
+	{
+		FreeRTOS_gzip_sibling(pcFileName);
+	}
+}
+#endif
+
 /** ***************************************************************************************************
  * @fn		void vApplicationTickHook(void)
  * @brief	TICK hook function.
@@ -265,6 +265,19 @@ UBaseType_t MPU_uxTaskGetNumberOfTasks( void )
 
 /*----------------------------------------------------------------------------*/
 
+#if ( configUSE_TRACE_FACILITY == 1 )
+	UBaseType_t MPU_uxTaskGetSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalRunTime )
+	{
+		UBaseType_t uxReturn;
+		BaseType_t xRunningPrivileged = prvRaisePrivilege();
+		uxReturn = uxTaskGetSystemState( pxTaskStatusArray, uxArraySize, pulTotalRunTime );
+		portRESET_PRIVILEGE( xRunningPrivileged );
+		return uxReturn;
+	}
+#endif
+
+/*----------------------------------------------------------------------------*/
+
 #if ( configUSE_APPLICATION_TASK_TAG == 1 )
 	void MPU_vTaskSetApplicationTaskTag( TaskHandle_t xTask, TaskHookFunction_t pxTagValue )
 	{
@@ -0,0 +1,799 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "os_task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "ff_stdio.h"
+#include "rti_runtimestats.h"
+#include "ptp_crosstimestamp.h"
+#include "pcap_capture.h"
+
+#define pcapALIGN4(x)				(((x) + 3U) & ~3U)
+#define pcapFILE_NAME_FORMAT		"/ram/cap%u.pcapng"
+
+/* A gyr rekordjainak llapota */
+#define pcapRECORD_BUSY				( 1U )			/* Lefoglalva, a msols folyik */
+#define pcapRECORD_READY			( 2U )			/* Kirhat */
+#define pcapRECORD_PAD				( 3U )			/* A gyr vgnek kitltse, tugorjuk */
+
+/* pcapng blokkok */
+#define pcapngSECTION_HEADER		( 0x0A0D0D0AUL )
+#define pcapngBYTE_ORDER_MAGIC		( 0x1A2B3C4DUL )
+#define pcapngINTERFACE_DESCRIPTION	( 0x00000001UL )
+#define pcapngENHANCED_PACKET		( 0x00000006UL )
+#define pcapngLINKTYPE_ETHERNET		( 1U )
+#define pcapngOPTION_TSRESOL		( 9U )
+#define pcapngOPTION_EPB_FLAGS		( 2U )
+#define pcapngTSRESOL_NS			( 9U )			/* 10^-9 sec felbonts */
+#define pcapngEPB_OVERHEAD			( 44U )			/* Fejlc, epb_flags, opt_endofopt s zr hossz */
+
+/* A szr elemei */
+#define pcapMATCH_DIRECTION			( 0x01U )
+#define pcapMATCH_ETHERTYPE			( 0x02U )
+#define pcapMATCH_PROTOCOL			( 0x04U )
+#define pcapMATCH_PTP				( 0x08U )
+#define pcapMATCH_HOST				( 0x10U )
+#define pcapMATCH_PORT				( 0x20U )
+
+#define pcapETHERTYPE_IPv4			( 0x0800U )
+#define pcapETHERTYPE_ARP			( 0x0806U )
+#define pcapETHERTYPE_VLAN			( 0x8100U )
+#define pcapETHERTYPE_PTP			( 0x88F7U )
+#define pcapPTP_EVENT_PORT			( 319U )
+#define pcapPTP_GENERAL_PORT		( 320U )
+#define pcapFILTER_TEXT_LENGTH		( 64U )
+
+/* Az rsi pufferbe egy teljes csomag blokkja is belefr */
+#define pcapWRITE_BUFFER_SIZE		( pcapngEPB_OVERHEAD + pcapALIGN4(ipTOTAL_ETHERNET_FRAME_SIZE) )
+
+/* A gyr egy rekordjnak fejlce, utna a csomag els usCaptureLength byte-ja kvetkezik */
+typedef struct xPCAP_RECORD
+{
+	uint16_t usRecordLength;		/* A teljes rekord hossza (4 tbbszrse) */
+	volatile uint8_t ucState;
+	uint8_t ucDirection;
+	uint32_t ulFRC0;				/* RTIFRC0 a rgzts pillanatban */
+	uint16_t usFrameLength;
+	uint16_t usCaptureLength;
+} PCAPRecord_t;
+
+typedef struct xPCAP_FILTER
+{
+	uint32_t ulMatch;				/* pcapMATCH_* bitek */
+	BaseType_t xNegate;
+	uint8_t ucDirection;
+	uint8_t ucProtocol;
+	uint16_t usEtherType;
+	uint16_t usPort;
+	uint32_t ulHost;				/* Host byte sorrendben */
+	char cText[pcapFILTER_TEXT_LENGTH];
+} PCAPFilter_t;
+
+static uint32_t ulPCAPRing[ipconfigPCAP_RING_SIZE / sizeof(uint32_t)];
+static uint32_t ulPCAPWrite = 0U;					/* A kvetkez rekord helye */
+static uint32_t ulPCAPRead = 0U;					/* A legrgebbi rekord helye */
+static uint32_t ulPCAPUsed = 0U;					/* Lefoglalt byte-ok (kitltssel egytt) */
+
+/*
+ * Kt szr pldny: a CLI mindig az inaktvat rja s utna vlt, a rgzt soha nem lt flksz szrt.
+ * A vlts eltt az aktvat tvett rgztk (RX csatornk, IP taszk) mg a rgit olvashatjk, ezrt az olvask
+ * szmt nyilvntartjuk, s az inaktv pldnyt csak akkor rjuk fell, ha mr senki nem hasznlja.
+ */
+static PCAPFilter_t xPCAPFilters[2];
+static volatile uint32_t ulPCAPActiveFilter = 0U;
+static volatile UBaseType_t uxPCAPFilterReaders[2] = { 0U, 0U };
+static BaseType_t xPCAPFilterUpdating = pdFALSE;		/* Egyszerre csak egy bellts fut */
+
+static volatile BaseType_t xPCAPActive = pdFALSE;
+static volatile BaseType_t xPCAPRestart = pdFALSE;	/* Az rt taszk az els fjllal kezdjen */
+static volatile BaseType_t xPCAPStartRequested = pdFALSE;	/* Az indtst az rt taszk vgzi el */
+static volatile BaseType_t xPCAPFlushRequested = pdFALSE;
+static uint32_t ulPCAPSnapLength = ipconfigPCAP_SNAPLEN;
+static uint32_t ulPCAPStartSnapLength = ipconfigPCAP_SNAPLEN;
+static PCAPStatus_t xPCAPStatus;
+static TaskHandle_t xPCAPTaskHandle = NULL;
+
+/* Az rt taszk rsi puffere, egyszerre tbb blokkot runk ki */
+static uint8_t ucPCAPWriteBuffer[pcapWRITE_BUFFER_SIZE];
+static size_t uxPCAPWriteLength = 0U;
+
+static BaseType_t prvPCAPMatch(const PCAPFilter_t *pxFilter, const uint8_t *pucFrame, size_t uxLength, uint8_t ucDirection);
+static uint32_t prvPCAPFilterTake(void);
+static void prvPCAPFilterGive(uint32_t ulFilter);
+static BaseType_t prvPCAPParseFilter(PCAPFilter_t *pxFilter, const char *pcExpression);
+static uint16_t prvPCAPRead16(const uint8_t *pucData);
+static uint32_t prvPCAPRead32(const uint8_t *pucData);
+static void prvPCAPPut32(uint32_t ulValue);
+static void prvPCAPPut16(uint16_t usValue);
+static void prvPCAPPutBytes(const void *pvData, size_t uxLength);
+static BaseType_t prvPCAPWriteOut(FF_FILE *pxFile);
+static FF_FILE *prvPCAPOpenFile(uint32_t ulBlockLength);
+static void prvPCAPFlush(void);
+static void prvPCAPRestart(void);
+static void prvPCAPTask(void *pvParameters);
+
+void vStartPCAPCaptureTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority)
+{
+	xTaskCreate(prvPCAPTask, "PCAP", usTaskStackSize, NULL, uxTaskPriority, &xPCAPTaskHandle);
+}
+
+BaseType_t xPCAPStart(uint32_t ulSnapLength)
+{
+	if(ulSnapLength == 0U)
+	{
+		ulSnapLength = ipconfigPCAP_SNAPLEN;
+	}
+	if((xPCAPTaskHandle == NULL) || (ulSnapLength < 14U) || (ulSnapLength > ipTOTAL_ETHERNET_FRAME_SIZE))
+	{
+		return pdFAIL;
+	}
+
+	/* A gyrt s a statisztikt az rt taszk trli, gy nem tkzik egy folyamatban lev kirssal */
+	taskENTER_CRITICAL();
+	{
+		ulPCAPStartSnapLength = ulSnapLength;
+		xPCAPStartRequested = pdTRUE;
+	}
+	taskEXIT_CRITICAL();
+	xTaskNotifyGive(xPCAPTaskHandle);
+
+	return pdPASS;
+}
+
+void vPCAPStop(void)
+{
+	/* A mg el nem vgzett indtst is visszavonjuk */
+	xPCAPStartRequested = pdFALSE;
+	xPCAPActive = pdFALSE;
+	if(xPCAPTaskHandle != NULL)
+	{
+		/* A gyr maradkt az rt taszk kirja */
+		xTaskNotifyGive(xPCAPTaskHandle);
+	}
+}
+
+void vPCAPGetStatus(PCAPStatus_t *pxStatus)
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStatus = xPCAPStatus;
+		pxStatus->xActive = xPCAPActive;
+		pxStatus->ulSnapLength = ulPCAPSnapLength;
+	}
+	taskEXIT_CRITICAL();
+}
+
+void vPCAPGetFilter(char *pcBuffer, size_t uxLength)
+{
+	uint32_t ulFilter = prvPCAPFilterTake();
+	const PCAPFilter_t *pxFilter = &xPCAPFilters[ulFilter];
+
+	snprintf(pcBuffer, uxLength, "%s", (pxFilter->cText[0] != '\0') ? pxFilter->cText : "(all)");
+	prvPCAPFilterGive(ulFilter);
+}
+
+/*
+ * Az aktv szr tvtele s elengedse, rvid kritikus szakaszok.
+ */
+static uint32_t prvPCAPFilterTake(void)
+{
+	uint32_t ulFilter;
+
+	taskENTER_CRITICAL();
+	{
+		ulFilter = ulPCAPActiveFilter;
+		uxPCAPFilterReaders[ulFilter]++;
+	}
+	taskEXIT_CRITICAL();
+	return ulFilter;
+}
+
+static void prvPCAPFilterGive(uint32_t ulFilter)
+{
+	taskENTER_CRITICAL();
+	{
+		uxPCAPFilterReaders[ulFilter]--;
+	}
+	taskEXIT_CRITICAL();
+}
+
+BaseType_t xPCAPSetFilter(const char *pcExpression)
+{
+	uint32_t ulInactive;
+	BaseType_t xResult;
+
+	taskENTER_CRITICAL();
+	{
+		xResult = (xPCAPFilterUpdating == pdFALSE) ? pdPASS : pdFAIL;
+		xPCAPFilterUpdating = pdTRUE;
+	}
+	taskEXIT_CRITICAL();
+	if(xResult == pdFAIL)
+	{
+		/* Egy msik konzol ppen belltja */
+		return pdFAIL;
+	}
+
+	/* Csak a bellts vlt, az aktv pldny itt nem vltozhat. A vlts eltti olvask kifutst megvrjuk. */
+	ulInactive = ulPCAPActiveFilter ^ 1U;
+	while(uxPCAPFilterReaders[ulInactive] != 0U)
+	{
+		vTaskDelay(1);
+	}
+
+	xResult = prvPCAPParseFilter(&xPCAPFilters[ulInactive], pcExpression);
+	if(xResult != pdFAIL)
+	{
+		ulPCAPActiveFilter = ulInactive;
+	}
+	xPCAPFilterUpdating = pdFALSE;
+
+	return xResult;
+}
+
+/*
+ * A kifejezs feldolgozsa az inaktv szr pldnyba.
+ */
+static BaseType_t prvPCAPParseFilter(PCAPFilter_t *pxFilter, const char *pcExpression)
+{
+	const char *pcToken = pcExpression;
+	char cWord[16];
+	size_t uxLength;
+	BaseType_t xExpectValue = 0;		/* 1: ether, 2: host, 3: port paramtere kvetkezik */
+	BaseType_t xFirst = pdTRUE;
+	uint32_t ulValue;
+	char *pcEnd;
+
+	memset(pxFilter, 0, sizeof(*pxFilter));
+
+	for(;;)
+	{
+		while(*pcToken == ' ')
+		{
+			pcToken++;
+		}
+		if(*pcToken == '\0')
+		{
+			break;
+		}
+		for(uxLength = 0U; (pcToken[uxLength] != ' ') && (pcToken[uxLength] != '\0'); uxLength++)
+		{
+		}
+		if(uxLength >= sizeof(cWord))
+		{
+			return pdFAIL;
+		}
+		memcpy(cWord, pcToken, uxLength);
+		cWord[uxLength] = '\0';
+		pcToken += uxLength;
+
+		if(xExpectValue == 1)
+		{
+			ulValue = strtoul(cWord, &pcEnd, 16);
+			if((*pcEnd != '\0') || (ulValue > 0xFFFFUL))
+			{
+				return pdFAIL;
+			}
+			pxFilter->usEtherType = (uint16_t)ulValue;
+			pxFilter->ulMatch |= pcapMATCH_ETHERTYPE;
+			xExpectValue = 0;
+		}
+		else if(xExpectValue == 2)
+		{
+			ulValue = FreeRTOS_inet_addr(cWord);
+			if(ulValue == 0UL)
+			{
+				return pdFAIL;
+			}
+			pxFilter->ulHost = FreeRTOS_ntohl(ulValue);
+			pxFilter->ulMatch |= pcapMATCH_HOST;
+			xExpectValue = 0;
+		}
+		else if(xExpectValue == 3)
+		{
+			ulValue = strtoul(cWord, &pcEnd, 10);
+			if((*pcEnd != '\0') || (ulValue == 0UL) || (ulValue > 0xFFFFUL))
+			{
+				return pdFAIL;
+			}
+			pxFilter->usPort = (uint16_t)ulValue;
+			pxFilter->ulMatch |= pcapMATCH_PORT;
+			xExpectValue = 0;
+		}
+		else if((xFirst != pdFALSE) && (strcmp(cWord, "not") == 0))
+		{
+			pxFilter->xNegate = pdTRUE;
+		}
+		else if(strcmp(cWord, "and") == 0)
+		{
+			/* Az elemek amgy is S kapcsolatban vannak */
+		}
+		else if((strcmp(cWord, "rx") == 0) || (strcmp(cWord, "tx") == 0))
+		{
+			pxFilter->ucDirection = (cWord[0] == 'r') ? pcapDIRECTION_RX : pcapDIRECTION_TX;
+			pxFilter->ulMatch |= pcapMATCH_DIRECTION;
+		}
+		else if(strcmp(cWord, "arp") == 0)
+		{
+			pxFilter->usEtherType = pcapETHERTYPE_ARP;
+			pxFilter->ulMatch |= pcapMATCH_ETHERTYPE;
+		}
+		else if(strcmp(cWord, "ip") == 0)
+		{
+			pxFilter->usEtherType = pcapETHERTYPE_IPv4;
+			pxFilter->ulMatch |= pcapMATCH_ETHERTYPE;
+		}
+		else if((strcmp(cWord, "icmp") == 0) || (strcmp(cWord, "tcp") == 0) || (strcmp(cWord, "udp") == 0))
+		{
+			pxFilter->ucProtocol = (cWord[0] == 'i') ? ipPROTOCOL_ICMP : ((cWord[0] == 't') ? ipPROTOCOL_TCP : ipPROTOCOL_UDP);
+			pxFilter->ulMatch |= pcapMATCH_PROTOCOL;
+		}
+		else if(strcmp(cWord, "ptp") == 0)
+		{
+			pxFilter->ulMatch |= pcapMATCH_PTP;
+		}
+		else if(strcmp(cWord, "ether") == 0)
+		{
+			xExpectValue = 1;
+		}
+		else if(strcmp(cWord, "host") == 0)
+		{
+			xExpectValue = 2;
+		}
+		else if(strcmp(cWord, "port") == 0)
+		{
+			xExpectValue = 3;
+		}
+		else
+		{
+			return pdFAIL;
+		}
+		xFirst = pdFALSE;
+	}
+
+	if(xExpectValue != 0)
+	{
+		/* Hinyz paramter */
+		return pdFAIL;
+	}
+
+	while(*pcExpression == ' ')
+	{
+		pcExpression++;
+	}
+	snprintf(pxFilter->cText, sizeof(pxFilter->cText), "%s", pcExpression);
+
+	return pdPASS;
+}
+
+static uint16_t prvPCAPRead16(const uint8_t *pucData)
+{
+	return (uint16_t)(((uint16_t)pucData[0] << 8) | pucData[1]);
+}
+
+static uint32_t prvPCAPRead32(const uint8_t *pucData)
+{
+	return ((uint32_t)pucData[0] << 24) | ((uint32_t)pucData[1] << 16) | ((uint32_t)pucData[2] << 8) | pucData[3];
+}
+
+/*
+ * A szr kirtkelse. Csak a keret fejlceit olvassa, a hossz ellenrzsvel.
+ */
+static BaseType_t prvPCAPMatch(const PCAPFilter_t *pxFilter, const uint8_t *pucFrame, size_t uxLength, uint8_t ucDirection)
+{
+	BaseType_t xMatch = pdTRUE;
+	size_t uxOffset = 12U;
+	uint16_t usEtherType = 0U;
+	const uint8_t *pucIP = NULL;
+	uint8_t ucProtocol = 0U;
+	uint16_t usSourcePort = 0U, usDestinationPort = 0U;
+	size_t uxHeaderLength;
+
+	if(pxFilter->ulMatch == 0U)
+	{
+		return (pxFilter->xNegate == pdFALSE) ? pdTRUE : pdFALSE;
+	}
+
+	if(uxLength >= uxOffset + 2U)
+	{
+		usEtherType = prvPCAPRead16(pucFrame + uxOffset);
+		if((usEtherType == pcapETHERTYPE_VLAN) && (uxLength >= uxOffset + 6U))
+		{
+			uxOffset += 4U;
+			usEtherType = prvPCAPRead16(pucFrame + uxOffset);
+		}
+		uxOffset += 2U;
+	}
+
+	if((usEtherType == pcapETHERTYPE_IPv4) && (uxLength >= uxOffset + 20U))
+	{
+		pucIP = pucFrame + uxOffset;
+		ucProtocol = pucIP[9];
+		uxHeaderLength = (size_t)(pucIP[0] & 0x0FU) * 4U;
+		/* Portok csak a nem tredkelt, vagy az els tredkben vannak */
+		if(((ucProtocol == ipPROTOCOL_TCP) || (ucProtocol == ipPROTOCOL_UDP)) &&
+			((prvPCAPRead16(pucIP + 6) & 0x1FFFU) == 0U) && (uxLength >= uxOffset + uxHeaderLength + 4U))
+		{
+			usSourcePort = prvPCAPRead16(pucIP + uxHeaderLength);
+			usDestinationPort = prvPCAPRead16(pucIP + uxHeaderLength + 2U);
+		}
+	}
+
+	if(((pxFilter->ulMatch & pcapMATCH_DIRECTION) != 0U) && (pxFilter->ucDirection != ucDirection))
+	{
+		xMatch = pdFALSE;
+	}
+	else if(((pxFilter->ulMatch & pcapMATCH_ETHERTYPE) != 0U) && (pxFilter->usEtherType != usEtherType))
+	{
+		xMatch = pdFALSE;
+	}
+	else if(((pxFilter->ulMatch & pcapMATCH_PROTOCOL) != 0U) && ((pucIP == NULL) || (pxFilter->ucProtocol != ucProtocol)))
+	{
+		xMatch = pdFALSE;
+	}
+	else if(((pxFilter->ulMatch & pcapMATCH_HOST) != 0U) &&
+		((pucIP == NULL) || ((prvPCAPRead32(pucIP + 12) != pxFilter->ulHost) && (prvPCAPRead32(pucIP + 16) != pxFilter->ulHost))))
+	{
+		xMatch = pdFALSE;
+	}
+	else if(((pxFilter->ulMatch & pcapMATCH_PORT) != 0U) && (usSourcePort != pxFilter->usPort) && (usDestinationPort != pxFilter->usPort))
+	{
+		xMatch = pdFALSE;
+	}
+	else if(((pxFilter->ulMatch & pcapMATCH_PTP) != 0U) && (usEtherType != pcapETHERTYPE_PTP) &&
+		((ucProtocol != ipPROTOCOL_UDP) || ((usDestinationPort != pcapPTP_EVENT_PORT) && (usDestinationPort != pcapPTP_GENERAL_PORT))))
+	{
+		xMatch = pdFALSE;
+	}
+
+	if(pxFilter->xNegate != pdFALSE)
+	{
+		xMatch = (xMatch == pdFALSE) ? pdTRUE : pdFALSE;
+	}
+	return xMatch;
+}
+
+/*
+ * A hely lefoglalsa rvid kritikus szakasz, a msols mr azon kvl trtnik, gy a rgzts tbb taszkbl
+ * (RX csatornk, IP taszk) is csak nhny utastsnyi idre tiltja a megszaktsokat.
+ */
+void vPCAPCaptureFrame(const uint8_t *pucFrame, size_t uxLength, uint8_t ucDirection)
+{
+	uint32_t ulFRC0 = RTI_FRC0_REG;
+	PCAPRecord_t *pxRecord = NULL;
+	uint32_t ulCaptureLength, ulRecordLength, ulContiguous, ulNeeded;
+	BaseType_t xNotify = pdFALSE;
+	uint32_t ulFilter;
+
+	if(xPCAPActive == pdFALSE)
+	{
+		return;
+	}
+
+	ulFilter = prvPCAPFilterTake();
+	if(prvPCAPMatch(&xPCAPFilters[ulFilter], pucFrame, uxLength, ucDirection) == pdFALSE)
+	{
+		taskENTER_CRITICAL();
+		{
+			uxPCAPFilterReaders[ulFilter]--;
+			xPCAPStatus.ulFiltered++;
+		}
+		taskEXIT_CRITICAL();
+		return;
+	}
+
+	ulCaptureLength = (uxLength < ulPCAPSnapLength) ? (uint32_t)uxLength : ulPCAPSnapLength;
+	ulRecordLength = pcapALIGN4(sizeof(PCAPRecord_t) + ulCaptureLength);
+
+	taskENTER_CRITICAL();
+	{
+		/* A szrt mr kirtkeltk, az elengeds itt nem kerl kln kritikus szakaszba */
+		uxPCAPFilterReaders[ulFilter]--;
+		ulContiguous = ipconfigPCAP_RING_SIZE - ulPCAPWrite;
+		ulNeeded = ulRecordLength + ((ulRecordLength > ulContiguous) ? ulContiguous : 0U);
+
+		if(ulPCAPUsed + ulNeeded > ipconfigPCAP_RING_SIZE)
+		{
+			xPCAPStatus.ulDropped++;
+		}
+		else
+		{
+			if(ulRecordLength > ulContiguous)
+			{
+				/* A gyr vgn maradt helyet kitltjk, a rekord az elejn kezddik */
+				pxRecord = (PCAPRecord_t *)((uint8_t *)ulPCAPRing + ulPCAPWrite);
+				pxRecord->usRecordLength = (uint16_t)ulContiguous;
+				pxRecord->ucState = pcapRECORD_PAD;
+				ulPCAPWrite = 0U;
+			}
+			pxRecord = (PCAPRecord_t *)((uint8_t *)ulPCAPRing + ulPCAPWrite);
+			pxRecord->usRecordLength = (uint16_t)ulRecordLength;
+			pxRecord->ucState = pcapRECORD_BUSY;
+			ulPCAPWrite += ulRecordLength;
+			if(ulPCAPWrite >= ipconfigPCAP_RING_SIZE)
+			{
+				ulPCAPWrite = 0U;
+			}
+			ulPCAPUsed += ulNeeded;
+			xPCAPStatus.ulCaptured++;
+
+			if((ulPCAPUsed > (ipconfigPCAP_RING_SIZE / 2U)) && (xPCAPFlushRequested == pdFALSE))
+			{
+				xPCAPFlushRequested = pdTRUE;
+				xNotify = pdTRUE;
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if(pxRecord != NULL)
+	{
+		pxRecord->ucDirection = ucDirection;
+		pxRecord->ulFRC0 = ulFRC0;
+		pxRecord->usFrameLength = (uint16_t)uxLength;
+		pxRecord->usCaptureLength = (uint16_t)ulCaptureLength;
+		memcpy(pxRecord + 1, pucFrame, ulCaptureLength);
+		pxRecord->ucState = pcapRECORD_READY;
+
+		if(xNotify != pdFALSE)
+		{
+			/* Flig telt gyr: az rt taszk ne vrja meg a peridus vgt */
+			xTaskNotifyGive(xPCAPTaskHandle);
+		}
+	}
+}
+
+static void prvPCAPPutBytes(const void *pvData, size_t uxLength)
+{
+	memcpy(ucPCAPWriteBuffer + uxPCAPWriteLength, pvData, uxLength);
+	uxPCAPWriteLength += uxLength;
+}
+
+static void prvPCAPPut32(uint32_t ulValue)
+{
+	/* A pcapng az r byte sorrendjt hasznlja, a Byte-Order Magic alapjn az olvas felismeri */
+	prvPCAPPutBytes(&ulValue, sizeof(ulValue));
+}
+
+static void prvPCAPPut16(uint16_t usValue)
+{
+	prvPCAPPutBytes(&usValue, sizeof(usValue));
+}
+
+static BaseType_t prvPCAPWriteOut(FF_FILE *pxFile)
+{
+	BaseType_t xResult = pdPASS;
+
+	if(uxPCAPWriteLength != 0U)
+	{
+		if(ff_fwrite(ucPCAPWriteBuffer, 1, uxPCAPWriteLength, pxFile) != uxPCAPWriteLength)
+		{
+			xPCAPStatus.ulWriteErrors++;
+			xResult = pdFAIL;
+		}
+		else
+		{
+			xPCAPStatus.ulFileSize += uxPCAPWriteLength;
+		}
+		uxPCAPWriteLength = 0U;
+	}
+	return xResult;
+}
+
+/*
+ * Az aktulis fjl megnyitsa hozzfzsre. Ha a kvetkez blokk mr nem fr el, vagy j rgzts indult,
+ * a (kvetkez) fjlt fellrjuk, s a Section Header s Interface Description blokkal kezdjk.
+ */
+static FF_FILE *prvPCAPOpenFile(uint32_t ulBlockLength)
+{
+	char cFileName[24];
+	FF_FILE *pxFile;
+	BaseType_t xNewFile = pdFALSE;
+
+	if(xPCAPRestart != pdFALSE)
+	{
+		xPCAPRestart = pdFALSE;
+		xPCAPStatus.ulFileIndex = 0U;
+		xNewFile = pdTRUE;
+	}
+	else if(xPCAPStatus.ulFileSize + ulBlockLength > ipconfigPCAP_FILE_SIZE)
+	{
+		xPCAPStatus.ulFileIndex = (xPCAPStatus.ulFileIndex + 1U) % ipconfigPCAP_FILE_COUNT;
+		xNewFile = pdTRUE;
+	}
+
+	snprintf(cFileName, sizeof(cFileName), pcapFILE_NAME_FORMAT, (unsigned)xPCAPStatus.ulFileIndex);
+	pxFile = ff_fopen(cFileName, (xNewFile != pdFALSE) ? "wb" : "ab");
+	if(pxFile == NULL)
+	{
+		xPCAPStatus.ulWriteErrors++;
+		return NULL;
+	}
+
+	if(xNewFile != pdFALSE)
+	{
+		xPCAPStatus.ulFileSize = 0U;
+
+		/* Section Header Block */
+		prvPCAPPut32(pcapngSECTION_HEADER);
+		prvPCAPPut32(28U);
+		prvPCAPPut32(pcapngBYTE_ORDER_MAGIC);
+		prvPCAPPut16(1U);							/* Major version */
+		prvPCAPPut16(0U);							/* Minor version */
+		prvPCAPPut32(0xFFFFFFFFUL);					/* Section length: ismeretlen */
+		prvPCAPPut32(0xFFFFFFFFUL);
+		prvPCAPPut32(28U);
+
+		/* Interface Description Block, ns felbonts idblyeggel */
+		prvPCAPPut32(pcapngINTERFACE_DESCRIPTION);
+		prvPCAPPut32(32U);
+		prvPCAPPut16(pcapngLINKTYPE_ETHERNET);
+		prvPCAPPut16(0U);
+		prvPCAPPut32(ulPCAPSnapLength);
+		prvPCAPPut16(pcapngOPTION_TSRESOL);
+		prvPCAPPut16(1U);
+		prvPCAPPut32((uint32_t)pcapngTSRESOL_NS << 24);	/* 1 byte rtk s 3 byte kitlts */
+		prvPCAPPut32(0U);							/* opt_endofopt */
+		prvPCAPPut32(32U);
+
+		if(prvPCAPWriteOut(pxFile) == pdFAIL)
+		{
+			ff_fclose(pxFile);
+			return NULL;
+		}
+	}
+
+	return pxFile;
+}
+
+/*
+ * A gyr kirsa. Az RTIFRC0 idblyeget itt vltjuk t: PHY id, ha a kereszt-idblyegzs rvnyes,
+ * egybknt rendszerid. Az rts legfeljebb ipconfigPCAP_FLUSH_PERIOD_MS-ot ksik, jval az RTIFRC0 krbefordulsa eltt.
+ */
+static void prvPCAPFlush(void)
+{
+	PCAPRecord_t *pxRecord;
+	FF_FILE *pxFile = NULL;
+	uint32_t ulBlockLength, ulPadding, ulNowFRC0 = 0U;
+	int32_t lDelta;
+	uint64_t uxTimestamp, uxNowNs = 0U;
+	BaseType_t xUsePTP;
+	const uint32_t ulZero = 0U;
+
+	xUsePTP = xPTPCrossTimestampIsValid();
+	if(xUsePTP == pdFALSE)
+	{
+		uxNowNs = xGetSysTimeNs(&ulNowFRC0);
+	}
+
+	while(ulPCAPUsed != 0U)
+	{
+		pxRecord = (PCAPRecord_t *)((uint8_t *)ulPCAPRing + ulPCAPRead);
+		if(pxRecord->ucState == pcapRECORD_BUSY)
+		{
+			/* A rgzt mg msol, a kvetkez menetben folytatjuk */
+			break;
+		}
+
+		if(pxRecord->ucState == pcapRECORD_READY)
+		{
+			ulPadding = pcapALIGN4(pxRecord->usCaptureLength) - pxRecord->usCaptureLength;
+			ulBlockLength = pcapngEPB_OVERHEAD + pxRecord->usCaptureLength + ulPadding;
+
+			if((pxFile != NULL) && (xPCAPStatus.ulFileSize + uxPCAPWriteLength + ulBlockLength > ipconfigPCAP_FILE_SIZE))
+			{
+				/* A fjl betelt, a kvetkezt kezdjk */
+				(void)prvPCAPWriteOut(pxFile);
+				ff_fclose(pxFile);
+				pxFile = NULL;
+			}
+			if(pxFile == NULL)
+			{
+				pxFile = prvPCAPOpenFile(ulBlockLength);
+			}
+			else if(uxPCAPWriteLength + ulBlockLength > sizeof(ucPCAPWriteBuffer))
+			{
+				(void)prvPCAPWriteOut(pxFile);
+			}
+
+			if(xUsePTP != pdFALSE)
+			{
+				uxTimestamp = xPTPCrossTimestampFromFRC0(pxRecord->ulFRC0);
+			}
+			else
+			{
+				/* A menet kzben rgztett csomagok a referencia utn vannak */
+				lDelta = (int32_t)(ulNowFRC0 - pxRecord->ulFRC0);
+				uxTimestamp = (lDelta >= 0) ? (uxNowNs - RTI_FRC0_TICKS_TO_NS(lDelta)) : (uxNowNs + RTI_FRC0_TICKS_TO_NS(-lDelta));
+			}
+
+			if(pxFile != NULL)
+			{
+				/* Enhanced Packet Block, az epb_flags jelzi az irnyt */
+				prvPCAPPut32(pcapngENHANCED_PACKET);
+				prvPCAPPut32(ulBlockLength);
+				prvPCAPPut32(0U);					/* Interface ID */
+				prvPCAPPut32((uint32_t)(uxTimestamp >> 32));
+				prvPCAPPut32((uint32_t)uxTimestamp);
+				prvPCAPPut32(pxRecord->usCaptureLength);
+				prvPCAPPut32(pxRecord->usFrameLength);
+				prvPCAPPutBytes(pxRecord + 1, pxRecord->usCaptureLength);
+				prvPCAPPutBytes(&ulZero, ulPadding);
+				prvPCAPPut16(pcapngOPTION_EPB_FLAGS);
+				prvPCAPPut16(4U);
+				prvPCAPPut32((pxRecord->ucDirection == pcapDIRECTION_RX) ? 1UL : 2UL);
+				prvPCAPPut32(0U);					/* opt_endofopt */
+				prvPCAPPut32(ulBlockLength);
+				xPCAPStatus.ulWritten++;
+			}
+		}
+
+		taskENTER_CRITICAL();
+		{
+			ulPCAPUsed -= pxRecord->usRecordLength;
+			ulPCAPRead += pxRecord->usRecordLength;
+			if(ulPCAPRead >= ipconfigPCAP_RING_SIZE)
+			{
+				ulPCAPRead = 0U;
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+	if(pxFile != NULL)
+	{
+		(void)prvPCAPWriteOut(pxFile);
+		/* Minden menet utn lezrjuk, gy a fjl kzben is letlthet FTP-vel */
+		ff_fclose(pxFile);
+	}
+}
+
+/*
+ * j rgzts indtsa az rt taszkban. A rgztst felfggesztjk, az elz rgzts maradkt kirjuk
+ * (a folyamatban lev msolsokat megvrva), gy az j cap0 csak az indts utni csomagokat tartalmazza.
+ */
+static void prvPCAPRestart(void)
+{
+	xPCAPActive = pdFALSE;
+	prvPCAPFlush();
+	while(ulPCAPUsed != 0U)
+	{
+		vTaskDelay(1);
+		prvPCAPFlush();
+	}
+
+	taskENTER_CRITICAL();
+	{
+		/* A kirs alatt kiadott vPCAPStop() visszavonta az indtst, ekkor lelltva maradunk */
+		if(xPCAPStartRequested != pdFALSE)
+		{
+			ulPCAPWrite = 0U;
+			ulPCAPRead = 0U;
+			ulPCAPSnapLength = ulPCAPStartSnapLength;
+			memset(&xPCAPStatus, 0, sizeof(xPCAPStatus));
+			xPCAPStartRequested = pdFALSE;
+			xPCAPRestart = pdTRUE;
+			xPCAPActive = pdTRUE;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+
+static void prvPCAPTask(void *pvParameters)
+{
+	(void)pvParameters;
+
+	for(;;)
+	{
+		(void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ipconfigPCAP_FLUSH_PERIOD_MS));
+		if(xPCAPStartRequested != pdFALSE)
+		{
+			prvPCAPRestart();
+		}
+		xPCAPFlushRequested = pdFALSE;
+		prvPCAPFlush();
+	}
+}
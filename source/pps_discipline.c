@@ -0,0 +1,200 @@
+#include "FreeRTOS.h"
+#include "os_task.h"
+#include "FreeRTOSTIMEConfig.h"
+#include "FreeRTOS_IP.h"
+#include "HL_ecap.h"
+#include "rti_runtimestats.h"
+#include "ptp_clock.h"
+#include "pps_discipline.h"
+
+#define ppsNS_PER_SECOND		1000000000LL
+#define ppsABS(x)				(((x) < 0) ? -(x) : (x))
+
+/* A mrt eCAP tem/msodperc csak a nvleges rtk +/- 1000 ppm-en bell elfogadhat */
+#define ppsMAX_TICK_DEVIATION	(configPPS_ECAP_CLOCK_HZ / 1000UL)
+
+static PPSStatus_t xPPSStatus;
+static double dPPSIntegral = 0.0;					/* PI szablyoz integrtora (ppb) */
+
+static unsigned int prvPPSReadCounter(void);
+static void prvPPSCaptureInit(void);
+static void prvPPSServo(int64_t xOffsetNs);
+static void prvPPSTask(void *pvParameters);
+
+void vStartPPSDisciplineTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority)
+{
+	xTaskCreate(prvPPSTask, "PPS", usTaskStackSize, NULL, uxTaskPriority, NULL);
+}
+
+void vPPSGetStatus(PPSStatus_t *pxStatus)
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStatus = xPPSStatus;
+	}
+	taskEXIT_CRITICAL();
+}
+
+/*
+ * Az eCAP idblyeg szmllja, ezzel prostjuk a PHY ra olvasst.
+ */
+static unsigned int prvPPSReadCounter(void)
+{
+	return configPPS_ECAP->TSCTR;
+}
+
+/*
+ * eCAP belltsa: folyamatos md, minden felfut l a CAP1-be kerl (wrap az 1. esemnynl).
+ */
+static void prvPPSCaptureInit(void)
+{
+	ecapStopCounter(configPPS_ECAP);
+	ecapDisableInterrupt(configPPS_ECAP, ecapInt_All);
+	ecapSetCaptureEvent1(configPPS_ECAP, RISING_EDGE, RESET_DISABLE);
+	ecapSetEventPrescaler(configPPS_ECAP, ecapPrescale_By_1);
+	ecapSetCaptureMode(configPPS_ECAP, CONTINUOUS, CAPTURE_EVENT1);
+	ecapEnableCapture(configPPS_ECAP);
+	ecapClearFlag(configPPS_ECAP, ecapInt_All);
+	ecapStartCounter(configPPS_ECAP);
+}
+
+/*
+ * PI szablyoz. xOffsetNs > 0: a PHY ra siet a PPS-hez kpest.
+ * Nagy eltrsnl (vagy az els impulzusnl) lptetnk, egybknt frekvencit lltunk.
+ */
+static void prvPPSServo(int64_t xOffsetNs)
+{
+	double dAdjust;
+	int32_t lFrequency;
+	BaseType_t xStep = pdFALSE;
+
+	if((xPPSStatus.ulPulseCount == 0U) || (ppsABS(xOffsetNs) > configPPS_STEP_THRESHOLD_NS))
+	{
+		xStep = pdTRUE;
+	}
+
+	if(xStep != pdFALSE)
+	{
+		vPTPClockStep(-xOffsetNs);
+		lFrequency = xPPSStatus.lFrequencyPpb;
+	}
+	else
+	{
+		dPPSIntegral += configPPS_SERVO_KI * (double)xOffsetNs;
+		if(dPPSIntegral > configPPS_MAX_FREQUENCY_PPB)
+		{
+			dPPSIntegral = configPPS_MAX_FREQUENCY_PPB;
+		}
+		else if(dPPSIntegral < -configPPS_MAX_FREQUENCY_PPB)
+		{
+			dPPSIntegral = -configPPS_MAX_FREQUENCY_PPB;
+		}
+
+		dAdjust = (configPPS_SERVO_KP * (double)xOffsetNs) + dPPSIntegral;
+		if(dAdjust > configPPS_MAX_FREQUENCY_PPB)
+		{
+			dAdjust = configPPS_MAX_FREQUENCY_PPB;
+		}
+		else if(dAdjust < -configPPS_MAX_FREQUENCY_PPB)
+		{
+			dAdjust = -configPPS_MAX_FREQUENCY_PPB;
+		}
+
+		lFrequency = -(int32_t)dAdjust;
+		vPTPClockAdjustFrequency(lFrequency);
+	}
+
+	taskENTER_CRITICAL();
+	{
+		xPPSStatus.ulPulseCount++;
+		xPPSStatus.xLastOffsetNs = xOffsetNs;
+		xPPSStatus.lFrequencyPpb = lFrequency;
+		if(xStep != pdFALSE)
+		{
+			xPPSStatus.ulSteps++;
+			xPPSStatus.xLocked = pdFALSE;
+		}
+		else
+		{
+			xPPSStatus.xLocked = (ppsABS(xOffsetNs) < configPPS_LOCK_THRESHOLD_NS) ? pdTRUE : pdFALSE;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+
+static void prvPPSTask(void *pvParameters)
+{
+	uint32_t ulCapture, ulPreviousCapture = 0U;
+	uint32_t ulTicksPerSecond = configPPS_ECAP_CLOCK_HZ;
+	unsigned int ulCounter, ulWindow;
+	uint32_t ulPollsWithoutPulse = 0U;
+	BaseType_t xHavePrevious = pdFALSE;
+	uint64_t uxPhyNow, uxSysNow, uxPhyAtPulse, uxSecond;
+	int64_t xElapsedNs, xOffsetNs;
+
+	(void)pvParameters;
+
+	/* A PHY-t a hlzati interfsz inicializlja, addig vrunk. */
+	while(FreeRTOS_IsNetworkUp() == pdFALSE)
+	{
+		vTaskDelay(pdMS_TO_TICKS(500));
+	}
+
+	if(xPTPClockIsEnabled() == pdFALSE)
+	{
+		vPTPClockEnable();
+	}
+	prvPPSCaptureInit();
+
+	for(;;)
+	{
+		vTaskDelay(pdMS_TO_TICKS(configPPS_POLL_PERIOD_MS));
+
+		if(ecapGetEventStatus(configPPS_ECAP, ecapInt_CEVT1) == 0U)
+		{
+			/* Nincs impulzus: holdover az utols frekvencival */
+			if(++ulPollsWithoutPulse > ((2000U / configPPS_POLL_PERIOD_MS) + 1U))
+			{
+				ulPollsWithoutPulse = 0U;
+				xHavePrevious = pdFALSE;
+				taskENTER_CRITICAL();
+				{
+					xPPSStatus.ulMissedPulses++;
+					xPPSStatus.xLocked = pdFALSE;
+				}
+				taskEXIT_CRITICAL();
+			}
+			continue;
+		}
+		ulPollsWithoutPulse = 0U;
+
+		ulCapture = ecapGetCAP1(configPPS_ECAP);
+		ecapClearFlag(configPPS_ECAP, ecapInt_CEVT1);
+
+		/* PHY id prostva az eCAP szmllval, majd visszavetts a PPS lre. */
+		uxPhyNow = xPTPClockGetTimePaired(prvPPSReadCounter, &ulCounter, &ulWindow);
+		uxSysNow = xGetSysTimeNs(NULL);
+
+		/* Az eCAP rajel hibjt a kt PPS kztti mrt temszmmal kompenzljuk. */
+		if(xHavePrevious != pdFALSE)
+		{
+			uint32_t ulMeasured = ulCapture - ulPreviousCapture;
+			if(ppsABS((int32_t)(ulMeasured - configPPS_ECAP_CLOCK_HZ)) < (int32_t)ppsMAX_TICK_DEVIATION)
+			{
+				ulTicksPerSecond = ulMeasured;
+			}
+		}
+		ulPreviousCapture = ulCapture;
+		xHavePrevious = pdTRUE;
+
+		xElapsedNs = (int64_t)(((uint64_t)(ulCounter - ulCapture) * (uint64_t)ppsNS_PER_SECOND) / ulTicksPerSecond);
+		uxPhyAtPulse = uxPhyNow - (uint64_t)xElapsedNs;
+
+		/* A PPS a rendszeridhz (NTP) legkzelebbi egsz msodpercet jelli. */
+		uxSecond = ((uxSysNow - (uint64_t)xElapsedNs) + (uint64_t)(ppsNS_PER_SECOND / 2)) / (uint64_t)ppsNS_PER_SECOND;
+		xOffsetNs = (int64_t)(uxPhyAtPulse - (uxSecond * (uint64_t)ppsNS_PER_SECOND));
+
+		xPPSStatus.ulPairWindowNs = (uint32_t)(((uint64_t)ulWindow * (uint64_t)ppsNS_PER_SECOND) / ulTicksPerSecond);
+		prvPPSServo(xOffsetNs);
+	}
+}
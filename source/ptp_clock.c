@@ -0,0 +1,153 @@
+#include "FreeRTOS.h"
+#include "os_task.h"
+#include "os_semphr.h"
+#include "HL_emac.h"
+#include "HL_mdio.h"
+#include "HL_hw_mdio.h"
+#include "HL_phy_dp83640.h"
+#include "rti_runtimestats.h"
+#include "ptp_clock.h"
+
+static SemaphoreHandle_t xPTPClockMutex = NULL;		/* MDIO hozzfrs s lapvlaszts vdelme */
+static volatile BaseType_t xPTPClockEnabled = pdFALSE;
+static volatile long lPTPClockFrequencyPpb = 0;
+static volatile unsigned long ulPTPClockStepCount = 0UL;	/* Az ra ugrsszer vltozsainak szma */
+
+void vPTPClockInit(void)
+{
+	if(xPTPClockMutex == NULL)
+	{
+		xPTPClockMutex = xSemaphoreCreateMutex();
+		configASSERT(xPTPClockMutex);
+	}
+}
+
+/*
+ * Az MDIO (USERACCESS0) kzs zra. A hlzati meghajt PHY elrsei (azonosts, link, autonegotiation) is ezen mennek,
+ * gy nem szakthatjk flbe a PTP regiszterek lapvlasztst s tbbszavas rst/olvasst.
+ */
+void vPTPClockMDIOTake(void)
+{
+	configASSERT(xPTPClockMutex);
+	xSemaphoreTake(xPTPClockMutex, portMAX_DELAY);
+}
+
+void vPTPClockMDIOGive(void)
+{
+	xSemaphoreGive(xPTPClockMutex);
+}
+
+/*
+ * A PHY ra engedlyezse s a rendszerid betltse.
+ * Felttelezi, hogy a PHY-t a hlzati interfsz mr inicializlta. Ismtelt hvs esetn nem csinl semmit.
+ */
+void vPTPClockEnable(void)
+{
+	uint64_t uxNow;
+
+	xSemaphoreTake(xPTPClockMutex, portMAX_DELAY);
+	if(xPTPClockEnabled == pdFALSE)
+	{
+		Dp83640PtpEnable(MDIO_BASE, EMAC_PHYADDRESS);
+		Dp83640PtpRateSet(MDIO_BASE, EMAC_PHYADDRESS, 0);
+		uxNow = xGetSysTimeNs(NULL);
+		Dp83640PtpClockLoad(MDIO_BASE, EMAC_PHYADDRESS, (uint32)(uxNow / 1000000000ULL), (uint32)(uxNow % 1000000000ULL));
+		lPTPClockFrequencyPpb = 0;
+		ulPTPClockStepCount++;
+		xPTPClockEnabled = pdTRUE;
+	}
+	xSemaphoreGive(xPTPClockMutex);
+}
+
+BaseType_t xPTPClockIsEnabled(void)
+{
+	return xPTPClockEnabled;
+}
+
+uint64_t xPTPClockGetTime(void)
+{
+	uint32 ulSeconds, ulNanoseconds;
+
+	xSemaphoreTake(xPTPClockMutex, portMAX_DELAY);
+	{
+		Dp83640PtpClockRead(MDIO_BASE, EMAC_PHYADDRESS, &ulSeconds, &ulNanoseconds);
+	}
+	xSemaphoreGive(xPTPClockMutex);
+
+	return ((uint64_t)ulSeconds * 1000000000ULL) + ulNanoseconds;
+}
+
+/*
+ * Prostott mintavtel: a PHY ra RD_CLK paranccsal trtn rgztse a helyi szmll olvassa kz kerl.
+ * Az ra az MDIO rsi keret vgn rgzl, ezrt a visszaadott szmll rtk a keret utni minta;
+ * az ablak (eltte/utna mintk klnbsge) a bizonytalansg fels korltja. A rgzts alatt a megszaktsok tiltva vannak (~30 usec).
+ */
+uint64_t xPTPClockGetTimePaired(PTPClockCounter_t pxCounter, unsigned int *pulCounter, unsigned int *pulWindow)
+{
+	uint32 ulSeconds, ulNanoseconds;
+	unsigned int ulBefore, ulAfter;
+
+	xSemaphoreTake(xPTPClockMutex, portMAX_DELAY);
+	{
+		Dp83640SelectPage(MDIO_BASE, EMAC_PHYADDRESS, DP83640_PAGE_PTP);
+
+		portENTER_CRITICAL();
+		{
+			ulBefore = pxCounter();
+			Dp83640PtpClockLatch(MDIO_BASE, EMAC_PHYADDRESS);
+			ulAfter = pxCounter();
+		}
+		portEXIT_CRITICAL();
+
+		Dp83640PtpClockGetLatched(MDIO_BASE, EMAC_PHYADDRESS, &ulSeconds, &ulNanoseconds);
+	}
+	xSemaphoreGive(xPTPClockMutex);
+
+	*pulCounter = ulAfter;
+	if(pulWindow != NULL)
+	{
+		*pulWindow = ulAfter - ulBefore;
+	}
+
+	return ((uint64_t)ulSeconds * 1000000000ULL) + ulNanoseconds;
+}
+
+void vPTPClockSetTime(uint64_t uxTimeNs)
+{
+	xSemaphoreTake(xPTPClockMutex, portMAX_DELAY);
+	{
+		Dp83640PtpClockLoad(MDIO_BASE, EMAC_PHYADDRESS, (uint32)(uxTimeNs / 1000000000ULL), (uint32)(uxTimeNs % 1000000000ULL));
+		ulPTPClockStepCount++;
+	}
+	xSemaphoreGive(xPTPClockMutex);
+}
+
+void vPTPClockStep(int64_t xOffsetNs)
+{
+	xSemaphoreTake(xPTPClockMutex, portMAX_DELAY);
+	{
+		Dp83640PtpClockStep(MDIO_BASE, EMAC_PHYADDRESS, xOffsetNs);
+		ulPTPClockStepCount++;
+	}
+	xSemaphoreGive(xPTPClockMutex);
+}
+
+void vPTPClockAdjustFrequency(long lPpb)
+{
+	xSemaphoreTake(xPTPClockMutex, portMAX_DELAY);
+	{
+		Dp83640PtpRateSet(MDIO_BASE, EMAC_PHYADDRESS, (sint32)lPpb);
+		lPTPClockFrequencyPpb = lPpb;
+	}
+	xSemaphoreGive(xPTPClockMutex);
+}
+
+long xPTPClockGetFrequency(void)
+{
+	return lPTPClockFrequencyPpb;
+}
+
+unsigned long ulPTPClockGetStepCount(void)
+{
+	return ulPTPClockStepCount;
+}
@@ -0,0 +1,194 @@
+#include "FreeRTOS.h"
+#include "os_task.h"
+#include "FreeRTOSTIMEConfig.h"
+#include "FreeRTOS_IP.h"
+#include "rti_runtimestats.h"
+#include "ptp_clock.h"
+#include "ptp_crosstimestamp.h"
+
+#define xtsNS_PER_SECOND			1000000000ULL
+#define xtsMULT_SHIFT				24U				/* A ns/tem szorz trtrsznek bitszma */
+#define xtsNOMINAL_MULT				( ( xtsNS_PER_SECOND << xtsMULT_SHIFT ) / RTI_FRC0_FREQUENCY_HZ )
+
+/*
+ * Lineris lekpezs: PTP = uxBaseNs + (FRC0 - ulBaseFRC0) * uxMult / 2^24.
+ * Kt pldnyt tartunk, a taszk mindig az inaktvat rja s utna vlt, gy a megszaktsbl olvas soha nem lt flksz lekpezst.
+ */
+typedef struct xPTP_CROSSTIMESTAMP_MAP
+{
+	uint32_t ulBaseFRC0;
+	uint64_t uxBaseNs;
+	uint64_t uxMult;
+} PTPCrossTimestampMap_t;
+
+static PTPCrossTimestampMap_t xXTSMaps[2];
+static volatile uint32_t ulXTSActiveMap = 0U;
+static volatile BaseType_t xXTSValid = pdFALSE;
+static unsigned long ulXTSStepCount = 0UL;			/* A PHY ra lptetseinek szma a bzis mintavtelekor */
+static PTPCrossTimestampStatus_t xXTSStatus;
+
+static unsigned int prvXTSReadFRC0(void);
+static uint64_t prvXTSConvert(const PTPCrossTimestampMap_t *pxMap, uint32_t ulFRC0);
+static BaseType_t prvXTSSample(uint64_t *puxPtpNs, uint32_t *pulFRC0, uint32_t *pulWindow);
+static void prvXTSTask(void *pvParameters);
+
+void vStartPTPCrossTimestampTask(uint16_t usTaskStackSize, UBaseType_t uxTaskPriority)
+{
+	xTaskCreate(prvXTSTask, "XTS", usTaskStackSize, NULL, uxTaskPriority, NULL);
+}
+
+void vPTPCrossTimestampGetStatus(PTPCrossTimestampStatus_t *pxStatus)
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStatus = xXTSStatus;
+		pxStatus->xValid = xXTSValid;
+	}
+	taskEXIT_CRITICAL();
+}
+
+BaseType_t xPTPCrossTimestampIsValid(void)
+{
+	return xXTSValid;
+}
+
+static unsigned int prvXTSReadFRC0(void)
+{
+	return RTI_FRC0_REG;
+}
+
+static uint64_t prvXTSConvert(const PTPCrossTimestampMap_t *pxMap, uint32_t ulFRC0)
+{
+	int32_t lDelta = (int32_t)(ulFRC0 - pxMap->ulBaseFRC0);
+	uint64_t uxOffset;
+
+	if(lDelta >= 0)
+	{
+		uxOffset = ((uint64_t)lDelta * pxMap->uxMult) >> xtsMULT_SHIFT;
+		return pxMap->uxBaseNs + uxOffset;
+	}
+
+	uxOffset = ((uint64_t)(-(int64_t)lDelta) * pxMap->uxMult) >> xtsMULT_SHIFT;
+	return pxMap->uxBaseNs - uxOffset;
+}
+
+uint64_t xPTPCrossTimestampFromFRC0(uint32_t ulFRC0)
+{
+	return prvXTSConvert(&xXTSMaps[ulXTSActiveMap], ulFRC0);
+}
+
+uint64_t xPTPCrossTimestampNow(void)
+{
+	return xPTPCrossTimestampFromFRC0(RTI_FRC0_REG);
+}
+
+/*
+ * configXTS_SAMPLES prostott mintavtelbl a legkisebb ablak (legkisebb bizonytalansg) minta kivlasztsa.
+ * pdFAIL, ha a legjobb ablak is nagyobb a configXTS_MAX_WINDOW_NS korltnl.
+ */
+static BaseType_t prvXTSSample(uint64_t *puxPtpNs, uint32_t *pulFRC0, uint32_t *pulWindow)
+{
+	BaseType_t x;
+	uint64_t uxPtp;
+	unsigned int ulCounter, ulWindow;
+	uint32_t ulBestWindow = 0xFFFFFFFFU;
+
+	for(x = 0; x < configXTS_SAMPLES; x++)
+	{
+		uxPtp = xPTPClockGetTimePaired(prvXTSReadFRC0, &ulCounter, &ulWindow);
+		if(ulWindow < ulBestWindow)
+		{
+			ulBestWindow = ulWindow;
+			*puxPtpNs = uxPtp;
+			*pulFRC0 = ulCounter;
+		}
+	}
+
+	*pulWindow = (uint32_t)RTI_FRC0_TICKS_TO_NS(ulBestWindow);
+	return (*pulWindow <= configXTS_MAX_WINDOW_NS) ? pdPASS : pdFAIL;
+}
+
+static void prvXTSTask(void *pvParameters)
+{
+	PTPCrossTimestampMap_t *pxNext;
+	PTPCrossTimestampMap_t *pxActive;
+	uint64_t uxPtp, uxPredicted, uxMult;
+	uint32_t ulFRC0, ulWindow, ulTicks;
+	int64_t xError, xRate;
+	unsigned long ulStepCount;
+	BaseType_t xRebase;
+
+	(void)pvParameters;
+
+	/* A PHY-t a hlzati interfsz inicializlja, addig vrunk. */
+	while(FreeRTOS_IsNetworkUp() == pdFALSE)
+	{
+		vTaskDelay(pdMS_TO_TICKS(500));
+	}
+	vPTPClockEnable();
+
+	for(;;)
+	{
+		ulStepCount = ulPTPClockGetStepCount();
+		if(prvXTSSample(&uxPtp, &ulFRC0, &ulWindow) == pdFAIL)
+		{
+			xXTSStatus.ulRejected++;
+			vTaskDelay(pdMS_TO_TICKS(configXTS_PERIOD_MS));
+			continue;
+		}
+
+		pxActive = &xXTSMaps[ulXTSActiveMap];
+		pxNext = &xXTSMaps[ulXTSActiveMap ^ 1U];
+		uxMult = pxActive->uxMult;
+		xRebase = pdTRUE;
+		xError = 0;
+
+		/* Ha az rt kzben lptettk vagy betltttk, a meredeksget megtartjuk s csak a bzist cserljk. */
+		if((xXTSValid != pdFALSE) && (ulStepCount == ulXTSStepCount) && (ulStepCount == ulPTPClockGetStepCount()))
+		{
+			ulTicks = ulFRC0 - pxActive->ulBaseFRC0;
+			uxPredicted = prvXTSConvert(pxActive, ulFRC0);
+			xError = (int64_t)(uxPtp - uxPredicted);
+
+			/* Sebessg az elz bzis ta, a hihetetlen rtkeket eldobjuk. */
+			if((ulTicks != 0U) && (ulTicks < 0x80000000U) && (uxPtp > pxActive->uxBaseNs) && ((uxPtp - pxActive->uxBaseNs) < (1ULL << 39)))
+			{
+				uint64_t uxMeasured = ((uxPtp - pxActive->uxBaseNs) << xtsMULT_SHIFT) / ulTicks;
+				xRate = (((int64_t)uxMeasured - (int64_t)xtsNOMINAL_MULT) * 1000000000LL) / (int64_t)xtsNOMINAL_MULT;
+				if((xRate < configXTS_MAX_RATE_PPB) && (xRate > -configXTS_MAX_RATE_PPB))
+				{
+					/* Enyhe szrs a mintavteli bizonytalansg ellen */
+					uxMult = (uint64_t)((int64_t)uxMult + (((int64_t)uxMeasured - (int64_t)uxMult) / configXTS_RATE_FILTER));
+					xRebase = pdFALSE;
+				}
+			}
+		}
+
+		if(xRebase != pdFALSE)
+		{
+			uxMult = (xXTSValid != pdFALSE) ? uxMult : xtsNOMINAL_MULT;
+		}
+
+		ulXTSStepCount = ulStepCount;
+		pxNext->ulBaseFRC0 = ulFRC0;
+		pxNext->uxBaseNs = uxPtp;
+		pxNext->uxMult = uxMult;
+
+		taskENTER_CRITICAL();
+		{
+			ulXTSActiveMap ^= 1U;
+			if((xRebase != pdFALSE) && (xXTSValid != pdFALSE))
+			{
+				xXTSStatus.ulRebases++;
+			}
+			xXTSValid = pdTRUE;
+			xXTSStatus.ulSamples++;
+			xXTSStatus.ulWindowNs = ulWindow;
+			xXTSStatus.lLastErrorNs = (xError > 0x7FFFFFFFLL) ? 0x7FFFFFFF : ((xError < -0x7FFFFFFFLL) ? -0x7FFFFFFF : (int32_t)xError);
+			xXTSStatus.lRatePpb = (int32_t)((((int64_t)uxMult - (int64_t)xtsNOMINAL_MULT) * 1000000000LL) / (int64_t)xtsNOMINAL_MULT);
+		}
+		taskEXIT_CRITICAL();
+
+		vTaskDelay(pdMS_TO_TICKS(configXTS_PERIOD_MS));
+	}
+}
@@ -8,6 +8,7 @@
 volatile time_t xSysTimeSeconds = configTIME_START_EPOCH_TIME;	/* Rendszerid (EPOCH) msodpercek.*/
 volatile unsigned int xSysTimeMsec;								/* Rendszerid ezredmsodpercek */
 volatile unsigned int xHighPrecisionTimerUsecMSB = 0;			/* 64 bites Nagyfelbonts (usec) timer fels 32 bit */
+volatile unsigned int xSysTimeMsecFRC0;							/* Az utols ezredmsodperc hatr RTIFRC0 rtke */
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 void vConfigureTimerForRunTimeStats(void)
@@ -92,12 +93,13 @@ void vConfigureTimerForSysTime(void)
 	/* RTI Compare 1. This register holds a value that is compared with the counter selected in the
 	compare control logic. If RTIFRC0 or RTIFRC1, depending on the counter selected, matches
 	this compare value, an interrupt is flagged. With this register, it is possible to initiate a DMA request. */
-	RTI_COMP1_REG = RTI_FRC0_REG + (( configCPU_CLOCK_HZ / 2 ) / 1000) - 75;
+	xSysTimeMsecFRC0 = RTI_FRC0_REG;
+	RTI_COMP1_REG = xSysTimeMsecFRC0 + RTI_FRC0_TICKS_PER_MSEC;
 
 	/* Update compare 1. This register holds a value that is added to the value in the RTICOMP1
 	register each time a compare matches. This process allows periodic interrupts to be generated
 	without software intervention. */
-	RTI_UDCP1_REG = (( configCPU_CLOCK_HZ / 2 ) / 1000) - 75;
+	RTI_UDCP1_REG = RTI_FRC0_TICKS_PER_MSEC;
 
 	/* Interrupt vektorok tirnytsa a sajt ISR fggvnyekre */
 	vimChannelMap(RTI_COMPARE_1, RTI_COMPARE_1, &vFreeRTOSRTICmp1Interrupt);
@@ -118,8 +120,11 @@ void vFreeRTOSRTICmp1Interrupt(void)
 	/* RTI Compare 1 megszakts tiltsa */
 	RTI_CLEARINTENA_REG = 0x00000002;
 
+	/* A most lejrt compare rtk az ezredmsodperc hatr (RTICOMP1 mr a kvetkezt tartalmazza). */
+	xSysTimeMsecFRC0 = RTI_COMP1_REG - RTI_UDCP1_REG;
+
 	//gioToggleBit(gioPORTA, 0);
-	if(xSysTimeMsec++ > 1000)
+	if(++xSysTimeMsec >= 1000)
 	{
 		xSysTimeMsec = 0;
 		xSysTimeSeconds++;
@@ -130,3 +135,33 @@ void vFreeRTOSRTICmp1Interrupt(void)
 	RTI_SETINTENA_REG |= 0x00000002;
 }
 
+/*
+ * Rendszerid nanoszekundumban (EPOCH ta), az RTIFRC0 szmllval interpollva.
+ * System time in nanoseconds since EPOCH, interpolated with RTIFRC0 between the 1 ms ticks.
+ * pulFRC0: ha nem NULL, ide kerl az RTIFRC0 rtke, amelyhez a visszaadott id tartozik.
+ */
+uint64_t xGetSysTimeNs(unsigned int *pulFRC0)
+{
+	uint64_t xSeconds;
+	unsigned int xMsec;
+	unsigned int xMsecFRC0;
+	unsigned int xFRC0;
+
+	/* Konzisztens mintavtel: a Compare 1 megszakts nem futhat kzben. */
+	portENTER_CRITICAL();
+	{
+		xSeconds = (uint64_t)xSysTimeSeconds;
+		xMsec = xSysTimeMsec;
+		xMsecFRC0 = xSysTimeMsecFRC0;
+		xFRC0 = RTI_FRC0_REG;
+	}
+	portEXIT_CRITICAL();
+
+	if(pulFRC0 != NULL)
+	{
+		*pulFRC0 = xFRC0;
+	}
+
+	/* A fggben lv Compare 1 megszakts miatt az eltrs 1 ms-nl nagyobb is lehet, ez gy is helyes. */
+	return (xSeconds * 1000000000ULL) + ((uint64_t)xMsec * 1000000ULL) + RTI_FRC0_TICKS_TO_NS(xFRC0 - xMsecFRC0);
+}
@@ -0,0 +1,238 @@
+#include "rti_runtimestats.h"
+#include "rti_timetrigger.h"
+#include "HL_sys_vim.h"
+#include "FreeRTOS.h"
+#include "FreeRTOSTIMEConfig.h"
+#include "os_task.h"
+
+#ifndef configTIME_TRIGGER_MAX_WAITERS
+	#define configTIME_TRIGGER_MAX_WAITERS	4
+#endif
+
+#define timetriggerCOMPARE_2_INT			0x00000004U		/* RTI Compare 2 megszakts bit (SETINTENA, CLEARINTENA, INTFLAG) */
+#define timetriggerCOMPSEL2					0x00000100U		/* COMPCTRL: Compare 2 az RTIFRC1-et hasznlja, ha 1 */
+
+#define timetriggerTICK_NS					( 1000000000ULL / configTICK_RATE_HZ )
+#define timetriggerFRC0_TICKS_PER_OS_TICK	( RTI_FRC0_FREQUENCY_HZ / configTICK_RATE_HZ )
+
+/* Ennl rvidebb htralv idre nem lestjk a Compare 2-t, hanem aktvan vrunk (~5 usec). */
+#define timetriggerMIN_ARM_TICKS			( RTI_FRC0_FREQUENCY_HZ / 200000 )
+
+/* A finom vrakozs leghosszabb ideje RTIFRC0 temekben (a durva vrakozs utn legfeljebb 3 tick marad). */
+#define timetriggerMAX_FINE_TICKS			( 4ULL * timetriggerFRC0_TICKS_PER_OS_TICK )
+
+typedef struct xTIME_TRIGGER_WAITER
+{
+	TaskHandle_t xTask;					/* Vrakoz taszk, NULL ha a hely szabad */
+	uint32_t ulCompareFRC0;				/* bresztsi idpont RTIFRC0-ban */
+} TimeTriggerWaiter_t;
+
+static TimeTriggerWaiter_t xTimeTriggerWaiters[configTIME_TRIGGER_MAX_WAITERS];
+
+/*
+ * Compare 2 belltsa a legkorbbi vrakozra. Letiltott megszaktsokkal hvand.
+ * pdFALSE-t ad vissza, ha a legkorbbi idpont mr elmlt (a hvnak kell bresztenie).
+ */
+static BaseType_t prvTimeTriggerArm(void)
+{
+	BaseType_t x;
+	BaseType_t xFound = pdFALSE;
+	uint32_t ulNow = RTI_FRC0_REG;
+	uint32_t ulEarliest = 0;
+
+	for(x = 0; x < configTIME_TRIGGER_MAX_WAITERS; x++)
+	{
+		if(xTimeTriggerWaiters[x].xTask != NULL)
+		{
+			if((xFound == pdFALSE) || ((int32_t)(xTimeTriggerWaiters[x].ulCompareFRC0 - ulEarliest) < 0))
+			{
+				ulEarliest = xTimeTriggerWaiters[x].ulCompareFRC0;
+				xFound = pdTRUE;
+			}
+		}
+	}
+
+	if(xFound == pdFALSE)
+	{
+		/* Nincs vrakoz, Compare 2 megszakts tiltsa */
+		RTI_CLEARINTENA_REG = timetriggerCOMPARE_2_INT;
+		return pdTRUE;
+	}
+
+	RTI_COMP2_REG = ulEarliest;
+	RTI_SETINTENA_REG = timetriggerCOMPARE_2_INT;
+
+	/* A compare csak egyezskor jelez: ha kzben elhagytuk, nem fog megszaktst adni. */
+	return ((int32_t)(ulEarliest - ulNow) > 0) ? pdTRUE : pdFALSE;
+}
+
+/*
+ * Az RTI modul Compare 2 egysgnek konfigurlsa az idztett indtshoz.
+ * vConfigureTimerForSysTime() utn hvand.
+ */
+void vConfigureTimerForTimeTrigger(void)
+{
+	/* Compare 2 megszakts tiltsa s trlse */
+	RTI_CLEARINTENA_REG = timetriggerCOMPARE_2_INT;
+	RTI_INTFLAG_REG = timetriggerCOMPARE_2_INT;
+
+	/* COMPSEL2 az RTIFRC0 szmllt fogja hasznlni (ugyanazt, mint a rendszerid). */
+	RTI_COMPCTRL_REG &= ~timetriggerCOMPSEL2;
+
+	/* Egylvet mkds: nincs automatikus frissts */
+	RTI_UDCP2_REG = 0U;
+
+	/* Interrupt vektor tirnytsa a sajt ISR fggvnyre s a VIM csatorna engedlyezse */
+	vimChannelMap(RTI_COMPARE_2, RTI_COMPARE_2, &vFreeRTOSRTICmp2Interrupt);
+	vimEnableInterrupt(RTI_COMPARE_2, SYS_IRQ);
+}
+
+/*
+ * Compare 2 megszakts kezel rutin: felbreszti a lejrt vrakozkat s lesti a kvetkezt.
+ */
+#pragma INTERRUPT(vFreeRTOSRTICmp2Interrupt, IRQ)
+void vFreeRTOSRTICmp2Interrupt(void)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	BaseType_t x;
+	TaskHandle_t xTask;
+	uint32_t ulNow;
+
+	/* RTI Compare 2 megszakts trlse */
+	RTI_INTFLAG_REG = timetriggerCOMPARE_2_INT;
+
+	do
+	{
+		ulNow = RTI_FRC0_REG;
+		for(x = 0; x < configTIME_TRIGGER_MAX_WAITERS; x++)
+		{
+			xTask = xTimeTriggerWaiters[x].xTask;
+			if((xTask != NULL) && ((int32_t)(xTimeTriggerWaiters[x].ulCompareFRC0 - ulNow) <= 0))
+			{
+				xTimeTriggerWaiters[x].xTask = NULL;
+				vTaskNotifyGiveFromISR(xTask, &xHigherPriorityTaskWoken);
+			}
+		}
+	} while(prvTimeTriggerArm() == pdFALSE);
+
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void vTaskDelayUntilTime(uint64_t uxWakeTimeNs)
+{
+	uint64_t uxNow;
+	unsigned int ulFRC0;
+	uint32_t ulCompare;
+	uint32_t ulDelta = 0;
+	uint64_t uxDelta;
+	TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+	BaseType_t xSlot = -1;
+	BaseType_t x;
+
+	do
+	{
+		uxNow = xGetSysTimeNs(NULL);
+		if(uxWakeTimeNs <= uxNow)
+		{
+			return;
+		}
+
+		/* Durva vrakozs az OS tick-kel: 1..3 tick marad a finom vrakozsra. */
+		if((uxWakeTimeNs - uxNow) > (3 * timetriggerTICK_NS))
+		{
+			vTaskDelay((TickType_t)((uxWakeTimeNs - uxNow) / timetriggerTICK_NS) - 1);
+		}
+
+		/* Finom vrakozs: a Compare 2 lestse a pontos RTIFRC0 rtkre. */
+		portENTER_CRITICAL();
+		{
+			uxNow = xGetSysTimeNs(&ulFRC0);
+			uxDelta = (uxWakeTimeNs <= uxNow) ? 0U : RTI_FRC0_NS_TO_TICKS(uxWakeTimeNs - uxNow);
+
+			/* A 32 bites RTIFRC0 ~114 sec alatt fordul krbe: ha a rendszerid a durva vrakozs alatt visszaugrott,
+			 * a htralv id nem fr el benne, jra a durva vrakozs jn. */
+			if(uxDelta <= timetriggerMAX_FINE_TICKS)
+			{
+				ulDelta = (uint32_t)uxDelta;
+				ulCompare = ulFRC0 + ulDelta;
+
+				if(ulDelta > timetriggerMIN_ARM_TICKS)
+				{
+					for(x = 0; x < configTIME_TRIGGER_MAX_WAITERS; x++)
+					{
+						if(xTimeTriggerWaiters[x].xTask == NULL)
+						{
+							xTimeTriggerWaiters[x].ulCompareFRC0 = ulCompare;
+							xTimeTriggerWaiters[x].xTask = xSelf;
+							xSlot = x;
+							/* Ha egy korbbi vrakoz mr lejrt, a fggben lv megszakts kezeli. */
+							(void)prvTimeTriggerArm();
+							break;
+						}
+					}
+				}
+			}
+		}
+		portEXIT_CRITICAL();
+	} while(uxDelta > timetriggerMAX_FINE_TICKS);
+
+	if(xSlot >= 0)
+	{
+		/* Egy korbbi, el nem fogyasztott notification miatt se bredjnk korn. */
+		while(xTimeTriggerWaiters[xSlot].xTask == xSelf)
+		{
+			if(ulTaskNotifyTake(pdTRUE, (TickType_t)(ulDelta / timetriggerFRC0_TICKS_PER_OS_TICK) + 2) == 0)
+			{
+				break;
+			}
+		}
+
+		/* Idtllps esetn a hely felszabadtsa */
+		portENTER_CRITICAL();
+		{
+			if(xTimeTriggerWaiters[xSlot].xTask == xSelf)
+			{
+				xTimeTriggerWaiters[xSlot].xTask = NULL;
+				(void)prvTimeTriggerArm();
+			}
+		}
+		portEXIT_CRITICAL();
+	}
+	else if(ulDelta > timetriggerMIN_ARM_TICKS)
+	{
+		/* Nincs szabad hely: tick pontossg vrakozs (felfel kerektve). */
+		vTaskDelay((TickType_t)(ulDelta / timetriggerFRC0_TICKS_PER_OS_TICK) + 1);
+	}
+	else
+	{
+		/* Nhny usec: aktv vrakozs */
+		while((int32_t)(ulCompare - RTI_FRC0_REG) > 0);
+	}
+}
+
+BaseType_t xTaskDelayUntilTimePeriodic(uint64_t *puxPreviousWakeTimeNs, uint64_t uxPeriodNs)
+{
+	uint64_t uxNext = *puxPreviousWakeTimeNs + uxPeriodNs;
+	uint64_t uxNow = xGetSysTimeNs(NULL);
+	BaseType_t xOnTime = pdTRUE;
+
+	/* Tlfuts vagy a rendszerid ugrsa (NTP/PTP lps): jraigazts a fzis megtartsval. */
+	if((uxNow >= uxNext) || ((uxNext - uxNow) > uxPeriodNs))
+	{
+		uxNext = xTimeTriggerGetNextAlignedTime(uxPeriodNs, *puxPreviousWakeTimeNs % uxPeriodNs);
+		xOnTime = pdFALSE;
+	}
+
+	*puxPreviousWakeTimeNs = uxNext;
+	vTaskDelayUntilTime(uxNext);
+
+	return xOnTime;
+}
+
+uint64_t xTimeTriggerGetNextAlignedTime(uint64_t uxPeriodNs, uint64_t uxPhaseNs)
+{
+	uint64_t uxNow = xGetSysTimeNs(NULL);
+
+	uxPhaseNs %= uxPeriodNs;
+	return (((uxNow - uxPhaseNs) / uxPeriodNs) + 1) * uxPeriodNs + uxPhaseNs;
+}